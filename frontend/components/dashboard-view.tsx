@@ -4,11 +4,13 @@ import { useEffect, useState } from "react";
 import { Card } from "@/components/ui/card";
 import { Badge } from "@/components/ui/badge";
 import { Button } from "@/components/ui/button";
+import { Input } from "@/components/ui/input";
 import { SensorCard } from "@/components/sensor-card";
 import { PumpCard } from "@/components/pump-card";
 import { ChartCard } from "@/components/chart-card";
 import { SystemStatus } from "@/components/system-status";
 import { ThemeToggle } from "@/components/theme-toggle";
+import { decodeSeries } from "@/lib/series-codec";
 import {
   Droplets,
   Beaker,
@@ -29,7 +31,10 @@ interface HydroponicData {
     mac: string;
     senal: number;
     ip: string;
-    timestamp: number;
+    timestamp: number; // ms epoch (ms desde el arranque si hora_sincronizada es false)
+    boot_id?: number;
+    seq?: number;
+    hora_sincronizada?: boolean;
   };
   sensores?: {
     ph4502c?: { ph: number };
@@ -59,6 +64,39 @@ interface HydroponicData {
   };
 }
 
+// Bloque de historial escrito por el ESP32 en historial/<AAAA-MM-DD>/<segundo del día>:
+// arreglos JSON, o empaquetado en base64 (z) si el firmware usa HISTORY_PACKED
+interface HistoryChunk {
+  t0: number; // Epoch UTC en ms (en segundos si el bloque trae t en lugar de dt)
+  b?: number; // boot_id
+  s0?: number; // seq de la primera muestra
+  dt?: number[]; // Desplazamiento de cada muestra desde t0 (ms)
+  ds?: number[]; // Desplazamiento de cada seq desde s0
+  t?: number[]; // Firmware anterior: desplazamiento desde t0 (s), sin boot_id ni seq
+  ph?: Array<number | null>; // pH × 100
+  tds?: Array<number | null>;
+  ldr?: number[];
+  n?: number;
+  z?: string; // SeriesCodec en base64
+}
+
+// Fecha UTC "AAAA-MM-DD", la misma que usa el ESP32 para fragmentar el historial
+const utcDay = (date: Date) => date.toISOString().split("T")[0];
+
+// Días UTC entre dos fechas "AAAA-MM-DD", ambos incluidos
+const daysInRange = (from: string, to: string) => {
+  const days: string[] = [];
+  const end = new Date(`${to}T00:00:00Z`);
+  for (
+    let d = new Date(`${from}T00:00:00Z`);
+    d <= end && days.length < 366;
+    d.setUTCDate(d.getUTCDate() + 1)
+  ) {
+    days.push(utcDay(d));
+  }
+  return days;
+};
+
 export default function DashboardView() {
   const [data, setData] = useState<HydroponicData | null>(null);
   const [phHistory, setPhHistory] = useState<
@@ -72,6 +110,10 @@ export default function DashboardView() {
   const [lastAlert, setLastAlert] = useState<string | null>(null);
   const [ldrAlert, setLdrAlert] = useState<string | null>(null);
   const [isDownloading, setIsDownloading] = useState(false);
+  const [downloadFrom, setDownloadFrom] = useState(() =>
+    utcDay(new Date(Date.now() - 6 * 86400000))
+  );
+  const [downloadTo, setDownloadTo] = useState(() => utcDay(new Date()));
   const [isResetting, setIsResetting] = useState(false);
   const [isEmergencyActive, setIsEmergencyActive] = useState(false);
   const [isTogglingEmergency, setIsTogglingEmergency] = useState(false);
@@ -198,43 +240,81 @@ export default function DashboardView() {
       const app = initializeApp(firebaseConfig);
       const db = getDatabase(app);
 
-      // Obtener datos del historial
-      const phRef = ref(db, "/hydroponic_data/historial/ph");
-      const tdsRef = ref(db, "/hydroponic_data/historial/tds");
-      const ldrRef = ref(db, "/hydroponic_data/historial/ldr");
-
-      const [phSnapshot, tdsSnapshot, ldrSnapshot] = await Promise.all([
-        get(phRef),
-        get(tdsRef),
-        get(ldrRef),
-      ]);
-
-      const phData = phSnapshot.val() || {};
-      const tdsData = tdsSnapshot.val() || {};
-      const ldrData = ldrSnapshot.val() || {};
+      // Un nodo por día: solo se descarga el rango pedido
+      const days = daysInRange(downloadFrom, downloadTo);
+      const snapshots = await Promise.all(
+        days.map((day) => get(ref(db, `/hydroponic_data/historial/${day}`)))
+      );
 
-      // Combinar datos por timestamp
-      const allTimestamps = new Set([
-        ...Object.keys(phData),
-        ...Object.keys(tdsData),
-        ...Object.keys(ldrData),
-      ]);
+      // Desempaquetar los bloques; una muestra repetida por un reenvío tiene
+      // el mismo (boot_id, seq) y se guarda una sola vez
+      type Row = {
+        time: number;
+        boot: string;
+        seq: string;
+        ph: string;
+        tds: string;
+        ldr: string;
+      };
+      const rows = new Map<string, Row>();
+      const addRow = (row: Row) =>
+        rows.set(row.seq ? `${row.boot}:${row.seq}` : `t${row.time}`, row);
+      const value = (v: number | null | undefined, scale: number) =>
+        v === null || v === undefined ? "" : String(v / scale);
+
+      snapshots.forEach((snapshot) => {
+        const chunks: Record<string, HistoryChunk> = snapshot.val() || {};
+        Object.values(chunks).forEach((chunk) => {
+          if (chunk.z) {
+            const samples = decodeSeries(chunk.z);
+            if (!samples) {
+              console.warn("Bloque de historial ilegible:", chunk.t0);
+            }
+            (samples || []).forEach((s) => {
+              addRow({
+                time: s.time,
+                boot: s.bootId ? String(s.bootId) : "",
+                seq: s.bootId ? String(s.seq) : "",
+                ph: isFinite(s.ph) ? s.ph.toFixed(2) : "",
+                tds: isFinite(s.tds) ? String(s.tds) : "",
+                ldr: String(s.ldr),
+              });
+            });
+            return;
+          }
+          const fields = (i: number) => ({
+            ph: value(chunk.ph?.[i], 100),
+            tds: value(chunk.tds?.[i], 1),
+            ldr: value(chunk.ldr?.[i], 1),
+          });
+          (chunk.dt || []).forEach((offset, i) => {
+            addRow({
+              time: chunk.t0 + offset,
+              boot: String(chunk.b ?? ""),
+              seq: String((chunk.s0 ?? 0) + (chunk.ds?.[i] ?? 0)),
+              ...fields(i),
+            });
+          });
+          (chunk.t || []).forEach((offset, i) => {
+            addRow({ time: (chunk.t0 + offset) * 1000, boot: "", seq: "", ...fields(i) });
+          });
+        });
+      });
 
-      const sortedTimestamps = Array.from(allTimestamps)
-        .map(Number)
-        .sort((a, b) => a - b);
+      // Orden por hora; a igual hora, por arranque y secuencia
+      const sortedRows = Array.from(rows.values()).sort(
+        (a, b) =>
+          a.time - b.time ||
+          Number(a.boot) - Number(b.boot) ||
+          Number(a.seq) - Number(b.seq)
+      );
 
       // Crear contenido CSV
-      let csvContent = "Timestamp,Fecha y Hora,pH,TDS,LDR\n";
+      let csvContent = "Timestamp,Fecha y Hora,Boot ID,Seq,pH,TDS,LDR\n";
 
-      sortedTimestamps.forEach((timestamp) => {
-        const date = new Date(timestamp);
-        const formattedDate = date.toLocaleString("es-ES");
-        const ph = phData[timestamp] || "";
-        const tds = tdsData[timestamp] || "";
-        const ldr = ldrData[timestamp] || "";
-
-        csvContent += `${timestamp},"${formattedDate}",${ph},${tds},${ldr}\n`;
+      sortedRows.forEach(({ time, boot, seq, ph, tds, ldr }) => {
+        const formattedDate = new Date(time).toLocaleString("es-ES");
+        csvContent += `${time},"${formattedDate}",${boot},${seq},${ph},${tds},${ldr}\n`;
       });
 
       // Crear blob y descargar
@@ -242,9 +322,7 @@ export default function DashboardView() {
       const link = document.createElement("a");
       const url = URL.createObjectURL(blob);
 
-      const filename = `datos_hidroponico_${
-        new Date().toISOString().split("T")[0]
-      }.csv`;
+      const filename = `datos_hidroponico_${downloadFrom}_${downloadTo}.csv`;
       link.setAttribute("href", url);
       link.setAttribute("download", filename);
       link.style.visibility = "hidden";
@@ -363,9 +441,11 @@ export default function DashboardView() {
   };
 
   const isOnline = data?.diagnostico?.estado === "Conectado";
-  const lastUpdate = data?.diagnostico?.timestamp
-    ? new Date(data.diagnostico.timestamp).toLocaleString("es-ES")
-    : "--";
+  // Sin hora SNTP el timestamp es el tiempo desde el arranque, no una fecha
+  const lastUpdate =
+    data?.diagnostico?.timestamp && data.diagnostico.hora_sincronizada !== false
+      ? new Date(data.diagnostico.timestamp).toLocaleString("es-ES")
+      : "--";
 
   return (
     <div className="min-h-screen bg-background p-3 sm:p-4 md:p-6 lg:p-8">
@@ -395,9 +475,27 @@ export default function DashboardView() {
             
             <div className="flex items-center gap-2 sm:gap-3">
             <ThemeToggle />
+            <Input
+              type="date"
+              value={downloadFrom}
+              max={downloadTo}
+              onChange={(e) => setDownloadFrom(e.target.value)}
+              aria-label="Descargar desde"
+              className="h-8 w-auto text-xs sm:text-sm"
+            />
+            <Input
+              type="date"
+              value={downloadTo}
+              min={downloadFrom}
+              onChange={(e) => setDownloadTo(e.target.value)}
+              aria-label="Descargar hasta"
+              className="h-8 w-auto text-xs sm:text-sm"
+            />
             <Button
               onClick={handleDownloadData}
-              disabled={isDownloading}
+              disabled={
+                isDownloading || !downloadFrom || downloadFrom > downloadTo
+              }
               variant="outline"
               size="sm"
               className="gap-2"
@@ -0,0 +1,167 @@
+// Decodificador de los bloques empaquetados del historial (lib/SeriesCodec en el firmware).
+// Formato: versión (8) | n (8) | boot_id (32) | tiempos (ms) delta-de-delta | seq delta-de-delta |
+//          pH XOR | TDS XOR | LDR delta zigzag varint
+// La versión 1 no trae boot_id ni seq y sus tiempos van en segundos de 32 bits.
+
+export interface SeriesSample {
+  time: number; // Epoch UTC en ms
+  bootId: number;
+  seq: number; // Junto con bootId identifica la muestra (0 en la versión 1)
+  ph: number;
+  tds: number;
+  ldr: number;
+}
+
+const VERSION = 2;
+const VERSION_V1 = 1;
+
+// Tramos del delta-de-delta: bits del valor y desplazamiento, por cantidad de unos del prefijo
+const BUCKETS = [
+  { valueBits: 7, offset: 63 },
+  { valueBits: 9, offset: 255 },
+  { valueBits: 12, offset: 2047 },
+];
+
+class BitReader {
+  private pos = 0;
+  error = false;
+
+  constructor(private bytes: Uint8Array) {}
+
+  // Hasta 32 bits, sin operadores de bits para no pasar por int32
+  read(bits: number): number {
+    if (this.error || this.pos + bits > this.bytes.length * 8) {
+      this.error = true;
+      return 0;
+    }
+    let value = 0;
+    while (bits > 0) {
+      const used = this.pos % 8;
+      const take = Math.min(8 - used, bits);
+      const chunk =
+        (this.bytes[this.pos >> 3] >> (8 - used - take)) & ((1 << take) - 1);
+      value = value * (1 << take) + chunk;
+      this.pos += take;
+      bits -= take;
+    }
+    return value;
+  }
+}
+
+const view = new DataView(new ArrayBuffer(4));
+const bitsToFloat = (bits: number) => {
+  view.setUint32(0, bits >>> 0);
+  return view.getFloat32(0);
+};
+
+// Valor de 64 bits con signo (hasta 2^53, suficiente para ms epoch)
+function readInt64(r: BitReader): number {
+  const hi = r.read(32);
+  const lo = r.read(32);
+  return (hi >= 2 ** 31 ? hi - 2 ** 32 : hi) * 2 ** 32 + lo;
+}
+
+// Delta-de-delta de 32 bits (módulo 2^32) o de 64 bits (ms epoch)
+function readDeltas(r: BitReader, n: number, bits: 32 | 64): number[] {
+  const out: number[] = [];
+  const wrap = (v: number) => (bits === 32 ? v >>> 0 : v);
+  let prev = 0;
+  let prevDelta = 0;
+  for (let i = 0; i < n; i++) {
+    if (i === 0) {
+      prev = bits === 32 ? r.read(32) : readInt64(r);
+    } else {
+      let dod = 0;
+      if (r.read(1)) {
+        let ones = 1;
+        while (ones < 4 && r.read(1)) ones++;
+        if (ones === 4) {
+          dod = bits === 32 ? r.read(32) : readInt64(r);
+        } else {
+          const b = BUCKETS[ones - 1];
+          dod = r.read(b.valueBits) - b.offset;
+        }
+      }
+      prevDelta = wrap(prevDelta + dod);
+      prev = wrap(prev + prevDelta);
+    }
+    out.push(prev);
+  }
+  return out;
+}
+
+function readFloats(r: BitReader, n: number): number[] {
+  const out: number[] = [];
+  let prev = 0;
+  let leading = 0;
+  let trailing = 0;
+  for (let i = 0; i < n; i++) {
+    if (i === 0) {
+      prev = r.read(32);
+    } else if (r.read(1)) {
+      if (r.read(1)) {
+        leading = r.read(5);
+        const meaningful = Math.min(r.read(5) + 1, 32 - leading);
+        trailing = 32 - leading - meaningful;
+      }
+      const meaningful = 32 - leading - trailing;
+      prev = (prev ^ (r.read(meaningful) * 2 ** trailing)) >>> 0;
+    }
+    out.push(bitsToFloat(prev));
+  }
+  return out;
+}
+
+function readInts(r: BitReader, n: number): number[] {
+  const out: number[] = [];
+  let prev = 0;
+  for (let i = 0; i < n; i++) {
+    let zz = 0;
+    for (let shift = 0; shift < 35; shift += 7) {
+      const group = r.read(8);
+      zz += (group & 0x7f) * 2 ** shift;
+      if (!(group & 0x80)) break;
+    }
+    const delta = zz % 2 ? -(zz + 1) / 2 : zz / 2;
+    prev = (prev + delta) | 0;
+    out.push(prev);
+  }
+  return out;
+}
+
+// Muestras del bloque en base64, o null si está truncado o es de otra versión
+export function decodeSeries(base64: string): SeriesSample[] | null {
+  let bytes: Uint8Array;
+  try {
+    bytes = Uint8Array.from(atob(base64), (c) => c.charCodeAt(0));
+  } catch {
+    return null;
+  }
+  const r = new BitReader(bytes);
+  const version = r.read(8);
+  if (version !== VERSION && version !== VERSION_V1) return null;
+  const n = r.read(8);
+  let bootId = 0;
+  let times: number[];
+  let seqs: number[];
+  if (version === VERSION) {
+    bootId = r.read(32);
+    times = readDeltas(r, n, 64);
+    seqs = readDeltas(r, n, 32);
+  } else {
+    times = readDeltas(r, n, 32).map((t) => t * 1000);
+    seqs = times.map(() => 0);
+  }
+  const ph = readFloats(r, n);
+  const tds = readFloats(r, n);
+  const ldr = readInts(r, n);
+  if (r.error) return null;
+  return times.map((time, i) => ({
+    time,
+    bootId,
+    seq: seqs[i],
+    ph: ph[i],
+    tds: tds[i],
+    ldr: ldr[i],
+  }));
+}
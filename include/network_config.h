@@ -89,6 +89,29 @@ const char *WIFI_PASSWORD = "1234567890";
  */
 #define DATA_SEND_INTERVAL 2000
 
+// ============================================================================
+// TRANSPORTE LOCAL (pruebas y benchmarks)
+// ============================================================================
+
+/**
+ * @brief Publicar en un servidor local en lugar de Firebase
+ * @note 1: HTTP plano (RestTransport) contra tools/rtdb_server;
+ *       0: Firebase_ESP_Client. También con -DTRANSPORT_LOCAL=1 en build_flags
+ */
+#ifndef TRANSPORT_LOCAL
+#define TRANSPORT_LOCAL 0
+#endif
+
+/**
+ * @brief IP de la máquina que corre tools/rtdb_server
+ */
+#define LOCAL_RTDB_HOST "192.168.1.50"
+
+/**
+ * @brief Puerto de tools/rtdb_server (--port)
+ */
+#define LOCAL_RTDB_PORT 8787
+
 // ============================================================================
 // CONFIGURACIÓN DE TIMEOUTS
 // ============================================================================
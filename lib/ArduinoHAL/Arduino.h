@@ -0,0 +1,221 @@
+#ifndef ARDUINO_HAL_ARDUINO_H
+#define ARDUINO_HAL_ARDUINO_H
+
+/**
+ * @file Arduino.h
+ * @brief Núcleo Arduino/ESP32 simulado para el entorno [env:native]
+ *
+ * Implementa solo la parte de la API que usan los módulos de lib/: tiempo,
+ * ADC, GPIO, Serial, String y los restos de FreeRTOS que aparecen en
+ * SensorHub. El reloj es virtual: delay() y delayMicroseconds() avanzan el
+ * tiempo sin dormir, así el código corre a velocidad completa en el host.
+ * Los tests controlan el hardware simulado con ArduinoHAL.h.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <cmath>
+#include <string>
+
+using std::abs;
+using std::isfinite;
+
+// ============================================================================
+// CONSTANTES
+// ============================================================================
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+typedef enum
+{
+    ADC_0db,
+    ADC_2_5db,
+    ADC_6db,
+    ADC_11db
+} adc_attenuation_t;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ============================================================================
+// TIEMPO (reloj virtual)
+// ============================================================================
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// SNTP: en el host time() ya da la hora real
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2 = nullptr,
+                const char *server3 = nullptr);
+
+// ============================================================================
+// ADC Y GPIO
+// ============================================================================
+
+uint16_t analogRead(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation);
+int8_t digitalPinToAnalogChannel(uint8_t pin);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+// ============================================================================
+// FREERTOS (lo mínimo que usa SensorHub)
+// ============================================================================
+
+struct portMUX_TYPE
+{
+    uint32_t owner;
+    uint32_t count;
+};
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+typedef void *TaskHandle_t;
+typedef int BaseType_t;
+#define pdPASS 1
+#define pdFAIL 0
+#define configMAX_PRIORITIES 25
+#define portTICK_PERIOD_MS 1
+
+// Sin planificador en el host: crear tareas falla y SensorHub usa el timer
+// (con hal::setTaskThreads(true) cada tarea es un hilo)
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char *name, uint32_t stack,
+                                   void *arg, uint32_t priority, TaskHandle_t *handle, int core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(uint32_t ticks);
+
+// ============================================================================
+// STRING
+// ============================================================================
+
+class String
+{
+public:
+    String(const char *s = "") : s(s ? s : "") {}
+    String(const std::string &s) : s(s) {}
+    String(char c) : s(1, c) {}
+    String(int value) : s(std::to_string(value)) {}
+    String(unsigned int value) : s(std::to_string(value)) {}
+    String(long value) : s(std::to_string(value)) {}
+    String(unsigned long value) : s(std::to_string(value)) {}
+    String(float value, unsigned int decimals = 2);
+    String(double value, unsigned int decimals = 2);
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    bool isEmpty() const { return s.empty(); }
+    char charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    bool equals(const String &other) const { return s == other.s; }
+    bool equalsIgnoreCase(const String &other) const;
+    bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+    bool endsWith(const String &suffix) const;
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String &str, unsigned int from = 0) const;
+
+    String substring(unsigned int from) const { return from < s.size() ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    long toInt() const { return strtol(s.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s.c_str(), nullptr); }
+
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+    void replace(const String &from, const String &to);
+
+    String &operator+=(const String &other)
+    {
+        s += other.s;
+        return *this;
+    }
+    bool operator==(const String &other) const { return s == other.s; }
+    bool operator==(const char *other) const { return s == other; }
+    bool operator!=(const String &other) const { return s != other.s; }
+    bool operator!=(const char *other) const { return s != other; }
+    bool operator<(const String &other) const { return s < other.s; }
+
+    friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+
+    const std::string &str() const { return s; }
+
+private:
+    std::string s;
+};
+
+// ============================================================================
+// SERIAL (salida capturada, entrada inyectable)
+// ============================================================================
+
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud);
+    void end() {}
+    operator bool() const { return true; }
+
+    int available();
+    int read();
+    int peek();
+    int availableForWrite(); // Espacio libre en el FIFO de TX (hal::setSerialTxRoom)
+    String readString();
+    String readStringUntil(char terminator);
+    void flush() {}
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t *data, size_t len);
+    size_t print(const char *s);
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t print(char c);
+    size_t print(int value, int base = 10);
+    size_t print(unsigned int value, int base = 10);
+    size_t print(long value, int base = 10);
+    size_t print(unsigned long value, int base = 10);
+    size_t print(double value, int decimals = 2);
+    size_t println() { return print("\n"); }
+    template <typename T>
+    size_t println(const T &value)
+    {
+        return print(value) + println();
+    }
+    template <typename T>
+    size_t println(const T &value, int format)
+    {
+        return print(value, format) + println();
+    }
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+
+// ============================================================================
+// ESP
+// ============================================================================
+
+class EspClass
+{
+public:
+    void restart();
+    uint32_t getFreeHeap() const { return 200000; }
+    uint32_t getCycleCount() const;
+};
+
+extern EspClass ESP;
+
+#endif // ARDUINO_HAL_ARDUINO_H
@@ -0,0 +1,915 @@
+#include "ArduinoHAL.h"
+#include "EEPROM.h"
+#include "LittleFS.h"
+#include "esp_timer.h"
+#include "WiFiClient.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+fs::LittleFSFS LittleFS;
+EspClass ESP;
+
+struct esp_timer
+{
+    esp_timer_cb_t callback;
+    void *arg;
+    uint64_t periodUs; // 0 = una sola vez
+    uint64_t dueUs;
+    bool active;
+};
+
+// ============================================================================
+// ESTADO SIMULADO
+// ============================================================================
+
+namespace
+{
+    struct PinState
+    {
+        uint8_t mode = INPUT;
+        int output = -1;
+        int input = LOW;
+        uint32_t writes = 0;
+        uint16_t analog = 0;
+        hal::AnalogSource source;
+        uint32_t analogReads = 0;
+    };
+
+    struct State
+    {
+        std::atomic<uint64_t> nowUs{0}; // Lo leen también las tareas en hilos (setTaskThreads)
+        uint32_t analogReadUs = 0;
+        bool inTimer = false;
+        PinState pins[hal::PIN_COUNT];
+        std::vector<uint8_t> eeprom;
+        uint32_t eepromCommits = 0;
+        std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+        uint64_t fsWritten = 0;
+        size_t fsCapacity = 0x160000; // Partición "spiffs" de default.csv
+        std::string serialIn;
+        size_t serialPos = 0;
+        std::string serialOut;
+        bool serialEcho = false;
+        int serialTxRoom = -1;
+        bool restart = false;
+        // Los timers sobreviven a reset() para que los handles que aún
+        // guarde el código (p. ej. un SensorHub) sigan siendo válidos
+        std::vector<std::unique_ptr<esp_timer>> timers;
+    };
+
+    State &state()
+    {
+        static State s;
+        return s;
+    }
+
+    PinState *pinState(uint8_t pin)
+    {
+        return pin < hal::PIN_COUNT ? &state().pins[pin] : nullptr;
+    }
+
+    void emit(const char *data, size_t len)
+    {
+        state().serialOut.append(data, len);
+        if (state().serialEcho)
+            fwrite(data, 1, len, stdout);
+        int &room = state().serialTxRoom;
+        if (room >= 0)
+            room = len < (size_t)room ? room - (int)len : 0;
+    }
+
+    esp_timer *nextDue(uint64_t limitUs)
+    {
+        esp_timer *next = nullptr;
+        for (auto &t : state().timers)
+        {
+            if (t->active && t->dueUs <= limitUs && (!next || t->dueUs < next->dueUs))
+                next = t.get();
+        }
+        return next;
+    }
+
+    std::string formatUnsigned(unsigned long value, int base)
+    {
+        if (base < 2 || base > 16)
+            base = 10;
+        char buf[65];
+        int i = sizeof(buf) - 1;
+        buf[i] = '\0';
+        do
+        {
+            buf[--i] = "0123456789ABCDEF"[value % base];
+            value /= base;
+        } while (value && i > 0);
+        return std::string(&buf[i]);
+    }
+}
+
+// ============================================================================
+// CONTROL DESDE LOS TESTS
+// ============================================================================
+
+namespace hal
+{
+    void reset()
+    {
+        State &s = state();
+        s.nowUs = 0;
+        s.analogReadUs = 0;
+        s.inTimer = false;
+        for (auto &p : s.pins)
+            p = PinState();
+        s.eeprom.clear();
+        s.eepromCommits = 0;
+        s.files.clear();
+        s.fsWritten = 0;
+        s.fsCapacity = 0x160000;
+        s.serialIn.clear();
+        s.serialPos = 0;
+        s.serialOut.clear();
+        s.serialTxRoom = -1;
+        s.restart = false;
+        for (auto &t : s.timers)
+            t->active = false;
+    }
+
+    uint64_t nowUs() { return state().nowUs; }
+
+    void advanceUs(uint64_t us)
+    {
+        State &s = state();
+        uint64_t target = s.nowUs + us;
+        // Los callbacks pueden volver a llamar a delay(); en ese caso solo
+        // avanza el reloj, como un ISR que no cede el procesador
+        if (s.inTimer)
+        {
+            s.nowUs = target;
+            return;
+        }
+        while (esp_timer *t = nextDue(target))
+        {
+            s.nowUs = std::max(s.nowUs.load(), t->dueUs);
+            if (t->periodUs)
+                t->dueUs += t->periodUs;
+            else
+                t->active = false;
+            s.inTimer = true;
+            t->callback(t->arg);
+            s.inTimer = false;
+        }
+        s.nowUs = std::max(s.nowUs.load(), target);
+    }
+
+    void setAnalogReadUs(uint32_t us) { state().analogReadUs = us; }
+
+    void setAnalog(uint8_t pin, uint16_t value)
+    {
+        if (PinState *p = pinState(pin))
+        {
+            p->analog = value;
+            p->source = nullptr;
+        }
+    }
+
+    void setAnalogSource(uint8_t pin, AnalogSource source)
+    {
+        if (PinState *p = pinState(pin))
+            p->source = std::move(source);
+    }
+
+    uint32_t analogReadCount(uint8_t pin)
+    {
+        PinState *p = pinState(pin);
+        return p ? p->analogReads : 0;
+    }
+
+    void setDigital(uint8_t pin, int level)
+    {
+        if (PinState *p = pinState(pin))
+            p->input = level ? HIGH : LOW;
+    }
+
+    int outputLevel(uint8_t pin)
+    {
+        PinState *p = pinState(pin);
+        return p ? p->output : -1;
+    }
+
+    uint8_t pinModeOf(uint8_t pin)
+    {
+        PinState *p = pinState(pin);
+        return p ? p->mode : INPUT;
+    }
+
+    uint32_t writeCount(uint8_t pin)
+    {
+        PinState *p = pinState(pin);
+        return p ? p->writes : 0;
+    }
+
+    std::vector<uint8_t> &eepromData() { return state().eeprom; }
+    uint32_t eepromCommits() { return state().eepromCommits; }
+
+    std::vector<std::string> fsList()
+    {
+        std::vector<std::string> paths;
+        for (auto &f : state().files)
+            paths.push_back(f.first);
+        return paths;
+    }
+
+    void fsTruncate(const std::string &path, size_t size)
+    {
+        auto it = state().files.find(path);
+        if (it != state().files.end() && size < it->second->size())
+            it->second->resize(size);
+    }
+
+    uint64_t fsBytesWritten() { return state().fsWritten; }
+    void fsSetCapacity(size_t bytes) { state().fsCapacity = bytes; }
+
+    void serialInput(const std::string &text) { state().serialIn += text; }
+    const std::string &serialOutput() { return state().serialOut; }
+    bool serialContains(const std::string &text) { return state().serialOut.find(text) != std::string::npos; }
+    void clearSerialOutput() { state().serialOut.clear(); }
+    void setSerialEcho(bool echo) { state().serialEcho = echo; }
+    void setSerialTxRoom(int bytes) { state().serialTxRoom = bytes; }
+
+    bool restartRequested() { return state().restart; }
+
+    size_t activeTimers()
+    {
+        return std::count_if(state().timers.begin(), state().timers.end(),
+                             [](const std::unique_ptr<esp_timer> &t) { return t->active; });
+    }
+}
+
+// ============================================================================
+// TIEMPO
+// ============================================================================
+
+unsigned long millis() { return state().nowUs / 1000ULL; }
+unsigned long micros() { return state().nowUs; }
+void delay(uint32_t ms) { hal::advanceUs(ms * 1000ULL); }
+void delayMicroseconds(uint32_t us) { hal::advanceUs(us); }
+void yield() {}
+void configTime(long, int, const char *, const char *, const char *) {}
+
+// ============================================================================
+// ADC Y GPIO
+// ============================================================================
+
+uint16_t analogRead(uint8_t pin)
+{
+    PinState *p = pinState(pin);
+    if (!p)
+        return 0;
+    p->analogReads++;
+    uint16_t value = p->source ? p->source(state().nowUs) : p->analog;
+    if (state().analogReadUs)
+        hal::advanceUs(state().analogReadUs);
+    return value > 4095 ? 4095 : value;
+}
+
+void analogReadResolution(uint8_t) {}
+void analogSetPinAttenuation(uint8_t, adc_attenuation_t) {}
+
+int8_t digitalPinToAnalogChannel(uint8_t pin)
+{
+    // ADC1 del ESP32: GPIO36..39 -> canales 0..3, GPIO32..35 -> 4..7
+    if (pin >= 36 && pin <= 39)
+        return pin - 36;
+    if (pin >= 32 && pin <= 35)
+        return pin - 28;
+    return -1;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (PinState *p = pinState(pin))
+        p->mode = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (PinState *p = pinState(pin))
+    {
+        p->output = value ? HIGH : LOW;
+        p->writes++;
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    PinState *p = pinState(pin);
+    if (!p)
+        return LOW;
+    return p->mode == OUTPUT ? (p->output == HIGH ? HIGH : LOW) : p->input;
+}
+
+// ============================================================================
+// FREERTOS
+// ============================================================================
+
+namespace
+{
+    std::atomic<bool> taskThreads(false);
+    std::list<std::thread> tasks; // Lista: el handle es la dirección del hilo y no se mueve
+    thread_local bool inTask = false;
+}
+
+namespace hal
+{
+    void setTaskThreads(bool enabled) { taskThreads = enabled; }
+
+    void joinTasks()
+    {
+        for (auto &t : tasks)
+            t.join();
+        tasks.clear();
+    }
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void *), const char *, uint32_t,
+                                   void *arg, uint32_t, TaskHandle_t *handle, int)
+{
+    if (!taskThreads)
+    {
+        if (handle)
+            *handle = nullptr;
+        return pdFAIL;
+    }
+    tasks.emplace_back([task, arg] {
+        inTask = true;
+        task(arg);
+    });
+    if (handle)
+        *handle = &tasks.back();
+    return pdPASS;
+}
+
+// Un hilo no se puede borrar desde afuera: la tarea termina al volver de su
+// función, así que solo vale vTaskDelete(nullptr) como última instrucción
+void vTaskDelete(TaskHandle_t) {}
+
+void vTaskDelay(uint32_t ticks)
+{
+    // Una tarea en hilo no mueve el reloj virtual; con hilos, quien espera les cede tiempo real
+    if (!inTask)
+        delay(ticks * portTICK_PERIOD_MS);
+    if (taskThreads)
+        std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+}
+
+// ============================================================================
+// ESP_TIMER
+// ============================================================================
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out)
+{
+    if (!args || !args->callback || !out)
+        return ESP_ERR_INVALID_ARG;
+    std::unique_ptr<esp_timer> t(new esp_timer{args->callback, args->arg, 0, 0, false});
+    *out = t.get();
+    state().timers.push_back(std::move(t));
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs)
+{
+    if (!timer || periodUs == 0)
+        return ESP_ERR_INVALID_ARG;
+    if (timer->active)
+        return ESP_ERR_INVALID_STATE;
+    timer->periodUs = periodUs;
+    timer->dueUs = state().nowUs + periodUs;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+    if (timer->active)
+        return ESP_ERR_INVALID_STATE;
+    timer->periodUs = 0;
+    timer->dueUs = state().nowUs + timeoutUs;
+    timer->active = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer)
+        return ESP_ERR_INVALID_ARG;
+    if (!timer->active)
+        return ESP_ERR_INVALID_STATE;
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    auto &timers = state().timers;
+    auto it = std::find_if(timers.begin(), timers.end(),
+                           [timer](const std::unique_ptr<esp_timer> &t) { return t.get() == timer; });
+    if (it == timers.end())
+        return ESP_ERR_INVALID_ARG;
+    if ((*it)->active)
+        return ESP_ERR_INVALID_STATE;
+    timers.erase(it);
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time() { return state().nowUs; }
+
+// ============================================================================
+// EEPROM
+// ============================================================================
+
+std::vector<uint8_t> &EEPROMClass::data() const { return state().eeprom; }
+
+bool EEPROMClass::begin(size_t size)
+{
+    // Flash borrada: todo en 0xFF, igual que un ESP32 recién programado
+    if (data().size() != size)
+        data().resize(size, 0xFF);
+    return true;
+}
+
+bool EEPROMClass::commit()
+{
+    state().eepromCommits++;
+    return !data().empty();
+}
+
+uint8_t EEPROMClass::read(int address) const
+{
+    return (address >= 0 && (size_t)address < length()) ? data()[address] : 0;
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+    if (address >= 0 && (size_t)address < length())
+        data()[address] = value;
+}
+
+// ============================================================================
+// STRING
+// ============================================================================
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+    s = buf;
+}
+
+bool String::equalsIgnoreCase(const String &other) const
+{
+    if (s.size() != other.s.size())
+        return false;
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        if (tolower((unsigned char)s[i]) != tolower((unsigned char)other.s[i]))
+            return false;
+    }
+    return true;
+}
+
+bool String::endsWith(const String &suffix) const
+{
+    return s.size() >= suffix.s.size() &&
+           s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const
+{
+    size_t pos = s.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String &str, unsigned int from) const
+{
+    size_t pos = s.find(str.s, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from, unsigned int to) const
+{
+    if (from > to)
+        std::swap(from, to);
+    if (from >= s.size())
+        return String();
+    return String(s.substr(from, std::min<size_t>(to, s.size()) - from));
+}
+
+void String::trim()
+{
+    size_t begin = 0;
+    size_t end = s.size();
+    while (begin < end && isspace((unsigned char)s[begin]))
+        begin++;
+    while (end > begin && isspace((unsigned char)s[end - 1]))
+        end--;
+    s = s.substr(begin, end - begin);
+}
+
+void String::toUpperCase()
+{
+    for (char &c : s)
+        c = toupper((unsigned char)c);
+}
+
+void String::toLowerCase()
+{
+    for (char &c : s)
+        c = tolower((unsigned char)c);
+}
+
+void String::replace(const String &from, const String &to)
+{
+    if (from.s.empty())
+        return;
+    size_t pos = 0;
+    while ((pos = s.find(from.s, pos)) != std::string::npos)
+    {
+        s.replace(pos, from.s.size(), to.s);
+        pos += to.s.size();
+    }
+}
+
+// ============================================================================
+// SERIAL
+// ============================================================================
+
+void HardwareSerial::begin(unsigned long) {}
+
+int HardwareSerial::available()
+{
+    return state().serialIn.size() - state().serialPos;
+}
+
+int HardwareSerial::read()
+{
+    State &s = state();
+    if (s.serialPos >= s.serialIn.size())
+        return -1;
+    int c = (uint8_t)s.serialIn[s.serialPos++];
+    if (s.serialPos == s.serialIn.size())
+    {
+        s.serialIn.clear();
+        s.serialPos = 0;
+    }
+    return c;
+}
+
+int HardwareSerial::peek()
+{
+    State &s = state();
+    return s.serialPos < s.serialIn.size() ? (uint8_t)s.serialIn[s.serialPos] : -1;
+}
+
+int HardwareSerial::availableForWrite()
+{
+    // Sin límite: lo que tendría libre el buffer de TX del driver
+    return state().serialTxRoom < 0 ? 4096 : state().serialTxRoom;
+}
+
+String HardwareSerial::readString()
+{
+    std::string out;
+    int c;
+    while ((c = read()) >= 0)
+        out += (char)c;
+    return String(out);
+}
+
+String HardwareSerial::readStringUntil(char terminator)
+{
+    // Sin timeout: la entrada inyectada ya está completa
+    std::string out;
+    int c;
+    while ((c = read()) >= 0 && c != terminator)
+        out += (char)c;
+    return String(out);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    emit((const char *)&c, 1);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *data, size_t len)
+{
+    emit((const char *)data, len);
+    return len;
+}
+
+size_t HardwareSerial::print(const char *s)
+{
+    size_t len = strlen(s);
+    emit(s, len);
+    return len;
+}
+
+size_t HardwareSerial::print(char c)
+{
+    emit(&c, 1);
+    return 1;
+}
+
+size_t HardwareSerial::print(int value, int base) { return print((long)value, base); }
+size_t HardwareSerial::print(unsigned int value, int base) { return print((unsigned long)value, base); }
+
+size_t HardwareSerial::print(long value, int base)
+{
+    if (value < 0 && base == 10)
+        return print('-') + print((unsigned long)-value, base);
+    return print((unsigned long)value, base);
+}
+
+size_t HardwareSerial::print(unsigned long value, int base)
+{
+    return print(formatUnsigned(value, base).c_str());
+}
+
+size_t HardwareSerial::print(double value, int decimals)
+{
+    return print(String(value, decimals < 0 ? 0 : decimals));
+}
+
+size_t HardwareSerial::printf(const char *format, ...)
+{
+    char small[256];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (len < 0)
+        return 0;
+    if ((size_t)len < sizeof(small))
+    {
+        emit(small, len);
+        return len;
+    }
+    std::string big(len + 1, '\0');
+    va_start(args, format);
+    vsnprintf(&big[0], big.size(), format, args);
+    va_end(args);
+    emit(big.data(), len);
+    return len;
+}
+
+// ============================================================================
+// LITTLEFS
+// ============================================================================
+
+size_t fs::File::write(const uint8_t *buf, size_t len)
+{
+    if (!data || !writable)
+        return 0;
+    if (LittleFS.usedBytes() + len > LittleFS.totalBytes())
+        return 0; // Partición llena
+    if (pos + len > data->size())
+        data->resize(pos + len);
+    memcpy(data->data() + pos, buf, len);
+    pos += len;
+    state().fsWritten += len;
+    return len;
+}
+
+size_t fs::File::read(uint8_t *buf, size_t len)
+{
+    size_t n = std::min(len, (size_t)available());
+    if (n)
+        memcpy(buf, data->data() + pos, n);
+    pos += n;
+    return n;
+}
+
+int fs::File::read()
+{
+    uint8_t b;
+    return read(&b, 1) ? b : -1;
+}
+
+bool fs::File::seek(uint32_t offset, SeekMode mode)
+{
+    if (!data)
+        return false;
+    size_t base = mode == SeekCur ? pos : mode == SeekEnd ? data->size() : 0;
+    if (base + offset > data->size())
+        return false;
+    pos = base + offset;
+    return true;
+}
+
+bool fs::LittleFSFS::begin(bool, const char *, uint8_t, const char *) { return true; }
+
+bool fs::LittleFSFS::format()
+{
+    state().files.clear();
+    return true;
+}
+
+fs::File fs::LittleFSFS::open(const char *path, const char *mode, bool)
+{
+    auto &files = state().files;
+    auto it = files.find(path);
+    if (mode[0] == 'r')
+        return it == files.end() ? File() : File(path, it->second, 0, mode[1] == '+');
+
+    // "w" trunca, "a" agrega; ambos crean el archivo
+    if (it == files.end())
+        it = files.emplace(path, std::make_shared<std::vector<uint8_t>>()).first;
+    else if (mode[0] == 'w')
+        it->second = std::make_shared<std::vector<uint8_t>>();
+    return File(path, it->second, mode[0] == 'a' ? it->second->size() : 0, true);
+}
+
+bool fs::LittleFSFS::exists(const char *path) { return state().files.count(path) > 0; }
+
+bool fs::LittleFSFS::remove(const char *path) { return state().files.erase(path) > 0; }
+
+bool fs::LittleFSFS::rename(const char *from, const char *to)
+{
+    auto &files = state().files;
+    auto it = files.find(from);
+    if (it == files.end())
+        return false;
+    std::shared_ptr<std::vector<uint8_t>> data = it->second;
+    files.erase(it);
+    files[to] = data; // Reemplaza el destino, como lfs_rename
+    return true;
+}
+
+size_t fs::LittleFSFS::totalBytes() const { return state().fsCapacity; }
+
+size_t fs::LittleFSFS::usedBytes() const
+{
+    size_t used = 0;
+    for (auto &f : state().files)
+        used += f.second->size();
+    return used;
+}
+
+// ============================================================================
+// ESP
+// ============================================================================
+
+void EspClass::restart() { state().restart = true; }
+
+uint32_t EspClass::getCycleCount() const
+{
+    return (uint32_t)(state().nowUs * 240ULL); // CPU a 240 MHz
+}
+
+// ============================================================================
+// WIFI CLIENT (sockets reales)
+// ============================================================================
+
+int WiFiClient::connect(const char *host, uint16_t port, int32_t timeoutMs)
+{
+    stop();
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *res = nullptr;
+    if (getaddrinfo(host, service, &hints, &res) != 0 || !res)
+        return 0;
+
+    int s = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (s < 0)
+    {
+        freeaddrinfo(res);
+        return 0;
+    }
+    // Conexión no bloqueante para respetar timeoutMs
+    int flags = fcntl(s, F_GETFL, 0);
+    fcntl(s, F_SETFL, flags | O_NONBLOCK);
+    int rc = ::connect(s, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc != 0)
+    {
+        pollfd p = {s, POLLOUT, 0};
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (poll(&p, 1, timeoutMs) != 1 || getsockopt(s, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0)
+        {
+            ::close(s);
+            return 0;
+        }
+    }
+    fcntl(s, F_SETFL, flags);
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fd = s;
+    closed = false;
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t len)
+{
+    size_t sent = 0;
+    while (fd >= 0 && sent < len)
+    {
+        ssize_t n = send(fd, buf + sent, len - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+        {
+            closed = true;
+            break;
+        }
+        sent += size_t(n);
+    }
+    return sent;
+}
+
+int WiFiClient::available()
+{
+    if (fd < 0)
+        return 0;
+    int n = 0;
+    if (ioctl(fd, FIONREAD, &n) == 0 && n > 0)
+        return n;
+    if (closed)
+        return 0;
+    // Nada en el buffer: hasta 1 ms real (ver WiFiClient.h)
+    pollfd p = {fd, POLLIN, 0};
+    if (poll(&p, 1, 1) != 1)
+        return 0;
+    if (ioctl(fd, FIONREAD, &n) != 0 || n == 0)
+    {
+        closed = true; // Legible sin datos: el otro extremo cerró
+        return 0;
+    }
+    return n;
+}
+
+int WiFiClient::read()
+{
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int WiFiClient::read(uint8_t *buf, size_t len)
+{
+    if (fd < 0 || !len)
+        return -1;
+    ssize_t n = recv(fd, buf, len, MSG_DONTWAIT);
+    if (n == 0)
+        closed = true;
+    return n > 0 ? int(n) : -1;
+}
+
+uint8_t WiFiClient::connected()
+{
+    if (fd < 0)
+        return 0;
+    if (!closed)
+    {
+        pollfd p = {fd, POLLIN, 0};
+        int n = 0;
+        if (poll(&p, 1, 0) == 1 && (p.revents & (POLLHUP | POLLERR) ||
+                                    (ioctl(fd, FIONREAD, &n) == 0 && n == 0)))
+            closed = true;
+        else
+            return 1;
+    }
+    int n = 0;
+    return ioctl(fd, FIONREAD, &n) == 0 && n > 0; // Como en Arduino: quedan datos por leer
+}
+
+void WiFiClient::stop()
+{
+    if (fd >= 0)
+        ::close(fd);
+    fd = -1;
+    closed = false;
+}
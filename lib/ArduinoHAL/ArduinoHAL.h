@@ -0,0 +1,93 @@
+#ifndef ARDUINO_HAL_H
+#define ARDUINO_HAL_H
+
+/**
+ * @file ArduinoHAL.h
+ * @brief Control del hardware simulado en el entorno [env:native]
+ *
+ * Los tests usan estas funciones para mover el reloj virtual, definir qué
+ * devuelve cada pin analógico o digital, inyectar comandos por Serial y
+ * revisar lo que el código escribió en GPIO, EEPROM, LittleFS y Serial.
+ *
+ *   hal::reset();
+ *   hal::setAnalog(PH_PIN, 2048);
+ *   hal::setAnalogSource(TDS_PIN, [](uint64_t us) { return 1500 + ...; });
+ *   hal::advanceMs(500);          // Dispara los esp_timer vencidos
+ *   hal::serialInput("PHCAL,7\n");
+ *   TEST_ASSERT_TRUE(hal::serialContains("Calibrado"));
+ */
+
+#include <Arduino.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace hal
+{
+    constexpr uint8_t PIN_COUNT = 40;
+
+    // Vuelve todo al estado inicial: reloj en 0, pines, EEPROM, LittleFS, Serial, timers
+    void reset();
+
+    // ------------------------------------------------------------------------
+    // Reloj virtual
+    // ------------------------------------------------------------------------
+    uint64_t nowUs();
+    void advanceUs(uint64_t us); // Ejecuta en orden los esp_timer que vencen
+    inline void advanceMs(uint64_t ms) { advanceUs(ms * 1000ULL); }
+    void setAnalogReadUs(uint32_t us); // Tiempo que consume cada analogRead (0 por defecto)
+
+    // ------------------------------------------------------------------------
+    // ADC
+    // ------------------------------------------------------------------------
+    using AnalogSource = std::function<uint16_t(uint64_t nowUs)>;
+    void setAnalog(uint8_t pin, uint16_t value);
+    void setAnalogSource(uint8_t pin, AnalogSource source);
+    uint32_t analogReadCount(uint8_t pin);
+
+    // ------------------------------------------------------------------------
+    // GPIO
+    // ------------------------------------------------------------------------
+    void setDigital(uint8_t pin, int level); // Nivel que ve un pin INPUT
+    int outputLevel(uint8_t pin);            // Último digitalWrite (-1 si nunca)
+    uint8_t pinModeOf(uint8_t pin);
+    uint32_t writeCount(uint8_t pin);
+
+    // ------------------------------------------------------------------------
+    // EEPROM
+    // ------------------------------------------------------------------------
+    std::vector<uint8_t> &eepromData();
+    uint32_t eepromCommits();
+
+    // ------------------------------------------------------------------------
+    // LittleFS
+    // ------------------------------------------------------------------------
+    std::vector<std::string> fsList();
+    void fsTruncate(const std::string &path, size_t size); // Corte de energía a mitad de escritura
+    uint64_t fsBytesWritten();                             // Total escrito desde reset()
+    void fsSetCapacity(size_t bytes);                      // Tamaño de la partición
+
+    // ------------------------------------------------------------------------
+    // Serial
+    // ------------------------------------------------------------------------
+    void serialInput(const std::string &text);
+    const std::string &serialOutput();
+    bool serialContains(const std::string &text);
+    void clearSerialOutput();
+    void setSerialEcho(bool echo); // Copiar también a stdout
+    void setSerialTxRoom(int bytes); // Espacio de TX que se consume al escribir (-1: sin límite)
+
+    // ------------------------------------------------------------------------
+    // Sistema
+    // ------------------------------------------------------------------------
+    bool restartRequested();
+    size_t activeTimers();
+
+    // true: xTaskCreatePinnedToCore corre la tarea en un hilo del host (por
+    // defecto falla y cada módulo sigue en línea); joinTasks() espera las que
+    // ya volvieron de su función
+    void setTaskThreads(bool enabled);
+    void joinTasks();
+}
+
+#endif // ARDUINO_HAL_H
@@ -0,0 +1,46 @@
+#ifndef ARDUINO_HAL_EEPROM_H
+#define ARDUINO_HAL_EEPROM_H
+
+#include <Arduino.h>
+#include <vector>
+
+/**
+ * @brief EEPROM en memoria con la API de la emulación del ESP32
+ *
+ * Como en el ESP32, los cambios quedan en el buffer hasta commit(); los tests
+ * pueden inspeccionar el contenido con hal::eepromData().
+ */
+class EEPROMClass
+{
+public:
+    bool begin(size_t size);
+    void end() {}
+    bool commit();
+
+    uint8_t read(int address) const;
+    void write(int address, uint8_t value);
+    size_t length() const { return data().size(); }
+
+    template <typename T>
+    T &get(int address, T &value) const
+    {
+        if (address >= 0 && address + sizeof(T) <= length())
+            memcpy(&value, &data()[address], sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    const T &put(int address, const T &value)
+    {
+        if (address >= 0 && address + sizeof(T) <= length())
+            memcpy(&data()[address], &value, sizeof(T));
+        return value;
+    }
+
+private:
+    std::vector<uint8_t> &data() const;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // ARDUINO_HAL_EEPROM_H
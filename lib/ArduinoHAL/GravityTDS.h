@@ -0,0 +1,49 @@
+#ifndef ARDUINO_HAL_GRAVITY_TDS_H
+#define ARDUINO_HAL_GRAVITY_TDS_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Sustituto de DFRobot GravityTDS para el host
+ *
+ * Misma fórmula que la librería original (polinomio del SEN0244 con
+ * compensación de temperatura al 2 %/°C) leyendo el ADC simulado. La
+ * constante K queda en memoria: la original la guarda en EEPROM, y aquí se
+ * evita para no mezclarla con la calibración de pH que inspeccionan los tests.
+ */
+class GravityTDS
+{
+public:
+    void setPin(int pin) { this->pin = pin; }
+    void setAref(float value) { aref = value; }
+    void setAdcRange(float range) { adcRange = range; }
+    void setTemperature(float temp) { temperature = temp; }
+    void begin() { pinMode(pin, INPUT); }
+
+    void update()
+    {
+        analogValue = analogRead(pin);
+        voltage = analogValue / adcRange * aref;
+        ecValue = (133.42f * voltage * voltage * voltage - 255.86f * voltage * voltage + 857.39f * voltage) * kValue;
+        ecValue25 = ecValue / (1.0f + 0.02f * (temperature - 25.0f));
+        tdsValue = ecValue25 * 0.5f;
+    }
+
+    float getKvalue() const { return kValue; }
+    float getTdsValue() const { return tdsValue; }
+    float getEcValue() const { return ecValue25; }
+
+private:
+    int pin = 0;
+    float aref = 5.0f;
+    float adcRange = 1024.0f;
+    float temperature = 25.0f;
+    float kValue = 1.0f;
+    float analogValue = 0.0f;
+    float voltage = 0.0f;
+    float ecValue = 0.0f;
+    float ecValue25 = 0.0f;
+    float tdsValue = 0.0f;
+};
+
+#endif // ARDUINO_HAL_GRAVITY_TDS_H
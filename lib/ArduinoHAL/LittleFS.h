@@ -0,0 +1,92 @@
+#ifndef ARDUINO_HAL_LITTLEFS_H
+#define ARDUINO_HAL_LITTLEFS_H
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief LittleFS en memoria con la API de arduino-esp32 (FS.h)
+ *
+ * Cada archivo es un vector de bytes; open("w") trunca, open("a") agrega y
+ * rename() reemplaza el destino de forma atómica, como en LittleFS. Los
+ * archivos sobreviven a objetos destruidos (un "reinicio" en el test) pero
+ * no a hal::reset(). hal::fsTruncate() simula un corte de energía a mitad
+ * de escritura y hal::fsBytesWritten() mide el desgaste.
+ */
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+    enum SeekMode
+    {
+        SeekSet = 0,
+        SeekCur = 1,
+        SeekEnd = 2
+    };
+
+    class File
+    {
+    public:
+        File() : pos(0), writable(false) {}
+        File(const std::string &path, std::shared_ptr<std::vector<uint8_t>> data, size_t pos, bool writable)
+            : path(path), data(std::move(data)), pos(pos), writable(writable) {}
+
+        explicit operator bool() const { return data != nullptr; }
+
+        size_t write(const uint8_t *buf, size_t len);
+        size_t write(uint8_t b) { return write(&b, 1); }
+        size_t read(uint8_t *buf, size_t len);
+        int read();
+        int available() const { return data && pos < data->size() ? int(data->size() - pos) : 0; }
+        bool seek(uint32_t offset, SeekMode mode = SeekSet);
+        size_t position() const { return pos; }
+        size_t size() const { return data ? data->size() : 0; }
+        void flush() {}
+        void close() { data.reset(); }
+        const char *name() const { return path.c_str(); }
+
+    private:
+        std::string path;
+        std::shared_ptr<std::vector<uint8_t>> data;
+        size_t pos;
+        bool writable;
+    };
+
+    class LittleFSFS
+    {
+    public:
+        bool begin(bool formatOnFail = false, const char *basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+                   const char *partitionLabel = "spiffs");
+        void end() {}
+        bool format();
+
+        File open(const char *path, const char *mode = FILE_READ, bool create = false);
+        File open(const String &path, const char *mode = FILE_READ, bool create = false)
+        {
+            return open(path.c_str(), mode, create);
+        }
+        bool exists(const char *path);
+        bool remove(const char *path);
+        bool rename(const char *from, const char *to);
+        bool mkdir(const char *) { return true; } // Directorios implícitos
+        bool rmdir(const char *) { return true; }
+
+        size_t totalBytes() const;
+        size_t usedBytes() const;
+    };
+}
+
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+extern fs::LittleFSFS LittleFS;
+
+#endif // ARDUINO_HAL_LITTLEFS_H
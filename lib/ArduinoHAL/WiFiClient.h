@@ -0,0 +1,44 @@
+#ifndef ARDUINO_HAL_WIFI_CLIENT_H
+#define ARDUINO_HAL_WIFI_CLIENT_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Cliente TCP con la API de arduino-esp32, sobre sockets POSIX reales
+ *
+ * Es la única pieza del HAL que sale de la máquina: sirve para medir
+ * RestTransport contra tools/rtdb_server. Sin datos, available() espera
+ * hasta 1 ms reales antes de devolver 0; así los bucles de espera con
+ * delay(1) hacen avanzar el reloj virtual a un ritmo parecido al real y
+ * los timeouts en millis() siguen teniendo sentido. TCP_NODELAY siempre.
+ *
+ *   WiFiClient c;
+ *   if (c.connect("127.0.0.1", 8787)) c.write(buf, len);
+ */
+class WiFiClient
+{
+public:
+    WiFiClient() : fd(-1), closed(false) {}
+    ~WiFiClient() { stop(); }
+    WiFiClient(const WiFiClient &) = delete;
+    WiFiClient &operator=(const WiFiClient &) = delete;
+
+    // 1 si conectó; timeoutMs limita el handshake
+    int connect(const char *host, uint16_t port, int32_t timeoutMs = 3000);
+    size_t write(const uint8_t *buf, size_t len);
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t print(const char *text) { return write(reinterpret_cast<const uint8_t *>(text), strlen(text)); }
+
+    int available();
+    int read();
+    int read(uint8_t *buf, size_t len);
+    uint8_t connected();
+    void stop();
+    void setNoDelay(bool) {}
+
+private:
+    int fd;
+    bool closed; // El otro extremo cerró (pueden quedar datos por leer)
+};
+
+#endif // ARDUINO_HAL_WIFI_CLIENT_H
@@ -0,0 +1,8 @@
+#ifndef ARDUINO_HAL_ESP_IDF_VERSION_H
+#define ARDUINO_HAL_ESP_IDF_VERSION_H
+
+// Misma versión que arduino-esp32 2.x; sin CONFIG_IDF_TARGET_ESP32 no hay DMA
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(4, 4, 0)
+
+#endif // ARDUINO_HAL_ESP_IDF_VERSION_H
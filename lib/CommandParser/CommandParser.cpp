@@ -0,0 +1,165 @@
+#include "CommandParser.h"
+#include <math.h>
+#include <stdlib.h>
+
+CommandParser::CommandParser() : length(0), discarding(false), overflowed(false)
+{
+    buffer[0] = '\0';
+}
+
+void CommandParser::clear()
+{
+    length = 0;
+    discarding = false;
+    overflowed = false;
+    buffer[0] = '\0';
+}
+
+bool CommandParser::feed(char c)
+{
+    if (c == '\n' || c == '\r')
+    {
+        // Fin de una línea descartada: se avisa una vez, vacía
+        if (discarding)
+        {
+            discarding = false;
+            overflowed = true;
+            length = 0;
+            buffer[0] = '\0';
+            return true;
+        }
+        if (length == 0)
+            return false; // "\r\n" o líneas en blanco
+        buffer[length] = '\0';
+        length = 0;
+        overflowed = false;
+        stats.lines++;
+        return true;
+    }
+
+    if (discarding)
+        return false;
+    if ((uint8_t)c < ' ' && c != '\t')
+        return false; // Otros caracteres de control no forman parte de un comando
+    if (length >= LINE_SIZE - 1)
+    {
+        discarding = true;
+        stats.overflows++;
+        return false;
+    }
+    if (c >= 'a' && c <= 'z')
+        c -= 'a' - 'A';
+    buffer[length++] = c;
+    return false;
+}
+
+static bool isBlank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+uint8_t CommandParser::tokenize(char *line, char **tokens, uint8_t max)
+{
+    uint8_t n = 0;
+    char *p = line;
+    while (n < max)
+    {
+        while (isBlank(*p))
+            p++;
+        char *start = p;
+        while (*p && *p != ',')
+            p++;
+        char *end = p;
+        while (end > start && isBlank(end[-1]))
+            end--;
+        bool last = (*p == '\0');
+        *end = '\0';
+        tokens[n++] = start;
+        if (last)
+            break;
+        p++;
+    }
+    return n;
+}
+
+bool CommandParser::parseArgs(const char *spec, char *const *tokens, uint8_t count, Args &args)
+{
+    args.count = 0;
+    bool optional = false;
+    uint8_t i = 0;
+    for (const char *s = spec; *s; s++)
+    {
+        if (*s == '?')
+        {
+            optional = true;
+            continue;
+        }
+        if (i >= count)
+            return optional; // Faltan argumentos: solo vale si son opcionales
+        if (i >= MAX_ARGS)
+            return false;
+
+        Arg &a = args.arg[i];
+        a.text = tokens[i];
+        a.number = 0.0f;
+        a.on = false;
+        switch (*s)
+        {
+        case 'f':
+        {
+            char *end;
+            a.number = strtof(a.text, &end);
+            if (end == a.text || *end != '\0' || !isfinite(a.number))
+                return false;
+            break;
+        }
+        case 'b':
+            if (strcmp(a.text, "ON") == 0)
+                a.on = true;
+            else if (strcmp(a.text, "OFF") != 0)
+                return false;
+            break;
+        case 'w':
+            if (a.text[0] == '\0')
+                return false;
+            break;
+        default:
+            return false; // Firma mal escrita en la tabla
+        }
+        args.count = ++i;
+    }
+    return i == count; // Sobran argumentos
+}
+
+CommandParser::Result CommandParser::dispatch(char *line, const Command *table, uint8_t count, void *context,
+                                              const Command **command)
+{
+    if (command)
+        *command = nullptr;
+
+    // Nombre + hasta MAX_ARGS argumentos; uno más para detectar los que sobran
+    char *tokens[MAX_ARGS + 2];
+    uint8_t n = tokenize(line, tokens, MAX_ARGS + 2);
+    if (n == 1 && tokens[0][0] == '\0')
+        return EMPTY;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const Command &c = table[i];
+        if (strcmp(c.name, tokens[0]) != 0)
+            continue;
+        if (command)
+            *command = &c;
+
+        Args args;
+        if (n > MAX_ARGS + 1 || !parseArgs(c.args, tokens + 1, n - 1, args))
+        {
+            stats.badArgs++;
+            return BAD_ARGS;
+        }
+        c.handler(context, args);
+        return OK;
+    }
+    stats.unknown++;
+    return UNKNOWN;
+}
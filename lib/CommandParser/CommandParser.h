@@ -0,0 +1,107 @@
+#ifndef COMMAND_PARSER_H
+#define COMMAND_PARSER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Lector de comandos por líneas sin bloqueo ni memoria dinámica
+ *
+ * feed() recibe los bytes según llegan y los junta en un buffer fijo (en
+ * mayúsculas); con '\n' o '\r' la línea queda lista. dispatch() la separa por
+ * comas en el mismo buffer, busca el comando en una tabla constante y
+ * convierte los argumentos según su firma antes de llamar al handler:
+ *
+ *   'f' número (float finito)   'b' ON/OFF   'w' palabra
+ *   '?' los que siguen son opcionales
+ *
+ *   static constexpr CommandParser::Command TABLA[] = {
+ *       {"SETT", "f", &fijarTemperatura, "SETT,25.5"},
+ *       {"EMERGENCY", "?b", &emergencia, "EMERGENCY[,ON|OFF]"},
+ *   };
+ *   while (Serial.available())
+ *       if (parser.feed(Serial.read()))
+ *           parser.dispatch(parser.line(), TABLA, contexto);
+ *
+ * Una línea más larga que LINE_SIZE - 1 se descarta entera (truncated()).
+ */
+class CommandParser
+{
+public:
+    static const uint8_t LINE_SIZE = 64; // Incluye el '\0'
+    static const uint8_t MAX_ARGS = 4;
+
+    struct Arg
+    {
+        const char *text; // Token tal cual (en mayúsculas, sin espacios)
+        float number;     // 'f'
+        bool on;          // 'b'
+    };
+
+    struct Args
+    {
+        uint8_t count;
+        Arg arg[MAX_ARGS];
+
+        const Arg &operator[](uint8_t i) const { return arg[i]; }
+    };
+
+    typedef void (*Handler)(void *context, const Args &args);
+
+    struct Command
+    {
+        const char *name; // En mayúsculas
+        const char *args; // Firma: un carácter por argumento
+        Handler handler;
+        const char *usage; // Para el mensaje de error
+    };
+
+    enum Result : uint8_t
+    {
+        OK,
+        EMPTY,    // Línea en blanco
+        UNKNOWN,  // Comando que no está en la tabla
+        BAD_ARGS  // Faltan, sobran o no encajan con la firma
+    };
+
+    struct Stats
+    {
+        uint32_t lines = 0;
+        uint32_t unknown = 0;
+        uint32_t badArgs = 0;
+        uint32_t overflows = 0; // Líneas descartadas por largas
+    };
+
+    CommandParser();
+
+    // Un byte del puerto; true cuando hay una línea completa en line(),
+    // válida hasta el próximo feed()
+    bool feed(char c);
+    char *line() { return buffer; }
+    bool truncated() const { return overflowed; }
+    void clear();
+
+    // Tokeniza line en el lugar y llama al handler; command queda apuntando
+    // a la entrada de la tabla (también con BAD_ARGS)
+    Result dispatch(char *line, const Command *table, uint8_t count, void *context,
+                    const Command **command = nullptr);
+    template <uint8_t N>
+    Result dispatch(char *line, const Command (&table)[N], void *context, const Command **command = nullptr)
+    {
+        return dispatch(line, table, N, context, command);
+    }
+
+    const Stats &getStats() const { return stats; }
+
+    // Separa por comas y recorta espacios; devuelve cuántos tokens hay (hasta max)
+    static uint8_t tokenize(char *line, char **tokens, uint8_t max);
+    static bool parseArgs(const char *spec, char *const *tokens, uint8_t count, Args &args);
+
+private:
+    char buffer[LINE_SIZE];
+    uint8_t length;
+    bool discarding; // Dentro de una línea demasiado larga
+    bool overflowed; // La última línea entregada venía truncada
+    Stats stats;
+};
+
+#endif // COMMAND_PARSER_H
@@ -0,0 +1,105 @@
+#include "CommandStream.h"
+
+CommandStream::CommandStream()
+{
+}
+
+bool CommandStream::parse(const char *path, const char *dataType, const char *payload, Event &event)
+{
+    event = Event();
+    stats.events++;
+    stats.lastEventMs = millis();
+
+    if (!path || !dataType || !payload)
+    {
+        stats.ignored++;
+        return false;
+    }
+
+    bool value;
+    if (strcmp(path, "/emergency") == 0)
+    {
+        if (strcmp(dataType, "boolean") == 0 && parseBool(payload, value))
+        {
+            event.hasEmergency = true;
+            event.emergency = value;
+        }
+    }
+    else if (strcmp(path, "/reset") == 0)
+    {
+        if (strcmp(dataType, "boolean") == 0 && parseBool(payload, value))
+            event.reset = value;
+    }
+    else if (strcmp(path, "/") == 0 && strcmp(dataType, "json") == 0)
+    {
+        // Nodo completo (put inicial o al reanudar) o patch con varias claves
+        if (findBool(payload, "emergency", value))
+        {
+            event.hasEmergency = true;
+            event.emergency = value;
+        }
+        if (findBool(payload, "reset", value))
+            event.reset = value;
+    }
+
+    if (!event.hasEmergency && !event.reset)
+    {
+        stats.ignored++;
+        return false;
+    }
+    stats.commands++;
+    return true;
+}
+
+bool CommandStream::parseBool(const char *text, bool &value)
+{
+    while (*text == ' ')
+        text++;
+    if (strncmp(text, "true", 4) == 0)
+    {
+        value = true;
+        return true;
+    }
+    if (strncmp(text, "false", 5) == 0)
+    {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool CommandStream::findBool(const char *json, const char *key, bool &value)
+{
+    // Sin biblioteca JSON: "clave" a profundidad 1 seguida de ':' y true/false
+    size_t keyLen = strlen(key);
+    int depth = 0;
+    bool inString = false;
+    for (const char *p = json; *p; p++)
+    {
+        if (inString)
+        {
+            if (*p == '\\' && p[1])
+                p++;
+            else if (*p == '"')
+                inString = false;
+            continue;
+        }
+        if (*p == '{' || *p == '[')
+            depth++;
+        else if (*p == '}' || *p == ']')
+            depth--;
+        else if (*p == '"')
+        {
+            if (depth == 1 && strncmp(p + 1, key, keyLen) == 0 && p[keyLen + 1] == '"')
+            {
+                const char *q = p + keyLen + 2;
+                while (*q == ' ')
+                    q++;
+                if (*q == ':')
+                    return parseBool(q + 1, value);
+            }
+            inString = true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,57 @@
+#ifndef COMMAND_STREAM_H
+#define COMMAND_STREAM_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Interpreta los eventos del stream (SSE) de /hydroponic_data/comandos
+ *
+ * RTDB envía un "put" en "/" con el nodo completo al abrir (o reabrir) el
+ * stream y luego un evento por cada cambio: "/emergency" o "/reset" con un
+ * boolean, o un "patch" en "/" con varias claves. Esta clase solo traduce
+ * (ruta, tipo, payload) a una orden; no depende de Firebase y se prueba en
+ * el host.
+ *
+ *   CommandStream::Event ev;
+ *   if (commandStream.parse(data.dataPath().c_str(), data.dataType().c_str(),
+ *                           data.payload().c_str(), ev)) { ... }
+ */
+class CommandStream
+{
+public:
+    struct Event
+    {
+        bool hasEmergency; // El evento trae comandos/emergency
+        bool emergency;
+        bool reset;        // comandos/reset == true
+    };
+
+    struct Stats
+    {
+        uint32_t events = 0;    // Eventos recibidos
+        uint32_t commands = 0;  // Eventos con alguna orden
+        uint32_t ignored = 0;   // Rutas o tipos desconocidos, null
+        uint32_t timeouts = 0;  // Keep-alive perdido (la biblioteca reanuda)
+        uint32_t restarts = 0;  // Stream reabierto con beginStream
+        unsigned long lastEventMs = 0;
+    };
+
+    CommandStream();
+
+    // path relativo al stream, dataType de RTDB ("boolean", "json", "null"...)
+    bool parse(const char *path, const char *dataType, const char *payload, Event &event);
+
+    void noteTimeout() { stats.timeouts++; }
+    void noteRestart() { stats.restarts++; }
+    const Stats &getStats() const { return stats; }
+
+    // Valor booleano de una clave de primer nivel en un objeto JSON plano
+    static bool findBool(const char *json, const char *key, bool &value);
+
+private:
+    Stats stats;
+
+    static bool parseBool(const char *text, bool &value);
+};
+
+#endif // COMMAND_STREAM_H
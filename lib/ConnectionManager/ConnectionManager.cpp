@@ -0,0 +1,157 @@
+#include "ConnectionManager.h"
+#include "Log.h"
+
+ConnectionManager::ConnectionManager() : ConnectionManager(Config())
+{
+}
+
+ConnectionManager::ConnectionManager(const Config &config)
+    : config(config), hooks(), current(WIFI_CONNECTING), enteredMs(0), retryAtMs(0), failures(0), started(false),
+      servicesStarted(false)
+{
+}
+
+const char *ConnectionManager::stateName(State s)
+{
+    switch (s)
+    {
+    case WIFI_CONNECTING:
+        return "conectando WiFi";
+    case WIFI_BACKOFF:
+        return "WiFi en espera";
+    case BACKEND_CONNECTING:
+        return "conectando base de datos";
+    case BACKEND_BACKOFF:
+        return "base de datos en espera";
+    case ONLINE:
+        return "en linea";
+    }
+    return "?";
+}
+
+void ConnectionManager::begin(const Hooks &h, unsigned long nowMs)
+{
+    hooks = h;
+    started = true;
+    startWiFi(nowMs);
+}
+
+void ConnectionManager::enter(State next, unsigned long nowMs)
+{
+    if (next != current)
+        LOG_I(NET, "Red: %s -> %s (%lu ms)", stateName(current), stateName(next), nowMs);
+    current = next;
+    enteredMs = nowMs;
+    if (next != WIFI_BACKOFF && next != BACKEND_BACKOFF)
+        stats.backoffMs = 0;
+}
+
+void ConnectionManager::startWiFi(unsigned long nowMs)
+{
+    stats.wifiAttempts++;
+    enter(WIFI_CONNECTING, nowMs);
+    hooks.beginWiFi();
+}
+
+void ConnectionManager::backoff(State next, unsigned long nowMs)
+{
+    // initial * 2^(fallas - 1), con tope
+    unsigned long wait = config.initialBackoffMs;
+    for (uint8_t i = 1; i < failures && wait < config.maxBackoffMs; i++)
+        wait *= 2;
+    if (wait > config.maxBackoffMs)
+        wait = config.maxBackoffMs;
+    enter(next, nowMs);
+    stats.backoffMs = wait;
+    retryAtMs = nowMs + wait;
+    LOG_I(NET, "Red: reintento en %lu ms", wait);
+}
+
+void ConnectionManager::wifiUp(unsigned long nowMs)
+{
+    failures = 0;
+    if (stats.bootToWiFiMs < 0)
+        stats.bootToWiFiMs = long(nowMs);
+    if (!servicesStarted)
+    {
+        servicesStarted = true;
+        hooks.startServices();
+    }
+    enter(BACKEND_CONNECTING, nowMs);
+}
+
+void ConnectionManager::wifiDown(unsigned long nowMs)
+{
+    // El driver suele reconectar solo: primero una espera corta
+    stats.wifiLost++;
+    failures = 1;
+    backoff(WIFI_BACKOFF, nowMs);
+}
+
+void ConnectionManager::update(unsigned long nowMs)
+{
+    if (!started)
+        return;
+
+    switch (current)
+    {
+    case WIFI_CONNECTING:
+        if (hooks.wifiConnected())
+            wifiUp(nowMs);
+        else if (nowMs - enteredMs >= config.wifiTimeoutMs)
+        {
+            stats.wifiFailures++;
+            if (failures < 31)
+                failures++;
+            hooks.dropWiFi();
+            backoff(WIFI_BACKOFF, nowMs);
+        }
+        break;
+
+    case WIFI_BACKOFF:
+        if (hooks.wifiConnected())
+            wifiUp(nowMs);
+        else if (long(nowMs - retryAtMs) >= 0)
+            startWiFi(nowMs);
+        break;
+
+    case BACKEND_CONNECTING:
+        if (!hooks.wifiConnected())
+            wifiDown(nowMs);
+        else if (hooks.backendReady())
+        {
+            failures = 0;
+            if (stats.bootToOnlineMs < 0)
+                stats.bootToOnlineMs = long(nowMs);
+            enter(ONLINE, nowMs);
+        }
+        else if (nowMs - enteredMs >= config.backendTimeoutMs)
+        {
+            stats.backendFailures++;
+            if (failures < 31)
+                failures++;
+            backoff(BACKEND_BACKOFF, nowMs);
+        }
+        break;
+
+    case BACKEND_BACKOFF:
+        if (!hooks.wifiConnected())
+            wifiDown(nowMs);
+        else if (long(nowMs - retryAtMs) >= 0)
+            enter(BACKEND_CONNECTING, nowMs);
+        break;
+
+    case ONLINE:
+        if (!hooks.wifiConnected())
+            wifiDown(nowMs);
+        else if (!hooks.backendReady())
+            enter(BACKEND_CONNECTING, nowMs);
+        break;
+    }
+}
+
+void ConnectionManager::notePublish(unsigned long nowMs)
+{
+    if (stats.bootToFirstPublishMs < 0)
+        stats.bootToFirstPublishMs = long(nowMs);
+}
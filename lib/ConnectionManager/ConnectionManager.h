@@ -0,0 +1,102 @@
+#ifndef CONNECTION_MANAGER_H
+#define CONNECTION_MANAGER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Conexión WiFi + base de datos como máquina de estados sin bloqueo
+ *
+ * setup() ya no espera la red: begin() lanza el primer intento y update()
+ * (en el contexto de red, cada pocos ms) avanza los estados sin esperar
+ * nunca. Un intento de WiFi que no conecta en wifiTimeoutMs, o una base de
+ * datos que no queda lista en backendTimeoutMs, pasan a espera con backoff
+ * exponencial (initialBackoffMs, el doble cada vez, hasta maxBackoffMs).
+ * Mientras tanto el control corre y la telemetría va a TelemetryLog.
+ *
+ *   WIFI_CONNECTING ──ok──► BACKEND_CONNECTING ──ready──► ONLINE
+ *        │ timeout                 │ timeout                │ WiFi o base caída
+ *        ▼                         ▼                        ▼
+ *   WIFI_BACKOFF            BACKEND_BACKOFF          (vuelve a conectar)
+ *
+ * Las acciones van por Hooks (WiFi.begin(), Firebase...), así la máquina se
+ * prueba en el host. También mide el arranque: del boot a la primera
+ * conexión, a ONLINE y a la primera publicación confirmada.
+ *
+ *   connection.begin(hooks, millis());
+ *   connection.update(millis());           // En atenderRed()
+ *   if (connection.isOnline()) publicar();
+ */
+class ConnectionManager
+{
+public:
+    enum State : uint8_t
+    {
+        WIFI_CONNECTING,
+        WIFI_BACKOFF,
+        BACKEND_CONNECTING,
+        BACKEND_BACKOFF,
+        ONLINE
+    };
+
+    struct Hooks
+    {
+        void (*beginWiFi)();      // Lanza un intento (WiFi.begin), no espera
+        bool (*wifiConnected)();
+        void (*dropWiFi)();       // Corta un intento fallido antes de reintentar
+        void (*startServices)();  // Una sola vez, con la primera conexión (SNTP, Firebase.begin)
+        bool (*backendReady)();
+    };
+
+    struct Config
+    {
+        unsigned long wifiTimeoutMs = 10000;
+        unsigned long backendTimeoutMs = 15000;
+        unsigned long initialBackoffMs = 1000;
+        unsigned long maxBackoffMs = 60000;
+    };
+
+    struct Stats
+    {
+        uint32_t wifiAttempts = 0;
+        uint32_t wifiFailures = 0;    // Intentos que vencieron
+        uint32_t wifiLost = 0;        // Caídas estando conectado
+        uint32_t backendFailures = 0;
+        long bootToWiFiMs = -1;       // -1: todavía no
+        long bootToOnlineMs = -1;
+        long bootToFirstPublishMs = -1;
+        unsigned long backoffMs = 0;  // Espera actual (0 si no hay)
+    };
+
+    ConnectionManager();
+    explicit ConnectionManager(const Config &config);
+
+    void begin(const Hooks &hooks, unsigned long nowMs);
+    void update(unsigned long nowMs);
+
+    // Publicación confirmada (guarda solo la primera)
+    void notePublish(unsigned long nowMs);
+
+    State state() const { return current; }
+    bool isOnline() const { return current == ONLINE; }
+    const Stats &getStats() const { return stats; }
+    static const char *stateName(State s);
+
+private:
+    Config config;
+    Hooks hooks;
+    State current;
+    unsigned long enteredMs; // Inicio del intento actual
+    unsigned long retryAtMs; // Fin del backoff
+    uint8_t failures;        // Fallas seguidas (define el backoff)
+    bool started;
+    bool servicesStarted;
+    Stats stats;
+
+    void enter(State next, unsigned long nowMs);
+    void startWiFi(unsigned long nowMs);
+    void backoff(State next, unsigned long nowMs);
+    void wifiUp(unsigned long nowMs);
+    void wifiDown(unsigned long nowMs);
+};
+
+#endif // CONNECTION_MANAGER_H
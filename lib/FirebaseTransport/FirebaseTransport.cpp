@@ -0,0 +1,105 @@
+#include "FirebaseTransport.h"
+
+// ============================================================================
+// FIREBASE SINK
+// ============================================================================
+
+FirebaseSink::FirebaseSink(FirebaseData &data) : data(data), status(0)
+{
+}
+
+bool FirebaseSink::ready()
+{
+    return Firebase.ready();
+}
+
+bool FirebaseSink::finish(bool ok)
+{
+    status = data.httpCode();
+    error = ok ? "" : data.errorReason();
+    return ok;
+}
+
+bool FirebaseSink::update(const char *path, const char *body)
+{
+    json.clear();
+    if (!json.setJsonData(body))
+    {
+        status = -3;
+        error = "JSON invalido";
+        return false;
+    }
+    return finish(Firebase.RTDB.updateNode(&data, path, &json));
+}
+
+bool FirebaseSink::set(const char *path, const char *body)
+{
+    // Los escalares van con su tipo; objetos y arreglos como JSON
+    bool ok;
+    if (strcmp(body, "true") == 0 || strcmp(body, "false") == 0)
+    {
+        ok = Firebase.RTDB.setBool(&data, path, body[0] == 't');
+    }
+    else if (body[0] == '{' || body[0] == '[')
+    {
+        json.clear();
+        ok = json.setJsonData(body) && Firebase.RTDB.setJSON(&data, path, &json);
+    }
+    else if (body[0] == '"')
+    {
+        String text(body + 1);
+        if (text.length() && text[text.length() - 1] == '"')
+            text = text.substring(0, text.length() - 1);
+        ok = Firebase.RTDB.setString(&data, path, text);
+    }
+    else
+    {
+        ok = Firebase.RTDB.setDouble(&data, path, atof(body));
+    }
+    return finish(ok);
+}
+
+// ============================================================================
+// FIREBASE COMMAND SOURCE
+// ============================================================================
+
+FirebaseCommandSource::FirebaseCommandSource(FirebaseData &stream) : stream(stream)
+{
+}
+
+bool FirebaseCommandSource::begin(const char *streamPath)
+{
+    if (!Firebase.RTDB.beginStream(&stream, streamPath))
+    {
+        error = stream.errorReason();
+        return false;
+    }
+    return true;
+}
+
+CommandSource::Result FirebaseCommandSource::read(Message &message)
+{
+    if (!Firebase.RTDB.readStream(&stream))
+    {
+        error = stream.errorReason();
+        return BROKEN;
+    }
+    if (stream.streamTimeout())
+        return TIMEOUT;
+    if (!stream.streamAvailable())
+        return NONE;
+
+    // Copias: el FirebaseData se reutiliza en la próxima lectura
+    path = stream.dataPath();
+    type = stream.dataType();
+    payload = stream.payload();
+    message.path = path.c_str();
+    message.type = type.c_str();
+    message.payload = payload.c_str();
+    return DATA;
+}
+
+void FirebaseCommandSource::end()
+{
+    Firebase.RTDB.endStream(&stream);
+}
@@ -0,0 +1,64 @@
+#ifndef FIREBASE_TRANSPORT_H
+#define FIREBASE_TRANSPORT_H
+
+#include <Arduino.h>
+#include <Firebase_ESP_Client.h>
+#include "TelemetrySink.h"
+
+/**
+ * @brief TelemetrySink sobre Firebase_ESP_Client (RTDB en la nube)
+ *
+ * update() carga el cuerpo en un FirebaseJson y hace updateNode(): las
+ * claves con '/' siguen siendo rutas, así el PATCH multi-ruta no cambia.
+ * Solo compila en el ESP32 ([env:native] la ignora).
+ *
+ *   FirebaseSink sink(fbData);
+ *   sink.update("/hydroponic_data", patch.c_str());
+ */
+class FirebaseSink : public TelemetrySink
+{
+public:
+    explicit FirebaseSink(FirebaseData &data);
+
+    bool ready() override;
+    bool update(const char *path, const char *json) override;
+    bool set(const char *path, const char *json) override;
+
+    int lastStatus() const override { return status; }
+    const char *lastError() const override { return error.c_str(); }
+
+private:
+    FirebaseData &data;
+    FirebaseJson json;
+    int status;
+    String error;
+
+    bool finish(bool ok);
+};
+
+/**
+ * @brief CommandSource sobre el stream de Firebase_ESP_Client
+ *
+ * Usa su propio FirebaseData (la conexión del stream no se comparte con
+ * los PATCH). readStream() no bloquea; tras un timeout de keep-alive la
+ * biblioteca reconecta sola.
+ */
+class FirebaseCommandSource : public CommandSource
+{
+public:
+    explicit FirebaseCommandSource(FirebaseData &stream);
+
+    bool begin(const char *path) override;
+    Result read(Message &message) override;
+    void end() override;
+    const char *lastError() const override { return error.c_str(); }
+
+private:
+    FirebaseData &stream;
+    String path;
+    String type;
+    String payload;
+    String error;
+};
+
+#endif // FIREBASE_TRANSPORT_H
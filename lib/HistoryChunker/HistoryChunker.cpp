@@ -0,0 +1,231 @@
+#include "HistoryChunker.h"
+
+namespace
+{
+    // Agrega texto con formato; false si no cabe (pos queda en len)
+    bool appendf(char *out, size_t len, size_t &pos, const char *fmt, long value)
+    {
+        if (pos >= len)
+            return false;
+        int n = snprintf(out + pos, len - pos, fmt, value);
+        if (n < 0 || size_t(n) >= len - pos)
+        {
+            pos = len;
+            return false;
+        }
+        pos += n;
+        return true;
+    }
+
+    bool appendU64(char *out, size_t len, size_t &pos, const char *fmt, uint64_t value)
+    {
+        if (pos >= len)
+            return false;
+        int n = snprintf(out + pos, len - pos, fmt, (unsigned long long)value);
+        if (n < 0 || size_t(n) >= len - pos)
+        {
+            pos = len;
+            return false;
+        }
+        pos += n;
+        return true;
+    }
+
+    bool appendText(char *out, size_t len, size_t &pos, const char *text)
+    {
+        size_t n = strlen(text);
+        if (pos + n >= len)
+        {
+            pos = len;
+            return false;
+        }
+        memcpy(out + pos, text, n + 1);
+        pos += n;
+        return true;
+    }
+
+    // Valor acotado a 5 cifras, o null si el sensor no dio un número
+    bool appendValue(char *out, size_t len, size_t &pos, float value, float scale, bool comma)
+    {
+        if (comma && !appendText(out, len, pos, ","))
+            return false;
+        if (!isfinite(value))
+            return appendText(out, len, pos, "null");
+        float v = constrain(value * scale, -99999.0f, 99999.0f);
+        return appendf(out, len, pos, "%ld", lroundf(v));
+    }
+}
+
+HistoryChunker::HistoryChunker(uint8_t chunkSamples)
+    : chunkSamples(constrain(chunkSamples, 1, MAX_CHUNK)), first(0), buffered(0), clockSet(false), clockOffsetMs(0)
+{
+}
+
+void HistoryChunker::setClock(int64_t offsetMs)
+{
+    clockOffsetMs = offsetMs;
+    clockSet = true;
+}
+
+uint64_t HistoryChunker::epochOf(const TimeService::Stamp &stamp) const
+{
+    // Sellada sin hora: se fecha con el offset actual
+    if (stamp.epochMs)
+        return stamp.epochMs;
+    return uint64_t(int64_t(stamp.monoMs) + clockOffsetMs);
+}
+
+// ============================================================================
+// BUFFER
+// ============================================================================
+
+void HistoryChunker::add(const TimeService::Stamp &stamp, float ph, float tds, int32_t ldr)
+{
+    if (buffered == MAX_SAMPLES)
+    {
+        first = (first + 1) % MAX_SAMPLES;
+        buffered--;
+        stats.dropped++;
+    }
+    Sample &s = samples[(first + buffered) % MAX_SAMPLES];
+    s.stamp = stamp;
+    s.ph = ph;
+    s.tds = tds;
+    s.ldr = ldr;
+    buffered++;
+    stats.samples++;
+}
+
+bool HistoryChunker::ready() const
+{
+    if (!buffered)
+        return false;
+    if (buffered >= chunkSamples)
+        return true;
+    if (!clockSet)
+        return false;
+    return day(epochOf(at(0).stamp) / 1000) != day(epochOf(at(buffered - 1).stamp) / 1000);
+}
+
+uint8_t HistoryChunker::peek(Point *out, uint8_t max) const
+{
+    uint8_t limit = buffered < chunkSamples ? buffered : chunkSamples;
+    if (max < limit)
+        limit = max;
+
+    uint8_t n = 0;
+    uint32_t firstDay = 0;
+    for (; n < limit; n++)
+    {
+        const Sample &s = at(n);
+        if (!clockSet)
+        {
+            out[n] = {s.stamp.monoMs, s.stamp.bootId, s.stamp.seq, s.ph, s.tds, s.ldr, true};
+            continue;
+        }
+        uint64_t epochMs = epochOf(s.stamp);
+        uint32_t d = day(uint32_t(epochMs / 1000));
+        if (n == 0)
+            firstDay = d;
+        else if (d != firstDay)
+            break; // El resto va al bloque del día siguiente
+        out[n] = {epochMs, s.stamp.bootId, s.stamp.seq, s.ph, s.tds, s.ldr, false};
+    }
+    return n;
+}
+
+void HistoryChunker::commit(uint8_t count)
+{
+    if (count > buffered)
+        count = buffered;
+    first = (first + count) % MAX_SAMPLES;
+    buffered -= count;
+    if (count)
+        stats.chunks++;
+}
+
+// ============================================================================
+// FORMATO
+// ============================================================================
+
+static_assert(HistoryChunker::JSON_MAX >=
+                  SeriesCodec::base64Len(SeriesCodec::maxBytes(HistoryChunker::MAX_CHUNK)) + 48,
+              "JSON_MAX no alcanza para un bloque empaquetado");
+
+uint8_t HistoryChunker::format(const Point *points, uint8_t count, char *key, size_t keyLen, char *json,
+                               size_t jsonLen, bool packed)
+{
+    if (!count || points[0].monotonic)
+        return 0;
+    if (count > MAX_CHUNK)
+        count = MAX_CHUNK;
+
+    // Un bloque: mismo día UTC, mismo arranque y tiempo sin retroceder
+    uint64_t t0 = points[0].epochMs;
+    uint32_t t0s = uint32_t(t0 / 1000);
+    uint32_t boot = points[0].bootId;
+    uint8_t n = 1;
+    while (n < count && day(uint32_t(points[n].epochMs / 1000)) == day(t0s) && points[n].epochMs >= t0 &&
+           points[n].bootId == boot && !points[n].monotonic)
+        n++;
+
+    char date[12];
+    dayString(t0s, date, sizeof(date));
+    int k = snprintf(key, keyLen, "historial/%s/%05lu", date, (unsigned long)(t0s % 86400UL));
+    if (k < 0 || size_t(k) >= keyLen)
+        return 0;
+
+    size_t pos = 0;
+    if (packed)
+    {
+        // Misma resolución que el formato JSON: así el XOR de la mantisa se repite
+        SeriesCodec::Sample samples[MAX_CHUNK];
+        for (uint8_t i = 0; i < n; i++)
+            samples[i] = {points[i].epochMs, points[i].seq, roundf(points[i].ph * 100.0f) / 100.0f,
+                          roundf(points[i].tds), points[i].ldr};
+        uint8_t bin[SeriesCodec::maxBytes(MAX_CHUNK)];
+        size_t len = SeriesCodec::encode(samples, n, boot, bin, sizeof(bin));
+        bool ok = len && appendU64(json, jsonLen, pos, "{\"t0\":%llu,", t0) &&
+                  appendf(json, jsonLen, pos, "\"n\":%ld,\"z\":\"", long(n));
+        size_t b64 = ok ? SeriesCodec::base64Encode(bin, len, json + pos, jsonLen - pos) : 0;
+        pos += b64;
+        ok = b64 && appendText(json, jsonLen, pos, "\"}");
+        return ok ? n : 0;
+    }
+
+    uint32_t s0 = points[0].seq;
+    bool ok = appendU64(json, jsonLen, pos, "{\"t0\":%llu,", t0) &&
+              appendU64(json, jsonLen, pos, "\"b\":%llu,", boot) &&
+              appendU64(json, jsonLen, pos, "\"s0\":%llu,\"dt\":[", s0);
+    for (uint8_t i = 0; i < n; i++)
+        ok = ok && appendU64(json, jsonLen, pos, i ? ",%llu" : "%llu", points[i].epochMs - t0);
+    ok = ok && appendText(json, jsonLen, pos, "],\"ds\":[");
+    for (uint8_t i = 0; i < n; i++)
+        ok = ok && appendU64(json, jsonLen, pos, i ? ",%llu" : "%llu", uint32_t(points[i].seq - s0));
+    ok = ok && appendText(json, jsonLen, pos, "],\"ph\":[");
+    for (uint8_t i = 0; i < n; i++)
+        ok = ok && appendValue(json, jsonLen, pos, points[i].ph, 100.0f, i);
+    ok = ok && appendText(json, jsonLen, pos, "],\"tds\":[");
+    for (uint8_t i = 0; i < n; i++)
+        ok = ok && appendValue(json, jsonLen, pos, points[i].tds, 1.0f, i);
+    ok = ok && appendText(json, jsonLen, pos, "],\"ldr\":[");
+    for (uint8_t i = 0; i < n; i++)
+        ok = ok && appendf(json, jsonLen, pos, i ? ",%ld" : "%ld", long(points[i].ldr));
+    ok = ok && appendText(json, jsonLen, pos, "]}");
+    return ok ? n : 0;
+}
+
+void HistoryChunker::dayString(uint32_t epochS, char *out, size_t len)
+{
+    // Días desde 1970-01-01 a fecha civil (calendario gregoriano proléptico)
+    uint32_t z = day(epochS) + 719468UL;
+    uint32_t era = z / 146097UL;
+    uint32_t doe = z - era * 146097UL;
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    unsigned long y = yoe + era * 400 + (m <= 2 ? 1 : 0);
+    snprintf(out, len, "%04lu-%02u-%02u", y, m, d);
+}
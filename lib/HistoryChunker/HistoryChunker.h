@@ -0,0 +1,130 @@
+#ifndef HISTORY_CHUNKER_H
+#define HISTORY_CHUNKER_H
+
+#include <Arduino.h>
+#include "SeriesCodec.h"
+#include "TimeService.h"
+
+// 1: bloques en binario (SeriesCodec + base64); 0: arreglos JSON legibles
+#ifndef HISTORY_PACKED
+#define HISTORY_PACKED 1
+#endif
+
+/**
+ * @brief Agrupa el historial en bloques compactos por día
+ *
+ * En lugar de tres claves RTDB por muestra (historial/ph/<ms>, ...), las
+ * muestras se juntan en RAM y se escriben de a chunkSamples en una sola
+ * clave con el día UTC como fragmento:
+ *
+ *   historial/2026-10-17/36000 -> {"t0":1792231200000,"b":12,"s0":340,
+ *                                  "dt":[0,10002,20001],"ds":[0,20,40],
+ *                                  "ph":[612,613,611],"tds":[803,801,802],
+ *                                  "ldr":[1021,1019,1024]}
+ *
+ * - La clave es el segundo del día de la primera muestra (5 dígitos, orden
+ *   lexicográfico = orden temporal): un reinicio no necesita recordar un
+ *   contador y reenviar el mismo bloque lo sobrescribe
+ * - Cada muestra lleva el sello de TimeService: t0 + dt es epoch UTC en ms,
+ *   b el boot_id y s0 + ds su seq, así (b, seq) identifica la muestra aunque
+ *   un reenvío la repita en otro bloque; pH va ×100 y TDS/LDR como enteros,
+ *   un valor no finito se escribe null
+ * - Un bloque nunca cruza la medianoche UTC, así el dashboard descarga un
+ *   rango de fechas leyendo solo historial/<día>
+ * - Empaquetado (packed): {"t0":1792231200000,"n":30,"z":"<base64>"}, donde
+ *   z es SeriesCodec (con boot_id y seq) con pH a 0.01 y TDS a 1 ppm
+ * - Lo sellado antes de la primera hora SNTP solo tiene tiempo monotónico;
+ *   setClock() da el offset que lo convierte, así también queda fechado
+ * - Sin hora un bloque completo también está listo, con monotonic: no se
+ *   puede formatear y va a flash con su tiempo desde el arranque, así un
+ *   corte largo antes de la primera hora no pierde muestras
+ *
+ * Uso:
+ *   chunker.add(timeService.stamp(millis()), ph, tds, ldr);
+ *   if (chunker.ready()) {
+ *       uint8_t n = chunker.peek(points, HistoryChunker::MAX_CHUNK);
+ *       n = HistoryChunker::format(points, n, key, sizeof(key), json, sizeof(json));
+ *       if (enviado) chunker.commit(n);
+ *   }
+ */
+class HistoryChunker
+{
+public:
+    struct Point
+    {
+        uint64_t epochMs; // ms UTC
+        uint32_t bootId;
+        uint32_t seq;
+        float ph;
+        float tds;
+        int32_t ldr;
+        bool monotonic; // Sin hora: epochMs es tiempo desde el arranque bootId
+    };
+
+    struct Stats
+    {
+        uint32_t samples = 0;
+        uint32_t chunks = 0;   // Confirmados con commit()
+        uint32_t dropped = 0;  // Descartados por buffer lleno
+    };
+
+    static constexpr uint8_t MAX_CHUNK = 32;    // Muestras por bloque como máximo
+    static constexpr uint8_t MAX_SAMPLES = 64;  // Buffer en RAM
+    static constexpr size_t KEY_MAX = 40;       // "historial/AAAA-MM-DD/SSSSS"
+    static constexpr size_t JSON_MAX = MAX_CHUNK * 48 + 96; // Alcanza para el peor caso (ambos formatos)
+
+    explicit HistoryChunker(uint8_t chunkSamples = 30);
+
+    // epoch - monotónico (TimeService::offsetMs()) una vez que hay hora SNTP
+    void setClock(int64_t offsetMs);
+    bool hasClock() const { return clockSet; }
+
+    // Con el buffer lleno (sin hora o sin vaciar) se descarta la más antigua
+    void add(const TimeService::Stamp &stamp, float ph, float tds, int32_t ldr);
+
+    // Hay un bloque completo (con o sin hora), o el día UTC cambió desde la primera muestra
+    bool ready() const;
+
+    // Copia el bloque listo (o lo que haya, si no está listo) sin quitarlo; sin hora, monotonic
+    uint8_t peek(Point *out, uint8_t max) const;
+    void commit(uint8_t count); // Quita las primeras count muestras
+
+    uint8_t count() const { return buffered; }
+    uint8_t chunkSize() const { return chunkSamples; }
+    const Stats &getStats() const { return stats; }
+
+    /**
+     * @brief Clave y JSON de un bloque (compartido con el reenvío desde flash)
+     * @param points Muestras ordenadas; se usan solo las del día y el arranque de la primera
+     * @param packed Binario en base64 en lugar de arreglos JSON
+     * @return Muestras incluidas (0 si los buffers no alcanzan o la primera no tiene hora)
+     */
+    static uint8_t format(const Point *points, uint8_t count, char *key, size_t keyLen, char *json,
+                          size_t jsonLen, bool packed = false);
+
+    // "AAAA-MM-DD" del día UTC de epochS en segundos (out de al menos 11 bytes)
+    static void dayString(uint32_t epochS, char *out, size_t len);
+    static uint32_t day(uint32_t epochS) { return epochS / 86400UL; }
+
+private:
+    struct Sample
+    {
+        TimeService::Stamp stamp;
+        float ph;
+        float tds;
+        int32_t ldr;
+    };
+
+    uint8_t chunkSamples;
+    Sample samples[MAX_SAMPLES];
+    uint8_t first; // Índice circular de la más antigua
+    uint8_t buffered;
+    bool clockSet;
+    int64_t clockOffsetMs;
+    Stats stats;
+
+    const Sample &at(uint8_t i) const { return samples[(first + i) % MAX_SAMPLES]; }
+    uint64_t epochOf(const TimeService::Stamp &stamp) const;
+};
+
+#endif // HISTORY_CHUNKER_H
@@ -1,48 +1,86 @@
 #include "LDRSensor.h"
+#include "Log.h"
+#include "SensorHub.h"
 
 LDRSensor::LDRSensor(uint8_t pin)
     : pin(pin), rawValue(0), voltage(0.0f), lightLevel(DARK),
-      lastUpdate(0), updateInterval(1000), sunThreshold(3000),
+      lastUpdate(0), updateInterval(1000), hub(nullptr), hubCursor(0),
+      oversampling(TARGET_ERROR_COUNTS, OVERSAMPLE_MIN, OVERSAMPLE_MAX), sampleRateHz(0.0f), sunThreshold(3000),
       darkThreshold(500), lowThreshold(1500), mediumThreshold(2500), brightThreshold(3500)
 {
+    syncThresholds();
 }
 
 void LDRSensor::begin()
 {
     analogSetPinAttenuation(pin, ADC_11db);
-    Serial.printf("LDRSensor: Inicializado en pin %d\n", pin);
+    LOG_I(SENSOR, "LDRSensor: Inicializado en pin %d", pin);
+}
+
+void LDRSensor::attachHub(SensorHub *hub)
+{
+    this->hub = hub;
+    hubCursor = 0;
+    acquire.reset();
 }
 
 void LDRSensor::update()
 {
-    rawValue = analogRead(pin);
+    rawValue = readRaw();
     voltage = (rawValue * VREF) / ADC_RES;
     calculateLightLevel();
     lastUpdate = millis();
 }
 
-void LDRSensor::calculateLightLevel()
+int LDRSensor::readRaw()
 {
-    if (rawValue < darkThreshold)
-    {
-        lightLevel = DARK;
-    }
-    else if (rawValue < lowThreshold)
-    {
-        lightLevel = LOW_LIGHT;
-    }
-    else if (rawValue < mediumThreshold)
-    {
-        lightLevel = MEDIUM_LIGHT;
-    }
-    else if (rawValue < brightThreshold)
+    uint8_t n = oversampling.samples();
+
+    if (!hub || !hub->isRunning())
     {
-        lightLevel = BRIGHT_LIGHT;
+        // Ráfaga de n lecturas directas
+        uint16_t samples[OVERSAMPLE_MAX];
+        sampleRateHz = SensorHub::readSpread(pin, samples, n, 0);
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < n; i++)
+        {
+            oversampling.push(samples[i]);
+            sum += samples[i];
+        }
+        return int((sum + n / 2) / n);
     }
-    else
+
+    // Media recortada de los n frames más recientes del hub
+    acquire.get<AcquireWindow>().setWindow(n);
+    sampleRateHz = hub->getFrameRate();
+
+    uint16_t raw[OVERSAMPLE_MAX];
+    uint8_t count = hub->copySince(SensorHub::CH_LDR, hubCursor, raw, n);
+    if (count == 0)
+        return rawValue;
+
+    float value = 0.0f;
+    for (uint8_t i = 0; i < count; i++)
     {
-        lightLevel = VERY_BRIGHT;
+        oversampling.push(raw[i]);
+        value = acquire.step(raw[i]);
     }
+    return int(value + 0.5f);
+}
+
+void LDRSensor::calculateLightLevel()
+{
+    // Oscuro < dark <= Poca luz < low <= Media < medium <= Intensa < bright <= Muy brillante
+    lightLevel = static_cast<LightLevel>(int(classify.step(rawValue)));
+}
+
+void LDRSensor::syncThresholds()
+{
+    ThresholdLadder<4> &ladder = classify.get<ThresholdLadder<4>>();
+    ladder.setThreshold(0, darkThreshold);
+    ladder.setThreshold(1, lowThreshold);
+    ladder.setThreshold(2, mediumThreshold);
+    ladder.setThreshold(3, brightThreshold);
 }
 
 String LDRSensor::getLightLevelString() const
@@ -70,8 +108,9 @@ void LDRSensor::setThresholds(int dark, int low, int medium, int bright)
     lowThreshold = low;
     mediumThreshold = medium;
     brightThreshold = bright;
+    syncThresholds();
 
-    Serial.printf("LDRSensor: Umbrales actualizados - Oscuro: %d, Bajo: %d, Medio: %d, Alto: %d\n",
+    LOG_I(SENSOR, "LDRSensor: Umbrales actualizados - Oscuro: %d, Bajo: %d, Medio: %d, Alto: %d",
                   dark, low, medium, bright);
 }
 
@@ -2,6 +2,9 @@
 #define LDR_SENSOR_H
 
 #include <Arduino.h>
+#include "SensorPipeline.h"
+
+class SensorHub;
 
 class LDRSensor
 {
@@ -20,6 +23,7 @@ public:
 
     // Inicialización
     void begin();
+    void attachHub(SensorHub *hub);
 
     // Actualización
     void update();
@@ -34,11 +38,22 @@ public:
     // Configuración
     void setSunThreshold(int threshold) { sunThreshold = threshold; }
     void setUpdateInterval(unsigned long interval) { updateInterval = interval; }
+    unsigned long getUpdateInterval() const { return updateInterval; } // ms
     void setThresholds(int dark, int low, int medium, int bright);
 
     // Control de timing
     bool shouldUpdate();
 
+    // Sobremuestreo adaptativo
+    const OversampleBudget &getOversampling() const { return oversampling; }
+    float getSampleRate() const { return sampleRateHz; }
+    void setTargetError(float counts) { oversampling.setTarget(counts); }
+
+    // Cadenas de procesamiento
+    using AcquireWindow = TrimmedMean<32>;                 // Hasta OVERSAMPLE_MAX
+    using AcquirePipeline = Pipeline<AcquireWindow>;       // Por frame ADC (solo con hub)
+    using ClassifyPipeline = Pipeline<ThresholdLadder<4>>; // Cuentas ADC -> LightLevel
+
 private:
     uint8_t pin;
     int rawValue;
@@ -46,6 +61,12 @@ private:
     LightLevel lightLevel;
     unsigned long lastUpdate;
     unsigned long updateInterval;
+    SensorHub *hub;
+    uint32_t hubCursor;
+    AcquirePipeline acquire;
+    OversampleBudget oversampling;
+    float sampleRateHz;
+    ClassifyPipeline classify;
     int sunThreshold;
 
     // Umbrales para niveles de luz
@@ -56,8 +77,13 @@ private:
 
     static constexpr float VREF = 3.3f;
     static constexpr float ADC_RES = 4095.0f;
+    static constexpr uint8_t OVERSAMPLE_MIN = 4;
+    static constexpr uint8_t OVERSAMPLE_MAX = 32;
+    static constexpr float TARGET_ERROR_COUNTS = 4.0f; // ~3 mV; basta para clasificar el nivel
 
     void calculateLightLevel();
+    void syncThresholds();
+    int readRaw();
 };
 
 #endif // LDR_SENSOR_H
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "LevelSensor.h"
+#include "Log.h"
 
 // Implementación de LevelSensor simple
 LevelSensor::LevelSensor() : pin(255), highMeansOK(true)
@@ -15,12 +16,12 @@ void LevelSensor::begin()
 {
     if (pin == 255)
     {
-        Serial.println("LevelSensor: Error - Pin no configurado");
+        LOG_E(LEVEL, "LevelSensor: Error - Pin no configurado");
         return;
     }
     pinMode(pin, INPUT);
-    Serial.printf("LevelSensor: Pin %d inicializado (lógica: %s = OK)\n",
-                  pin, highMeansOK ? "HIGH" : "LOW");
+    LOG_I(LEVEL, "LevelSensor: Pin %d inicializado (lógica: %s = OK)",
+                 pin, highMeansOK ? "HIGH" : "LOW");
 }
 
 bool LevelSensor::isLevelOK()
@@ -47,7 +48,7 @@ void MultiLevelSensor::addSensor(uint8_t pin, bool highMeansOK, const String &na
 {
     if (sensorCount >= MAX_SENSORS)
     {
-        Serial.printf("MultiLevelSensor: Error - Máximo %d sensores permitidos\n", MAX_SENSORS);
+        LOG_E(LEVEL, "MultiLevelSensor: Error - Máximo %d sensores permitidos", MAX_SENSORS);
         return;
     }
 
@@ -55,7 +56,7 @@ void MultiLevelSensor::addSensor(uint8_t pin, bool highMeansOK, const String &na
     sensorNames[sensorCount] = name;
     sensorCount++;
 
-    Serial.printf("MultiLevelSensor: Sensor '%s' agregado en pin %d\n", name.c_str(), pin);
+    LOG_I(LEVEL, "MultiLevelSensor: Sensor '%s' agregado en pin %d", name.c_str(), pin);
 }
 
 void MultiLevelSensor::begin()
@@ -64,14 +65,14 @@ void MultiLevelSensor::begin()
     {
         sensors[i].begin();
     }
-    Serial.printf("MultiLevelSensor: %d sensores inicializados\n", sensorCount);
+    LOG_I(LEVEL, "MultiLevelSensor: %d sensores inicializados", sensorCount);
 }
 
 bool MultiLevelSensor::isLevelOK(uint8_t index)
 {
     if (index >= sensorCount)
     {
-        Serial.printf("MultiLevelSensor: Error - Índice %d fuera de rango\n", index);
+        LOG_E(LEVEL, "MultiLevelSensor: Error - Índice %d fuera de rango", index);
         return false;
     }
     return sensors[index].isLevelOK();
@@ -82,7 +83,7 @@ bool MultiLevelSensor::isLevelOK(const String &name)
     int index = findSensorByName(name);
     if (index < 0)
     {
-        Serial.printf("MultiLevelSensor: Error - Sensor '%s' no encontrado\n", name.c_str());
+        LOG_E(LEVEL, "MultiLevelSensor: Error - Sensor '%s' no encontrado", name.c_str());
         return false;
     }
     return sensors[index].isLevelOK();
@@ -92,7 +93,7 @@ int MultiLevelSensor::getRawReading(uint8_t index)
 {
     if (index >= sensorCount)
     {
-        Serial.printf("MultiLevelSensor: Error - Índice %d fuera de rango\n", index);
+        LOG_E(LEVEL, "MultiLevelSensor: Error - Índice %d fuera de rango", index);
         return LOW;
     }
     return sensors[index].getRawReading();
@@ -103,7 +104,7 @@ int MultiLevelSensor::getRawReading(const String &name)
     int index = findSensorByName(name);
     if (index < 0)
     {
-        Serial.printf("MultiLevelSensor: Error - Sensor '%s' no encontrado\n", name.c_str());
+        LOG_E(LEVEL, "MultiLevelSensor: Error - Sensor '%s' no encontrado", name.c_str());
         return LOW;
     }
     return sensors[index].getRawReading();
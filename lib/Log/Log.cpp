@@ -0,0 +1,181 @@
+#include "Log.h"
+
+Logger logger;
+
+Logger::Logger()
+    : async(false), task(nullptr), stopRequested(false), stopped(false), droppedCount(0), truncatedCount(0), pending(), hasPending(false),
+      lastSite(nullptr), lastModule(0), repeatCount(0), repeatStartMs(0), reportedDrops(0), flushing(false)
+{
+    lastText[0] = '\0';
+}
+
+bool Logger::begin(bool dedicated)
+{
+    async = true;
+    if (dedicated)
+    {
+        stopRequested = false;
+        stopped = false;
+        // Prioridad mínima en el núcleo 0: corre cuando la red duerme
+        if (xTaskCreatePinnedToCore(&Logger::taskEntry, "log_task", STACK_BYTES, this, 0, &task, 0) != pdPASS)
+            task = nullptr;
+    }
+    LOG_I(MAIN, "Log: cola de %u mensajes, %s", (unsigned)LOG_QUEUE_SIZE,
+          task ? "tarea propia (nucleo 0)" : "vaciada desde loop()");
+    return task != nullptr;
+}
+
+bool Logger::end()
+{
+    if (task)
+    {
+        // Borrarla desde afuera podría cortarla con el UART tomado: se le pide
+        // que termine el mensaje en curso y salga, y recién entonces se vacía
+        stopRequested.store(true, std::memory_order_release);
+        unsigned long start = millis();
+        while (!stopped.load(std::memory_order_acquire))
+        {
+            if (millis() - start >= STOP_TIMEOUT_MS)
+                return false;
+            vTaskDelay(1);
+        }
+        task = nullptr;
+    }
+    flushing = true;
+    service(millis());
+    if (repeatCount)
+        flushRepeats();
+    flushing = false;
+    async = false;
+    lastSite = nullptr;
+    return true;
+}
+
+void Logger::taskEntry(void *arg)
+{
+    Logger *log = static_cast<Logger *>(arg);
+    while (!log->stopRequested.load(std::memory_order_acquire))
+    {
+        log->service(millis());
+        vTaskDelay(IDLE_MS / portTICK_PERIOD_MS);
+    }
+    log->stopped.store(true, std::memory_order_release); // Lo que dejó en pending pasa a end()
+    vTaskDelete(nullptr);
+}
+
+void Logger::write(uint8_t module, uint8_t level, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    submit(module, level, false, format, args);
+    va_end(args);
+}
+
+void Logger::print(uint8_t module, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    submit(module, LOG_LVL_INFO, true, format, args);
+    va_end(args);
+}
+
+void Logger::submit(uint8_t module, uint8_t level, bool plain, const char *format, va_list args)
+{
+    Record record;
+    record.site = format;
+    record.module = module;
+    record.level = level;
+    record.plain = plain;
+    int n = vsnprintf(record.text, LINE_SIZE, format, args);
+    if (n >= (int)LINE_SIZE)
+    {
+        truncatedCount.fetch_add(1, std::memory_order_relaxed);
+        n = LINE_SIZE - 1;
+    }
+    // El salto de línea lo pone la salida
+    if (n > 0 && record.text[n - 1] == '\n')
+        record.text[n - 1] = '\0';
+
+    if (!async)
+    {
+        Serial.println(record.text);
+        return;
+    }
+    if (!queue.push(record))
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool Logger::room(size_t bytes) const
+{
+    if (flushing)
+        return true;
+    int need = bytes < (size_t)TX_FIFO_BYTES ? (int)bytes : TX_FIFO_BYTES;
+    return Serial.availableForWrite() >= need;
+}
+
+bool Logger::flushRepeats()
+{
+    char line[LINE_SIZE + 48];
+    int n = snprintf(line, sizeof(line), "  ^ repetido %lu veces, ultimo: %s", (unsigned long)repeatCount, lastText);
+    if (!room(n + 2))
+        return false;
+    Serial.println(line);
+    repeatCount = 0;
+    return true;
+}
+
+bool Logger::emit(const Record &record, unsigned long nowMs)
+{
+    // Misma línea de código que el anterior y dentro de la ventana: se agrupa
+    if (!record.plain && record.site == lastSite && record.module == lastModule &&
+        nowMs - repeatStartMs < REPEAT_WINDOW_MS)
+    {
+        repeatCount++;
+        stats.repeats++;
+        memcpy(lastText, record.text, LINE_SIZE);
+        return true;
+    }
+
+    if (repeatCount && !flushRepeats())
+        return false;
+    if (!room(strlen(record.text) + 2))
+        return false;
+    Serial.println(record.text);
+    stats.printed++;
+    lastSite = record.plain ? nullptr : record.site;
+    lastModule = record.module;
+    repeatStartMs = nowMs;
+    return true;
+}
+
+void Logger::service(unsigned long nowMs)
+{
+    stats.dropped = droppedCount.load(std::memory_order_relaxed);
+    stats.truncated = truncatedCount.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        if (!hasPending)
+        {
+            uint32_t queued = queue.size();
+            if (queued > stats.maxQueued)
+                stats.maxQueued = queued;
+            if (!queue.pop(pending))
+                break;
+            hasPending = true;
+        }
+        if (!emit(pending, nowMs))
+            return; // UART lleno: sigue en el próximo servicio
+        hasPending = false;
+    }
+
+    // Repeticiones que quedaron sin un mensaje distinto detrás
+    if (repeatCount && nowMs - repeatStartMs >= REPEAT_WINDOW_MS && flushRepeats())
+        lastSite = nullptr;
+
+    if (stats.dropped != reportedDrops && room(64))
+    {
+        Serial.printf("Log: %lu mensajes descartados (cola llena)\n", (unsigned long)(stats.dropped - reportedDrops));
+        reportedDrops = stats.dropped;
+    }
+}
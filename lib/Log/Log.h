@@ -0,0 +1,187 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include "MpscQueue.h"
+
+/**
+ * @brief Mensajes por Serial sin bloquear el lazo de control
+ *
+ * Cada mensaje se formatea en un registro fijo y va a una cola sin bloqueo
+ * (MpscQueue: loop(), tarea de red y callbacks pueden escribir a la vez);
+ * una tarea de baja prioridad en el núcleo 0 la vacía hacia el UART solo
+ * cuando hay lugar en el FIFO de TX. Con la cola llena el mensaje se
+ * descarta y se cuenta; nunca espera.
+ *
+ * Niveles por módulo en compilación: LOG_D(LEVEL, ...) con LOG_LEVEL_LEVEL
+ * por debajo de LOG_LVL_DEBUG no genera código (ni el texto ni los
+ * argumentos). LOG_LEVEL fija el nivel de todos los que no tienen uno propio:
+ *
+ *   build_flags = -DLOG_LEVEL=LOG_LVL_WARN -DLOG_LEVEL_CTRL=LOG_LVL_DEBUG
+ *
+ * Mensajes seguidos de la misma línea de código (mismo formato) se agrupan:
+ * sale el primero y, al cambiar de mensaje o cada REPEAT_WINDOW_MS, una
+ * línea con cuántos se omitieron y el último texto. LOG_PRINT() no se
+ * agrupa (bloques como el estado del sistema).
+ *
+ * Antes de begin() todo sale directo por Serial, como en el host.
+ *
+ *   logger.begin(LOG_TASK_DEDICATED);
+ *   LOG_W(CTRL, "PumpController: ALERTA - pH+ bloqueado. pH=%.2f", ph);
+ *   if (!logger.isDedicated()) logger.service(millis()); // En el loop()
+ */
+
+// Niveles
+#define LOG_LVL_NONE 0
+#define LOG_LVL_ERROR 1
+#define LOG_LVL_WARN 2
+#define LOG_LVL_INFO 3
+#define LOG_LVL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LVL_INFO
+#endif
+
+// Nivel de cada módulo (por defecto LOG_LEVEL)
+#ifndef LOG_LEVEL_MAIN
+#define LOG_LEVEL_MAIN LOG_LEVEL // main.cpp
+#endif
+#ifndef LOG_LEVEL_CTRL
+#define LOG_LEVEL_CTRL LOG_LEVEL // PumpController, LoopJitter
+#endif
+#ifndef LOG_LEVEL_SENSOR
+#define LOG_LEVEL_SENSOR LOG_LEVEL // PHSensor, TDSSensor, LDRSensor, SensorHub
+#endif
+#ifndef LOG_LEVEL_LEVEL
+#define LOG_LEVEL_LEVEL LOG_LEVEL // LevelSensor
+#endif
+#ifndef LOG_LEVEL_NET
+#define LOG_LEVEL_NET LOG_LEVEL // NetTask, ConnectionManager, publicación
+#endif
+#ifndef LOG_LEVEL_STORE
+#define LOG_LEVEL_STORE LOG_LEVEL // TelemetryLog, TelemetryShadow
+#endif
+#ifndef LOG_LEVEL_TIME
+#define LOG_LEVEL_TIME LOG_LEVEL // TimeService
+#endif
+
+// 1: vaciar la cola en una tarea propia; 0: logger.service() desde el loop()
+#ifndef LOG_TASK_DEDICATED
+#define LOG_TASK_DEDICATED 1
+#endif
+
+#ifndef LOG_QUEUE_SIZE
+#define LOG_QUEUE_SIZE 64 // Potencia de 2
+#endif
+
+enum LogModule : uint8_t
+{
+    LOG_MOD_MAIN,
+    LOG_MOD_CTRL,
+    LOG_MOD_SENSOR,
+    LOG_MOD_LEVEL,
+    LOG_MOD_NET,
+    LOG_MOD_STORE,
+    LOG_MOD_TIME,
+    LOG_MODULES
+};
+
+#define LOG_AT(mod, lvl, ...)                                                                                         \
+    do                                                                                                                \
+    {                                                                                                                 \
+        if ((lvl) <= LOG_LEVEL_##mod)                                                                                 \
+            logger.write(LOG_MOD_##mod, (lvl), __VA_ARGS__);                                                          \
+    } while (0)
+
+#define LOG_E(mod, ...) LOG_AT(mod, LOG_LVL_ERROR, __VA_ARGS__)
+#define LOG_W(mod, ...) LOG_AT(mod, LOG_LVL_WARN, __VA_ARGS__)
+#define LOG_I(mod, ...) LOG_AT(mod, LOG_LVL_INFO, __VA_ARGS__)
+#define LOG_D(mod, ...) LOG_AT(mod, LOG_LVL_DEBUG, __VA_ARGS__)
+
+// Nivel INFO, sin agrupar repeticiones
+#define LOG_PRINT(mod, ...)                                                                                           \
+    do                                                                                                                \
+    {                                                                                                                 \
+        if (LOG_LVL_INFO <= LOG_LEVEL_##mod)                                                                          \
+            logger.print(LOG_MOD_##mod, __VA_ARGS__);                                                                 \
+    } while (0)
+
+class Logger
+{
+public:
+    static constexpr uint8_t LINE_SIZE = 160; // Texto con '\0'; lo que no cabe se corta
+    static constexpr uint32_t STACK_BYTES = 3072;
+    static constexpr uint32_t IDLE_MS = 10;
+    static constexpr unsigned long REPEAT_WINDOW_MS = 10000;
+    static constexpr int TX_FIFO_BYTES = 128; // FIFO de TX del UART: una línea más larga espera a que se vacíe
+    static constexpr unsigned long STOP_TIMEOUT_MS = 500; // end(): espera a que la tarea termine su mensaje
+
+    struct Record
+    {
+        const char *site; // Formato: identifica la línea de código
+        uint8_t module;
+        uint8_t level;
+        bool plain; // LOG_PRINT
+        char text[LINE_SIZE];
+    };
+
+    struct Stats
+    {
+        uint32_t printed = 0;
+        uint32_t repeats = 0;   // Agrupados (no impresos)
+        uint32_t dropped = 0;   // Cola llena
+        uint32_t truncated = 0; // Más largos que LINE_SIZE
+        uint32_t maxQueued = 0;
+    };
+
+    Logger();
+
+    // Desde aquí los mensajes van a la cola; true si la vacía una tarea propia
+    bool begin(bool dedicated);
+    // Detiene la tarea, vacía lo pendiente y vuelve a escribir directo. false si la
+    // tarea no se detuvo en STOP_TIMEOUT_MS: sigue siendo el consumidor y no se vacía
+    bool end();
+    bool isAsync() const { return async; }
+    bool isDedicated() const { return task != nullptr; }
+
+    void write(uint8_t module, uint8_t level, const char *format, ...) __attribute__((format(printf, 4, 5)));
+    void print(uint8_t module, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+    // Consumidor: imprime mientras haya lugar en el FIFO de TX
+    void service(unsigned long nowMs);
+
+    // Stats del consumidor; dropped y truncated se actualizan en service()
+    const Stats &getStats() const { return stats; }
+
+private:
+    MpscQueue<Record, LOG_QUEUE_SIZE> queue;
+    std::atomic<bool> async;
+    TaskHandle_t task;
+    std::atomic<bool> stopRequested; // end() -> tarea
+    std::atomic<bool> stopped;       // tarea -> end(): ya no consume
+    std::atomic<uint32_t> droppedCount;
+    std::atomic<uint32_t> truncatedCount;
+
+    // Solo el consumidor
+    Record pending; // Sacado de la cola, esperando lugar en el UART
+    bool hasPending;
+    const char *lastSite;
+    uint8_t lastModule;
+    char lastText[LINE_SIZE]; // Último agrupado
+    uint32_t repeatCount;
+    unsigned long repeatStartMs;
+    uint32_t reportedDrops;
+    bool flushing; // end(): imprimir aunque el UART esté lleno
+    Stats stats;
+
+    void submit(uint8_t module, uint8_t level, bool plain, const char *format, va_list args);
+    bool emit(const Record &record, unsigned long nowMs);
+    bool flushRepeats();
+    bool room(size_t bytes) const;
+    static void taskEntry(void *arg);
+};
+
+extern Logger logger;
+
+#endif // LOG_H
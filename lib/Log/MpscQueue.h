@@ -0,0 +1,80 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @brief Cola FIFO sin bloqueo con varios productores y un consumidor (N potencia de 2)
+ *
+ * Como SpscQueue, pero cualquier tarea o núcleo puede encolar: cada ranura
+ * lleva un número de secuencia y el productor reserva la posición con un
+ * compare-exchange sobre head. Nadie espera a nadie; si la cola está llena
+ * push() devuelve false y el elemento se descarta. pop() solo desde un hilo.
+ */
+template <typename T, uint32_t N>
+class MpscQueue
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "MpscQueue requiere N potencia de 2");
+
+public:
+    static constexpr uint32_t CAPACITY = N;
+
+    MpscQueue() : head(0), tail(0)
+    {
+        for (uint32_t i = 0; i < N; i++)
+            cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    // Productores: false si la cola está llena
+    bool push(const T &item)
+    {
+        uint32_t pos = head.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = cells[pos & (N - 1)];
+            int32_t diff = (int32_t)(cell.seq.load(std::memory_order_acquire) - pos);
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false; // El consumidor todavía no liberó esta ranura
+            else
+                pos = head.load(std::memory_order_relaxed); // Otro productor la tomó
+        }
+        Cell &cell = cells[pos & (N - 1)];
+        cell.item = item;
+        cell.seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: false si no hay nada (o el siguiente todavía se está escribiendo)
+    bool pop(T &item)
+    {
+        Cell &cell = cells[tail & (N - 1)];
+        if ((int32_t)(cell.seq.load(std::memory_order_acquire) - (tail + 1)) < 0)
+            return false;
+        item = cell.item;
+        cell.seq.store(tail + N, std::memory_order_release);
+        tail++;
+        return true;
+    }
+
+    // Consumidor: elementos reservados y no consumidos (aproximado)
+    uint32_t size() const { return head.load(std::memory_order_acquire) - tail; }
+
+private:
+    struct Cell
+    {
+        std::atomic<uint32_t> seq;
+        T item;
+    };
+
+    Cell cells[N];
+    std::atomic<uint32_t> head;
+    uint32_t tail; // Solo el consumidor
+};
+
+#endif // MPSC_QUEUE_H
@@ -0,0 +1,65 @@
+#include "LoopJitter.h"
+#include "Log.h"
+
+const uint32_t LoopJitter::BUCKET_LIMITS_MS[BUCKETS - 1] = {1, 5, 20, 100, 1000};
+
+LoopJitter::LoopJitter(uint32_t periodUs) : periodUs(periodUs), lastUs(0), started(false)
+{
+}
+
+void LoopJitter::tick(uint32_t nowUs)
+{
+    if (!started)
+    {
+        started = true;
+        lastUs = nowUs;
+        return;
+    }
+
+    uint32_t interval = nowUs - lastUs;
+    lastUs = nowUs;
+    // El loop() compara millis(): un intervalo algo corto es redondeo, no adelanto
+    uint32_t lateUs = interval > periodUs ? interval - periodUs : 0;
+
+    stats.ticks++;
+    stats.lateLastUs = lateUs;
+    stats.lateSumUs += lateUs;
+    float lateMs = lateUs / 1000.0f;
+    stats.lateSqSumMs += double(lateMs) * lateMs;
+    if (lateUs > stats.lateMaxUs)
+        stats.lateMaxUs = lateUs;
+
+    uint8_t bucket = 0;
+    while (bucket < BUCKETS - 1 && lateUs >= BUCKET_LIMITS_MS[bucket] * 1000UL)
+        bucket++;
+    stats.histogram[bucket]++;
+}
+
+void LoopJitter::reset()
+{
+    stats = Stats();
+    started = false;
+}
+
+void LoopJitter::print(const char *label) const
+{
+    LOG_PRINT(CTRL, "%s: %lu ciclos de %lu ms, retraso medio %.2f ms, RMS %.2f ms, max %.1f ms",
+              label, (unsigned long)stats.ticks, (unsigned long)(periodUs / 1000UL),
+              stats.meanLateMs(), stats.rmsLateMs(), stats.lateMaxUs / 1000.0f);
+    if (!stats.ticks)
+        return;
+
+    // Una sola línea al log: se arma el histograma completo antes
+    char line[Logger::LINE_SIZE];
+    size_t n = snprintf(line, sizeof(line), "  retraso:");
+    for (uint8_t i = 0; i < BUCKETS && n < sizeof(line); i++)
+    {
+        if (i < BUCKETS - 1)
+            n += snprintf(line + n, sizeof(line) - n, " <%lums %.1f%%", (unsigned long)BUCKET_LIMITS_MS[i],
+                          100.0f * stats.histogram[i] / stats.ticks);
+        else
+            n += snprintf(line + n, sizeof(line) - n, " >=%lums %.1f%%", (unsigned long)BUCKET_LIMITS_MS[i - 1],
+                          100.0f * stats.histogram[i] / stats.ticks);
+    }
+    LOG_PRINT(CTRL, "%s", line);
+}
@@ -0,0 +1,53 @@
+#ifndef LOOP_JITTER_H
+#define LOOP_JITTER_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Mide cuánto se atrasa un ciclo periódico respecto a su período
+ *
+ * Se llama tick() al inicio de cada ciclo de control; el retraso es el
+ * intervalo real menos el nominal. Guarda media, RMS, máximo y un histograma
+ * por décadas, suficiente para comparar el loop() con la red en línea (un
+ * PATCH lento retrasa el control segundos) y con la red en su propia tarea.
+ *
+ *   LoopJitter jitter(500000UL);   // 500 ms
+ *   jitter.tick(micros());         // En cada ciclo de control
+ *   jitter.print("Control");
+ */
+class LoopJitter
+{
+public:
+    static constexpr uint8_t BUCKETS = 6;
+    static const uint32_t BUCKET_LIMITS_MS[BUCKETS - 1]; // <1, <5, <20, <100, <1000, resto
+
+    struct Stats
+    {
+        uint32_t ticks = 0;       // Intervalos medidos
+        uint32_t lateMaxUs = 0;
+        uint32_t lateLastUs = 0;  // Último intervalo medido
+        uint64_t lateSumUs = 0;
+        double lateSqSumMs = 0.0; // Σ retraso², para el RMS
+        uint32_t histogram[BUCKETS] = {};
+
+        float meanLateMs() const { return ticks ? lateSumUs / 1000.0f / ticks : 0.0f; }
+        float rmsLateMs() const { return ticks ? sqrtf(lateSqSumMs / ticks) : 0.0f; }
+    };
+
+    explicit LoopJitter(uint32_t periodUs);
+
+    void tick(uint32_t nowUs);
+    void reset(); // Nueva ventana (el primer tick tras reset no mide)
+
+    uint32_t getPeriodUs() const { return periodUs; }
+    const Stats &getStats() const { return stats; }
+    void print(const char *label) const;
+
+private:
+    uint32_t periodUs;
+    uint32_t lastUs;
+    bool started;
+    Stats stats;
+};
+
+#endif // LOOP_JITTER_H
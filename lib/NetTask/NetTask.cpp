@@ -0,0 +1,81 @@
+#include "NetTask.h"
+#include "Log.h"
+
+NetTask::NetTask(unsigned long publishIntervalMs, unsigned long pollIntervalMs)
+    : publishIntervalMs(publishIntervalMs), pollIntervalMs(pollIntervalMs), publish(nullptr), poll(nullptr),
+      task(nullptr), snapshot(), snapshotValid(false), publishPending(true), lastPublishMs(0), lastPollMs(0)
+{
+}
+
+bool NetTask::begin(PublishFn publish, PollFn poll, bool dedicated)
+{
+    this->publish = publish;
+    this->poll = poll;
+    lastPublishMs = millis();
+    lastPollMs = lastPublishMs;
+
+    if (dedicated)
+    {
+        // Misma prioridad que loopTask; el núcleo 0 ya atiende la pila WiFi
+        if (xTaskCreatePinnedToCore(&NetTask::taskEntry, "net_task", STACK_BYTES, this,
+                                    1, &task, 0) != pdPASS)
+        {
+            task = nullptr;
+            LOG_E(NET, "NetTask: Error - No se pudo crear la tarea, red en linea");
+        }
+    }
+
+    LOG_I(NET, "NetTask: Red %s", task ? "en tarea propia (nucleo 0)" : "en linea con loop()");
+    return task != nullptr;
+}
+
+void NetTask::taskEntry(void *arg)
+{
+    NetTask *net = static_cast<NetTask *>(arg);
+    for (;;)
+    {
+        net->service(millis());
+        vTaskDelay(IDLE_MS / portTICK_PERIOD_MS);
+    }
+}
+
+void NetTask::service(unsigned long nowMs)
+{
+    if (snapshots.read(snapshot))
+        snapshotValid = true;
+    if (!snapshotValid)
+        return;
+
+    if (publish && (publishPending || nowMs - lastPublishMs >= publishIntervalMs))
+    {
+        publishPending = false;
+        lastPublishMs = nowMs;
+        unsigned long t0 = millis();
+        publish(snapshot);
+        stats.lastPublishMs = millis() - t0;
+        if (stats.lastPublishMs > stats.maxPublishMs)
+            stats.maxPublishMs = stats.lastPublishMs;
+        stats.publishes++;
+    }
+
+    if (poll && nowMs - lastPollMs >= pollIntervalMs)
+    {
+        lastPollMs = nowMs;
+        unsigned long t0 = millis();
+        poll(*this, snapshot);
+        unsigned long elapsed = millis() - t0;
+        if (elapsed > stats.maxPollMs)
+            stats.maxPollMs = elapsed;
+        stats.polls++;
+    }
+}
+
+bool NetTask::sendCommand(NetCommand::Type type)
+{
+    NetCommand command = {type};
+    if (commands.push(command))
+        return true;
+    stats.commandsDropped++;
+    LOG_E(NET, "NetTask: Error - Cola de comandos llena");
+    return false;
+}
@@ -0,0 +1,140 @@
+#ifndef NET_TASK_H
+#define NET_TASK_H
+
+#include <Arduino.h>
+#include "SpscChannels.h"
+#include "TimeService.h"
+#include "PerfStage.h"
+
+/**
+ * @brief Red fuera del lazo de control
+ *
+ * Si NET_TASK_DEDICATED es 1, publicar y consultar comandos corre en una
+ * tarea FreeRTOS fijada al núcleo 0 (el de WiFi); el loop() queda en el
+ * núcleo 1 y un handshake TLS o un timeout de Firebase ya no lo detienen.
+ * Con 0 (o si la tarea no se puede crear, como en el host) el loop() llama
+ * a service() y todo corre en línea como antes; sirve para comparar el
+ * jitter del control en ambos modos.
+ */
+#ifndef NET_TASK_DEDICATED
+#define NET_TASK_DEDICATED 1
+#endif
+
+/**
+ * @brief Estado del sistema que el loop() entrega a la red en cada ciclo
+ */
+struct TelemetrySnapshot
+{
+    unsigned long takenMs;
+    float ph;
+    float tds;
+    int ldrRaw;
+    char ldrLevel[16];
+    bool tdsConnected;
+    bool phCalibrated;
+    bool circulation;
+    bool pumpMinus;
+    bool pumpPlus;
+    bool emergency;
+    bool levelMinus;
+    bool levelPlus;
+    uint32_t loopLateMaxUs; // Peor retraso del ciclo de control (LoopJitter)
+    TimeService::Stamp stamp; // {epoch_ms, boot_id, seq} del momento de la lectura
+    bool clockSynced;         // Hay hora SNTP (clockOffsetMs válido)
+    int64_t clockOffsetMs;    // epoch - monotónico (TimeService::offsetMs())
+    float clockDriftPpm;
+    int32_t bootControlMs;    // millis() del primer ciclo de control
+#if PERF_ENABLED && PERF_TELEMETRY
+    uint8_t perfStages;
+    PerfStage::Summary perf[PerfStage::MAX_SUMMARY]; // Latencia por etapa (PerfStage::summarize)
+#endif
+};
+
+/**
+ * @brief Orden de la red al lazo de control
+ */
+struct NetCommand
+{
+    enum Type : uint8_t
+    {
+        EMERGENCY_STOP,
+        EMERGENCY_RESUME,
+        RESTART
+    };
+    Type type;
+};
+
+/**
+ * @brief Tarea de red con un canal de estado (loop -> red) y uno de órdenes (red -> loop)
+ *
+ * Los callbacks corren en el contexto de la red (tarea o service()):
+ * publish cada publishIntervalMs con el último snapshot y poll cada
+ * pollIntervalMs para leer órdenes y encolarlas con sendCommand().
+ *
+ *   netTask.begin(&publicar, &consultar, NET_TASK_DEDICATED);
+ *   // loop():
+ *   netTask.publishSnapshot(snap);
+ *   while (netTask.receiveCommand(cmd)) { ... }
+ *   if (!netTask.isDedicated()) netTask.service(millis());
+ */
+class NetTask
+{
+public:
+    typedef void (*PublishFn)(const TelemetrySnapshot &snapshot);
+    typedef void (*PollFn)(NetTask &net, const TelemetrySnapshot &snapshot);
+
+    struct Stats
+    {
+        uint32_t publishes = 0;
+        uint32_t polls = 0;
+        uint32_t commandsDropped = 0;
+        unsigned long lastPublishMs = 0; // Duración de la última publicación
+        unsigned long maxPublishMs = 0;
+        unsigned long maxPollMs = 0;
+    };
+
+    static constexpr uint32_t COMMAND_QUEUE = 8;
+    static constexpr uint32_t STACK_BYTES = 12288; // Firebase + TLS
+    static constexpr uint32_t IDLE_MS = 10;
+
+    NetTask(unsigned long publishIntervalMs, unsigned long pollIntervalMs);
+
+    // Devuelve true si la red quedó en su propia tarea
+    bool begin(PublishFn publish, PollFn poll, bool dedicated);
+    bool isDedicated() const { return task != nullptr; }
+
+    // Lado del control
+    void publishSnapshot(const TelemetrySnapshot &snapshot) { snapshots.write(snapshot); }
+    bool receiveCommand(NetCommand &command) { return commands.pop(command); }
+
+    // Lado de la red
+    void service(unsigned long nowMs);
+    bool sendCommand(NetCommand::Type type);
+    bool hasSnapshot() const { return snapshotValid; }
+    const TelemetrySnapshot &latest() const { return snapshot; }
+    void forcePublish() { publishPending = true; }
+
+    const Stats &getStats() const { return stats; }
+
+private:
+    unsigned long publishIntervalMs;
+    unsigned long pollIntervalMs;
+    PublishFn publish;
+    PollFn poll;
+    TaskHandle_t task;
+
+    TripleBuffer<TelemetrySnapshot> snapshots;
+    SpscQueue<NetCommand, COMMAND_QUEUE> commands;
+
+    // Solo los toca el contexto de red
+    TelemetrySnapshot snapshot;
+    bool snapshotValid;
+    bool publishPending;
+    unsigned long lastPublishMs;
+    unsigned long lastPollMs;
+    Stats stats;
+
+    static void taskEntry(void *arg);
+};
+
+#endif // NET_TASK_H
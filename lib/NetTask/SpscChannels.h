@@ -0,0 +1,116 @@
+#ifndef SPSC_CHANNELS_H
+#define SPSC_CHANNELS_H
+
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * @file SpscChannels.h
+ * @brief Canales sin bloqueo entre exactamente un productor y un consumidor
+ *
+ * Pensados para cruzar datos entre el loop() de control (núcleo 1) y la tarea
+ * de red (núcleo 0) sin secciones críticas: ninguno de los dos lados espera
+ * nunca al otro. Solo usan std::atomic con acquire/release, así que también
+ * compilan y se prueban en el host con hilos reales.
+ */
+
+/**
+ * @brief Cola FIFO circular de capacidad fija (N potencia de 2)
+ *
+ * head solo lo escribe el productor y tail solo el consumidor; los índices
+ * corren libres y se enmascaran al acceder, así caben N elementos.
+ */
+template <typename T, uint32_t N>
+class SpscQueue
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscQueue requiere N potencia de 2");
+
+public:
+    static constexpr uint32_t CAPACITY = N;
+
+    SpscQueue() : slots(), head(0), tail(0) {}
+
+    // Productor: false si la cola está llena (el elemento se descarta)
+    bool push(const T &item)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N)
+            return false;
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: false si no hay nada
+    bool pop(T &item)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t)
+            return false;
+        item = slots[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Aproximado si se llama desde el otro lado
+    uint32_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+};
+
+/**
+ * @brief Último valor publicado, sin colas ni copias a medias
+ *
+ * Tres ranuras: el escritor llena la suya y la intercambia con la del medio;
+ * el lector, si el medio trae un valor nuevo, lo intercambia con la suya. El
+ * lector siempre ve el valor más reciente completo y el escritor nunca espera,
+ * aunque el lector tarde segundos (p. ej. bloqueado en un PATCH).
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() : slots(), middle(1), back(0), front(2), written(0) {}
+
+    // Escritor
+    void write(const T &value)
+    {
+        slots[back] = value;
+        uint8_t prev = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = prev & INDEX;
+        written++;
+    }
+
+    // Lector: copia el valor si hay uno nuevo desde la última lectura
+    bool read(T &value)
+    {
+        if (!(middle.load(std::memory_order_acquire) & FRESH))
+            return false;
+        uint8_t prev = middle.exchange(front, std::memory_order_acq_rel);
+        front = prev & INDEX;
+        value = slots[front];
+        return true;
+    }
+
+    // Valores escritos (lado escritor)
+    uint32_t writeCount() const { return written; }
+
+private:
+    static constexpr uint8_t INDEX = 0x03;
+    static constexpr uint8_t FRESH = 0x04;
+
+    T slots[3];
+    std::atomic<uint8_t> middle; // Índice de la ranura intermedia | FRESH
+    uint8_t back;                // Propiedad del escritor
+    uint8_t front;               // Propiedad del lector
+    uint32_t written;
+};
+
+#endif // SPSC_CHANNELS_H
@@ -1,15 +1,21 @@
 #include "PHSensor.h"
+#include "Log.h"
+#include "SensorHub.h"
 
 PHSensor::PHSensor(uint8_t pin, int eepromAddr)
     : pin(pin), eepromAddr(eepromAddr), temperature(25.0f),
-      phFiltered(7.0f), phInstant(7.0f), lastVoltage(0.0f),
-      filterAlpha(0.25f), dividerK(1.0f)
+      phFiltered(7.0f), phInstant(7.0f), lastVoltage(0.0f), lastRaw(0.0f),
+      lastSpread(0), lastSamples(OVERSAMPLE_MAX), lastUpdateMs(0), hub(nullptr), hubCursor(0),
+      oversampling(TARGET_ERROR_COUNTS, OVERSAMPLE_MIN, OVERSAMPLE_MAX), sampleRateHz(0.0f)
 {
 
     // Valores por defecto de calibración
     calibration.v_at_ph7 = 2.50f;
     calibration.v_per_ph_25 = 0.18f;
     calibration.valid = false;
+
+    convert.get<PhKalman>().setInitial(7.0f);
+    syncCalibration();
 }
 
 void PHSensor::begin()
@@ -18,89 +24,139 @@ void PHSensor::begin()
     analogSetPinAttenuation(pin, ADC_11db);
     loadCalibration();
     sanitizeCalibration();
+    syncCalibration();
 }
 
-void PHSensor::update()
+void PHSensor::attachHub(SensorHub *hub)
 {
-    lastVoltage = readVoltageMedianAvg(10);
-    float modulVoltage = lastVoltage * dividerK;
-    phInstant = computePH(modulVoltage, temperature);
-    phFiltered = filterAlpha * phInstant + (1.0f - filterAlpha) * phFiltered;
+    this->hub = hub;
+    hubCursor = 0;
+    acquire.get<Notch>().configure(hub->getFrameRate(), hub->getHumFrequency());
+    acquire.reset();
 }
 
-float PHSensor::readVoltageMedianAvg(uint8_t nSamples)
+void PHSensor::update()
 {
-    float buf[20];
-    if (nSamples > 20)
-        nSamples = 20;
+    float raw = readRaw(oversampling.samples());
+    lastVoltage = raw * (VREF / ADC_RES);
 
-    // Tomar muestras
-    for (uint8_t i = 0; i < nSamples; i++)
+    // Intervalo real entre updates para la predicción del filtro
+    unsigned long now = millis();
+    if (lastUpdateMs != 0)
     {
-        int adc = analogRead(pin);
-        buf[i] = (adc * VREF) / ADC_RES;
-        delay(8);
+        float dt = (now - lastUpdateMs) / 1000.0f;
+        convert.get<PhKalman>().setInterval(constrain(dt, 0.01f, 10.0f));
     }
+    lastUpdateMs = now;
 
-    // Ordenar (inserción)
-    for (uint8_t i = 1; i < nSamples; i++)
-    {
-        float key = buf[i];
-        int j = i - 1;
-        while (j >= 0 && buf[j] > key)
-        {
-            buf[j + 1] = buf[j];
-            j--;
-        }
-        buf[j + 1] = key;
-    }
+    updateMeasurementNoise();
+    phFiltered = convert.step(raw);
+    phInstant = convert.get<PhKalman>().lastInput();
+}
 
-    // Promedio de la parte central
-    uint8_t start = nSamples / 4;
-    uint8_t end = nSamples - start;
-    float sum = 0.0f;
-    for (uint8_t i = start; i < end; i++)
-    {
-        sum += buf[i];
-    }
-    return sum / float(end - start);
+void PHSensor::updateMeasurementNoise()
+{
+    // σ de una muestra ≈ rango / 4; la media recortada promedia la mitad
+    // central de la ventana. Se lleva a pH con la sensibilidad actual.
+    float sigmaCounts = lastSpread / 4.0f / sqrtf(lastSamples / 2.0f);
+    if (sigmaCounts < 0.5f)
+        sigmaCounts = 0.5f; // Cuantización del ADC
+    float phPerCount = (VREF / ADC_RES) * convert.get<ScaleStage>().getFactor() *
+                       convert.get<CalibStage>().phPerVolt();
+    float sigmaPh = sigmaCounts * phPerCount;
+
+    PhKalman &kalman = convert.get<PhKalman>();
+    float r = kalman.measurementNoise();
+    kalman.setMeasurementNoise(r + NOISE_SMOOTHING * (sigmaPh * sigmaPh - r));
 }
 
-float PHSensor::computePH(float voltage, float tempC)
+void PHSensor::setTemperature(float temp)
 {
-    voltage = clamp(voltage, 0.0f, 5.0f);
+    temperature = temp;
+    convert.get<CalibStage>().setTemperature(temp);
+}
 
-    float slope25 = (isfinite(calibration.v_per_ph_25) && calibration.v_per_ph_25 > MIN_SLOPE)
-                        ? calibration.v_per_ph_25
-                        : 0.18f;
-    float v7 = isfinite(calibration.v_at_ph7) ? calibration.v_at_ph7 : 2.50f;
+float PHSensor::readVoltage(uint8_t nSamples)
+{
+    return readRaw(nSamples) * (VREF / ADC_RES);
+}
 
-    // Compensación por temperatura
-    float slope_T = slope25 * ((tempC + 273.15f) / 298.15f);
-    if (slope_T < MIN_SLOPE)
-        slope_T = MIN_SLOPE;
+float PHSensor::readRaw(uint8_t nSamples)
+{
+    if (nSamples < OVERSAMPLE_MIN)
+        nSamples = OVERSAMPLE_MIN;
+    if (nSamples > OVERSAMPLE_MAX)
+        nSamples = OVERSAMPLE_MAX;
+    lastSamples = nSamples;
+
+    if (hub && hub->isRunning())
+        return readRawFromHub(nSamples);
+    return readRawMedianAvg(nSamples);
+}
+
+float PHSensor::readRawMedianAvg(uint8_t nSamples)
+{
+    uint16_t buf[OVERSAMPLE_MAX];
+
+    // Repartir las muestras en periodos completos de red (bloqueante, solo sin hub)
+    uint32_t windowUs = SensorHub::mainsWindowUs(BLOCK_MAINS_PERIODS);
+    if (windowUs == 0)
+        windowUs = BLOCK_WINDOW_MS * 1000UL;
+    sampleRateHz = SensorHub::readSpread(pin, buf, nSamples, windowUs);
+
+    uint16_t lo = buf[0], hi = buf[0];
+    for (uint8_t i = 0; i < nSamples; i++)
+    {
+        oversampling.push(buf[i]);
+        if (buf[i] < lo)
+            lo = buf[i];
+        if (buf[i] > hi)
+            hi = buf[i];
+    }
+    lastSpread = hi - lo;
+
+    lastRaw = trimmedMeanSort(buf, nSamples);
+    return lastRaw;
+}
 
-    return 7.0f + (v7 - voltage) / slope_T;
+float PHSensor::readRawFromHub(uint8_t nSamples)
+{
+    // La ventana de la media recortada sigue al presupuesto de muestras
+    AcquireWindow &window = acquire.get<AcquireWindow>();
+    window.setWindow(nSamples);
+    sampleRateHz = hub->getFrameRate();
+
+    // Pasar por la cadena solo los frames nuevos desde la última lectura
+    uint16_t raw[OVERSAMPLE_MAX];
+    uint8_t n = hub->copySince(SensorHub::CH_PH, hubCursor, raw, nSamples);
+    for (uint8_t i = 0; i < n; i++)
+    {
+        oversampling.push(raw[i]);
+        lastRaw = acquire.step(raw[i]);
+    }
+    lastSpread = window.spread();
+    return lastRaw;
 }
 
 void PHSensor::calibratePoint(float targetPH, float temperature)
 {
-    float voltageNow = readVoltageMedianAvg();
-    float moduleVoltage = voltageNow * dividerK;
+    float voltageNow = readVoltage(OVERSAMPLE_MAX);
+    float moduleVoltage = voltageNow * convert.get<ScaleStage>().getFactor();
 
     if (abs(targetPH - 7.0f) < 0.01f)
     {
         // Calibración punto neutro
         calibration.v_at_ph7 = moduleVoltage;
         calibration.valid = true;
-        Serial.printf("PHSensor: Calibrado V@7=%.4f V\n", moduleVoltage);
+        syncCalibration();
+        LOG_I(SENSOR, "PHSensor: Calibrado V@7=%.4f V", moduleVoltage);
     }
     else
     {
         // Calibración pendiente
         if (!isfinite(calibration.v_at_ph7))
         {
-            Serial.println("PHSensor: Error - Primero calibra el punto pH 7");
+            LOG_E(SENSOR, "PHSensor: Error - Primero calibra el punto pH 7");
             return;
         }
 
@@ -110,13 +166,14 @@ void PHSensor::calibratePoint(float targetPH, float temperature)
 
         if (slope25 < MIN_SLOPE || slope25 > MAX_SLOPE)
         {
-            Serial.printf("PHSensor: Error - Pendiente fuera de rango: %.3f V/pH\n", slope25);
+            LOG_E(SENSOR, "PHSensor: Error - Pendiente fuera de rango: %.3f V/pH", slope25);
             return;
         }
 
         calibration.v_per_ph_25 = slope25;
         calibration.valid = true;
-        Serial.printf("PHSensor: Calibrado slope=%.4f V/pH (buffer %.0f)\n", slope25, targetPH);
+        syncCalibration();
+        LOG_I(SENSOR, "PHSensor: Calibrado slope=%.4f V/pH (buffer %.0f)", slope25, targetPH);
     }
 }
 
@@ -124,7 +181,7 @@ void PHSensor::saveCalibration()
 {
     EEPROM.put(eepromAddr, calibration);
     EEPROM.commit();
-    Serial.println("PHSensor: Calibración guardada en EEPROM");
+    LOG_I(SENSOR, "PHSensor: Calibración guardada en EEPROM");
 }
 
 void PHSensor::loadCalibration()
@@ -137,8 +194,9 @@ void PHSensor::resetCalibration()
     calibration.v_at_ph7 = 2.50f;
     calibration.v_per_ph_25 = 0.18f;
     calibration.valid = false;
+    syncCalibration();
     saveCalibration();
-    Serial.println("PHSensor: Calibración restablecida a valores por defecto");
+    LOG_I(SENSOR, "PHSensor: Calibración restablecida a valores por defecto");
 }
 
 void PHSensor::clearEEPROM()
@@ -148,7 +206,7 @@ void PHSensor::clearEEPROM()
         EEPROM.write(eepromAddr + i, 0xFF);
     }
     EEPROM.commit();
-    Serial.println("PHSensor: EEPROM de calibración borrada");
+    LOG_I(SENSOR, "PHSensor: EEPROM de calibración borrada");
 }
 
 void PHSensor::sanitizeCalibration()
@@ -169,15 +227,11 @@ void PHSensor::sanitizeCalibration()
         calibration.v_at_ph7 = 2.50f;
         calibration.v_per_ph_25 = 0.18f;
         calibration.valid = false;
-        Serial.println("PHSensor: Calibración inválida. Usando valores por defecto.");
+        LOG_W(SENSOR, "PHSensor: Calibración inválida. Usando valores por defecto.");
     }
 }
 
-float PHSensor::clamp(float x, float lo, float hi)
+void PHSensor::syncCalibration()
 {
-    if (x < lo)
-        return lo;
-    if (x > hi)
-        return hi;
-    return x;
+    convert.get<CalibStage>().setCalibration(calibration.v_at_ph7, calibration.v_per_ph_25);
 }
\ No newline at end of file
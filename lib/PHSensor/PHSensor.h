@@ -3,6 +3,9 @@
 
 #include <Arduino.h>
 #include <EEPROM.h>
+#include "SensorPipeline.h"
+
+class SensorHub;
 
 class PHSensor
 {
@@ -19,12 +22,21 @@ public:
 
     // Inicialización
     void begin();
+    void attachHub(SensorHub *hub);
 
     // Lectura de pH
     void update();
     float getFilteredPH() const { return phFiltered; }
     float getInstantPH() const { return phInstant; }
     float getVoltage() const { return lastVoltage; }
+    float getPHRate() const { return convert.get<PhKalman>().rate(); } // pH/s
+    bool isSettled() const { return convert.get<PhKalman>().isSettled(); }
+    float getNoisePH() const { return sqrtf(convert.get<PhKalman>().measurementNoise()); }
+
+    // Sobremuestreo adaptativo
+    const OversampleBudget &getOversampling() const { return oversampling; }
+    float getSampleRate() const { return sampleRateHz; }
+    void setTargetError(float counts) { oversampling.setTarget(counts); }
 
     // Calibración
     void calibratePoint(float targetPH, float temperature = 25.0f);
@@ -35,13 +47,30 @@ public:
     bool isCalibrationValid() const { return calibration.valid; }
 
     // Configuración
-    void setTemperature(float temp) { temperature = temp; }
-    void setFilterAlpha(float alpha) { filterAlpha = alpha; }
-    void setDividerK(float k) { dividerK = k; }
+    void setTemperature(float temp);
+    void setProcessNoise(float q) { convert.get<PhKalman>().setProcessNoise(q); }
+    void setSettledRate(float phPerSec) { convert.get<PhKalman>().setSettledRate(phPerSec); }
+    void setDividerK(float k) { convert.get<ScaleStage>().setFactor(k); }
 
     // Obtener calibración
     Calibration getCalibration() const { return calibration; }
 
+    // Etapas de conversión (float o Q16.16 según SENSOR_FIXED_POINT)
+#if SENSOR_FIXED_POINT
+    using VoltsStage = AdcToVoltsQ16<4095>;
+    using ScaleStage = ScaleQ16;
+    using CalibStage = PhCalibQ16;
+#else
+    using VoltsStage = AdcToVolts;
+    using ScaleStage = Scale;
+    using CalibStage = PhCalib;
+#endif
+
+    // Cadenas de procesamiento
+    using AcquireWindow = TrimmedMean<32>;                                               // Hasta OVERSAMPLE_MAX
+    using AcquirePipeline = Pipeline<Notch, AcquireWindow>;                              // Por frame ADC
+    using ConvertPipeline = Pipeline<VoltsStage, ScaleStage, CalibStage, PhKalman>; // Por update
+
 private:
     uint8_t pin;
     int eepromAddr;
@@ -49,9 +78,17 @@ private:
     float phFiltered;
     float phInstant;
     float lastVoltage;
-    float filterAlpha;
-    float dividerK;
+    float lastRaw;
+    uint16_t lastSpread; // Dispersión (máx - mín) de la última ventana, en cuentas
+    uint8_t lastSamples; // Muestras promediadas en la última lectura
+    unsigned long lastUpdateMs;
     Calibration calibration;
+    SensorHub *hub;
+    uint32_t hubCursor;
+    AcquirePipeline acquire;
+    ConvertPipeline convert;
+    OversampleBudget oversampling;
+    float sampleRateHz;
 
     // Constantes
     static constexpr float VREF = 3.3f;
@@ -60,12 +97,21 @@ private:
     static constexpr float MAX_SLOPE = 0.40f;
     static constexpr float MIN_V_AT_7 = 0.2f;
     static constexpr float MAX_V_AT_7 = 4.0f;
+    static constexpr float NOISE_SMOOTHING = 0.2f; // Peso de cada nueva estimación de R
+    static constexpr uint8_t OVERSAMPLE_MIN = 4;
+    static constexpr uint8_t OVERSAMPLE_MAX = 32;
+    static constexpr float TARGET_ERROR_COUNTS = 0.5f; // ~0.002 pH con la pendiente nominal
+    static constexpr uint16_t BLOCK_WINDOW_MS = 80;    // Lectura bloqueante sin red configurada
+    static constexpr uint8_t BLOCK_MAINS_PERIODS = 2;  // Lectura bloqueante sincronizada (33 ms a 60 Hz)
 
     // Métodos privados
-    float readVoltageMedianAvg(uint8_t nSamples = 10);
-    float computePH(float voltage, float tempC);
+    float readRawMedianAvg(uint8_t nSamples);
+    float readRawFromHub(uint8_t nSamples);
+    float readRaw(uint8_t nSamples);
+    float readVoltage(uint8_t nSamples);
     void sanitizeCalibration();
-    float clamp(float x, float lo, float hi);
+    void syncCalibration();
+    void updateMeasurementNoise();
 };
 
 #endif // PH_SENSOR_H
\ No newline at end of file
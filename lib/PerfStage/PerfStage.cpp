@@ -0,0 +1,99 @@
+#include "PerfStage.h"
+
+PerfStage *PerfStage::head = nullptr;
+
+PerfStage::PerfStage(const char *name, const char *path) : name(name), path(path), next(nullptr)
+{
+    reset();
+    // Al final de la lista: PERF las muestra en orden de declaración
+    PerfStage **link = &head;
+    while (*link)
+        link = &(*link)->next;
+    *link = this;
+}
+
+PerfStage::~PerfStage()
+{
+    for (PerfStage **link = &head; *link; link = &(*link)->next)
+    {
+        if (*link == this)
+        {
+            *link = next;
+            return;
+        }
+    }
+}
+
+float PerfStage::ticksPerUs()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    return float(ESP.getCpuFreqMHz()); // Un ciclo por tick
+#else
+    return 100.0f; // Ticks de 10 ns
+#endif
+}
+
+void PerfStage::reset()
+{
+    count = 0;
+    maxTicks = 0;
+    sumTicks = 0;
+    for (uint8_t b = 0; b < BUCKETS; b++)
+        histogram[b] = 0;
+}
+
+void PerfStage::resetAll()
+{
+    for (PerfStage *s = head; s; s = s->next)
+        s->reset();
+}
+
+uint32_t PerfStage::bucketLower(uint8_t b)
+{
+    if (b < 2)
+        return b;
+    uint8_t msb = b / 2;
+    return (1UL << msb) | (uint32_t(b & 1) << (msb - 1));
+}
+
+uint32_t PerfStage::bucketUpper(uint8_t b)
+{
+    return b + 1 < BUCKETS ? bucketLower(b + 1) - 1 : 0xFFFFFFFFu;
+}
+
+uint32_t PerfStage::percentileTicks(uint16_t perMille) const
+{
+    if (!count)
+        return 0;
+    uint64_t rank = (uint64_t(count) * perMille + 999) / 1000;
+    if (rank < 1)
+        rank = 1;
+    uint64_t seen = 0;
+    for (uint8_t b = 0; b < BUCKETS; b++)
+    {
+        seen += histogram[b];
+        if (seen >= rank)
+            return bucketUpper(b) < maxTicks ? bucketUpper(b) : maxTicks;
+    }
+    return maxTicks;
+}
+
+static uint32_t summaryUs(uint32_t t)
+{
+    float us = PerfStage::toUs(t) + 0.5f;
+    return us < PerfStage::SUMMARY_MAX_US ? uint32_t(us) : PerfStage::SUMMARY_MAX_US;
+}
+
+uint8_t PerfStage::summarize(Summary *out, uint8_t max)
+{
+    uint8_t n = 0;
+    for (const PerfStage *s = head; s && n < max; s = s->next, n++)
+    {
+        out[n].path = s->path;
+        out[n].count = s->count;
+        out[n].p50Us = summaryUs(s->percentileTicks(500));
+        out[n].p99Us = summaryUs(s->percentileTicks(990));
+        out[n].maxUs = summaryUs(s->maxTicks);
+    }
+    return n;
+}
@@ -0,0 +1,144 @@
+#ifndef PERF_STAGE_H
+#define PERF_STAGE_H
+
+#include <Arduino.h>
+#if !defined(ARDUINO_ARCH_ESP32)
+#include <chrono>
+#endif
+
+// 0: PERF_STAGE y PERF_SCOPE no generan código ni ocupan RAM
+#ifndef PERF_ENABLED
+#define PERF_ENABLED 1
+#endif
+
+// 1: la telemetría suma diagnostico/perf/<etapa> = "p50/p99/max" en µs
+#ifndef PERF_TELEMETRY
+#define PERF_TELEMETRY 0
+#endif
+
+/**
+ * @brief Histograma de latencia de una etapa del firmware
+ *
+ * PERF_SCOPE mide el bloque en ticks (ESP.getCycleCount() en el ESP32,
+ * steady_clock en el host) y record() suma la duración a un histograma
+ * logarítmico fijo: dos cubetas por octava, así p50 y p99 salen con un error
+ * menor al 50% y sin guardar muestras. El máximo es exacto.
+ *
+ * Las etapas se encadenan al construirse, en orden de declaración; el
+ * comando PERF las recorre con first()/getNext(). Cada etapa se escribe
+ * desde un solo contexto (loop() o la tarea de red); leerla desde el otro
+ * núcleo puede mezclar una muestra a medio sumar, nada más.
+ *
+ *   PERF_STAGE(perfPh, "ph");        // Global: ruta diagnostico/perf/ph
+ *   void tareaControl(void *)
+ *   {
+ *       { PERF_SCOPE(perfPh); phSensor.update(); }
+ *   }
+ */
+class PerfStage
+{
+public:
+    static constexpr uint8_t BUCKETS = 64;              // 2 por octava de ticks de 32 bits
+    static constexpr uint8_t MAX_SUMMARY = 8;           // Etapas que viajan en el snapshot
+    static constexpr uint32_t SUMMARY_MAX_US = 9999999; // "p50/p99/max" entra en un texto de 24
+
+    // p50/p99/max en µs (con tope SUMMARY_MAX_US), para la telemetría
+    struct Summary
+    {
+        const char *path;
+        uint32_t count;
+        uint32_t p50Us;
+        uint32_t p99Us;
+        uint32_t maxUs;
+    };
+
+    // path debe ser un literal (TelemetryShadow guarda el puntero)
+    PerfStage(const char *name, const char *path);
+    ~PerfStage();
+
+    static uint32_t ticks()
+    {
+#if defined(ARDUINO_ARCH_ESP32)
+        return ESP.getCycleCount();
+#else
+        using namespace std::chrono;
+        return uint32_t(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count() / 10);
+#endif
+    }
+
+    static float ticksPerUs();
+    static float toUs(uint32_t t) { return t / ticksPerUs(); }
+
+    void record(uint32_t t)
+    {
+        histogram[bucketOf(t)]++;
+        count++;
+        sumTicks += t;
+        if (t > maxTicks)
+            maxTicks = t;
+    }
+    void reset();
+
+    // Cota superior de la cubeta donde cae la muestra perMille/1000 (nunca más que el máximo)
+    uint32_t percentileTicks(uint16_t perMille) const;
+
+    const char *getName() const { return name; }
+    const char *getPath() const { return path; }
+    uint32_t getCount() const { return count; }
+    uint32_t getMaxTicks() const { return maxTicks; }
+    float meanUs() const { return count ? toUs(uint32_t(sumTicks / count)) : 0.0f; }
+    const PerfStage *getNext() const { return next; }
+
+    static PerfStage *first() { return head; }
+    static void resetAll();
+    static uint8_t summarize(Summary *out, uint8_t max);
+
+    // Cubeta b: [bucketLower(b), bucketUpper(b)]
+    static uint8_t bucketOf(uint32_t t)
+    {
+        if (t < 2)
+            return uint8_t(t);
+        uint8_t msb = 31 - __builtin_clz(t);
+        return uint8_t(2 * msb + ((t >> (msb - 1)) & 1));
+    }
+    static uint32_t bucketLower(uint8_t b);
+    static uint32_t bucketUpper(uint8_t b);
+
+private:
+    const char *name;
+    const char *path;
+    uint32_t count;
+    uint32_t maxTicks;
+    uint64_t sumTicks;
+    uint32_t histogram[BUCKETS];
+    PerfStage *next;
+
+    static PerfStage *head;
+};
+
+/**
+ * @brief Mide desde la construcción hasta el final del bloque
+ */
+class PerfScope
+{
+public:
+    explicit PerfScope(PerfStage &stage) : stage(stage), start(PerfStage::ticks()) {}
+    ~PerfScope() { stage.record(PerfStage::ticks() - start); }
+
+private:
+    PerfStage &stage;
+    uint32_t start;
+};
+
+#define PERF_CONCAT_(a, b) a##b
+#define PERF_CONCAT(a, b) PERF_CONCAT_(a, b)
+
+#if PERF_ENABLED
+#define PERF_STAGE(var, name) PerfStage var(name, "diagnostico/perf/" name)
+#define PERF_SCOPE(var) PerfScope PERF_CONCAT(perfScope, __LINE__)(var)
+#else
+#define PERF_STAGE(var, name) static_assert(true, "")
+#define PERF_SCOPE(var) do { } while (0)
+#endif
+
+#endif // PERF_STAGE_H
@@ -0,0 +1,303 @@
+#include "PlantSim.h"
+#include <stdio.h>
+
+namespace
+{
+    constexpr double KW = 1e-14;
+    constexpr float PI_F = 3.14159265f;
+    constexpr float SECONDS_PER_DAY = 86400.0f;
+
+    // Fórmula de GravityTDS a 25 °C (ppm en función del voltaje)
+    float tdsFromVolts(float v)
+    {
+        return (133.42f * v * v * v - 255.86f * v * v + 857.39f * v) * 0.5f;
+    }
+
+    float voltsFromTds(float ppm)
+    {
+        // Monótona en 0..3.3 V: bisección
+        float lo = 0.0f, hi = 3.3f;
+        for (int i = 0; i < 24; i++)
+        {
+            float mid = 0.5f * (lo + hi);
+            if (tdsFromVolts(mid) < ppm)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return 0.5f * (lo + hi);
+    }
+}
+
+PlantSim::PlantSim(const Pins &pins) : PlantSim(pins, Config())
+{
+}
+
+PlantSim::PlantSim(const Pins &pins, const Config &config)
+    : pins(pins), config(config), timer(nullptr), rng(config.seed), noiseState(config.seed * 2654435761u | 1u),
+      ct(config.bufferMmolL / 1000.0), ka(pow(10.0, -config.bufferPKa)), cb(0.0),
+      hydrogen(pow(10.0, -config.initialPH)), ph(config.initialPH), unmixedMmol(0.0),
+      tds(config.initialTdsPpm), light(0.0f), cloud(1.0f), cloudNext(1.0f),
+      reservoirMinusMl(config.reservoirMl), reservoirPlusMl(config.reservoirMl),
+      wasMinusOn(false), wasPlusOn(false), runMinusS(0.0), runPlusS(0.0),
+      phLevel(0.0f), tdsLevel(0.0f), ldrLevel(0.0f), tdsLevelPpm(-1.0f)
+{
+    // Exceso de base que deja el tanque en initialPH
+    cb = ct * ka / (ka + hydrogen) + KW / hydrogen - hydrogen;
+}
+
+PlantSim::~PlantSim()
+{
+    end();
+}
+
+void PlantSim::begin()
+{
+    report = Report();
+    report.tdsStart = tds;
+
+    hal::setAnalogSource(pins.ph, [this](uint64_t us) { return toAdc(phLevel, us, true); });
+    hal::setAnalogSource(pins.tds, [this](uint64_t us) { return toAdc(tdsLevel, us, true); });
+    hal::setAnalogSource(pins.ldr, [this](uint64_t us) { return toAdc(ldrLevel, us, false); });
+
+    esp_timer_create_args_t args = {};
+    args.callback = &PlantSim::onStep;
+    args.arg = this;
+    args.name = "plant_sim";
+    esp_timer_create(&args, &timer);
+
+    step(0.0f); // Niveles y luz válidos antes del primer setup() del firmware
+    esp_timer_start_periodic(timer, config.stepMs * 1000ULL);
+}
+
+void PlantSim::end()
+{
+    if (!timer)
+        return;
+    esp_timer_stop(timer);
+    esp_timer_delete(timer);
+    timer = nullptr;
+    report.tdsEnd = tds;
+}
+
+void PlantSim::addAcidMmol(float mmol)
+{
+    cb -= mmol / (config.tankLiters * 1000.0);
+    solvePH();
+    updateLevels();
+}
+
+// ============================================================================
+// PASO FÍSICO
+// ============================================================================
+
+void PlantSim::onStep(void *arg)
+{
+    PlantSim *sim = static_cast<PlantSim *>(arg);
+    sim->step(sim->config.stepMs / 1000.0f);
+}
+
+void PlantSim::step(float dt)
+{
+    // Luz: medio seno entre amanecer y atardecer, nubes que cambian cada hora
+    float hour = hourOfDay();
+    float day = 0.0f;
+    if (hour > config.sunriseHour && hour < config.sunsetHour)
+        day = sinf(PI_F * (hour - config.sunriseHour) / (config.sunsetHour - config.sunriseHour));
+    float hourPhase = fmodf(hour, 1.0f);
+    if (hourPhase < dt / 3600.0f)
+        cloudNext = std::uniform_real_distribution<float>(0.5f, 1.0f)(rng);
+    cloud += (cloudNext - cloud) * (dt / 1200.0f);
+    light = day * cloud;
+
+    // Bombas de dosificación: el relé manda, el depósito limita
+    bool circulating = relayOn(pins.relayCirc);
+    pump(relayOn(pins.relayMinus), wasMinusOn, runMinusS, reservoirMinusMl, report.minus, -1.0f, dt);
+    pump(relayOn(pins.relayPlus), wasPlusOn, runPlusS, reservoirPlusMl, report.plus, +1.0f, dt);
+
+    // Tiempo muerto hasta la zona de mezcla (solo avanza con circulación)
+    // (todas las parcelas tienen el mismo retardo: salen en orden)
+    if (circulating)
+    {
+        for (Parcel &p : inTransit)
+            p.remainS -= dt;
+        while (!inTransit.empty() && inTransit.front().remainS <= 0.0f)
+        {
+            unmixedMmol += inTransit.front().mmol;
+            inTransit.pop_front();
+        }
+        report.circulationS += dt;
+    }
+
+    // Mezcla de primer orden hacia el volumen del tanque
+    double tau = config.mixTauS * (circulating ? 1.0f : config.stagnantFactor);
+    double mixed = unmixedMmol * (1.0 - exp(-dt / tau));
+    unmixedMmol -= mixed;
+
+    // Deriva de alcalinidad por absorción de nitrato
+    cb += mixed / (config.tankLiters * 1000.0) +
+          config.alkalinityRiseMmolLDay / 1000.0 * light * dt / SECONDS_PER_DAY;
+    solvePH();
+
+    tds += (config.evaporationPpmDay - config.uptakePpmDay * light) * dt / SECONDS_PER_DAY;
+    updateLevels();
+
+    // Sensores de nivel (HIGH = nivel OK, como en main.cpp)
+    bool minusOK = reservoirMinusMl > config.reservoirLowMl;
+    bool plusOK = reservoirPlusMl > config.reservoirLowMl;
+    hal::setDigital(pins.levelMinus, minusOK ? HIGH : LOW);
+    hal::setDigital(pins.levelPlus, plusOK ? HIGH : LOW);
+
+    // Estadísticas
+    report.simulatedS += dt;
+    if (ph >= config.bandMin && ph <= config.bandMax)
+        report.inBandS += dt;
+    if (ph >= config.targetMin && ph <= config.targetMax)
+        report.inTargetS += dt;
+    if (dt > 0.0f)
+    {
+        report.phMin = std::min(report.phMin, ph);
+        report.phMax = std::max(report.phMax, ph);
+    }
+    report.phSum += ph * dt;
+    if (!minusOK)
+        report.minus.lowLevelS += dt;
+    if (!plusOK)
+        report.plus.lowLevelS += dt;
+    if (light > 0.5f)
+        report.sunnyS += dt;
+    report.tdsEnd = tds;
+}
+
+void PlantSim::pump(bool on, bool &wasOn, double &runS, float &reservoirMl, DoseStats &stats, float sign, float dt)
+{
+    if (on && !wasOn)
+    {
+        stats.sessions++;
+        runS = 0.0;
+    }
+    if (!on && wasOn)
+        stats.longestS = std::max(stats.longestS, runS);
+    wasOn = on;
+    if (!on)
+        return;
+
+    runS += dt;
+    stats.onS += dt;
+    stats.longestS = std::max(stats.longestS, runS);
+
+    float ml = std::min(config.pumpMlPerS * dt, reservoirMl);
+    if (ml <= 0.0f)
+    {
+        stats.dryS += dt;
+        return;
+    }
+    reservoirMl -= ml;
+    stats.ml += ml;
+    inTransit.push_back({sign * ml * config.reagentMolL, config.deadTimeS});
+}
+
+void PlantSim::solvePH()
+{
+    // Balance de cargas: H + Cb = C_T·Ka/(Ka+H) + Kw/H, creciente en H.
+    // Newton desde el H anterior; el pH cambia poco entre pasos.
+    double h = hydrogen;
+    for (int i = 0; i < 20; i++)
+    {
+        double a = ka + h;
+        double f = h + cb - ct * ka / a - KW / h;
+        double df = 1.0 + ct * ka / (a * a) + KW / (h * h);
+        double next = h - f / df;
+        if (next <= 0.0)
+            next = h * 0.1;
+        if (fabs(next - h) < h * 1e-6)
+        {
+            h = next;
+            break;
+        }
+        h = next;
+    }
+    hydrogen = h;
+    ph = float(-log10(hydrogen));
+}
+
+bool PlantSim::relayOn(uint8_t pin) const
+{
+    // Relés activos en LOW (PumpController::Config por defecto); -1 = sin inicializar
+    return hal::outputLevel(pin) == LOW;
+}
+
+float PlantSim::hourOfDay() const
+{
+    double hours = config.startHourOfDay + hal::nowUs() / 3.6e9;
+    return float(fmod(hours, 24.0));
+}
+
+// ============================================================================
+// ADC SIMULADO
+// ============================================================================
+
+float PlantSim::gaussian()
+{
+    // Suma de 4 uniformes: casi normal, media 0 y σ 1, mucho más barata que
+    // std::normal_distribution en 300 M lecturas por semana simulada
+    float sum = 0.0f;
+    for (int i = 0; i < 4; i++)
+    {
+        noiseState ^= noiseState << 13;
+        noiseState ^= noiseState >> 17;
+        noiseState ^= noiseState << 5;
+        sum += (noiseState >> 8) * (1.0f / 16777216.0f);
+    }
+    return (sum - 2.0f) * 1.7320508f;
+}
+
+uint16_t PlantSim::toAdc(float counts, uint64_t us, bool hum)
+{
+    counts += config.noiseCounts * gaussian();
+    if (hum)
+        counts += config.humCounts * sinf(2.0f * PI_F * config.mainsHz * float(us % 1000000ULL) * 1e-6f);
+    if (counts < 0.0f)
+        return 0;
+    if (counts > 4095.0f)
+        return 4095;
+    return uint16_t(counts + 0.5f);
+}
+
+void PlantSim::updateLevels()
+{
+    float volts = config.phVAt7 - (ph - 7.0f) * config.phVPerPh;
+    phLevel = volts / config.phDividerK * 4095.0f / 3.3f;
+    if (fabsf(tds - tdsLevelPpm) > 0.01f)
+    {
+        tdsLevel = voltsFromTds(tds) * 4096.0f / 3.3f;
+        tdsLevelPpm = tds;
+    }
+    ldrLevel = config.ldrDark + (config.ldrNoon - config.ldrDark) * light;
+}
+
+// ============================================================================
+// REPORTE
+// ============================================================================
+
+void PlantSim::printReport() const
+{
+    const Report &r = report;
+    printf("\n=== PlantSim: %.1f días simulados ===\n", r.simulatedS / SECONDS_PER_DAY);
+    printf("pH: media %.2f, mín %.2f, máx %.2f\n", r.meanPH(), r.phMin, r.phMax);
+    printf("En banda [%.1f, %.1f]: %.2f %%   En objetivo [%.1f, %.1f]: %.2f %%\n",
+           config.bandMin, config.bandMax, r.inBandPct(), config.targetMin, config.targetMax, r.inTargetPct());
+    const DoseStats *stats[2] = {&r.minus, &r.plus};
+    const char *names[2] = {"pH-", "pH+"};
+    for (int i = 0; i < 2; i++)
+    {
+        const DoseStats &d = *stats[i];
+        printf("%s: %.1f mL en %lu sesiones (media %.1f s, máx %.1f s), en seco %.1f s, nivel BAJO %.1f h\n",
+               names[i], d.ml, (unsigned long)d.sessions, d.sessions ? d.onS / d.sessions : 0.0,
+               d.longestS, d.dryS, d.lowLevelS / 3600.0f);
+    }
+    printf("Depósitos: pH- %.0f mL, pH+ %.0f mL\n", reservoirMinusMl, reservoirPlusMl);
+    printf("TDS: %.0f -> %.0f ppm   Sol: %.1f h   Circulación: %.1f %%\n",
+           r.tdsStart, r.tdsEnd, r.sunnyS / 3600.0f,
+           r.simulatedS > 0 ? 100.0f * r.circulationS / r.simulatedS : 0.0f);
+}
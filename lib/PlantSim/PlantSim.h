@@ -0,0 +1,184 @@
+#ifndef PLANT_SIM_H
+#define PLANT_SIM_H
+
+#include <ArduinoHAL.h>
+#include <esp_timer.h>
+#include <deque>
+#include <random>
+
+/**
+ * @brief Tanque hidropónico simulado para el entorno [env:native]
+ *
+ * Modela la planta que ve el firmware a través de la HAL: lee los relés de
+ * PumpController y escribe los pines de pH, TDS, LDR y nivel. Todo avanza con
+ * el reloj virtual (un esp_timer propio cada stepMs), así que una semana de
+ * operación corre en segundos sin tocar el código de control.
+ *
+ * - pH: balance de cargas de un tampón monoprótico (C_T, pKa) con exceso de
+ *   base fuerte Cb; el ácido o la base dosificados cambian Cb
+ * - Mezcla: cada dosis recorre un tiempo muerto que solo avanza con la
+ *   circulación encendida y luego se mezcla con constante mixTauS (mucho
+ *   más lenta sin circulación)
+ * - Deriva: la absorción de nitrato sube la alcalinidad en proporción a la
+ *   luz; el TDS baja con la absorción y sube con la evaporación
+ * - LDR: curva diurna (seno entre amanecer y atardecer) con nubes aleatorias
+ * - Depósitos de pH+/pH-: se vacían con el tiempo de bomba y ponen el sensor
+ *   de nivel en BAJO por debajo de reservoirLowMl
+ *
+ *   PlantSim sim;
+ *   sim.begin();            // Después de hal::reset()
+ *   ... bucle del firmware con delay() ...
+ *   sim.printReport();
+ */
+class PlantSim
+{
+public:
+    struct Pins
+    {
+        uint8_t ph, tds, ldr;
+        uint8_t levelMinus, levelPlus;
+        uint8_t relayCirc, relayMinus, relayPlus;
+    };
+
+    struct Config
+    {
+        // Tanque y química
+        float tankLiters = 50.0f;
+        float bufferMmolL = 2.0f;          // C_T del tampón
+        float bufferPKa = 6.35f;           // Carbonato/bicarbonato
+        float initialPH = 6.5f;
+        float alkalinityRiseMmolLDay = 1.0f; // Absorción de nitrato a plena luz
+
+        // Dosificación
+        float reagentMolL = 1.0f;      // Ácido (pH-) y base (pH+) equivalentes
+        float pumpMlPerS = 1.0f;       // Bomba peristáltica
+        float reservoirMl = 1000.0f;   // Volumen inicial de cada depósito
+        float reservoirLowMl = 100.0f; // Umbral del sensor de nivel
+        float deadTimeS = 20.0f;       // Recorrido hasta la zona de mezcla
+        float mixTauS = 60.0f;         // Mezcla con circulación
+        float stagnantFactor = 30.0f;  // Mezcla sin circulación: tau × factor
+
+        // TDS
+        float initialTdsPpm = 800.0f;
+        float uptakePpmDay = 60.0f;      // A plena luz
+        float evaporationPpmDay = 25.0f; // Constante
+
+        // Luz
+        float sunriseHour = 6.0f;
+        float sunsetHour = 18.0f;
+        uint16_t ldrDark = 150;
+        uint16_t ldrNoon = 3700;
+        uint32_t startHourOfDay = 0; // Hora del día al arrancar
+
+        // Módulos y ruido del ADC
+        float phVAt7 = 2.50f;       // Debe coincidir con la calibración del firmware
+        float phVPerPh = 0.18f;
+        float phDividerK = 1.0f;
+        float noiseCounts = 3.0f;   // σ blanco
+        float humCounts = 20.0f;    // Amplitud del zumbido de red
+        float mainsHz = 60.0f;
+
+        // Estadísticas
+        float bandMin = 5.5f; // Mismos límites que PumpController::Config
+        float bandMax = 7.5f;
+        float targetMin = 5.8f;
+        float targetMax = 6.8f;
+
+        uint32_t stepMs = 100;
+        uint32_t seed = 1;
+    };
+
+    struct DoseStats
+    {
+        double ml = 0.0;          // Entregado al tanque
+        double dryS = 0.0;        // Bomba encendida con el depósito vacío
+        uint32_t sessions = 0;    // Encendidos del relé
+        double onS = 0.0;
+        double longestS = 0.0;
+        double lowLevelS = 0.0;   // Tiempo con el sensor de nivel en BAJO
+    };
+
+    // Acumuladores en double: una semana a 100 ms son 6 M pasos
+    struct Report
+    {
+        double simulatedS = 0.0;
+        double inBandS = 0.0;
+        double inTargetS = 0.0;
+        float phMin = 14.0f;
+        float phMax = 0.0f;
+        double phSum = 0.0; // ∫pH dt, para la media
+        double circulationS = 0.0;
+        DoseStats minus, plus;
+        float tdsStart = 0.0f, tdsEnd = 0.0f;
+        double sunnyS = 0.0;
+
+        float inBandPct() const { return simulatedS > 0 ? 100.0 * inBandS / simulatedS : 0.0f; }
+        float inTargetPct() const { return simulatedS > 0 ? 100.0 * inTargetS / simulatedS : 0.0f; }
+        float meanPH() const { return simulatedS > 0 ? phSum / simulatedS : 0.0f; }
+    };
+
+    explicit PlantSim(const Pins &pins);
+    PlantSim(const Pins &pins, const Config &config);
+    ~PlantSim();
+
+    // Instala las fuentes del ADC y arranca el paso físico
+    void begin();
+    void end();
+
+    // Estado verdadero del tanque
+    float getPH() const { return ph; }
+    float getTDS() const { return tds; }
+    float getLight() const { return light; } // 0..1
+    float getReservoirMl(bool minus) const { return minus ? reservoirMinusMl : reservoirPlusMl; }
+
+    // Perturbaciones para escenarios
+    void addAcidMmol(float mmol);
+    void setTDS(float ppm) { tds = ppm; }
+
+    const Config &getConfig() const { return config; }
+    const Report &getReport() const { return report; }
+    void printReport() const;
+
+private:
+    struct Parcel
+    {
+        float mmol;     // + base, - ácido
+        float remainS;  // Tiempo muerto restante
+    };
+
+    Pins pins;
+    Config config;
+    Report report;
+    esp_timer_handle_t timer;
+    std::mt19937 rng;     // Nubes
+    uint32_t noiseState;  // xorshift32 para el ruido del ADC (una llamada por analogRead)
+
+    // Química (mol/L; double porque la deriva por paso es ~1e-10)
+    double ct, ka, cb;
+    double hydrogen;
+    float ph;
+    std::deque<Parcel> inTransit;
+    double unmixedMmol;
+
+    float tds;
+    float light;
+    float cloud, cloudNext; // Nubosidad actual y objetivo (por hora)
+    float reservoirMinusMl, reservoirPlusMl;
+    bool wasMinusOn, wasPlusOn;
+    double runMinusS, runPlusS;
+    float phLevel, tdsLevel, ldrLevel; // Cuentas ADC sin ruido, recalculadas en cada paso
+    float tdsLevelPpm;                 // TDS con el que se calculó tdsLevel
+
+    static void onStep(void *arg);
+    void step(float dt);
+    void pump(bool on, bool &wasOn, double &runS, float &reservoirMl, DoseStats &stats, float sign, float dt);
+    void solvePH();
+    bool relayOn(uint8_t pin) const;
+    float hourOfDay() const;
+
+    void updateLevels();
+    float gaussian();
+    uint16_t toAdc(float counts, uint64_t us, bool hum);
+};
+
+#endif // PLANT_SIM_H
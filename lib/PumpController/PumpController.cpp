@@ -1,4 +1,5 @@
 #include "PumpController.h"
+#include "Log.h"
 
 PumpController::PumpController(uint8_t relayCirc, uint8_t relayPhMinus, uint8_t relayPhPlus)
     : relayCircPin(relayCirc), relayMinusPin(relayPhMinus), relayPlusPin(relayPhPlus),
@@ -25,10 +26,16 @@ void PumpController::begin(const Config &config)
     relayWrite(relayMinusPin, false);
     relayWrite(relayPlusPin, false);
 
-    Serial.println("PumpController: Inicializado - Circulación ON, dosificación OFF");
+    LOG_I(CTRL, "PumpController: Inicializado - Circulación ON, dosificación OFF");
 }
 
 void PumpController::update(float ph, bool levelMinusOK, bool levelPlusOK)
+{
+    // Sin tendencia: pH quieto, se decide solo con el valor actual
+    update(ph, 0.0f, true, levelMinusOK, levelPlusOK);
+}
+
+void PumpController::update(float ph, float phRate, bool settled, bool levelMinusOK, bool levelPlusOK)
 {
     // Si está en modo emergencia, no ejecutar control automático
     if (emergencyMode)
@@ -38,12 +45,15 @@ void PumpController::update(float ph, bool levelMinusOK, bool levelPlusOK)
 
     unsigned long now = millis();
 
+    // pH esperado cuando termine de mezclarse lo ya dosificado
+    float phAhead = settled ? ph : ph + phRate * (config.trendHorizonMs / 1000.0f);
+
     switch (doseState)
     {
     case IDLE:
     {
-        // ¿Necesita subir pH?
-        if (ph < config.phMin && levelPlusOK)
+        // ¿Necesita subir pH? (y no se está corrigiendo solo)
+        if (ph < config.phMin && phAhead < config.phMin && levelPlusOK)
         {
             doseType = DOSE_PLUS;
             relayWrite(relayPlusPin, true);
@@ -51,11 +61,11 @@ void PumpController::update(float ph, bool levelMinusOK, bool levelPlusOK)
             doseStamp = now;
             sessionStart = now;
             doseState = DOSING;
-            Serial.printf("PumpController: pH+ ON - pH=%.2f < MIN=%.2f, Nivel=%s\n",
-                          ph, config.phMin, levelPlusOK ? "OK" : "BAJO");
+            LOG_I(CTRL, "PumpController: pH+ ON - pH=%.2f < MIN=%.2f, Nivel=%s",
+                        ph, config.phMin, levelPlusOK ? "OK" : "BAJO");
         }
         // ¿Necesita bajar pH?
-        else if (ph > config.phMax && levelMinusOK)
+        else if (ph > config.phMax && phAhead > config.phMax && levelMinusOK)
         {
             doseType = DOSE_MINUS;
             relayWrite(relayMinusPin, true);
@@ -63,21 +73,21 @@ void PumpController::update(float ph, bool levelMinusOK, bool levelPlusOK)
             doseStamp = now;
             sessionStart = now;
             doseState = DOSING;
-            Serial.printf("PumpController: pH- ON - pH=%.2f > MAX=%.2f, Nivel=%s\n",
-                          ph, config.phMax, levelMinusOK ? "OK" : "BAJO");
+            LOG_I(CTRL, "PumpController: pH- ON - pH=%.2f > MAX=%.2f, Nivel=%s",
+                        ph, config.phMax, levelMinusOK ? "OK" : "BAJO");
         }
         else
         {
             // Alertas de nivel bajo
             if (ph < config.phMin && !levelPlusOK)
             {
-                Serial.printf("PumpController: ALERTA - pH+ bloqueado. pH=%.2f < MIN=%.2f pero Nivel=BAJO\n",
-                              ph, config.phMin);
+                LOG_W(CTRL, "PumpController: ALERTA - pH+ bloqueado. pH=%.2f < MIN=%.2f pero Nivel=BAJO",
+                            ph, config.phMin);
             }
             if (ph > config.phMax && !levelMinusOK)
             {
-                Serial.printf("PumpController: ALERTA - pH- bloqueado. pH=%.2f > MAX=%.2f pero Nivel=BAJO\n",
-                              ph, config.phMax);
+                LOG_W(CTRL, "PumpController: ALERTA - pH- bloqueado. pH=%.2f > MAX=%.2f pero Nivel=BAJO",
+                            ph, config.phMax);
             }
         }
         break;
@@ -89,7 +99,17 @@ void PumpController::update(float ph, bool levelMinusOK, bool levelPlusOK)
         if (now - sessionStart >= config.maxSessionMs)
         {
             stopAllDosing();
-            Serial.println("PumpController: ALERTA - Tiempo máximo alcanzado. Apagado por seguridad.");
+            LOG_W(CTRL, "PumpController: ALERTA - Tiempo máximo alcanzado. Apagado por seguridad.");
+            break;
+        }
+
+        // La tendencia ya llega al objetivo: cortar el pulso antes de tiempo
+        if (!settled && now - doseStamp < config.doseOnMs &&
+            ((doseType == DOSE_PLUS && phAhead >= config.phLowHyst) ||
+             (doseType == DOSE_MINUS && phAhead <= config.phHighHyst)))
+        {
+            stopAllDosing();
+            LOG_I(CTRL, "PumpController: Tendencia %.4f pH/s alcanza el objetivo → OFF anticipado", phRate);
             break;
         }
 
@@ -100,19 +120,19 @@ void PumpController::update(float ph, bool levelMinusOK, bool levelPlusOK)
 
             if (doseType == DOSE_PLUS)
             {
-                objetivoAlcanzado = (ph >= config.phLowHyst);
+                objetivoAlcanzado = (phAhead >= config.phLowHyst);
                 if (!levelPlusOK)
                 {
-                    Serial.println("PumpController: Depósito pH+ BAJO durante dosificación");
+                    LOG_W(CTRL, "PumpController: Depósito pH+ BAJO durante dosificación");
                     objetivoAlcanzado = true;
                 }
             }
             else if (doseType == DOSE_MINUS)
             {
-                objetivoAlcanzado = (ph <= config.phHighHyst);
+                objetivoAlcanzado = (phAhead <= config.phHighHyst);
                 if (!levelMinusOK)
                 {
-                    Serial.println("PumpController: Depósito pH- BAJO durante dosificación");
+                    LOG_W(CTRL, "PumpController: Depósito pH- BAJO durante dosificación");
                     objetivoAlcanzado = true;
                 }
             }
@@ -120,14 +140,14 @@ void PumpController::update(float ph, bool levelMinusOK, bool levelPlusOK)
             if (objetivoAlcanzado)
             {
                 stopAllDosing();
-                Serial.println("PumpController: Objetivo alcanzado → OFF");
+                LOG_I(CTRL, "PumpController: Objetivo alcanzado → OFF");
             }
             else
             {
                 // Continuar con otro pulso
                 doseStamp = now + config.recheckDelayMs;
-                Serial.printf("PumpController: Continúa %s otros 10s\n",
-                              (doseType == DOSE_PLUS) ? "pH+" : "pH-");
+                LOG_I(CTRL, "PumpController: Continúa %s otros 10s",
+                            (doseType == DOSE_PLUS) ? "pH+" : "pH-");
             }
         }
         break;
@@ -145,7 +165,7 @@ void PumpController::forcePumpMinus(bool on)
         doseStamp = millis();
         sessionStart = doseStamp;
         relayWrite(relayPlusPin, false);
-        Serial.println("PumpController: MANUAL - pH- ON");
+        LOG_I(CTRL, "PumpController: MANUAL - pH- ON");
     }
     else
     {
@@ -154,7 +174,7 @@ void PumpController::forcePumpMinus(bool on)
             doseType = NONE;
             doseState = IDLE;
         }
-        Serial.println("PumpController: MANUAL - pH- OFF");
+        LOG_I(CTRL, "PumpController: MANUAL - pH- OFF");
     }
 }
 
@@ -168,7 +188,7 @@ void PumpController::forcePumpPlus(bool on)
         doseStamp = millis();
         sessionStart = doseStamp;
         relayWrite(relayMinusPin, false);
-        Serial.println("PumpController: MANUAL - pH+ ON");
+        LOG_I(CTRL, "PumpController: MANUAL - pH+ ON");
     }
     else
     {
@@ -177,14 +197,14 @@ void PumpController::forcePumpPlus(bool on)
             doseType = NONE;
             doseState = IDLE;
         }
-        Serial.println("PumpController: MANUAL - pH+ OFF");
+        LOG_I(CTRL, "PumpController: MANUAL - pH+ OFF");
     }
 }
 
 void PumpController::forceCirculation(bool on)
 {
     relayWrite(relayCircPin, on);
-    Serial.printf("PumpController: Circulación %s\n", on ? "ON" : "OFF");
+    LOG_I(CTRL, "PumpController: Circulación %s", on ? "ON" : "OFF");
 }
 
 bool PumpController::isPumpMinusOn() const
@@ -274,7 +294,7 @@ void PumpController::emergencyStop()
     relayWrite(relayPlusPin, false);
     doseType = NONE;
     doseState = IDLE;
-    Serial.println("🚨🚨🚨 MODO EMERGENCIA ACTIVADO - TODAS LAS BOMBAS DETENIDAS 🚨🚨🚨");
+    LOG_W(CTRL, "🚨🚨🚨 MODO EMERGENCIA ACTIVADO - TODAS LAS BOMBAS DETENIDAS 🚨🚨🚨");
 }
 
 void PumpController::emergencyResume()
@@ -287,5 +307,5 @@ void PumpController::emergencyResume()
     relayWrite(relayCircPin, true);
     doseType = NONE;
     doseState = IDLE;
-    Serial.println("✅ MODO EMERGENCIA DESACTIVADO - Sistema restaurado");
+    LOG_W(CTRL, "✅ MODO EMERGENCIA DESACTIVADO - Sistema restaurado");
 }
\ No newline at end of file
@@ -27,6 +27,7 @@ public:
         unsigned long doseOnMs = 5000;       // 5s por pulso
         unsigned long maxSessionMs = 600000; // 10 min máximo
         unsigned long recheckDelayMs = 0;    // Sin delay entre pulsos
+        unsigned long trendHorizonMs = 30000; // Proyección de la tendencia de pH (mezcla del tanque)
         bool relayActiveLow = true;          // true: LOW=ON, false: HIGH=ON
     };
 
@@ -39,6 +40,9 @@ public:
 
     // Control automático
     void update(float ph, bool levelMinusOK, bool levelPlusOK);
+    // Con tendencia del filtro de pH: corta pulsos y sesiones cuando la
+    // respuesta ya en curso alcanza el objetivo (menos sobreimpulso)
+    void update(float ph, float phRate, bool settled, bool levelMinusOK, bool levelPlusOK);
 
     // Control manual
     void forcePumpMinus(bool on);
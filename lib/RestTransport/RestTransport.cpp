@@ -0,0 +1,491 @@
+#include "RestTransport.h"
+
+// ============================================================================
+// SSE
+// ============================================================================
+
+SseParser::SseParser() : droppedEvents(0)
+{
+    reset();
+}
+
+void SseParser::reset()
+{
+    lineLen = 0;
+    dataLen = 0;
+    hasData = false;
+    truncated = false;
+    delivered = false;
+    eventName[0] = '\0';
+    dataBuf[0] = '\0';
+}
+
+bool SseParser::feed(char c)
+{
+    if (delivered)
+        reset(); // El evento entregado vale hasta este feed()
+    if (c == '\r')
+        return false; // \r\n y \n valen igual
+    if (c != '\n')
+    {
+        if (lineLen + 1 < sizeof(line))
+            line[lineLen++] = c;
+        else
+            truncated = true;
+        return false;
+    }
+
+    if (lineLen)
+    {
+        line[lineLen] = '\0';
+        processLine();
+        lineLen = 0;
+        return false;
+    }
+
+    // Línea en blanco: fin del evento
+    if (truncated)
+        droppedEvents++;
+    if (truncated || (!hasData && !eventName[0]))
+    {
+        reset();
+        return false;
+    }
+    if (!eventName[0])
+        strcpy(eventName, "message");
+    delivered = true;
+    return true;
+}
+
+void SseParser::processLine()
+{
+    if (line[0] == ':')
+        return; // Comentario
+
+    char *value = strchr(line, ':');
+    if (value)
+    {
+        *value++ = '\0';
+        if (*value == ' ')
+            value++;
+    }
+    else
+    {
+        value = line + lineLen; // Campo sin valor
+    }
+
+    if (strcmp(line, "event") == 0)
+    {
+        strncpy(eventName, value, sizeof(eventName) - 1);
+        eventName[sizeof(eventName) - 1] = '\0';
+    }
+    else if (strcmp(line, "data") == 0)
+    {
+        size_t n = strlen(value);
+        if (dataLen + n + (hasData ? 1 : 0) + 1 > sizeof(dataBuf))
+        {
+            truncated = true;
+            return;
+        }
+        if (hasData)
+            dataBuf[dataLen++] = '\n';
+        memcpy(dataBuf + dataLen, value, n);
+        dataLen += n;
+        dataBuf[dataLen] = '\0';
+        hasData = true;
+    }
+    // id y retry no se usan
+}
+
+// ============================================================================
+// HTTP
+// ============================================================================
+
+HttpConnection::HttpConnection(const char *host, uint16_t port, unsigned long timeoutMs)
+    : host(host), port(port), timeoutMs(timeoutMs), timedOut(false), rxPos(0), rxLen(0)
+{
+}
+
+bool HttpConnection::open()
+{
+    close();
+    if (!client.connect(host, port, int32_t(timeoutMs)))
+        return false;
+    client.setNoDelay(true);
+    return true;
+}
+
+void HttpConnection::close()
+{
+    client.stop();
+    rxPos = rxLen = 0;
+}
+
+bool HttpConnection::send(const char *text, size_t len)
+{
+    return client.write(reinterpret_cast<const uint8_t *>(text), len) == len;
+}
+
+int HttpConnection::pollByte()
+{
+    if (rxPos == rxLen)
+    {
+        int n = client.available();
+        if (n <= 0)
+            return -1;
+        int got = client.read(rx, n < (int)sizeof(rx) ? n : sizeof(rx));
+        if (got <= 0)
+            return -1;
+        rxPos = 0;
+        rxLen = got;
+    }
+    return rx[rxPos++];
+}
+
+int HttpConnection::readByte(unsigned long startMs)
+{
+    for (;;)
+    {
+        int c = pollByte();
+        if (c >= 0)
+            return c;
+        if (!client.connected())
+            return -1;
+        if (millis() - startMs > timeoutMs)
+        {
+            timedOut = true;
+            return -1;
+        }
+        delay(1);
+    }
+}
+
+bool HttpConnection::readLine(char *out, size_t cap, unsigned long startMs)
+{
+    size_t n = 0;
+    for (;;)
+    {
+        int c = readByte(startMs);
+        if (c < 0)
+            return false;
+        if (c == '\n')
+            break;
+        if (c != '\r' && n + 1 < cap)
+            out[n++] = char(c);
+    }
+    out[n] = '\0';
+    return true;
+}
+
+int HttpConnection::readHead(unsigned long startMs, long &contentLength, bool &keepAlive)
+{
+    char line[160];
+    timedOut = false;
+    contentLength = -1;
+    keepAlive = true;
+    if (!readLine(line, sizeof(line), startMs))
+        return timedOut ? -2 : -1;
+    int code = 0;
+    if (strncmp(line, "HTTP/1.", 7) != 0 || sscanf(line + 8, " %d", &code) != 1)
+        return -3;
+
+    while (readLine(line, sizeof(line), startMs))
+    {
+        if (!line[0])
+            return code;
+        if (strncasecmp(line, "Content-Length:", 15) == 0)
+            contentLength = atol(line + 15);
+        else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line + 11, "close"))
+            keepAlive = false;
+    }
+    return timedOut ? -2 : -1;
+}
+
+// ============================================================================
+// REST SINK
+// ============================================================================
+
+RestSink::RestSink(const char *host, uint16_t port, unsigned long timeoutMs, unsigned long retryMs)
+    : http(host, port, timeoutMs), retryMs(retryMs), lastFailMs(0), failedConnect(false), everConnected(false),
+      status(0)
+{
+    error[0] = '\0';
+}
+
+bool RestSink::ready()
+{
+    // Tras un connect fallido se espera retryMs antes de volver a intentar
+    return !failedConnect || millis() - lastFailMs >= retryMs;
+}
+
+bool RestSink::update(const char *path, const char *json)
+{
+    return request("PATCH", path, json);
+}
+
+bool RestSink::set(const char *path, const char *json)
+{
+    return request("PUT", path, json);
+}
+
+bool RestSink::request(const char *method, const char *path, const char *json)
+{
+    unsigned long t0 = millis();
+    stats.requests++;
+    bool retry = false;
+    bool ok = attempt(method, path, json, retry);
+    if (!ok && retry)
+    {
+        ok = attempt(method, path, json, retry); // Conexión ociosa cerrada por el servidor
+    }
+    stats.lastLatencyMs = millis() - t0;
+    if (stats.lastLatencyMs > stats.maxLatencyMs)
+        stats.maxLatencyMs = stats.lastLatencyMs;
+    if (!ok)
+        stats.failures++;
+    return ok;
+}
+
+bool RestSink::attempt(const char *method, const char *path, const char *json, bool &retry)
+{
+    retry = false;
+    bool reused = http.isOpen();
+    if (!reused)
+    {
+        if (!http.open())
+        {
+            failedConnect = true;
+            lastFailMs = millis();
+            status = -1;
+            snprintf(error, sizeof(error), "sin conexion con %s:%u", http.host, http.port);
+            return false;
+        }
+        if (everConnected)
+            stats.reconnects++;
+        everConnected = true;
+        failedConnect = false;
+    }
+
+    size_t bodyLen = strlen(json);
+    char head[224];
+    int n = snprintf(head, sizeof(head),
+                     "%s %s.json HTTP/1.1\r\nHost: %s\r\nContent-Type: application/json\r\n"
+                     "Content-Length: %u\r\nConnection: keep-alive\r\n\r\n",
+                     method, path, http.host, (unsigned)bodyLen);
+    if (n <= 0 || n >= (int)sizeof(head))
+    {
+        status = -3;
+        snprintf(error, sizeof(error), "ruta demasiado larga");
+        return false;
+    }
+
+    unsigned long start = millis();
+    long contentLength;
+    bool keepAlive;
+    int code = -1;
+    if (http.send(head, n) && http.send(json, bodyLen))
+        code = http.readHead(start, contentLength, keepAlive);
+    if (code == -1 && reused)
+    {
+        // Cerrada sin respuesta en una conexión reutilizada: se reintenta una vez
+        http.close();
+        retry = true;
+        status = -1;
+        snprintf(error, sizeof(error), "conexion cerrada por el servidor");
+        return false;
+    }
+    if (code < 0)
+    {
+        http.close();
+        status = code;
+        if (code == -2)
+            stats.timeouts++;
+        if (code == -2)
+            snprintf(error, sizeof(error), "timeout (%lu ms)", http.timeoutMs);
+        else
+            snprintf(error, sizeof(error), "respuesta invalida o conexion cerrada");
+        return false;
+    }
+
+    // Cuerpo: se guarda el comienzo para el mensaje de error
+    char body[64];
+    size_t kept = 0;
+    for (long i = 0; contentLength < 0 || i < contentLength; i++)
+    {
+        int c = http.readByte(start);
+        if (c < 0)
+        {
+            if (contentLength >= 0)
+                keepAlive = false; // Cuerpo incompleto: la conexión no se puede reutilizar
+            break;
+        }
+        if (kept + 1 < sizeof(body))
+            body[kept++] = char(c);
+    }
+    body[kept] = '\0';
+    if (!keepAlive || contentLength < 0)
+        http.close();
+
+    status = code;
+    if (code < 200 || code >= 300)
+    {
+        snprintf(error, sizeof(error), "HTTP %d: %s", code, body);
+        return false;
+    }
+    error[0] = '\0';
+    return true;
+}
+
+// ============================================================================
+// REST COMMAND SOURCE
+// ============================================================================
+
+RestCommandSource::RestCommandSource(const char *host, uint16_t port, unsigned long timeoutMs,
+                                     unsigned long keepAliveTimeoutMs)
+    : http(host, port, timeoutMs), keepAliveTimeoutMs(keepAliveTimeoutMs), lastRxMs(0), open(false), resume(false)
+{
+    path[0] = '\0';
+    error[0] = '\0';
+}
+
+bool RestCommandSource::begin(const char *streamPath)
+{
+    end();
+    if (streamPath != path)
+    {
+        strncpy(path, streamPath, sizeof(path) - 1);
+        path[sizeof(path) - 1] = '\0';
+    }
+    if (!http.open())
+    {
+        snprintf(error, sizeof(error), "sin conexion con %s:%u", http.host, http.port);
+        return false;
+    }
+
+    char head[192];
+    int n = snprintf(head, sizeof(head),
+                     "GET %s.json HTTP/1.1\r\nHost: %s\r\nAccept: text/event-stream\r\nConnection: keep-alive\r\n\r\n",
+                     path, http.host);
+    long contentLength;
+    bool keepAlive;
+    int code = http.send(head, n) ? http.readHead(millis(), contentLength, keepAlive) : -1;
+    if (code != 200)
+    {
+        http.close();
+        if (code == -2)
+            snprintf(error, sizeof(error), "timeout abriendo el stream");
+        else
+            snprintf(error, sizeof(error), "stream rechazado (HTTP %d)", code);
+        return false;
+    }
+    parser.reset();
+    lastRxMs = millis();
+    open = true;
+    error[0] = '\0';
+    return true;
+}
+
+CommandSource::Result RestCommandSource::read(Message &message)
+{
+    if (resume)
+    {
+        resume = false;
+        if (!begin(path))
+            return BROKEN;
+    }
+    if (!open)
+        return BROKEN;
+
+    // Solo lo que ya llegó: nunca espera al servidor
+    int c;
+    while ((c = http.pollByte()) >= 0)
+    {
+        lastRxMs = millis();
+        if (!parser.feed(char(c)))
+            continue;
+
+        const char *event = parser.event();
+        if (strcmp(event, "keep-alive") == 0)
+            continue;
+        if (strcmp(event, "cancel") == 0 || strcmp(event, "auth_revoked") == 0)
+        {
+            snprintf(error, sizeof(error), "stream cerrado por el servidor (%s)", event);
+            end();
+            return BROKEN;
+        }
+        if ((strcmp(event, "put") == 0 || strcmp(event, "patch") == 0) && splitEvent(parser.data(), message))
+            return DATA;
+    }
+
+    if (!http.isOpen())
+    {
+        snprintf(error, sizeof(error), "conexion cerrada");
+        end();
+        return BROKEN;
+    }
+    if (millis() - lastRxMs > keepAliveTimeoutMs)
+    {
+        snprintf(error, sizeof(error), "sin keep-alive en %lu ms", keepAliveTimeoutMs);
+        http.close();
+        open = false;
+        resume = true;
+        return TIMEOUT;
+    }
+    return NONE;
+}
+
+void RestCommandSource::end()
+{
+    http.close();
+    open = false;
+    resume = false;
+}
+
+bool RestCommandSource::splitEvent(char *data, Message &message)
+{
+    // Sin biblioteca JSON: RTDB siempre manda {"path":"...","data":...}
+    char *p = strstr(data, "\"path\"");
+    char *d = strstr(data, "\"data\"");
+    if (!p || !d)
+        return false;
+    p = strchr(p + 6, '"');
+    char *pathEnd = p ? strchr(p + 1, '"') : nullptr;
+    d = strchr(d + 6, ':');
+    if (!pathEnd || !d)
+        return false;
+
+    // El valor va hasta la llave que cierra el objeto externo
+    char *value = d + 1;
+    while (*value == ' ')
+        value++;
+    char *end = strrchr(value, '}');
+    if (!end)
+        return false;
+    while (end > value && end[-1] == ' ')
+        end--;
+    if (pathEnd > value && pathEnd < end)
+        return false; // "path" después de "data": no es el formato de RTDB
+    *pathEnd = '\0';
+    *end = '\0';
+
+    message.path = p + 1;
+    message.payload = value;
+    if (*value == '{' || *value == '[')
+        message.type = "json";
+    else if (strcmp(value, "true") == 0 || strcmp(value, "false") == 0)
+        message.type = "boolean";
+    else if (strcmp(value, "null") == 0)
+        message.type = "null";
+    else if (*value == '"')
+    {
+        message.type = "string";
+        message.payload = value + 1;
+        if (end > value + 1 && end[-1] == '"')
+            end[-1] = '\0';
+    }
+    else if (strpbrk(value, ".eE"))
+        message.type = "float";
+    else
+        message.type = "int";
+    return true;
+}
@@ -0,0 +1,158 @@
+#ifndef REST_TRANSPORT_H
+#define REST_TRANSPORT_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include "TelemetrySink.h"
+
+/**
+ * @brief Lector incremental de text/event-stream (SSE), sin memoria dinámica
+ *
+ * Recibe los bytes de a uno; con la línea en blanco que cierra un evento
+ * feed() devuelve true y event()/data() quedan válidos hasta el siguiente
+ * feed(). Acepta \n o \r\n y varias líneas "data:" (se unen con \n). Un
+ * evento más largo que BUFFER_SIZE se descarta y se cuenta en dropped().
+ */
+class SseParser
+{
+public:
+    static const size_t BUFFER_SIZE = 1024;
+
+    SseParser();
+    void reset();
+    bool feed(char c);
+
+    const char *event() const { return eventName; }
+    char *data() { return dataBuf; }
+    uint32_t dropped() const { return droppedEvents; }
+
+private:
+    char line[BUFFER_SIZE];
+    char eventName[24];
+    char dataBuf[BUFFER_SIZE];
+    size_t lineLen;
+    size_t dataLen;
+    bool hasData;
+    bool truncated;
+    bool delivered;
+    uint32_t droppedEvents;
+
+    void processLine();
+};
+
+/**
+ * @brief Respuesta HTTP/1.1 leída de un WiFiClient con timeout
+ *
+ * Buffer de recepción propio para no leer byte a byte del socket. Todas las
+ * esperas son "available() o delay(1)" hasta vencer el plazo.
+ */
+class HttpConnection
+{
+public:
+    HttpConnection(const char *host, uint16_t port, unsigned long timeoutMs);
+
+    bool open();
+    bool isOpen() { return client.connected(); }
+    void close();
+    bool send(const char *text, size_t len);
+
+    // Línea sin \r\n; false si vence deadlineMs o se cierra la conexión
+    bool readLine(char *out, size_t cap, unsigned long startMs);
+    int readByte(unsigned long startMs); // -1 por timeout o cierre
+    int pollByte();                       // -1 si no hay datos ya recibidos
+
+    // Línea de estado y encabezados; devuelve el código (o < 0)
+    int readHead(unsigned long startMs, long &contentLength, bool &keepAlive);
+
+    const char *host;
+    uint16_t port;
+    unsigned long timeoutMs;
+    bool timedOut;
+
+private:
+    WiFiClient client;
+    uint8_t rx[256];
+    size_t rxPos;
+    size_t rxLen;
+};
+
+/**
+ * @brief TelemetrySink por HTTP plano con rutas al estilo RTDB (/ruta.json)
+ *
+ * PATCH para update() y PUT para set(), sobre una conexión keep-alive que
+ * se reabre sola (una vez, si el servidor cerró la conexión ociosa). Pensado
+ * para tools/rtdb_server en la red local o en el host; sin TLS.
+ *
+ *   RestSink sink("192.168.1.50", 8787);
+ *   sink.update("/hydroponic_data", "{\"sensores/ph\":6.1}");
+ */
+class RestSink : public TelemetrySink
+{
+public:
+    struct Stats
+    {
+        uint32_t requests = 0;
+        uint32_t failures = 0;   // Sin conexión, timeout o HTTP fuera de 2xx
+        uint32_t timeouts = 0;
+        uint32_t reconnects = 0; // Conexiones abiertas después de la primera
+        unsigned long lastLatencyMs = 0;
+        unsigned long maxLatencyMs = 0;
+    };
+
+    RestSink(const char *host, uint16_t port, unsigned long timeoutMs = 5000, unsigned long retryMs = 1000);
+
+    bool ready() override;
+    bool update(const char *path, const char *json) override;
+    bool set(const char *path, const char *json) override;
+
+    int lastStatus() const override { return status; }
+    const char *lastError() const override { return error; }
+    const Stats &getStats() const { return stats; }
+
+private:
+    HttpConnection http;
+    unsigned long retryMs;
+    unsigned long lastFailMs;
+    bool failedConnect;
+    bool everConnected;
+    int status;
+    char error[96];
+    Stats stats;
+
+    bool request(const char *method, const char *path, const char *json);
+    bool attempt(const char *method, const char *path, const char *json, bool &retry);
+};
+
+/**
+ * @brief CommandSource sobre el stream SSE de RTDB (GET con text/event-stream)
+ *
+ * Si no llega nada (ni el keep-alive del servidor) en keepAliveTimeoutMs,
+ * read() devuelve TIMEOUT y la siguiente llamada reabre el stream; el put
+ * inicial vuelve a traer el nodo completo.
+ */
+class RestCommandSource : public CommandSource
+{
+public:
+    RestCommandSource(const char *host, uint16_t port, unsigned long timeoutMs = 5000,
+                      unsigned long keepAliveTimeoutMs = 45000);
+
+    bool begin(const char *path) override;
+    Result read(Message &message) override;
+    void end() override;
+    const char *lastError() const override { return error; }
+
+    // {"path":"/x","data":valor} → ruta, tipo de RTDB y payload (in situ)
+    static bool splitEvent(char *data, Message &message);
+
+private:
+    HttpConnection http;
+    SseParser parser;
+    unsigned long keepAliveTimeoutMs;
+    unsigned long lastRxMs;
+    char path[64];
+    bool open;
+    bool resume; // Reabrir en el próximo read() (tras un TIMEOUT)
+    char error[96];
+};
+
+#endif // REST_TRANSPORT_H
@@ -0,0 +1,270 @@
+#include "Scheduler.h"
+#include "Log.h"
+
+#if SCHED_LIGHT_SLEEP && defined(CONFIG_PM_ENABLE)
+#include "esp_pm.h"
+#endif
+
+Scheduler::Scheduler() : nowUs64(0), lastNowUs(0), cursorTick(0), started(false)
+{
+    for (uint8_t i = 0; i < MAX_TASKS; i++)
+        tasks[i].active = false;
+    for (uint8_t i = 0; i < WHEEL_SLOTS; i++)
+        slots[i] = INVALID_TASK;
+}
+
+void Scheduler::begin()
+{
+#if SCHED_LIGHT_SLEEP && defined(CONFIG_PM_ENABLE)
+    // El idle de FreeRTOS entra en light sleep cuando ambos núcleos esperan
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    esp_pm_config_t pm = {};
+#else
+    esp_pm_config_esp32_t pm = {};
+#endif
+    pm.max_freq_mhz = 240;
+    pm.min_freq_mhz = 80;
+    pm.light_sleep_enable = true;
+    if (esp_pm_configure(&pm) != ESP_OK)
+        LOG_W(CTRL, "Scheduler: No se pudo activar light sleep");
+#endif
+}
+
+// ============================================================================
+// TAREAS
+// ============================================================================
+
+Scheduler::TaskId Scheduler::add(const char *name, uint32_t periodUs, uint64_t deadlineUs, uint8_t priority,
+                                 Callback callback, void *context)
+{
+    for (TaskId id = 0; id < MAX_TASKS; id++)
+    {
+        Task &t = tasks[id];
+        if (t.active)
+            continue;
+        t.name = name;
+        t.callback = callback;
+        t.context = context;
+        t.periodUs = periodUs;
+        t.priority = priority;
+        t.active = true;
+        t.deadlineUs = deadlineUs;
+        t.stats = TaskStats();
+        insert(id);
+        return id;
+    }
+    LOG_E(CTRL, "Scheduler: Error - Sin lugar para la tarea %s", name);
+    return INVALID_TASK;
+}
+
+Scheduler::TaskId Scheduler::every(const char *name, uint32_t periodUs, uint8_t priority, Callback callback,
+                                   void *context)
+{
+    return add(name, periodUs ? periodUs : 1, nowUs64, priority, callback, context);
+}
+
+Scheduler::TaskId Scheduler::after(const char *name, uint32_t delayUs, uint8_t priority, Callback callback,
+                                   void *context)
+{
+    return add(name, 0, nowUs64 + delayUs, priority, callback, context);
+}
+
+void Scheduler::cancel(TaskId id)
+{
+    if (!isActive(id))
+        return;
+    unlink(id);
+    tasks[id].active = false;
+}
+
+void Scheduler::setPeriod(TaskId id, uint32_t periodUs)
+{
+    if (isActive(id) && periodUs)
+        tasks[id].periodUs = periodUs;
+}
+
+// ============================================================================
+// RUEDA DE TIEMPO
+// ============================================================================
+
+void Scheduler::advance(uint32_t nowUs)
+{
+    // El tiempo 0 es la primera llamada: lo registrado en setup() cuenta desde ahí
+    if (!started)
+    {
+        started = true;
+        lastNowUs = nowUs;
+    }
+    nowUs64 += uint32_t(nowUs - lastNowUs);
+    lastNowUs = nowUs;
+}
+
+void Scheduler::insert(TaskId id)
+{
+    // Un vencimiento anterior a lo ya revisado va a la ranura actual
+    uint64_t tick = tasks[id].deadlineUs / TICK_US;
+    if (tick < cursorTick)
+        tick = cursorTick;
+    uint8_t slot = tick & (WHEEL_SLOTS - 1);
+    tasks[id].nextInSlot = slots[slot];
+    slots[slot] = id;
+}
+
+void Scheduler::unlink(TaskId id)
+{
+    for (uint8_t s = 0; s < WHEEL_SLOTS; s++)
+    {
+        for (TaskId *link = &slots[s]; *link != INVALID_TASK; link = &tasks[*link].nextInSlot)
+        {
+            if (*link == id)
+            {
+                *link = tasks[id].nextInSlot;
+                return;
+            }
+        }
+    }
+}
+
+// ============================================================================
+// EJECUCIÓN
+// ============================================================================
+
+uint8_t Scheduler::run(uint32_t nowUs)
+{
+    advance(nowUs);
+    uint32_t startMicros = micros();
+
+    // Solo las ranuras que pasaron desde la última vez (todas si pasó una vuelta)
+    TaskId ready[MAX_TASKS];
+    uint8_t count = 0;
+    uint64_t nowTick = nowUs64 / TICK_US;
+    uint64_t span = nowTick - cursorTick + 1;
+    if (span > WHEEL_SLOTS)
+        span = WHEEL_SLOTS;
+    for (uint64_t k = 0; k < span; k++)
+    {
+        uint8_t slot = (cursorTick + k) & (WHEEL_SLOTS - 1);
+        for (TaskId id = slots[slot]; id != INVALID_TASK; id = tasks[id].nextInSlot)
+        {
+            if (tasks[id].deadlineUs > nowUs64)
+                continue;
+            // Mayor prioridad primero; a igual prioridad, el vencimiento más antiguo
+            uint8_t pos = count++;
+            while (pos > 0 && (tasks[ready[pos - 1]].priority < tasks[id].priority ||
+                               (tasks[ready[pos - 1]].priority == tasks[id].priority &&
+                                tasks[ready[pos - 1]].deadlineUs > tasks[id].deadlineUs)))
+            {
+                ready[pos] = ready[pos - 1];
+                pos--;
+            }
+            ready[pos] = id;
+        }
+    }
+    cursorTick = nowTick;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        TaskId id = ready[i];
+        Task &t = tasks[id];
+        if (!t.active || t.deadlineUs > nowUs64)
+            continue; // La canceló (o la reemplazó) una tarea anterior
+        unlink(id);
+
+        uint32_t t0 = micros();
+        uint64_t start = nowUs64 + uint32_t(t0 - startMicros);
+        uint64_t late = start - t.deadlineUs;
+        t.callback(t.context);
+        uint32_t runUs = micros() - t0;
+
+        TaskStats &st = t.stats;
+        st.runs++;
+        st.lateSumUs += late;
+        if (late > st.lateMaxUs)
+            st.lateMaxUs = late > 0xFFFFFFFFULL ? 0xFFFFFFFFu : uint32_t(late);
+        st.runSumUs += runUs;
+        if (runUs > st.runMaxUs)
+            st.runMaxUs = runUs;
+
+        if (!t.active)
+            continue; // Se canceló a sí misma
+        if (!t.periodUs)
+        {
+            t.active = false;
+            continue;
+        }
+
+        // Mantiene la fase; si ya pasó el próximo vencimiento, salta los perdidos
+        uint64_t end = start + runUs;
+        uint64_t next = t.deadlineUs + t.periodUs;
+        if (end > next)
+        {
+            uint64_t periods = (end - t.deadlineUs) / t.periodUs + 1;
+            st.overruns++;
+            st.skipped += uint32_t(periods - 1);
+            next = t.deadlineUs + periods * t.periodUs;
+        }
+        t.deadlineUs = next;
+        insert(id);
+    }
+
+    stats.busyUs += uint32_t(micros() - startMicros);
+    return count;
+}
+
+uint32_t Scheduler::untilNextUs(uint32_t nowUs)
+{
+    advance(nowUs);
+
+    // La rueda en orden desde lo último revisado: la primera ranura con una
+    // tarea de esta vuelta tiene el vencimiento más cercano
+    for (uint8_t k = 0; k < WHEEL_SLOTS; k++)
+    {
+        uint64_t tick = cursorTick + k;
+        uint64_t best = UINT64_MAX;
+        for (TaskId id = slots[tick & (WHEEL_SLOTS - 1)]; id != INVALID_TASK; id = tasks[id].nextInSlot)
+        {
+            uint64_t deadline = tasks[id].deadlineUs;
+            if (deadline <= nowUs64)
+                return 0;
+            if (deadline / TICK_US == tick && deadline < best)
+                best = deadline;
+        }
+        if (best != UINT64_MAX)
+            return best - nowUs64 < MAX_IDLE_US ? uint32_t(best - nowUs64) : MAX_IDLE_US;
+    }
+
+    // Nada en una vuelta: la más cercana de todas (tareas de varios segundos)
+    uint64_t best = nowUs64 + MAX_IDLE_US;
+    for (uint8_t id = 0; id < MAX_TASKS; id++)
+        if (tasks[id].active && tasks[id].deadlineUs < best)
+            best = tasks[id].deadlineUs;
+    return best > nowUs64 ? uint32_t(best - nowUs64) : 0;
+}
+
+void Scheduler::idle(uint32_t nowUs)
+{
+    uint32_t waitUs = untilNextUs(nowUs);
+    if (waitUs < MIN_IDLE_US)
+        return;
+    uint32_t t0 = micros();
+    delay(waitUs / 1000);
+    stats.idleUs += uint32_t(micros() - t0);
+    stats.sleeps++;
+}
+
+void Scheduler::print(const char *label) const
+{
+    LOG_PRINT(CTRL, "%s: carga %.1f%%, %lu esperas", label, stats.loadPercent(), (unsigned long)stats.sleeps);
+    for (uint8_t id = 0; id < MAX_TASKS; id++)
+    {
+        const Task &t = tasks[id];
+        if (!t.active)
+            continue;
+        const TaskStats &st = t.stats;
+        LOG_PRINT(CTRL,
+                  "  %-10s %7.1f ms p%u: %lu ejec, tarde %.2f/%.1f ms, dura %.2f/%.1f ms, %lu desbordes (%lu saltados)",
+                  t.name, t.periodUs / 1000.0f, t.priority, (unsigned long)st.runs, st.meanLateMs(),
+                  st.lateMaxUs / 1000.0f, st.meanRunMs(), st.runMaxUs / 1000.0f, (unsigned long)st.overruns,
+                  (unsigned long)st.skipped);
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+// 1: begin() activa el light sleep automático del ESP-IDF (requiere CONFIG_PM_ENABLE)
+#ifndef SCHED_LIGHT_SLEEP
+#define SCHED_LIGHT_SLEEP 0
+#endif
+
+/**
+ * @brief Planificador cooperativo por vencimiento para el loop()
+ *
+ * Reemplaza las cadenas de if (millis() - last >= INTERVAL): cada trabajo
+ * se registra como tarea periódica (every) o de una vez (after) con una
+ * prioridad. run() ejecuta las vencidas, primero la de mayor prioridad y,
+ * a igual prioridad, la que venció antes; ninguna interrumpe a otra.
+ *
+ * Los vencimientos viven en una rueda de tiempo de WHEEL_SLOTS ranuras de
+ * TICK_US: run() solo mira las ranuras que pasaron desde la llamada
+ * anterior y idle() encuentra el próximo vencimiento recorriendo la rueda
+ * desde el tick actual. El tiempo se extiende a 64 bits, así que el
+ * desborde de micros() (cada ~71 min) no adelanta ni atrasa tareas.
+ *
+ * Por tarea se cuentan ejecuciones, retraso al empezar (medio y máximo),
+ * duración máxima y desbordes: una ejecución que termina después de su
+ * próximo vencimiento. Los períodos que se pierden se saltan (sin ráfaga)
+ * y se cuentan aparte.
+ *
+ * idle() cede la CPU con delay() hasta el próximo vencimiento: en el ESP32
+ * es vTaskDelay(), el núcleo pasa a la tarea idle (WAITI) y, con
+ * SCHED_LIGHT_SLEEP=1 y CONFIG_PM_ENABLE, a light sleep automático.
+ *
+ *   scheduler.every("control", 500000, 5, &cicloControl);
+ *   scheduler.after("reinicio", 1000000, 5, &reiniciar);
+ *   void loop() { scheduler.run(micros()); scheduler.idle(micros()); }
+ */
+class Scheduler
+{
+public:
+    static constexpr uint8_t MAX_TASKS = 16;
+    static constexpr uint32_t TICK_US = 1000;
+    static constexpr uint8_t WHEEL_SLOTS = 64;       // Potencia de 2
+    static constexpr uint32_t MIN_IDLE_US = 1000;    // Menos que esto no vale un vTaskDelay
+    static constexpr uint32_t MAX_IDLE_US = 1000000; // Tope de una espera sin tareas
+
+    typedef void (*Callback)(void *context);
+    typedef int8_t TaskId;
+    static constexpr TaskId INVALID_TASK = -1;
+
+    struct TaskStats
+    {
+        uint32_t runs = 0;
+        uint32_t overruns = 0; // Terminó después de su próximo vencimiento
+        uint32_t skipped = 0;  // Períodos perdidos por un desborde
+        uint32_t lateMaxUs = 0;
+        uint64_t lateSumUs = 0;
+        uint32_t runMaxUs = 0;
+        uint64_t runSumUs = 0;
+
+        float meanLateMs() const { return runs ? lateSumUs / 1000.0f / runs : 0.0f; }
+        float meanRunMs() const { return runs ? runSumUs / 1000.0f / runs : 0.0f; }
+    };
+
+    struct Stats
+    {
+        uint64_t busyUs = 0; // En run()
+        uint64_t idleUs = 0; // En idle()
+        uint32_t sleeps = 0;
+
+        float loadPercent() const { return busyUs + idleUs ? 100.0f * busyUs / (busyUs + idleUs) : 0.0f; }
+    };
+
+    Scheduler();
+
+    // Light sleep automático si SCHED_LIGHT_SLEEP (no hace falta para planificar)
+    void begin();
+
+    // Primera ejecución en el próximo run(); INVALID_TASK si no hay lugar
+    TaskId every(const char *name, uint32_t periodUs, uint8_t priority, Callback callback, void *context = nullptr);
+    TaskId after(const char *name, uint32_t delayUs, uint8_t priority, Callback callback, void *context = nullptr);
+    void cancel(TaskId id);
+    // Desde el próximo vencimiento (también desde la propia tarea)
+    void setPeriod(TaskId id, uint32_t periodUs);
+
+    // Ejecuta las tareas vencidas; devuelve cuántas corrieron
+    uint8_t run(uint32_t nowUs);
+    // Microsegundos hasta el próximo vencimiento (0: ya hay una vencida)
+    uint32_t untilNextUs(uint32_t nowUs);
+    // Espera con delay() hasta el próximo vencimiento (nada si falta menos de MIN_IDLE_US)
+    void idle(uint32_t nowUs);
+
+    bool isActive(TaskId id) const { return id >= 0 && id < MAX_TASKS && tasks[id].active; }
+    const char *getName(TaskId id) const { return tasks[id].name; }
+    uint32_t getPeriod(TaskId id) const { return tasks[id].periodUs; }
+    const TaskStats &getTaskStats(TaskId id) const { return tasks[id].stats; }
+    const Stats &getStats() const { return stats; }
+    void print(const char *label) const;
+
+private:
+    struct Task
+    {
+        const char *name;
+        Callback callback;
+        void *context;
+        uint32_t periodUs; // 0: una vez
+        uint8_t priority;
+        bool active;
+        uint64_t deadlineUs;
+        TaskId nextInSlot;
+        TaskStats stats;
+    };
+
+    Task tasks[MAX_TASKS];
+    TaskId slots[WHEEL_SLOTS];
+    uint64_t nowUs64;
+    uint32_t lastNowUs;
+    uint64_t cursorTick; // Ranuras anteriores ya revisadas
+    bool started;
+    Stats stats;
+
+    TaskId add(const char *name, uint32_t periodUs, uint64_t deadlineUs, uint8_t priority, Callback callback,
+               void *context);
+    void advance(uint32_t nowUs);
+    void insert(TaskId id);
+    void unlink(TaskId id);
+};
+
+#endif // SCHEDULER_H
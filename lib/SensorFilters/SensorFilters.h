@@ -0,0 +1,329 @@
+#ifndef SENSOR_FILTERS_H
+#define SENSOR_FILTERS_H
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @file SensorFilters.h
+ * @brief Filtros de ventana deslizante para los sensores analógicos
+ *
+ * Biblioteca solo de cabecera (sin Arduino.h) para poder compilarla y
+ * medirla también en el host.
+ */
+
+/**
+ * @brief Media recortada y mediana sobre una ventana deslizante de N muestras
+ *
+ * Mantiene la ventana ordenada de forma incremental: cada muestra nueva
+ * reemplaza a la más antigua con una búsqueda binaria y un memmove, y la suma
+ * de la mitad central [N/4, N - N/4) se ajusta en O(1) según dónde salió y
+ * dónde entró el valor. Leer la media recortada o la mediana no recorre la
+ * ventana. Con T entero y Acc suficientemente ancho la suma es exacta.
+ * La longitud activa se puede reducir en tiempo de ejecución (setLength).
+ *
+ * @tparam T   Tipo de muestra (p. ej. uint16_t para ADC crudo)
+ * @tparam N   Capacidad de la ventana (>= 4)
+ * @tparam Acc Acumulador de la suma central
+ */
+template <typename T, uint8_t N, typename Acc = uint32_t>
+class SlidingTrimmedMean
+{
+    static_assert(N >= 4, "SlidingTrimmedMean requiere N >= 4");
+
+public:
+    static constexpr uint8_t SIZE = N;
+
+    SlidingTrimmedMean() { reset(); }
+
+    void reset()
+    {
+        count = 0;
+        pos = 0;
+        midSum = 0;
+    }
+
+    // Cambia la longitud activa (4..N); vacía la ventana si cambia
+    void setLength(uint8_t n)
+    {
+        if (n < 4)
+            n = 4;
+        if (n > N)
+            n = N;
+        if (n != len)
+        {
+            len = n;
+            reset();
+        }
+    }
+    uint8_t length() const { return len; }
+
+    void push(T x)
+    {
+        if (count < len)
+        {
+            ring[count] = x;
+            insertSorted(x, count);
+            count++;
+            recomputeSum();
+            return;
+        }
+
+        const uint8_t lo = len / 4;
+        const uint8_t hi = len - lo;
+
+        // Quitar la muestra más antigua
+        T old = ring[pos];
+        ring[pos] = x;
+        pos = (pos + 1 == len) ? 0 : pos + 1;
+
+        uint8_t p = lowerBound(old, len);
+        Acc sum = midSum;
+        if (p < lo)
+            sum -= sorted[lo];
+        else if (p < hi)
+            sum -= old;
+        else
+            sum -= sorted[hi - 1];
+        memmove(&sorted[p], &sorted[p + 1], (len - 1 - p) * sizeof(T));
+
+        // Insertar la nueva en la ventana de len - 1
+        uint8_t q = upperBound(x, len - 1);
+        if (q < lo)
+            sum += sorted[lo - 1];
+        else if (q < hi)
+            sum += x;
+        else
+            sum += sorted[hi - 1];
+        memmove(&sorted[q + 1], &sorted[q], (len - 1 - q) * sizeof(T));
+        sorted[q] = x;
+
+        midSum = sum;
+    }
+
+    uint8_t size() const { return count; }
+    bool isFull() const { return count == len; }
+
+    // Media de la mitad central de la ventana
+    float trimmedMean() const
+    {
+        if (count == 0)
+            return 0.0f;
+        uint8_t lo = count / 4;
+        return float(midSum) / float(count - 2 * lo);
+    }
+
+    T median() const { return count ? sorted[count / 2] : T(0); }
+
+    // Ancho de la mitad central (rango intercuartil aproximado)
+    T spread() const
+    {
+        if (count < 4)
+            return T(0);
+        uint8_t lo = count / 4;
+        return sorted[count - lo - 1] - sorted[lo];
+    }
+
+    T minimum() const { return count ? sorted[0] : T(0); }
+    T maximum() const { return count ? sorted[count - 1] : T(0); }
+
+private:
+    T ring[N];   // Orden de llegada
+    T sorted[N]; // Misma ventana, ordenada
+    uint8_t len = N;
+    uint8_t count;
+    uint8_t pos;
+    Acc midSum;
+
+    uint8_t lowerBound(T x, uint8_t n) const
+    {
+        uint8_t a = 0, b = n;
+        while (a < b)
+        {
+            uint8_t m = (a + b) / 2;
+            if (sorted[m] < x)
+                a = m + 1;
+            else
+                b = m;
+        }
+        return a;
+    }
+
+    uint8_t upperBound(T x, uint8_t n) const
+    {
+        uint8_t a = 0, b = n;
+        while (a < b)
+        {
+            uint8_t m = (a + b) / 2;
+            if (x < sorted[m])
+                b = m;
+            else
+                a = m + 1;
+        }
+        return a;
+    }
+
+    void insertSorted(T x, uint8_t n)
+    {
+        uint8_t q = upperBound(x, n);
+        memmove(&sorted[q + 1], &sorted[q], (n - q) * sizeof(T));
+        sorted[q] = x;
+    }
+
+    void recomputeSum()
+    {
+        uint8_t lo = count / 4;
+        Acc sum = 0;
+        for (uint8_t i = lo; i < count - lo; i++)
+        {
+            sum += sorted[i];
+        }
+        midSum = sum;
+    }
+};
+
+/**
+ * @brief Media y varianza en línea (Welford) con memoria limitada
+ *
+ * Las primeras MEMORY muestras usan el algoritmo de Welford exacto; a partir
+ * de ahí pasa a una media y varianza exponenciales con peso 1/MEMORY, así la
+ * estimación sigue los cambios de ruido del sensor en lugar de congelarse.
+ */
+class RunningVariance
+{
+public:
+    explicit RunningVariance(uint16_t memory = 256) : memory(memory < 2 ? 2 : memory) { reset(); }
+
+    void reset()
+    {
+        n = 0;
+        m = 0.0f;
+        m2 = 0.0f;
+    }
+
+    void push(float x)
+    {
+        float d = x - m;
+        if (n < memory)
+        {
+            n++;
+            m += d / n;
+            m2 += d * (x - m);
+            if (n == memory)
+                m2 /= (n - 1); // A partir de aquí m2 guarda la varianza
+        }
+        else
+        {
+            float a = 1.0f / memory;
+            m += a * d;
+            m2 = (1.0f - a) * (m2 + a * d * d);
+        }
+    }
+
+    uint16_t count() const { return n; }
+    float mean() const { return m; }
+    float variance() const
+    {
+        if (n < 2)
+            return 0.0f;
+        return (n < memory) ? m2 / (n - 1) : m2;
+    }
+    float stddev() const { return sqrtf(variance()); }
+
+private:
+    uint16_t memory;
+    uint16_t n;
+    float m;
+    float m2;
+};
+
+/**
+ * @brief Cantidad de muestras por lectura según el ruido medido
+ *
+ * Con la varianza de las muestras individuales elige n para que el error
+ * estándar del promedio, σ/√n, quede por debajo del objetivo. Hasta juntar
+ * WARMUP muestras usa el máximo.
+ */
+class OversampleBudget
+{
+public:
+    static constexpr uint16_t WARMUP = 16;
+
+    OversampleBudget(float targetError, uint8_t minSamples, uint8_t maxSamples)
+        : targetError(targetError), minN(minSamples), maxN(maxSamples) {}
+
+    void push(float sample) { stats.push(sample); }
+    void reset() { stats.reset(); }
+
+    void setTarget(float standardError) { targetError = standardError; }
+    void setLimits(uint8_t minSamples, uint8_t maxSamples)
+    {
+        minN = minSamples;
+        maxN = maxSamples;
+    }
+
+    uint8_t samples() const
+    {
+        if (stats.count() < WARMUP || targetError <= 0.0f)
+            return maxN;
+        float n = ceilf(stats.variance() / (targetError * targetError));
+        if (n < minN)
+            return minN;
+        if (n > maxN)
+            return maxN;
+        return uint8_t(n);
+    }
+
+    // Error estándar del promedio de n muestras (mismas unidades que las muestras)
+    float standardError(uint8_t n) const { return n ? stats.stddev() / sqrtf(n) : 0.0f; }
+    float standardError() const { return standardError(samples()); }
+
+    float getTarget() const { return targetError; }
+    uint8_t minSamples() const { return minN; }
+    uint8_t maxSamples() const { return maxN; }
+    const RunningVariance &statistics() const { return stats; }
+
+private:
+    RunningVariance stats;
+    float targetError;
+    uint8_t minN;
+    uint8_t maxN;
+};
+
+/**
+ * @brief Media recortada de un bloque (ordena in situ)
+ *
+ * Algoritmo original de PHSensor: inserción y promedio de la mitad central.
+ * Se usa para lecturas puntuales (calibración) y como referencia en los
+ * benchmarks de host.
+ */
+template <typename T>
+float trimmedMeanSort(T *buf, uint8_t n)
+{
+    if (n == 0)
+        return 0.0f;
+
+    for (uint8_t i = 1; i < n; i++)
+    {
+        T key = buf[i];
+        int j = i - 1;
+        while (j >= 0 && buf[j] > key)
+        {
+            buf[j + 1] = buf[j];
+            j--;
+        }
+        buf[j + 1] = key;
+    }
+
+    uint8_t start = n / 4;
+    uint8_t end = n - start;
+    float sum = 0.0f;
+    for (uint8_t i = start; i < end; i++)
+    {
+        sum += buf[i];
+    }
+    return sum / float(end - start);
+}
+
+#endif // SENSOR_FILTERS_H
@@ -0,0 +1,385 @@
+#include "SensorHub.h"
+#include "Log.h"
+
+#if SENSOR_HUB_USE_DMA
+#include "esp_idf_version.h"
+#if defined(CONFIG_IDF_TARGET_ESP32) && ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 4, 0)
+#include "driver/adc.h"
+#define SENSOR_HUB_HAS_DMA 1
+#endif
+#endif
+
+#ifndef SENSOR_HUB_HAS_DMA
+#define SENSOR_HUB_HAS_DMA 0
+#endif
+
+namespace
+{
+    constexpr uint32_t DMA_READ_BYTES = 256; // 128 conversiones por lectura
+    constexpr uint32_t DMA_STORE_BYTES = 1024;
+    constexpr uint32_t DMA_RESULT_BYTES = 2; // Formato TYPE1 del ESP32
+}
+
+SensorHub::SensorHub(uint8_t phPin, uint8_t tdsPin, uint8_t ldrPin)
+    : mode(MODE_STOPPED), frameRateHz(0), mainsHz(0), head(0), timer(nullptr),
+      dmaTask(nullptr), dmaStop(false)
+{
+    pins[CH_PH] = phPin;
+    pins[CH_TDS] = tdsPin;
+    pins[CH_LDR] = ldrPin;
+}
+
+bool SensorHub::begin(uint32_t frameRateHz, uint8_t mainsHz)
+{
+    if (mode != MODE_STOPPED || frameRateHz == 0)
+        return false;
+
+    this->mainsHz = mainsHz;
+
+    // Sincronizado: un frame DMA = un periodo de red
+    this->frameRateHz = mainsHz ? mainsHz : frameRateHz;
+    if (beginDma())
+    {
+        mode = MODE_DMA;
+        LOG_I(SENSOR, "SensorHub: ADC continuo (DMA) - %lu conv/s, %lu frames/s%s",
+                      (unsigned long)DMA_CONV_HZ, (unsigned long)this->frameRateHz,
+                      mainsHz ? " (sincronizado con la red)" : "");
+        return true;
+    }
+
+    // Sincronizado: timer a 2× la red, el zumbido queda en fs/2
+    this->frameRateHz = mainsHz ? 2 * mainsHz : frameRateHz;
+
+    // Respaldo: esp_timer + analogRead
+    analogReadResolution(12);
+    for (uint8_t i = 0; i < CH_COUNT; i++)
+    {
+        analogSetPinAttenuation(pins[i], ADC_11db);
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback = &SensorHub::onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "sensor_hub";
+
+    if (esp_timer_create(&args, &timer) != ESP_OK)
+    {
+        timer = nullptr;
+        LOG_E(SENSOR, "SensorHub: Error - No se pudo crear el timer");
+        return false;
+    }
+
+    // Llenar el buffer antes de arrancar para que la primera lectura sea válida
+    for (uint8_t i = 0; i < FRAME_DEPTH / 2; i++)
+    {
+        sampleTimer();
+    }
+
+    esp_timer_start_periodic(timer, 1000000UL / this->frameRateHz);
+    mode = MODE_TIMER;
+    LOG_I(SENSOR, "SensorHub: Modo timer - %lu frames/s%s", (unsigned long)this->frameRateHz,
+                  mainsHz ? " (2x red)" : "");
+    return true;
+}
+
+float SensorHub::getHumFrequency() const
+{
+    if (mainsHz == 0 || frameRateHz == 0)
+        return 0.0f;
+    if (mode == MODE_DMA && frameRateHz == mainsHz)
+        return 0.0f;
+
+    // Frecuencia aparente de la red muestreada a frameRateHz
+    float fs = float(frameRateHz);
+    float alias = fmodf(float(mainsHz), fs);
+    if (alias > fs * 0.5f)
+        alias = fs - alias;
+    return alias;
+}
+
+float SensorHub::readSpread(uint8_t pin, uint16_t *out, uint8_t n, uint32_t windowUs)
+{
+    if (n == 0)
+        return 0.0f;
+
+    // Cada muestra en t0 + i·windowUs/n: n muestras equiespaciadas cubren la
+    // ventana completa y, si es un número entero de periodos, el zumbido se anula
+    uint32_t t0 = micros();
+    for (uint8_t i = 0; i < n; i++)
+    {
+        uint32_t due = uint32_t(uint64_t(windowUs) * i / n);
+        uint32_t elapsed = micros() - t0;
+        if (due > elapsed)
+        {
+            uint32_t waitUs = due - elapsed;
+            if (waitUs >= 2000)
+                delay(waitUs / 1000);
+            elapsed = micros() - t0;
+            if (due > elapsed)
+                delayMicroseconds(due - elapsed);
+        }
+        out[i] = analogRead(pin);
+    }
+    uint32_t totalUs = windowUs ? windowUs : micros() - t0;
+    return totalUs ? n * 1e6f / totalUs : 0.0f;
+}
+
+void SensorHub::end()
+{
+    if (mode == MODE_DMA)
+    {
+        endDma();
+    }
+    else if (mode == MODE_TIMER)
+    {
+        esp_timer_stop(timer);
+        esp_timer_delete(timer);
+        timer = nullptr;
+    }
+    mode = MODE_STOPPED;
+}
+
+// ============================================================================
+// Backend timer
+// ============================================================================
+
+void SensorHub::onTimer(void *arg)
+{
+    static_cast<SensorHub *>(arg)->sampleTimer();
+}
+
+void SensorHub::sampleTimer()
+{
+    Frame frame;
+    for (uint8_t i = 0; i < CH_COUNT; i++)
+    {
+        frame.raw[i] = analogRead(pins[i]);
+    }
+    frame.conversions = 1;
+    frame.stampUs = micros();
+    pushFrame(frame);
+}
+
+// ============================================================================
+// Backend DMA (ADC1 en modo continuo)
+// ============================================================================
+
+bool SensorHub::beginDma()
+{
+#if SENSOR_HUB_HAS_DMA
+    if (frameRateHz > DMA_CONV_HZ / CH_COUNT)
+        return false;
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        dmaSlotOf[i] = -1;
+    }
+
+    adc_digi_pattern_config_t pattern[CH_COUNT] = {};
+    uint16_t mask = 0;
+    for (uint8_t i = 0; i < CH_COUNT; i++)
+    {
+        int8_t adcChannel = digitalPinToAnalogChannel(pins[i]);
+        if (adcChannel < 0 || adcChannel > 7)
+        {
+            LOG_I(SENSOR, "SensorHub: Pin %d no es ADC1, DMA no disponible", pins[i]);
+            return false;
+        }
+        dmaSlotOf[adcChannel] = i;
+        mask |= (1 << adcChannel);
+
+        pattern[i].atten = ADC_ATTEN_DB_11;
+        pattern[i].channel = adcChannel;
+        pattern[i].unit = 0; // ADC1
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    adc_digi_init_config_t init = {};
+    init.max_store_buf_size = DMA_STORE_BYTES;
+    init.conv_num_each_intr = DMA_READ_BYTES;
+    init.adc1_chan_mask = mask;
+    init.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&init) != ESP_OK)
+        return false;
+
+    adc_digi_configuration_t config = {};
+    config.conv_limit_en = true;
+    config.conv_limit_num = 250;
+    config.pattern_num = CH_COUNT;
+    config.adc_pattern = pattern;
+    config.sample_freq_hz = DMA_CONV_HZ;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+    if (adc_digi_controller_configure(&config) != ESP_OK || adc_digi_start() != ESP_OK)
+    {
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    dmaStop = false;
+    if (xTaskCreatePinnedToCore(&SensorHub::dmaTaskEntry, "sensor_hub", 3072, this,
+                                configMAX_PRIORITIES - 5, &dmaTask, 1) != pdPASS)
+    {
+        dmaTask = nullptr;
+        adc_digi_stop();
+        adc_digi_deinitialize();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SensorHub::endDma()
+{
+#if SENSOR_HUB_HAS_DMA
+    dmaStop = true;
+    while (dmaTask)
+    {
+        delay(1);
+    }
+    adc_digi_stop();
+    adc_digi_deinitialize();
+#endif
+}
+
+void SensorHub::dmaTaskEntry(void *arg)
+{
+    SensorHub *hub = static_cast<SensorHub *>(arg);
+    hub->dmaLoop();
+    hub->dmaTask = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void SensorHub::dmaLoop()
+{
+#if SENSOR_HUB_HAS_DMA
+    uint8_t buf[DMA_READ_BYTES];
+    uint32_t sums[CH_COUNT] = {};
+    uint16_t counts[CH_COUNT] = {};
+    uint32_t total = 0;
+    const uint32_t perFrame = DMA_CONV_HZ / frameRateHz;
+    Frame frame = {};
+
+    while (!dmaStop)
+    {
+        uint32_t len = 0;
+        if (adc_digi_read_bytes(buf, sizeof(buf), &len, 100) != ESP_OK)
+            continue;
+
+        for (uint32_t i = 0; i + DMA_RESULT_BYTES <= len; i += DMA_RESULT_BYTES)
+        {
+            const adc_digi_output_data_t *p = reinterpret_cast<const adc_digi_output_data_t *>(&buf[i]);
+            uint8_t adcChannel = p->type1.channel;
+            if (adcChannel >= 8 || dmaSlotOf[adcChannel] < 0)
+                continue;
+
+            uint8_t slot = dmaSlotOf[adcChannel];
+            sums[slot] += p->type1.data;
+            counts[slot]++;
+
+            if (++total < perFrame)
+                continue;
+
+            // Cerrar frame: promedio por canal de todo el periodo
+            uint16_t minCount = 0xFFFF;
+            for (uint8_t ch = 0; ch < CH_COUNT; ch++)
+            {
+                if (counts[ch] > 0)
+                    frame.raw[ch] = (sums[ch] + counts[ch] / 2) / counts[ch];
+                if (counts[ch] < minCount)
+                    minCount = counts[ch];
+                sums[ch] = 0;
+                counts[ch] = 0;
+            }
+            frame.conversions = minCount;
+            frame.stampUs = micros();
+            pushFrame(frame);
+            total = 0;
+        }
+    }
+#endif
+}
+
+// ============================================================================
+// Buffer de frames
+// ============================================================================
+
+void SensorHub::pushFrame(const Frame &frame)
+{
+    portENTER_CRITICAL(&mux);
+    frames[head & (FRAME_DEPTH - 1)] = frame;
+    head++;
+    portEXIT_CRITICAL(&mux);
+}
+
+uint8_t SensorHub::copyRecent(Channel channel, uint16_t *out, uint8_t n) const
+{
+    if (channel >= CH_COUNT)
+        return 0;
+    if (n > FRAME_DEPTH)
+        n = FRAME_DEPTH;
+
+    portENTER_CRITICAL(&mux);
+    if (n > head)
+        n = head;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        out[i] = frames[(head - n + i) & (FRAME_DEPTH - 1)].raw[channel];
+    }
+    portEXIT_CRITICAL(&mux);
+    return n;
+}
+
+uint8_t SensorHub::copyFrames(Frame *out, uint8_t n) const
+{
+    if (n > FRAME_DEPTH)
+        n = FRAME_DEPTH;
+
+    portENTER_CRITICAL(&mux);
+    if (n > head)
+        n = head;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        out[i] = frames[(head - n + i) & (FRAME_DEPTH - 1)];
+    }
+    portEXIT_CRITICAL(&mux);
+    return n;
+}
+
+uint8_t SensorHub::copySince(Channel channel, uint32_t &cursor, uint16_t *out, uint8_t max) const
+{
+    if (channel >= CH_COUNT)
+        return 0;
+    if (max > FRAME_DEPTH)
+        max = FRAME_DEPTH;
+
+    // Frames nuevos desde cursor; si hay más que max se descartan los antiguos
+    portENTER_CRITICAL(&mux);
+    uint32_t available = head - cursor;
+    uint8_t n = (available > max) ? max : available;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        out[i] = frames[(head - n + i) & (FRAME_DEPTH - 1)].raw[channel];
+    }
+    cursor = head;
+    portEXIT_CRITICAL(&mux);
+    return n;
+}
+
+uint16_t SensorHub::getLatest(Channel channel) const
+{
+    uint16_t value = 0;
+    copyRecent(channel, &value, 1);
+    return value;
+}
+
+uint32_t SensorHub::getFrameCount() const
+{
+    portENTER_CRITICAL(&mux);
+    uint32_t count = head;
+    portEXIT_CRITICAL(&mux);
+    return count;
+}
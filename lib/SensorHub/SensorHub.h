@@ -0,0 +1,118 @@
+#ifndef SENSOR_HUB_H
+#define SENSOR_HUB_H
+
+#include <Arduino.h>
+#include "esp_timer.h"
+
+// Usar el ADC continuo (DMA) si está disponible; 0 fuerza el modo timer
+#ifndef SENSOR_HUB_USE_DMA
+#define SENSOR_HUB_USE_DMA 1
+#endif
+
+// Frecuencia de la red eléctrica para el muestreo sincronizado (0 = desactivado)
+#ifndef SENSOR_MAINS_HZ
+#define SENSOR_MAINS_HZ 60
+#endif
+
+// Adquisición compartida de los canales analógicos (pH, TDS, LDR).
+// En modo DMA el controlador digital del ADC1 recorre los tres pines en un
+// único patrón y una tarea promedia todas las conversiones de cada periodo
+// en un frame alineado en el tiempo. Si el DMA no está disponible se usa un
+// esp_timer que lee los tres canales con analogRead().
+//
+// Con mainsHz > 0 la adquisición se sincroniza con la red: en modo DMA cada
+// frame promedia exactamente un periodo (el zumbido se cancela en el propio
+// frame) y en modo timer se muestrea a 2× la red, de modo que el zumbido
+// queda en fs/2 y lo elimina la etapa Notch de los sensores.
+class SensorHub
+{
+public:
+    enum Channel : uint8_t
+    {
+        CH_PH,
+        CH_TDS,
+        CH_LDR,
+        CH_COUNT
+    };
+
+    enum Mode
+    {
+        MODE_STOPPED,
+        MODE_DMA,
+        MODE_TIMER
+    };
+
+    struct Frame
+    {
+        uint16_t raw[CH_COUNT]; // Promedio de las conversiones del periodo
+        uint16_t conversions;   // Conversiones por canal promediadas
+        uint32_t stampUs;       // micros() al cerrar el frame
+    };
+
+    static constexpr uint8_t FRAME_DEPTH = 64;       // Potencia de 2
+    static constexpr uint32_t DMA_CONV_HZ = 20000;   // Mínimo del ADC continuo del ESP32
+
+    // Constructor
+    SensorHub(uint8_t phPin, uint8_t tdsPin, uint8_t ldrPin);
+
+    // Inicialización
+    bool begin(uint32_t frameRateHz, uint8_t mainsHz = 0);
+    void end();
+
+    // Lectura (no bloqueante)
+    uint8_t copyRecent(Channel channel, uint16_t *out, uint8_t n) const;
+    uint8_t copyFrames(Frame *out, uint8_t n) const;
+    uint8_t copySince(Channel channel, uint32_t &cursor, uint16_t *out, uint8_t max) const;
+    uint16_t getLatest(Channel channel) const;
+    uint32_t getFrameCount() const;
+
+    // Estado
+    bool isRunning() const { return mode != MODE_STOPPED; }
+    Mode getMode() const { return mode; }
+    uint32_t getFrameRate() const { return frameRateHz; }
+    uint8_t getMainsFrequency() const { return mainsHz; }
+    float getHumFrequency() const; // Donde aparece la red en los frames (0: ya cancelada)
+    uint8_t getPin(Channel channel) const { return pins[channel]; }
+
+    // Lectura directa de n muestras repartidas en windowUs (0: ráfaga).
+    // Devuelve la frecuencia de muestreo lograda en Hz.
+    static float readSpread(uint8_t pin, uint16_t *out, uint8_t n, uint32_t windowUs);
+    // Duración de un número entero de periodos de red (0 si no hay red configurada)
+    static constexpr uint32_t mainsWindowUs(uint8_t periods)
+    {
+#if SENSOR_MAINS_HZ
+        return periods * 1000000UL / SENSOR_MAINS_HZ;
+#else
+        (void)periods;
+        return 0;
+#endif
+    }
+
+private:
+    uint8_t pins[CH_COUNT];
+    Mode mode;
+    uint32_t frameRateHz;
+    uint8_t mainsHz;
+
+    Frame frames[FRAME_DEPTH];
+    uint32_t head; // Total de frames escritos
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+    // Backend timer
+    esp_timer_handle_t timer;
+    static void onTimer(void *arg);
+    void sampleTimer();
+
+    // Backend DMA
+    TaskHandle_t dmaTask;
+    volatile bool dmaStop;
+    int8_t dmaSlotOf[8]; // Canal ADC1 -> canal del hub
+    bool beginDma();
+    void endDma();
+    static void dmaTaskEntry(void *arg);
+    void dmaLoop();
+
+    void pushFrame(const Frame &frame);
+};
+
+#endif // SENSOR_HUB_H
@@ -0,0 +1,257 @@
+#ifndef FIXED_POINT_STAGES_H
+#define FIXED_POINT_STAGES_H
+
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * @file FixedPointStages.h
+ * @brief Etapas de SensorPipeline en punto fijo Q16.16
+ *
+ * Versión entera de la conversión de pH y TDS. Todo lo que depende de la
+ * calibración o de la temperatura (pendiente de Nernst, 1/pendiente, offset,
+ * coeficiente de compensación del TDS) se calcula una sola vez en los
+ * setters a partir de tablas de temperatura generadas en compilación; por
+ * muestra solo quedan multiplicaciones enteras y desplazamientos.
+ *
+ * Cota de error frente al camino float (verificada en
+ * test/host/bench_fixed_point.cpp, ADC 0-4095, temperatura -10 a 80 °C):
+ *   - pH:  |Δ| <= 0.002 pH
+ *   - TDS: |Δ| <= 0.5 ppm o 0.05 % (el mayor)
+ */
+
+// ============================================================================
+// TIPO Q16.16
+// ============================================================================
+
+struct Q16
+{
+    int32_t raw;
+};
+
+constexpr int32_t Q16_ONE = 65536;
+
+constexpr Q16 toQ16(float x)
+{
+    return Q16{int32_t(x * 65536.0f + (x >= 0.0f ? 0.5f : -0.5f))};
+}
+
+constexpr float asFloat(Q16 x) { return x.raw / 65536.0f; }
+constexpr float asFloat(float x) { return x; }
+
+inline int32_t mulQ16(int32_t a, int32_t b)
+{
+    return int32_t((int64_t(a) * b) >> 16);
+}
+
+// ============================================================================
+// TABLAS DE TEMPERATURA (-10 a 80 °C cada 5 °C)
+// ============================================================================
+
+namespace q16tables
+{
+    constexpr int TEMP_MIN_C = -10;
+    constexpr int TEMP_STEP_C = 5;
+    constexpr int TEMP_POINTS = 19;
+
+    struct TempTable
+    {
+        int32_t v[TEMP_POINTS];
+    };
+
+    template <typename F>
+    constexpr TempTable makeTable(F f)
+    {
+        TempTable t = {};
+        for (int i = 0; i < TEMP_POINTS; i++)
+        {
+            t.v[i] = toQ16(f(float(TEMP_MIN_C + i * TEMP_STEP_C))).raw;
+        }
+        return t;
+    }
+
+    // Factor de Nernst relativo a 25 °C: (T + 273.15) / 298.15
+    inline constexpr TempTable NERNST = makeTable([](float t)
+                                                  { return (t + 273.15f) / 298.15f; });
+
+    // Compensación del SEN0244: 1 + 0.02 (T - 25). Se tabula el denominador
+    // (lineal, la interpolación es exacta) y se invierte una vez en el setter
+    inline constexpr TempTable TDS_COMP = makeTable([](float t)
+                                                    { return 1.0f + 0.02f * (t - 25.0f); });
+
+    // Interpolación lineal; fuera de rango se usa el extremo
+    inline int32_t lookup(const TempTable &table, float tempC)
+    {
+        int32_t t = toQ16(tempC).raw - TEMP_MIN_C * Q16_ONE;
+        if (t <= 0)
+            return table.v[0];
+        int32_t span = TEMP_STEP_C * Q16_ONE;
+        int32_t i = t / span;
+        if (i >= TEMP_POINTS - 1)
+            return table.v[TEMP_POINTS - 1];
+        int32_t frac = int32_t((int64_t(t - i * span) << 16) / span);
+        return table.v[i] + mulQ16(table.v[i + 1] - table.v[i], frac);
+    }
+}
+
+// ============================================================================
+// ETAPAS
+// ============================================================================
+
+/**
+ * @brief Cuentas ADC (float, admite fracción) a voltios Q16
+ */
+template <uint32_t RANGE>
+class AdcToVoltsQ16
+{
+public:
+    // VREF / RANGE con 36 bits de fracción
+    static constexpr int64_t K = int64_t((3.3 / double(RANGE)) * 68719476736.0 + 0.5);
+
+    inline Q16 step(float raw)
+    {
+        int64_t raw16 = int64_t(raw * 16.0f + 0.5f); // 1/16 de cuenta
+        return Q16{int32_t((raw16 * K) >> 24)};
+    }
+    void reset() {}
+};
+
+class ScaleQ16
+{
+public:
+    inline Q16 step(Q16 x) { return Q16{mulQ16(x.raw, k)}; }
+    void reset() {}
+
+    void setFactor(float factor) { k = toQ16(factor).raw; }
+    float getFactor() const { return asFloat(Q16{k}); }
+
+private:
+    int32_t k = Q16_ONE;
+};
+
+class EmaQ16
+{
+public:
+    inline Q16 step(Q16 x)
+    {
+        in = x.raw;
+        y += mulQ16(alpha, x.raw - y);
+        return Q16{y};
+    }
+    void reset() { y = initial; }
+
+    void setAlpha(float a) { alpha = toQ16(a).raw; }
+    void setInitial(float value)
+    {
+        initial = toQ16(value).raw;
+        y = initial;
+    }
+    float lastInput() const { return asFloat(Q16{in}); }
+    float value() const { return asFloat(Q16{y}); }
+
+private:
+    int32_t alpha = Q16_ONE / 4;
+    int32_t initial = 0;
+    int32_t in = 0;
+    int32_t y = 0;
+};
+
+/**
+ * @brief Voltaje Q16 a pH Q16: pH = offset - V / pendiente(T)
+ */
+class PhCalibQ16
+{
+public:
+    PhCalibQ16() { recompute(); }
+
+    inline Q16 step(Q16 v)
+    {
+        int32_t x = v.raw;
+        if (x < 0)
+            x = 0;
+        if (x > V_MAX)
+            x = V_MAX;
+        return Q16{offset - mulQ16(x, invSlope)};
+    }
+    void reset() {}
+
+    void setCalibration(float vAtPh7, float vPerPh25)
+    {
+        v7 = toQ24(isfinite(vAtPh7) ? vAtPh7 : 2.50f);
+        slope25 = toQ24((isfinite(vPerPh25) && vPerPh25 > 0.05f) ? vPerPh25 : 0.18f);
+        recompute();
+    }
+    void setTemperature(float tempC)
+    {
+        nernst = q16tables::lookup(q16tables::NERNST, tempC);
+        recompute();
+    }
+
+    // Sensibilidad actual |dpH/dV|
+    float phPerVolt() const { return asFloat(Q16{invSlope}); }
+
+private:
+    static constexpr int32_t V_MAX = 5 * Q16_ONE;
+    static constexpr int64_t MIN_SLOPE_Q40 = int64_t(0.05 * 1099511627776.0);
+
+    // La calibración se guarda con 24 bits de fracción: 1/pendiente amplifica
+    // el error de cuantización y en Q16 ya se notaría en el tercer decimal
+    static constexpr int32_t toQ24(float x) { return int32_t(x * 16777216.0f + 0.5f); }
+
+    int32_t v7 = toQ24(2.50f);
+    int32_t slope25 = toQ24(0.18f);
+    int32_t nernst = Q16_ONE;
+    int32_t invSlope = 0;
+    int32_t offset = 7 * Q16_ONE;
+
+    void recompute()
+    {
+        int64_t slopeT = int64_t(slope25) * nernst; // Q40
+        if (slopeT < MIN_SLOPE_Q40)
+            slopeT = MIN_SLOPE_Q40;
+        invSlope = int32_t(((int64_t(1) << 56) + slopeT / 2) / slopeT);
+        offset = 7 * Q16_ONE + int32_t((int64_t(v7) * invSlope + (1 << 23)) >> 24);
+    }
+};
+
+/**
+ * @brief Voltaje Q16 a ppm Q16 con la fórmula de GravityTDS
+ */
+class GravityTdsPolyQ16
+{
+public:
+    inline Q16 step(Q16 v)
+    {
+        int64_t x = v.raw;
+        int64_t x2 = (x * x) >> 16;
+        int64_t x3 = (x2 * x) >> 16;
+        int64_t ec = (A * x3 - B * x2 + C * x) >> 16;
+        return Q16{int32_t((ec * coef) >> 16)};
+    }
+    void reset() {}
+
+    void setKValue(float k)
+    {
+        kValue = k;
+        recompute();
+    }
+    void setTemperature(float tempC)
+    {
+        comp = q16tables::lookup(q16tables::TDS_COMP, tempC);
+        recompute();
+    }
+
+private:
+    static constexpr int64_t A = int64_t(133.42 * 65536.0 + 0.5);
+    static constexpr int64_t B = int64_t(255.86 * 65536.0 + 0.5);
+    static constexpr int64_t C = int64_t(857.39 * 65536.0 + 0.5);
+
+    float kValue = 1.0f;
+    int32_t comp = Q16_ONE;
+    int32_t coef = Q16_ONE / 2;
+
+    // K * 0.5 / comp, con la única división fuera del camino por muestra
+    void recompute() { coef = int32_t((int64_t(toQ16(kValue * 0.5f).raw) << 16) / comp); }
+};
+
+#endif // FIXED_POINT_STAGES_H
@@ -0,0 +1,444 @@
+#ifndef SENSOR_PIPELINE_H
+#define SENSOR_PIPELINE_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <tuple>
+#include "SensorFilters.h"
+#include "FixedPointStages.h"
+
+// 1: los sensores usan las etapas Q16.16 de FixedPointStages.h
+#ifndef SENSOR_FIXED_POINT
+#define SENSOR_FIXED_POINT 0
+#endif
+
+/**
+ * @file SensorPipeline.h
+ * @brief Cadenas de procesamiento de sensores compuestas en tiempo de compilación
+ *
+ * Pipeline<A, B, C>::step(x) equivale a c.step(b.step(a.step(x))): las etapas
+ * se guardan por valor en una tupla y la recursión se resuelve con
+ * if constexpr, así que el compilador genera código lineal sin llamadas
+ * virtuales. Agregar o reordenar etapas no cuesta nada en tiempo de ejecución.
+ *
+ * Cada etapa expone:
+ *   Out step(In x);  // procesa una muestra (float o Q16)
+ *   void reset();    // vuelve al estado inicial
+ *
+ * El tipo que sale de una etapa es el que recibe la siguiente, así que una
+ * cadena puede pasar de float a Q16 y el compilador rechaza mezclas inválidas.
+ */
+
+template <typename... Stages>
+class Pipeline
+{
+public:
+    template <typename T>
+    inline auto step(T x) { return run<0>(x); }
+
+    void reset() { resetFrom<0>(); }
+
+    // Acceso a una etapa por tipo o por posición (para configurarla)
+    template <typename Stage>
+    Stage &get() { return std::get<Stage>(stages); }
+    template <typename Stage>
+    const Stage &get() const { return std::get<Stage>(stages); }
+
+    template <size_t I>
+    auto &at() { return std::get<I>(stages); }
+
+    static constexpr size_t size() { return sizeof...(Stages); }
+
+private:
+    std::tuple<Stages...> stages;
+
+    template <size_t I, typename T>
+    inline auto run(T x)
+    {
+        if constexpr (I == sizeof...(Stages))
+            return x;
+        else
+            return run<I + 1>(std::get<I>(stages).step(x));
+    }
+
+    template <size_t I>
+    void resetFrom()
+    {
+        if constexpr (I < sizeof...(Stages))
+        {
+            std::get<I>(stages).reset();
+            resetFrom<I + 1>();
+        }
+    }
+};
+
+// ============================================================================
+// ETAPAS GENÉRICAS
+// ============================================================================
+
+/**
+ * @brief Media recortada deslizante sobre cuentas ADC crudas
+ */
+template <uint8_t N>
+class TrimmedMean
+{
+public:
+    inline float step(float raw)
+    {
+        // Puede venir de un filtro previo (Notch): redondear y no bajar de 0
+        window.push(raw > 0.0f ? uint16_t(raw + 0.5f) : uint16_t(0));
+        return window.trimmedMean();
+    }
+    void reset() { window.reset(); }
+
+    uint8_t size() const { return window.size(); }
+    uint16_t spread() const { return window.spread(); }
+
+    // Longitud activa de la ventana (4..N)
+    void setWindow(uint8_t n) { window.setLength(n); }
+    uint8_t getWindow() const { return window.length(); }
+
+private:
+    SlidingTrimmedMean<uint16_t, N> window;
+};
+
+/**
+ * @brief Cuentas ADC de 12 bits a voltios (0-3.3V)
+ * @tparam RANGE Divisor de escala (4095 en los sensores, 4096 en GravityTDS)
+ */
+template <uint32_t RANGE>
+class AdcToVoltsT
+{
+public:
+    static constexpr float VREF = 3.3f;
+    static constexpr float ADC_RES = float(RANGE);
+
+    inline float step(float raw) { return raw * (VREF / ADC_RES); }
+    void reset() {}
+};
+
+using AdcToVolts = AdcToVoltsT<4095>;
+
+/**
+ * @brief Ganancia constante (p. ej. divisor resistivo del módulo)
+ */
+class Scale
+{
+public:
+    inline float step(float x) { return x * k; }
+    void reset() {}
+
+    void setFactor(float factor) { k = factor; }
+    float getFactor() const { return k; }
+
+private:
+    float k = 1.0f;
+};
+
+/**
+ * @brief Filtro exponencial (IIR de primer orden)
+ */
+class Ema
+{
+public:
+    inline float step(float x)
+    {
+        in = x;
+        y = alpha * x + (1.0f - alpha) * y;
+        return y;
+    }
+    void reset() { y = initial; }
+
+    void setAlpha(float a) { alpha = a; }
+    void setInitial(float value)
+    {
+        initial = value;
+        y = value;
+    }
+    float lastInput() const { return in; }
+    float value() const { return y; }
+
+private:
+    float alpha = 0.25f;
+    float initial = 0.0f;
+    float in = 0.0f;
+    float y = 0.0f;
+};
+
+/**
+ * @brief Filtro notch IIR de segundo orden (rechazo de red 50/60 Hz)
+ *
+ * Ceros sobre el círculo unidad en ±f0 y polos en el mismo ángulo con radio
+ * r = 1 - π·BW/fs, normalizado a ganancia 1 en DC. A diferencia del notch
+ * de RBJ no degenera en f0 = fs/2, que es donde cae la red cuando se
+ * muestrea a 2× la frecuencia de red. Sin configurar deja pasar la señal.
+ */
+class Notch
+{
+public:
+    // notchHz <= 0 o fuera de (0, fs/2] desactiva el filtro
+    void configure(float sampleHz, float notchHz, float bandwidthHz = 2.0f)
+    {
+        enabled = sampleHz > 0.0f && notchHz > 0.0f && notchHz <= sampleHz * 0.5f;
+        if (!enabled)
+            return;
+
+        float c = cosf(6.2831853f * notchHz / sampleHz);
+        float r = 1.0f - 3.1415927f * bandwidthHz / sampleHz;
+        if (r < 0.5f)
+            r = 0.5f;
+
+        float gain = (1.0f - 2.0f * r * c + r * r) / (2.0f - 2.0f * c);
+        b0 = gain;
+        b1 = -2.0f * c * gain;
+        b2 = gain;
+        a1 = -2.0f * r * c;
+        a2 = r * r;
+        reset();
+    }
+    void disable() { enabled = false; }
+    bool isEnabled() const { return enabled; }
+
+    inline float step(float x)
+    {
+        if (!enabled)
+            return x;
+        if (!primed)
+        {
+            // Arrancar en régimen para una entrada constante
+            x1 = x2 = y1 = y2 = x;
+            primed = true;
+        }
+        float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+        return y;
+    }
+    void reset() { primed = false; }
+
+private:
+    bool enabled = false;
+    bool primed = false;
+    float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+};
+
+/**
+ * @brief Escalera de umbrales: devuelve cuántos umbrales alcanza el valor
+ */
+template <uint8_t N>
+class ThresholdLadder
+{
+public:
+    inline float step(float x)
+    {
+        uint8_t level = 0;
+        while (level < N && x >= thresholds[level])
+        {
+            level++;
+        }
+        return float(level);
+    }
+    void reset() {}
+
+    void setThreshold(uint8_t i, float value)
+    {
+        if (i < N)
+            thresholds[i] = value;
+    }
+
+private:
+    float thresholds[N] = {};
+};
+
+// ============================================================================
+// ETAPAS ESPECÍFICAS DE SENSOR
+// ============================================================================
+
+/**
+ * @brief Voltaje del módulo PH4502C a pH con compensación de temperatura
+ */
+class PhCalib
+{
+public:
+    static constexpr float MIN_SLOPE = 0.05f;
+
+    PhCalib() { recompute(); }
+
+    inline float step(float voltage)
+    {
+        if (voltage < 0.0f)
+            voltage = 0.0f;
+        if (voltage > 5.0f)
+            voltage = 5.0f;
+        return offset - voltage * invSlope;
+    }
+    void reset() {}
+
+    void setCalibration(float vAtPh7, float vPerPh25)
+    {
+        this->vAtPh7 = isfinite(vAtPh7) ? vAtPh7 : 2.50f;
+        this->vPerPh25 = (isfinite(vPerPh25) && vPerPh25 > MIN_SLOPE) ? vPerPh25 : 0.18f;
+        recompute();
+    }
+    void setTemperature(float tempC)
+    {
+        this->tempC = tempC;
+        recompute();
+    }
+
+    // Sensibilidad actual |dpH/dV|
+    float phPerVolt() const { return invSlope; }
+
+private:
+    float vAtPh7 = 2.50f;
+    float vPerPh25 = 0.18f;
+    float tempC = 25.0f;
+    float invSlope = 0.0f; // 1 / pendiente(T)
+    float offset = 7.0f;   // 7 + V@7 / pendiente(T)
+
+    // Solo cuando cambia la calibración o la temperatura
+    void recompute()
+    {
+        // Compensación por temperatura (Nernst)
+        float slopeT = vPerPh25 * ((tempC + 273.15f) / 298.15f);
+        if (slopeT < MIN_SLOPE)
+            slopeT = MIN_SLOPE;
+        invSlope = 1.0f / slopeT;
+        offset = 7.0f + vAtPh7 * invSlope;
+    }
+};
+
+/**
+ * @brief Filtro de Kalman de pH con estado [pH, dpH/dt]
+ *
+ * Modelo de velocidad constante con aceleración aleatoria (q, pH²/s³). El
+ * ruido de medición R no es fijo: el sensor lo estima en cada update a partir
+ * de la dispersión de la ventana ADC (setMeasurementNoise), así que con
+ * lecturas limpias el filtro sigue rápido al pH real y con ruido lo suaviza
+ * más. Acepta float o Q16 para poder ir detrás de PhCalibQ16.
+ */
+class PhKalman
+{
+public:
+    static constexpr float DEFAULT_Q = 3e-7f;     // pH²/s³
+    static constexpr float DEFAULT_R = 4e-4f;     // pH² (σ = 0.02)
+    static constexpr float MIN_R = 1e-6f;
+    static constexpr float SETTLED_RATE = 0.002f; // pH/s (0.12 pH/min)
+
+    inline float step(float ph)
+    {
+        in = ph;
+        if (!primed)
+        {
+            p = ph;
+            r = 0.0f;
+            primed = true;
+            return p;
+        }
+
+        // Predicción
+        float dt2 = dt * dt;
+        p += r * dt;
+        P00 += dt * (2.0f * P01 + dt * P11) + q * dt2 * dt / 3.0f;
+        P01 += dt * P11 + q * dt2 * 0.5f;
+        P11 += q * dt;
+
+        // Corrección
+        float s = P00 + R;
+        float k0 = P00 / s;
+        float k1 = P01 / s;
+        float y = ph - p;
+        p += k0 * y;
+        r += k1 * y;
+        P11 -= k1 * P01;
+        P00 -= k0 * P00;
+        P01 -= k0 * P01;
+        return p;
+    }
+    inline float step(Q16 ph) { return step(asFloat(ph)); }
+
+    void reset()
+    {
+        p = initial;
+        r = 0.0f;
+        P00 = 1.0f;
+        P01 = 0.0f;
+        P11 = 1e-2f;
+        primed = false;
+    }
+
+    // Intervalo hasta la próxima muestra (s)
+    void setInterval(float seconds) { dt = seconds; }
+    void setProcessNoise(float qValue) { q = qValue; }
+    void setMeasurementNoise(float variance) { R = (variance > MIN_R) ? variance : MIN_R; }
+    void setSettledRate(float phPerSec) { settledRate = phPerSec; }
+    void setInitial(float value)
+    {
+        initial = value;
+        reset();
+    }
+
+    float lastInput() const { return in; }
+    float value() const { return p; }
+    float rate() const { return r; }
+    float measurementNoise() const { return R; }
+
+    // Sin tendencia significativa y con la pendiente bien determinada
+    bool isSettled() const
+    {
+        return primed && fabsf(r) < settledRate && sqrtf(P11) < settledRate;
+    }
+
+private:
+    float q = DEFAULT_Q;
+    float R = DEFAULT_R;
+    float dt = 0.5f;
+    float settledRate = SETTLED_RATE;
+    float initial = 7.0f;
+    float in = 7.0f;
+    float p = 7.0f;
+    float r = 0.0f;
+    float P00 = 1.0f;
+    float P01 = 0.0f;
+    float P11 = 1e-2f;
+    bool primed = false;
+};
+
+/**
+ * @brief Voltaje del SEN0244 a ppm (misma fórmula que GravityTDS)
+ */
+class GravityTdsPoly
+{
+public:
+    inline float step(float voltage)
+    {
+        return (133.42f * voltage * voltage * voltage
+                - 255.86f * voltage * voltage
+                + 857.39f * voltage) * coef;
+    }
+    void reset() {}
+
+    void setKValue(float k)
+    {
+        kValue = k;
+        recompute();
+    }
+    void setTemperature(float tempC)
+    {
+        this->tempC = tempC;
+        recompute();
+    }
+
+private:
+    float kValue = 1.0f;
+    float tempC = 25.0f;
+    float coef = 0.5f; // K * 0.5 / (1 + 0.02 (T - 25))
+
+    void recompute() { coef = kValue * 0.5f / (1.0f + 0.02f * (tempC - 25.0f)); }
+};
+
+#endif // SENSOR_PIPELINE_H
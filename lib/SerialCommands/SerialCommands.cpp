@@ -2,16 +2,24 @@
 #include "PHSensor.h"
 #include "PumpController.h"
 #include "TDSSensor.h"
+#include "LDRSensor.h"
+#include "SerialStream.h"
+#include "PerfStage.h"
 
-SerialCommands::SerialCommands() : phSensor(nullptr), pumpController(nullptr), tdsSesor(nullptr)
+SerialCommands::SerialCommands()
+    : phSensor(nullptr), pumpController(nullptr), tdsSesor(nullptr), ldrSensor(nullptr), stream(nullptr),
+      restart(nullptr)
 {
 }
 
-void SerialCommands::begin(PHSensor *phSensor, PumpController *pumpController, TDSSensor *tdsSesor)
+void SerialCommands::begin(PHSensor *phSensor, PumpController *pumpController, TDSSensor *tdsSesor,
+                           LDRSensor *ldrSensor, RestartFn restart)
 {
     this->phSensor = phSensor;
     this->pumpController = pumpController;
     this->tdsSesor = tdsSesor;
+    this->ldrSensor = ldrSensor;
+    this->restart = restart;
 
     Serial.println("SerialCommands: Inicializado");
     printHelp();
@@ -19,152 +27,258 @@ void SerialCommands::begin(PHSensor *phSensor, PumpController *pumpController, T
 
 void SerialCommands::processCommands()
 {
-    if (!Serial.available())
-        return;
+    // Solo lo que ya está en el buffer del UART: una línea a medias espera al próximo loop()
+    int pending = Serial.available();
+    while (pending-- > 0)
+    {
+        int c = Serial.read();
+        if (c < 0)
+            break;
+        if (!parser.feed(char(c)))
+            continue;
+        if (parser.truncated())
+        {
+            Serial.printf("Comando demasiado largo (max %u caracteres)\n", CommandParser::LINE_SIZE - 1);
+            continue;
+        }
+        processLine(parser.line());
+    }
+}
 
-    String command = Serial.readStringUntil('\n');
-    command.trim();
-    command.toUpperCase();
+void SerialCommands::processLine(char *line)
+{
+    // Nombre, firma de argumentos, handler y uso (ver CommandParser)
+    static constexpr CommandParser::Command COMMANDS[] = {
+        {"PHCAL", "f", &cmdPhCal, "PHCAL,7 | PHCAL,4 | PHCAL,10"},
+        {"PHSAVE", "", &cmdPhSave, "PHSAVE"},
+        {"PHRESET", "", &cmdPhReset, "PHRESET"},
+        {"PHEEPRCLR", "", &cmdPhEepromClear, "PHEEPRCLR"},
+        {"SETT", "f", &cmdSetTemperature, "SETT,25.5"},
+        {"PPLUS", "b", &cmdPumpPlus, "PPLUS,ON | PPLUS,OFF"},
+        {"PMINUS", "b", &cmdPumpMinus, "PMINUS,ON | PMINUS,OFF"},
+        {"RELCFG", "w", &cmdRelayConfig, "RELCFG,LOW | RELCFG,HIGH"},
+        {"RESET", "", &cmdReset, "RESET"},
+        {"EMERGENCY", "?b", &cmdEmergency, "EMERGENCY | EMERGENCY,ON | EMERGENCY,OFF"},
+        {"RESUME", "", &cmdResume, "RESUME"},
+        {"NOISE", "", &cmdNoise, "NOISE"},
+        {"STREAM", "b?f", &cmdStream, "STREAM,ON,200 | STREAM,OFF"},
+        {"PERF", "?w", &cmdPerf, "PERF | PERF,RESET"},
+        {"HELP", "", &cmdHelp, "HELP"},
+    };
 
-    processCommand(command);
+    const CommandParser::Command *command;
+    switch (parser.dispatch(line, COMMANDS, this, &command))
+    {
+    case CommandParser::UNKNOWN:
+        Serial.println("Comando no reconocido. Escribe HELP para ver comandos disponibles.");
+        break;
+    case CommandParser::BAD_ARGS:
+        Serial.printf("Uso: %s\n", command->usage);
+        break;
+    default:
+        break;
+    }
 }
 
-void SerialCommands::processCommand(String cmd)
+// ============================================================================
+// HANDLERS
+// ============================================================================
+
+void SerialCommands::cmdPhCal(void *self, const CommandParser::Args &args)
 {
-    if (cmd.startsWith("PHCAL"))
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    if (!s.phSensor)
     {
-        if (!phSensor)
-        {
-            Serial.println("Error: PHSensor no inicializado");
-            return;
-        }
+        Serial.println("Error: PHSensor no inicializado");
+        return;
+    }
 
-        int comma = cmd.indexOf(',');
-        if (comma < 0)
-        {
-            Serial.println("Uso: PHCAL,7 | PHCAL,4 | PHCAL,10");
-            return;
-        }
+    float target = args[0].number;
+    if (target != 4.0f && target != 7.0f && target != 10.0f)
+    {
+        Serial.println("Solo pH 4, 7 o 10 permitidos");
+        return;
+    }
 
-        float target = cmd.substring(comma + 1).toFloat();
-        if (target != 4.0f && target != 7.0f && target != 10.0f)
-        {
-            Serial.println("Solo pH 4, 7 o 10 permitidos");
-            return;
-        }
+    s.phSensor->calibratePoint(target);
+}
 
-        phSensor->calibratePoint(target);
+void SerialCommands::cmdPhSave(void *self, const CommandParser::Args &)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    if (s.phSensor)
+    {
+        s.phSensor->saveCalibration();
     }
-    else if (cmd == "PHSAVE")
+}
+
+void SerialCommands::cmdPhReset(void *self, const CommandParser::Args &)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    if (s.phSensor)
     {
-        if (phSensor)
-        {
-            phSensor->saveCalibration();
-        }
+        s.phSensor->resetCalibration();
     }
-    else if (cmd == "PHRESET")
+}
+
+void SerialCommands::cmdPhEepromClear(void *self, const CommandParser::Args &)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    if (s.phSensor)
     {
-        if (phSensor)
-        {
-            phSensor->resetCalibration();
-        }
+        s.phSensor->clearEEPROM();
     }
-    else if (cmd == "PHEEPRCLR")
+}
+
+void SerialCommands::cmdSetTemperature(void *self, const CommandParser::Args &args)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    float temp = args[0].number;
+    if (temp > -10 && temp < 80)
     {
-        if (phSensor)
-        {
-            phSensor->clearEEPROM();
-        }
+        if (s.phSensor)
+            s.phSensor->setTemperature(temp);
+        if (s.tdsSesor)
+            s.tdsSesor->setTemperature(temp);
+        Serial.printf("Temperatura establecida: %.2f °C\n", temp);
     }
-    else if (cmd.startsWith("SETT,"))
+    else
     {
-        float temp = cmd.substring(5).toFloat();
-        if (temp > -10 && temp < 80)
-        {
-            if (phSensor)
-                phSensor->setTemperature(temp);
-            if (tdsSesor)
-                tdsSesor->setTemperature(temp);
-            Serial.printf("Temperatura establecida: %.2f °C\n", temp);
-        }
-        else
-        {
-            Serial.println("Temperatura fuera de rango (-10 a 80°C)");
-        }
+        Serial.println("Temperatura fuera de rango (-10 a 80°C)");
     }
-    else if (cmd == "PPLUS,ON")
+}
+
+void SerialCommands::cmdPumpPlus(void *self, const CommandParser::Args &args)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    if (s.pumpController)
     {
-        if (pumpController)
-        {
-            pumpController->forcePumpPlus(true);
-        }
+        s.pumpController->forcePumpPlus(args[0].on);
     }
-    else if (cmd == "PPLUS,OFF")
+}
+
+void SerialCommands::cmdPumpMinus(void *self, const CommandParser::Args &args)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    if (s.pumpController)
     {
-        if (pumpController)
-        {
-            pumpController->forcePumpPlus(false);
-        }
+        s.pumpController->forcePumpMinus(args[0].on);
     }
-    else if (cmd == "PMINUS,ON")
+}
+
+void SerialCommands::cmdRelayConfig(void *self, const CommandParser::Args &args)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    bool activeLow = strcmp(args[0].text, "LOW") == 0;
+    if (!activeLow && strcmp(args[0].text, "HIGH") != 0)
     {
-        if (pumpController)
-        {
-            pumpController->forcePumpMinus(true);
-        }
+        Serial.println("Uso: RELCFG,LOW | RELCFG,HIGH");
+        return;
     }
-    else if (cmd == "PMINUS,OFF")
+    if (s.pumpController)
     {
-        if (pumpController)
-        {
-            pumpController->forcePumpMinus(false);
-        }
+        s.pumpController->setRelayLogic(activeLow);
+        Serial.println(activeLow ? "Relés configurados: LOW = ON" : "Relés configurados: HIGH = ON");
     }
-    else if (cmd == "RELCFG,LOW")
+}
+
+void SerialCommands::cmdReset(void *self, const CommandParser::Args &)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    Serial.println("\n⚠️ COMANDO DE REINICIO RECIBIDO");
+    // El loop() no se detiene: quien programa el reinicio decide cuándo y vacía el log antes
+    if (s.restart)
     {
-        if (pumpController)
-        {
-            pumpController->setRelayLogic(true);
-            Serial.println("Relés configurados: LOW = ON");
-        }
+        s.restart();
+        return;
     }
-    else if (cmd == "RELCFG,HIGH")
+    ESP.restart();
+}
+
+void SerialCommands::cmdEmergency(void *self, const CommandParser::Args &args)
+{
+    // EMERGENCY sin argumento equivale a EMERGENCY,ON
+    if (args.count && !args[0].on)
     {
-        if (pumpController)
-        {
-            pumpController->setRelayLogic(false);
-            Serial.println("Relés configurados: HIGH = ON");
-        }
+        cmdResume(self, args);
+        return;
     }
-    else if (cmd == "RESET")
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    if (s.pumpController)
     {
-        Serial.println("\n⚠️ COMANDO DE REINICIO RECIBIDO");
-        Serial.println("Reiniciando ESP32 en 1 segundo...");
-        delay(1000);
-        ESP.restart();
+        s.pumpController->emergencyStop();
     }
-    else if (cmd == "EMERGENCY" || cmd == "EMERGENCY,ON")
+}
+
+void SerialCommands::cmdResume(void *self, const CommandParser::Args &)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    if (s.pumpController)
     {
-        if (pumpController)
-        {
-            pumpController->emergencyStop();
-        }
+        s.pumpController->emergencyResume();
     }
-    else if (cmd == "EMERGENCY,OFF" || cmd == "RESUME")
+}
+
+void SerialCommands::cmdNoise(void *self, const CommandParser::Args &)
+{
+    static_cast<SerialCommands *>(self)->printNoise();
+}
+
+void SerialCommands::cmdStream(void *self, const CommandParser::Args &args)
+{
+    SerialCommands &s = *static_cast<SerialCommands *>(self);
+    if (!s.stream)
     {
-        if (pumpController)
-        {
-            pumpController->emergencyResume();
-        }
+        Serial.println("Error: Stream binario no disponible");
+        return;
     }
-    else if (cmd == "HELP")
+
+    if (!args[0].on)
     {
-        printHelp();
+        s.stream->stop();
+        const SerialStream::Stats &st = s.stream->getStats();
+        Serial.printf("Stream binario detenido: %lu tramas, %lu omitidas (UART lleno)\n", (unsigned long)st.frames,
+                      (unsigned long)st.skipped);
+        return;
     }
-    else
+
+    float hz = args.count > 1 ? args[1].number : SerialStream::DEFAULT_HZ;
+    if (hz < 1.0f || hz > SerialStream::MAX_HZ)
     {
-        Serial.println("Comando no reconocido. Escribe HELP para ver comandos disponibles.");
+        Serial.printf("Frecuencia fuera de rango (1 a %u Hz)\n", SerialStream::MAX_HZ);
+        return;
+    }
+    // El aviso sale antes de la primera trama
+    Serial.printf("Stream binario: %u Hz, tramas COBS de %u bytes (tools/decode_stream.cpp)\n", (unsigned)hz,
+                  (unsigned)StreamFrame::MAX_FRAME);
+    s.stream->start((uint16_t)hz);
+}
+
+void SerialCommands::cmdPerf(void *self, const CommandParser::Args &args)
+{
+#if PERF_ENABLED
+    if (args.count > 0)
+    {
+        if (strcmp(args[0].text, "RESET") != 0)
+        {
+            Serial.println("Uso: PERF | PERF,RESET");
+            return;
+        }
+        PerfStage::resetAll();
+        Serial.println("Latencias reiniciadas");
+        return;
     }
+    static_cast<SerialCommands *>(self)->printPerf();
+#else
+    (void)self;
+    (void)args;
+    Serial.println("Medición de latencia desactivada (-DPERF_ENABLED=0)");
+#endif
+}
+
+void SerialCommands::cmdHelp(void *self, const CommandParser::Args &)
+{
+    static_cast<SerialCommands *>(self)->printHelp();
 }
 
 void SerialCommands::printHelp()
@@ -193,6 +307,52 @@ void SerialCommands::printHelp()
     Serial.println("  RESET      - Reiniciar ESP32");
     Serial.println("  EMERGENCY  - Activar parada de emergencia");
     Serial.println("  RESUME     - Desactivar parada de emergencia");
+    Serial.println("  NOISE      - Ruido y muestras por canal");
+    Serial.println("  STREAM,ON,200 - Registros binarios a 200 Hz");
+    Serial.println("  STREAM,OFF - Volver al texto");
+    Serial.println("  PERF       - Latencia por etapa (p50/p99/max)");
+    Serial.println("  PERF,RESET - Reiniciar las latencias");
     Serial.println("  HELP       - Mostrar esta ayuda");
     Serial.println("===============================\n");
-}
\ No newline at end of file
+}
+
+static void printBudget(const char *name, const OversampleBudget &budget, float rateHz)
+{
+    const float mvPerCount = 3300.0f / 4095.0f;
+    uint8_t n = budget.samples();
+    float sigma = budget.statistics().stddev();
+    float error = budget.standardError(n);
+    Serial.printf("  %-4s σ=%6.2f  n=%2u (%u-%u)  %6.1f Hz  error=%5.2f cuentas (%5.2f mV)  objetivo=%.2f %s\n",
+                  name, sigma, n, budget.minSamples(), budget.maxSamples(), rateHz,
+                  error, error * mvPerCount, budget.getTarget(),
+                  error <= budget.getTarget() ? "OK" : "LIMITADO");
+}
+
+void SerialCommands::printNoise()
+{
+    Serial.println("\n=== SOBREMUESTREO ADAPTATIVO ===");
+    if (phSensor)
+        printBudget("pH", phSensor->getOversampling(), phSensor->getSampleRate());
+    if (tdsSesor)
+        printBudget("TDS", tdsSesor->getOversampling(), tdsSesor->getSampleRate());
+    if (ldrSensor)
+        printBudget("LDR", ldrSensor->getOversampling(), ldrSensor->getSampleRate());
+    Serial.println("===============================\n");
+}
+
+void SerialCommands::printPerf()
+{
+    Serial.println("\n=== LATENCIA POR ETAPA ===");
+    if (!PerfStage::first())
+    {
+        Serial.println("  Sin etapas medidas");
+        return;
+    }
+    for (const PerfStage *st = PerfStage::first(); st; st = st->getNext())
+    {
+        Serial.printf("  %-9s %8lu  media %9.1f  p50 %9.1f  p99 %9.1f  max %9.1f us\n", st->getName(),
+                      (unsigned long)st->getCount(), st->meanUs(), PerfStage::toUs(st->percentileTicks(500)),
+                      PerfStage::toUs(st->percentileTicks(990)), PerfStage::toUs(st->getMaxTicks()));
+    }
+    Serial.println("  (p50/p99: cota superior de la cubeta, hasta +50%)");
+}
@@ -2,6 +2,7 @@
 #define SERIAL_COMMANDS_H
 
 #include <Arduino.h>
+#include "CommandParser.h"
 
 // Forward declarations
 class PHSensor;
@@ -9,26 +10,65 @@ class PumpController;
 class TDSSensor;
 class LevelSensor;
 class LDRSensor;
+class SerialStream;
 
+/**
+ * @brief Comandos de calibración y control por el monitor serie
+ *
+ * processCommands() lee solo lo que ya llegó (nunca espera una línea
+ * incompleta) y despacha por la tabla de comandos de processLine().
+ */
 class SerialCommands
 {
 public:
+    // Programa el reinicio sin esperar (RESET); sin ella RESET reinicia en el acto
+    typedef void (*RestartFn)();
+
     // Constructor
     SerialCommands();
 
     // Inicialización con referencias a los módulos
-    void begin(PHSensor *phSensor, PumpController *pumpController, TDSSensor *tdsSesor);
+    void begin(PHSensor *phSensor, PumpController *pumpController, TDSSensor *tdsSesor,
+               LDRSensor *ldrSensor = nullptr, RestartFn restart = nullptr);
+
+    // STREAM,ON,<hz> / STREAM,OFF (sin esto el comando responde que no está disponible)
+    void attachStream(SerialStream *stream) { this->stream = stream; }
 
-    // Procesamiento de comandos
+    // Procesamiento de comandos (no bloquea)
     void processCommands();
 
+    const CommandParser::Stats &getStats() const { return parser.getStats(); }
+
 private:
     PHSensor *phSensor;
     PumpController *pumpController;
     TDSSensor *tdsSesor;
+    LDRSensor *ldrSensor;
+    SerialStream *stream;
+    RestartFn restart;
+    CommandParser parser;
 
-    void processCommand(String command);
+    void processLine(char *line);
     void printHelp();
+    void printNoise();
+    void printPerf();
+
+    // Handlers de la tabla (self es el SerialCommands)
+    static void cmdPhCal(void *self, const CommandParser::Args &args);
+    static void cmdPhSave(void *self, const CommandParser::Args &args);
+    static void cmdPhReset(void *self, const CommandParser::Args &args);
+    static void cmdPhEepromClear(void *self, const CommandParser::Args &args);
+    static void cmdSetTemperature(void *self, const CommandParser::Args &args);
+    static void cmdPumpPlus(void *self, const CommandParser::Args &args);
+    static void cmdPumpMinus(void *self, const CommandParser::Args &args);
+    static void cmdRelayConfig(void *self, const CommandParser::Args &args);
+    static void cmdReset(void *self, const CommandParser::Args &args);
+    static void cmdEmergency(void *self, const CommandParser::Args &args);
+    static void cmdResume(void *self, const CommandParser::Args &args);
+    static void cmdNoise(void *self, const CommandParser::Args &args);
+    static void cmdStream(void *self, const CommandParser::Args &args);
+    static void cmdPerf(void *self, const CommandParser::Args &args);
+    static void cmdHelp(void *self, const CommandParser::Args &args);
 };
 
 #endif // SERIAL_COMMANDS_H
\ No newline at end of file
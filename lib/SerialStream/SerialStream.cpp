@@ -0,0 +1,40 @@
+#include "SerialStream.h"
+
+SerialStream::SerialStream() : active(false), rateHz(DEFAULT_HZ), seq(0)
+{
+}
+
+void SerialStream::start(uint16_t hz)
+{
+    if (hz < 1)
+        hz = 1;
+    if (hz > MAX_HZ)
+        hz = MAX_HZ;
+    rateHz = hz;
+    seq = 0;
+    stats = Stats();
+    active = true;
+}
+
+void SerialStream::stop()
+{
+    active = false;
+}
+
+bool SerialStream::send(StreamFrame::Record &record)
+{
+    record.seq = seq++;
+    if (!record.timeUs)
+        record.timeUs = micros();
+
+    uint8_t frame[StreamFrame::MAX_FRAME];
+    size_t len = StreamFrame::encode(record, frame, sizeof(frame));
+    if (Serial.availableForWrite() < (int)len)
+    {
+        stats.skipped++;
+        return false;
+    }
+    Serial.write(frame, len);
+    stats.frames++;
+    return true;
+}
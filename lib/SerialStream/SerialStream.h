@@ -0,0 +1,58 @@
+#ifndef SERIAL_STREAM_H
+#define SERIAL_STREAM_H
+
+#include <Arduino.h>
+#include "StreamFrame.h"
+
+/**
+ * @brief Modo STREAM: registros binarios por Serial a frecuencia fija
+ *
+ * Reemplaza leer el texto del estado del sistema (cada 5 s) o cargar los
+ * sketches de test/ para capturar datos en banco. Con STREAM,ON,<hz> una
+ * tarea del Scheduler con período getPeriodUs() arma un StreamFrame::Record
+ * y send() lo escribe como trama COBS con CRC; tools/decode_stream.cpp lo
+ * pasa a CSV o a columnas.
+ *
+ * send() nunca espera al UART: si la trama no entra en el FIFO de TX se
+ * omite y se cuenta (el salto de seq lo muestra el decodificador). A
+ * 115200 baudios entran unas 290 tramas/s; para más, subir el baudrate.
+ *
+ *   if (serialStream.isActive()) {
+ *       StreamFrame::Record r; // ADC, filtrados, niveles, relés, tiempos
+ *       serialStream.send(r);  // Cada getPeriodUs()
+ *   }
+ */
+class SerialStream
+{
+public:
+    static constexpr uint16_t MAX_HZ = 500;
+    static constexpr uint16_t DEFAULT_HZ = 100;
+
+    struct Stats
+    {
+        uint32_t frames = 0;  // Escritas desde STREAM,ON
+        uint32_t skipped = 0; // Sin lugar en el FIFO de TX
+    };
+
+    SerialStream();
+
+    // hz se limita a 1..MAX_HZ; reinicia seq y las estadísticas
+    void start(uint16_t hz);
+    void stop();
+    bool isActive() const { return active; }
+    uint16_t getRate() const { return rateHz; }
+    uint32_t getPeriodUs() const { return 1000000UL / rateHz; }
+
+    // Completa seq y timeUs (si es 0) y escribe la trama; false si se omitió
+    bool send(StreamFrame::Record &record);
+
+    const Stats &getStats() const { return stats; }
+
+private:
+    bool active;
+    uint16_t rateHz;
+    uint32_t seq;
+    Stats stats;
+};
+
+#endif // SERIAL_STREAM_H
@@ -0,0 +1,168 @@
+#include "StreamFrame.h"
+#include <string.h>
+
+namespace
+{
+    // Little-endian explícito: igual en el ESP32 y en cualquier host
+    uint8_t *put16(uint8_t *p, uint16_t v)
+    {
+        p[0] = uint8_t(v);
+        p[1] = uint8_t(v >> 8);
+        return p + 2;
+    }
+
+    uint8_t *put32(uint8_t *p, uint32_t v)
+    {
+        for (uint8_t i = 0; i < 4; i++)
+            p[i] = uint8_t(v >> (8 * i));
+        return p + 4;
+    }
+
+    uint8_t *putFloat(uint8_t *p, float v)
+    {
+        uint32_t bits;
+        memcpy(&bits, &v, sizeof(bits));
+        return put32(p, bits);
+    }
+
+    uint16_t get16(const uint8_t *&p)
+    {
+        uint16_t v = uint16_t(p[0] | (p[1] << 8));
+        p += 2;
+        return v;
+    }
+
+    uint32_t get32(const uint8_t *&p)
+    {
+        uint32_t v = 0;
+        for (uint8_t i = 0; i < 4; i++)
+            v |= uint32_t(p[i]) << (8 * i);
+        p += 4;
+        return v;
+    }
+
+    float getFloat(const uint8_t *&p)
+    {
+        uint32_t bits = get32(p);
+        float v;
+        memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+}
+
+uint16_t StreamFrame::crc16(const uint8_t *data, size_t len)
+{
+    // CRC-16/CCITT-FALSE (0x1021, inicial 0xFFFF), bit a bit: 37 bytes por trama
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= uint16_t(data[i]) << 8;
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x1021) : uint16_t(crc << 1);
+    }
+    return crc;
+}
+
+size_t StreamFrame::cobsEncode(const uint8_t *in, size_t len, uint8_t *out, size_t cap)
+{
+    if (cap < len + len / 254 + 1)
+        return 0;
+    size_t codePos = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++)
+    {
+        if (in[i])
+        {
+            out[o++] = in[i];
+            code++;
+        }
+        if (!in[i] || code == 0xFF)
+        {
+            out[codePos] = code;
+            codePos = o++;
+            code = 1;
+        }
+    }
+    out[codePos] = code;
+    return o;
+}
+
+size_t StreamFrame::cobsDecode(const uint8_t *in, size_t len, uint8_t *out, size_t cap)
+{
+    size_t o = 0;
+    for (size_t i = 0; i < len;)
+    {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > len)
+            return 0;
+        for (uint8_t k = 1; k < code; k++)
+        {
+            if (o >= cap || in[i] == 0)
+                return 0;
+            out[o++] = in[i++];
+        }
+        // Cada bloque de menos de 254 datos termina en un cero implícito (salvo el último)
+        if (code < 0xFF && i < len)
+        {
+            if (o >= cap)
+                return 0;
+            out[o++] = 0;
+        }
+    }
+    return o;
+}
+
+size_t StreamFrame::encode(const Record &r, uint8_t *out, size_t cap)
+{
+    uint8_t raw[PAYLOAD_SIZE + CRC_SIZE];
+    uint8_t *p = raw;
+    *p++ = VERSION;
+    p = put32(p, r.seq);
+    p = put32(p, r.timeUs);
+    p = put16(p, r.rawPh);
+    p = put16(p, r.rawTds);
+    p = put16(p, r.rawLdr);
+    p = putFloat(p, r.ph);
+    p = putFloat(p, r.tds);
+    p = put16(p, r.ldr);
+    *p++ = r.levels;
+    *p++ = r.relays;
+    p = put32(p, r.loopMaxUs);
+    p = put32(p, r.controlLateUs);
+    put16(p, crc16(raw, PAYLOAD_SIZE));
+
+    if (cap < 2)
+        return 0;
+    out[0] = 0;
+    size_t n = cobsEncode(raw, sizeof(raw), out + 1, cap - 2);
+    if (!n)
+        return 0;
+    out[1 + n] = 0;
+    return n + 2;
+}
+
+bool StreamFrame::decode(const uint8_t *in, size_t len, Record &r)
+{
+    uint8_t raw[PAYLOAD_SIZE + CRC_SIZE + 1];
+    if (cobsDecode(in, len, raw, sizeof(raw)) != PAYLOAD_SIZE + CRC_SIZE)
+        return false;
+    const uint8_t *crc = raw + PAYLOAD_SIZE;
+    if (raw[0] != VERSION || crc16(raw, PAYLOAD_SIZE) != get16(crc))
+        return false;
+
+    const uint8_t *p = raw + 1;
+    r.seq = get32(p);
+    r.timeUs = get32(p);
+    r.rawPh = get16(p);
+    r.rawTds = get16(p);
+    r.rawLdr = get16(p);
+    r.ph = getFloat(p);
+    r.tds = getFloat(p);
+    r.ldr = get16(p);
+    r.levels = *p++;
+    r.relays = *p++;
+    r.loopMaxUs = get32(p);
+    r.controlLateUs = get32(p);
+    return true;
+}
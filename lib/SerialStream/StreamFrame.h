@@ -0,0 +1,75 @@
+#ifndef STREAM_FRAME_H
+#define STREAM_FRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Trama binaria del modo STREAM: registro fijo, CRC-16 y COBS
+ *
+ * No depende de Arduino: el mismo código arma las tramas en el ESP32 y las
+ * lee en tools/decode_stream.cpp.
+ *
+ * Registro (little-endian, PAYLOAD_SIZE bytes):
+ *
+ *   versión (8) | seq (32) | t_us (32) | ADC pH, TDS, LDR (3×16) |
+ *   pH filtrado (f32) | TDS ppm (f32) | LDR (16) | niveles (8) | relés (8) |
+ *   loop máx us (32) | retraso control us (32)
+ *
+ * Al registro se le suma el CRC-16/CCITT-FALSE (2 bytes, little-endian) y el
+ * conjunto se codifica con COBS, que elimina los 0x00; la trama va entre dos
+ * 0x00. Un mensaje de texto que se cuele entre tramas queda en su propio
+ * tramo y lo descarta el CRC, sin arrastrar la trama siguiente.
+ *
+ *   uint8_t frame[StreamFrame::MAX_FRAME];
+ *   size_t len = StreamFrame::encode(record, frame, sizeof(frame));
+ *   Serial.write(frame, len);
+ */
+class StreamFrame
+{
+public:
+    static constexpr uint8_t VERSION = 1;
+
+    // Bits de Record::levels
+    static constexpr uint8_t LEVEL_PH_MINUS_OK = 0x01;
+    static constexpr uint8_t LEVEL_PH_PLUS_OK = 0x02;
+
+    // Bits de Record::relays
+    static constexpr uint8_t PUMP_CIRCULATION_ON = 0x01;
+    static constexpr uint8_t PUMP_PH_MINUS_ON = 0x02;
+    static constexpr uint8_t PUMP_PH_PLUS_ON = 0x04;
+    static constexpr uint8_t EMERGENCY_STOP = 0x80;
+
+    struct Record
+    {
+        uint32_t seq = 0;           // Consecutivo desde STREAM,ON: un salto es una trama perdida
+        uint32_t timeUs = 0;        // micros() al tomar la muestra
+        uint16_t rawPh = 0;         // ADC (0-4095)
+        uint16_t rawTds = 0;
+        uint16_t rawLdr = 0;
+        float ph = 0.0f;            // Filtrados (cambian al ritmo de cada sensor)
+        float tds = 0.0f;           // ppm
+        uint16_t ldr = 0;
+        uint8_t levels = 0;         // LEVEL_*
+        uint8_t relays = 0;         // PUMP_* y EMERGENCY_STOP
+        uint32_t loopMaxUs = 0;     // Pasada más larga del loop() (sin la espera) desde el registro anterior
+        uint32_t controlLateUs = 0; // Retraso del último ciclo de control
+    };
+
+    static constexpr size_t PAYLOAD_SIZE = 35;
+    static constexpr size_t CRC_SIZE = 2;
+    // Delimitador + COBS (1 byte de código cada 254) + delimitador
+    static constexpr size_t MAX_FRAME = 1 + (PAYLOAD_SIZE + CRC_SIZE) + (PAYLOAD_SIZE + CRC_SIZE) / 254 + 1 + 1;
+
+    // Trama completa con sus dos 0x00; bytes escritos o 0 si out no alcanza
+    static size_t encode(const Record &record, uint8_t *out, size_t cap);
+    // Contenido entre dos 0x00 (sin ellos); false si COBS, largo, versión o CRC no coinciden
+    static bool decode(const uint8_t *in, size_t len, Record &record);
+
+    static uint16_t crc16(const uint8_t *data, size_t len);
+    // COBS: largo escrito, o 0 si no cabe / la entrada no es COBS válido
+    static size_t cobsEncode(const uint8_t *in, size_t len, uint8_t *out, size_t cap);
+    static size_t cobsDecode(const uint8_t *in, size_t len, uint8_t *out, size_t cap);
+};
+
+#endif // STREAM_FRAME_H
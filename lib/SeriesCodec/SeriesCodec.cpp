@@ -0,0 +1,438 @@
+#include "SeriesCodec.h"
+#include <string.h>
+
+namespace
+{
+    const char BASE64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    int base64Value(char c)
+    {
+        if (c >= 'A' && c <= 'Z')
+            return c - 'A';
+        if (c >= 'a' && c <= 'z')
+            return c - 'a' + 26;
+        if (c >= '0' && c <= '9')
+            return c - '0' + 52;
+        if (c == '+')
+            return 62;
+        if (c == '/')
+            return 63;
+        return -1;
+    }
+
+    uint32_t floatBits(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float bitsFloat(uint32_t bits)
+    {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    uint8_t leadingZeros(uint32_t x)
+    {
+        uint8_t n = 0;
+        for (uint32_t bit = 0x80000000u; bit && !(x & bit); bit >>= 1)
+            n++;
+        return n;
+    }
+
+    uint8_t trailingZeros(uint32_t x)
+    {
+        uint8_t n = 0;
+        for (uint32_t bit = 1; bit && !(x & bit); bit <<= 1)
+            n++;
+        return n;
+    }
+
+    // Tramos del delta-de-delta: prefijo, bits del prefijo, bits del valor, desplazamiento
+    struct Bucket
+    {
+        uint8_t prefix;
+        uint8_t prefixBits;
+        uint8_t valueBits;
+        int32_t offset; // Valor guardado = dod + offset (sin signo)
+    };
+    const Bucket BUCKETS[] = {
+        {0b10, 2, 7, 63},
+        {0b110, 3, 9, 255},
+        {0b1110, 4, 12, 2047},
+    };
+
+    uint64_t widthMask(uint8_t bits) { return bits >= 64 ? ~uint64_t(0) : (uint64_t(1) << bits) - 1; }
+
+    // Valor de bits bits con signo, extendido a 64
+    int64_t signExtend(uint64_t value, uint8_t bits)
+    {
+        if (bits < 64 && (value >> (bits - 1)) & 1)
+            value |= ~widthMask(bits);
+        return int64_t(value);
+    }
+}
+
+// ============================================================================
+// FLUJO DE BITS
+// ============================================================================
+
+SeriesCodec::BitWriter::BitWriter(uint8_t *buf, size_t cap) : buf(buf), cap(cap), bitPos(0), full(false)
+{
+}
+
+void SeriesCodec::BitWriter::write(uint64_t value, uint8_t bits)
+{
+    if (full || bitPos + bits > cap * 8)
+    {
+        full = true;
+        return;
+    }
+    while (bits)
+    {
+        size_t byte = bitPos / 8;
+        uint8_t used = bitPos % 8;
+        if (!used)
+            buf[byte] = 0;
+        uint8_t take = 8 - used < bits ? 8 - used : bits;
+        uint8_t chunk = uint8_t((value >> (bits - take)) & ((1u << take) - 1));
+        buf[byte] |= uint8_t(chunk << (8 - used - take));
+        bitPos += take;
+        bits -= take;
+    }
+}
+
+SeriesCodec::BitReader::BitReader(const uint8_t *buf, size_t len) : buf(buf), len(len), bitPos(0), past(false)
+{
+}
+
+uint64_t SeriesCodec::BitReader::read(uint8_t bits)
+{
+    if (past || bitPos + bits > len * 8)
+    {
+        past = true;
+        return 0;
+    }
+    uint64_t value = 0;
+    while (bits)
+    {
+        uint8_t used = bitPos % 8;
+        uint8_t take = 8 - used < bits ? 8 - used : bits;
+        uint8_t chunk = uint8_t(buf[bitPos / 8] >> (8 - used - take)) & uint8_t((1u << take) - 1);
+        value = (value << take) | chunk;
+        bitPos += take;
+        bits -= take;
+    }
+    return value;
+}
+
+// ============================================================================
+// TIEMPOS: DELTA-DE-DELTA
+// ============================================================================
+
+void SeriesCodec::TimeEncoder::write(BitWriter &w, uint64_t t)
+{
+    uint64_t mask = widthMask(bits);
+    t &= mask;
+    if (!started)
+    {
+        w.write(t, bits);
+        prev = t;
+        started = true;
+        return;
+    }
+    uint64_t delta = (t - prev) & mask;
+    int64_t dod = signExtend((delta - prevDelta) & mask, bits);
+    prev = t;
+    prevDelta = delta;
+
+    if (dod == 0)
+    {
+        w.write(0, 1);
+        return;
+    }
+    for (const Bucket &b : BUCKETS)
+    {
+        int64_t max = int64_t(1) << b.valueBits;
+        if (dod >= -b.offset && dod < max - b.offset)
+        {
+            w.write(b.prefix, b.prefixBits);
+            w.write(uint64_t(dod + b.offset), b.valueBits);
+            return;
+        }
+    }
+    w.write(0b1111, 4);
+    w.write(uint64_t(dod) & mask, bits);
+}
+
+uint64_t SeriesCodec::TimeDecoder::read(BitReader &r)
+{
+    uint64_t mask = widthMask(bits);
+    if (!started)
+    {
+        prev = r.read(bits);
+        started = true;
+        return prev;
+    }
+    uint64_t dod = 0;
+    if (r.read(1))
+    {
+        // Cuenta de unos del prefijo: 1 → '10', 2 → '110', 3 → '1110', 4 → '1111'
+        uint8_t ones = 1;
+        while (ones < 4 && r.read(1))
+            ones++;
+        if (ones == 4)
+        {
+            dod = r.read(bits);
+        }
+        else
+        {
+            const Bucket &b = BUCKETS[ones - 1];
+            dod = uint64_t(int64_t(r.read(b.valueBits)) - b.offset);
+        }
+    }
+    prevDelta = (prevDelta + dod) & mask;
+    prev = (prev + prevDelta) & mask;
+    return prev;
+}
+
+// ============================================================================
+// FLOATS: XOR (GORILLA)
+// ============================================================================
+
+void SeriesCodec::FloatEncoder::write(BitWriter &w, float value)
+{
+    uint32_t bits = floatBits(value);
+    if (!started)
+    {
+        w.write(bits, 32);
+        prev = bits;
+        started = true;
+        return;
+    }
+    uint32_t x = bits ^ prev;
+    prev = bits;
+    if (!x)
+    {
+        w.write(0, 1);
+        return;
+    }
+
+    uint8_t lz = leadingZeros(x);
+    uint8_t tz = trailingZeros(x);
+    if (leading != 0xFF && lz >= leading && tz >= trailing)
+    {
+        // Cabe en la ventana anterior: no se repiten ceros ni largo
+        w.write(0b10, 2);
+        w.write(x >> trailing, 32 - leading - trailing);
+        return;
+    }
+    if (lz > 31)
+        lz = 31;
+    uint8_t meaningful = 32 - lz - tz;
+    w.write(0b11, 2);
+    w.write(lz, 5);
+    w.write(meaningful - 1, 5);
+    w.write(x >> tz, meaningful);
+    leading = lz;
+    trailing = tz;
+}
+
+float SeriesCodec::FloatDecoder::read(BitReader &r)
+{
+    if (!started)
+    {
+        prev = uint32_t(r.read(32));
+        started = true;
+        return bitsFloat(prev);
+    }
+    if (!r.read(1))
+        return bitsFloat(prev);
+
+    if (r.read(1))
+    {
+        leading = uint8_t(r.read(5));
+        uint8_t meaningful = uint8_t(r.read(5)) + 1;
+        if (leading + meaningful > 32)
+            meaningful = 32 - leading; // Bloque corrupto: no desplazar fuera de rango
+        trailing = 32 - leading - meaningful;
+    }
+    uint8_t meaningful = 32 - leading - trailing;
+    prev ^= uint32_t(r.read(meaningful)) << trailing;
+    return bitsFloat(prev);
+}
+
+// ============================================================================
+// ENTEROS: DELTA + ZIGZAG + VARINT
+// ============================================================================
+
+void SeriesCodec::IntEncoder::write(BitWriter &w, int32_t value)
+{
+    int64_t delta = int64_t(value) - prev;
+    prev = value;
+    uint64_t zz = (uint64_t(delta) << 1) ^ uint64_t(delta >> 63);
+    do
+    {
+        uint8_t group = zz & 0x7F;
+        zz >>= 7;
+        w.write(group | (zz ? 0x80 : 0), 8);
+    } while (zz);
+}
+
+int32_t SeriesCodec::IntDecoder::read(BitReader &r)
+{
+    uint64_t zz = 0;
+    for (uint8_t shift = 0; shift < 35; shift += 7)
+    {
+        uint8_t group = uint8_t(r.read(8));
+        zz |= uint64_t(group & 0x7F) << shift;
+        if (!(group & 0x80))
+            break;
+    }
+    int64_t delta = int64_t(zz >> 1) ^ -int64_t(zz & 1);
+    prev = int32_t(int64_t(prev) + delta);
+    return prev;
+}
+
+// ============================================================================
+// BLOQUE TIEMPO / SEQ / pH / TDS / LDR
+// ============================================================================
+
+size_t SeriesCodec::encode(const Sample *samples, uint8_t count, uint32_t bootId, uint8_t *out, size_t cap)
+{
+    BitWriter w(out, cap);
+    w.write(VERSION, 8);
+    w.write(count, 8);
+    w.write(bootId, 32);
+
+    // Una serie detrás de otra: cada una comprime mejor con sus vecinas
+    TimeEncoder time(64);
+    for (uint8_t i = 0; i < count; i++)
+        time.write(w, samples[i].time);
+    TimeEncoder seq(32);
+    for (uint8_t i = 0; i < count; i++)
+        seq.write(w, samples[i].seq);
+    FloatEncoder ph;
+    for (uint8_t i = 0; i < count; i++)
+        ph.write(w, samples[i].ph);
+    FloatEncoder tds;
+    for (uint8_t i = 0; i < count; i++)
+        tds.write(w, samples[i].tds);
+    IntEncoder ldr;
+    for (uint8_t i = 0; i < count; i++)
+        ldr.write(w, samples[i].ldr);
+
+    return w.overflow() ? 0 : w.bytes();
+}
+
+uint8_t SeriesCodec::decode(const uint8_t *in, size_t len, Sample *out, uint8_t max, uint32_t *bootId)
+{
+    BitReader r(in, len);
+    uint8_t version = uint8_t(r.read(8));
+    if (version != VERSION && version != VERSION_V1)
+        return 0;
+    uint8_t count = uint8_t(r.read(8));
+    uint32_t boot = version == VERSION ? uint32_t(r.read(32)) : 0;
+    if (count > max || r.error())
+        return 0;
+
+    if (version == VERSION)
+    {
+        TimeDecoder time(64);
+        for (uint8_t i = 0; i < count; i++)
+            out[i].time = time.read(r);
+        TimeDecoder seq(32);
+        for (uint8_t i = 0; i < count; i++)
+            out[i].seq = uint32_t(seq.read(r));
+    }
+    else
+    {
+        // Versión 1: segundos de 32 bits, sin secuencia
+        TimeDecoder time(32);
+        for (uint8_t i = 0; i < count; i++)
+        {
+            out[i].time = time.read(r) * 1000ULL;
+            out[i].seq = 0;
+        }
+    }
+    FloatDecoder ph;
+    for (uint8_t i = 0; i < count; i++)
+        out[i].ph = ph.read(r);
+    FloatDecoder tds;
+    for (uint8_t i = 0; i < count; i++)
+        out[i].tds = tds.read(r);
+    IntDecoder ldr;
+    for (uint8_t i = 0; i < count; i++)
+        out[i].ldr = ldr.read(r);
+
+    if (r.error())
+        return 0;
+    if (bootId)
+        *bootId = boot;
+    return count;
+}
+
+// ============================================================================
+// BASE64
+// ============================================================================
+
+size_t SeriesCodec::base64Encode(const uint8_t *data, size_t len, char *out, size_t cap)
+{
+    size_t need = base64Len(len);
+    if (need + 1 > cap)
+        return 0;
+    size_t o = 0;
+    for (size_t i = 0; i < len; i += 3)
+    {
+        uint32_t v = uint32_t(data[i]) << 16;
+        if (i + 1 < len)
+            v |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < len)
+            v |= data[i + 2];
+        out[o++] = BASE64[(v >> 18) & 0x3F];
+        out[o++] = BASE64[(v >> 12) & 0x3F];
+        out[o++] = i + 1 < len ? BASE64[(v >> 6) & 0x3F] : '=';
+        out[o++] = i + 2 < len ? BASE64[v & 0x3F] : '=';
+    }
+    out[o] = '\0';
+    return o;
+}
+
+size_t SeriesCodec::base64Decode(const char *text, uint8_t *out, size_t cap)
+{
+    size_t o = 0;
+    uint32_t v = 0;
+    uint8_t n = 0;
+    for (const char *p = text; *p && *p != '='; p++)
+    {
+        int d = base64Value(*p);
+        if (d < 0)
+            return 0;
+        v = (v << 6) | uint32_t(d);
+        if (++n == 4)
+        {
+            if (o + 3 > cap)
+                return 0;
+            out[o++] = uint8_t(v >> 16);
+            out[o++] = uint8_t(v >> 8);
+            out[o++] = uint8_t(v);
+            v = 0;
+            n = 0;
+        }
+    }
+    // Cola de 2 o 3 caracteres: 1 o 2 bytes
+    if (n == 1)
+        return 0;
+    if (n)
+    {
+        if (o + n - 1 > cap)
+            return 0;
+        v <<= 6 * (4 - n);
+        out[o++] = uint8_t(v >> 16);
+        if (n == 3)
+            out[o++] = uint8_t(v >> 8);
+    }
+    return o;
+}
@@ -0,0 +1,172 @@
+#ifndef SERIES_CODEC_H
+#define SERIES_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Codificación binaria compacta de series de sensores (estilo Gorilla)
+ *
+ * No depende de Arduino: el mismo código codifica en el ESP32 y decodifica
+ * en herramientas de host (tools/decode_history.cpp).
+ *
+ * Flujo de bits (MSB primero) de un bloque:
+ *
+ *   versión (8) | n (8) | boot_id (32) | tiempos | seq | pH | TDS | LDR
+ *
+ * - Tiempos (ms epoch UTC): t0 en 64 bits y luego delta-de-delta por tramos:
+ *   '0' = mismo intervalo, '10'+7, '110'+9, '1110'+12 o '1111'+64 bits
+ * - seq (32 bits): el mismo delta-de-delta; con un intervalo fijo entre
+ *   muestras cuesta 1 bit por muestra
+ * - pH y TDS (float): XOR con el valor anterior; '0' si se repite, '10' si
+ *   los bits significativos caben en la ventana anterior, '11' + ceros a la
+ *   izquierda (5) + largo-1 (5) si no
+ * - LDR (entero): delta con el anterior en zigzag y varint de 7 bits
+ *
+ * decode() también lee la versión 1 (sin boot_id ni seq, tiempos en
+ * segundos de 32 bits): devuelve los tiempos en ms y seq en 0.
+ *
+ * Sin pérdida: decode(encode(x)) devuelve los mismos bits (NaN incluido).
+ * Conviene cuantizar antes (pH a 0.01, TDS a 1 ppm): con menos ruido en la
+ * mantisa el XOR sale mucho más corto.
+ *
+ * Uso:
+ *   uint8_t bin[SeriesCodec::maxBytes(n)];
+ *   size_t len = SeriesCodec::encode(samples, n, bootId, bin, sizeof(bin));
+ *   SeriesCodec::base64Encode(bin, len, text, sizeof(text));
+ */
+class SeriesCodec
+{
+public:
+    struct Sample
+    {
+        uint64_t time; // ms epoch UTC
+        uint32_t seq;  // Secuencia del registro dentro del arranque
+        float ph;
+        float tds;
+        int32_t ldr;
+    };
+
+    static constexpr uint8_t VERSION = 2;
+    static constexpr uint8_t VERSION_V1 = 1; // Solo lectura
+    static constexpr uint8_t MAX_SAMPLES = 255;
+
+    // Peor caso de encode() para count muestras
+    static constexpr size_t maxBytes(uint8_t count) { return 16 + size_t(count) * 29; }
+    static constexpr size_t base64Len(size_t bytes) { return (bytes + 2) / 3 * 4; }
+
+    // Bytes escritos, o 0 si out no alcanza
+    static size_t encode(const Sample *samples, uint8_t count, uint32_t bootId, uint8_t *out, size_t cap);
+    // Muestras leídas, o 0 si el bloque está truncado, es de otra versión o no cabe en max
+    static uint8_t decode(const uint8_t *in, size_t len, Sample *out, uint8_t max, uint32_t *bootId = nullptr);
+
+    // Con relleno '='; devuelven el largo escrito (sin el '\0') o 0 si no cabe / es inválido
+    static size_t base64Encode(const uint8_t *data, size_t len, char *out, size_t cap);
+    static size_t base64Decode(const char *text, uint8_t *out, size_t cap);
+
+    // ========================================================================
+    // FLUJO DE BITS (usado por encode/decode, disponible para otras series)
+    // ========================================================================
+
+    class BitWriter
+    {
+    public:
+        BitWriter(uint8_t *buf, size_t cap);
+        void write(uint64_t value, uint8_t bits);
+        size_t bytes() const { return (bitPos + 7) / 8; }
+        bool overflow() const { return full; }
+
+    private:
+        uint8_t *buf;
+        size_t cap;
+        size_t bitPos;
+        bool full;
+    };
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t *buf, size_t len);
+        uint64_t read(uint8_t bits);
+        bool error() const { return past; }
+
+    private:
+        const uint8_t *buf;
+        size_t len;
+        size_t bitPos;
+        bool past;
+    };
+
+    // Delta-de-delta de tiempos (o de cualquier contador) de 32 o 64 bits
+    class TimeEncoder
+    {
+    public:
+        explicit TimeEncoder(uint8_t bits = 64) : bits(bits) {}
+        void write(BitWriter &w, uint64_t t);
+
+    private:
+        uint8_t bits;
+        uint64_t prev = 0;
+        uint64_t prevDelta = 0; // Con desborde módulo 2^bits
+        bool started = false;
+    };
+
+    class TimeDecoder
+    {
+    public:
+        explicit TimeDecoder(uint8_t bits = 64) : bits(bits) {}
+        uint64_t read(BitReader &r);
+
+    private:
+        uint8_t bits;
+        uint64_t prev = 0;
+        uint64_t prevDelta = 0; // Con desborde módulo 2^bits
+        bool started = false;
+    };
+
+    // XOR de floats (Gorilla, 32 bits)
+    class FloatEncoder
+    {
+    public:
+        void write(BitWriter &w, float value);
+
+    private:
+        uint32_t prev = 0;
+        uint8_t leading = 0xFF; // 0xFF: todavía sin ventana
+        uint8_t trailing = 0;
+        bool started = false;
+    };
+
+    class FloatDecoder
+    {
+    public:
+        float read(BitReader &r);
+
+    private:
+        uint32_t prev = 0;
+        uint8_t leading = 0;
+        uint8_t trailing = 0;
+        bool started = false;
+    };
+
+    // Delta entero en zigzag + varint
+    class IntEncoder
+    {
+    public:
+        void write(BitWriter &w, int32_t value);
+
+    private:
+        int32_t prev = 0;
+    };
+
+    class IntDecoder
+    {
+    public:
+        int32_t read(BitReader &r);
+
+    private:
+        int32_t prev = 0;
+    };
+};
+
+#endif // SERIES_CODEC_H
@@ -1,11 +1,24 @@
 #include "TDSSensor.h"
+#include "Log.h"
+#include "SensorHub.h"
 
 TDSSensor::TDSSensor(uint8_t pin)
     : pin(pin), tdsValue(0.0f), connected(false), initialized(false),
-      rawADC(0), temperature(25.0f), lastUpdate(0), updateInterval(1000)
+      rawADC(0), rawCounts(0.0f), temperature(25.0f), lastUpdate(0), updateInterval(1000),
+      hub(nullptr), hubCursor(0),
+      oversampling(TARGET_ERROR_COUNTS, OVERSAMPLE_MIN, OVERSAMPLE_MAX), sampleRateHz(0.0f)
 {
 }
 
+void TDSSensor::attachHub(SensorHub *hub)
+{
+    this->hub = hub;
+    hubCursor = 0;
+    acquire.get<Notch>().configure(hub->getFrameRate(), hub->getHumFrequency());
+    acquire.reset();
+    convert.get<TdsStage>().setKValue(gravityTds.getKvalue());
+}
+
 void TDSSensor::begin()
 {
     analogReadResolution(12); // Asegurar resolución de 12 bits
@@ -18,10 +31,11 @@ void TDSSensor::begin()
 
     // Leer un valor inicial para verificar que funciona
     rawADC = analogRead(pin);
+    rawCounts = rawADC;
     float initialVoltage = (rawADC * 3.3f) / 4096.0f;
     
     initialized = true;
-    Serial.printf("TDSSensor: Inicializado correctamente (ADC inicial: %d, Voltaje: %.3fV)\n", 
+    LOG_I(SENSOR, "TDSSensor: Inicializado correctamente (ADC inicial: %d, Voltaje: %.3fV)", 
                   rawADC, initialVoltage);
 }
 
@@ -29,11 +43,12 @@ void TDSSensor::update()
 {
     if (!initialized)
     {
-        Serial.println("TDSSensor: Error - No inicializado");
+        LOG_E(SENSOR, "TDSSensor: Error - No inicializado");
         return;
     }
 
-    rawADC = analogRead(pin);
+    rawCounts = readRaw();
+    rawADC = int(rawCounts + 0.5f);
     bool wasConnected = connected;
     checkConnection();
 
@@ -42,33 +57,42 @@ void TDSSensor::update()
     {
         if (connected)
         {
-            Serial.printf("TDSSensor: Sensor conectado (ADC: %d)\n", rawADC);
+            LOG_I(SENSOR, "TDSSensor: Sensor conectado (ADC: %d)", rawADC);
         }
         else
         {
-            Serial.printf("TDSSensor: Sensor desconectado (ADC: %d)\n", rawADC);
+            LOG_W(SENSOR, "TDSSensor: Sensor desconectado (ADC: %d)", rawADC);
             if (rawADC < MIN_CONNECTED_ADC)
             {
-                Serial.printf("  → ADC muy bajo (< %d). Verificar:\n", MIN_CONNECTED_ADC);
-                Serial.println("     - Sensor tiene alimentación 5V?");
-                Serial.println("     - Cable de señal conectado a GPIO33?");
-                Serial.println("     - Sensor sumergido en agua?");
+                LOG_W(SENSOR, "  → ADC muy bajo (< %d). Verificar:", MIN_CONNECTED_ADC);
+                LOG_W(SENSOR, "     - Sensor tiene alimentación 5V?");
+                LOG_W(SENSOR, "     - Cable de señal conectado a GPIO33?");
+                LOG_W(SENSOR, "     - Sensor sumergido en agua?");
             }
             else if (rawADC > MAX_CONNECTED_ADC)
             {
-                Serial.printf("  → ADC muy alto (> %d). Verificar:\n", MAX_CONNECTED_ADC);
-                Serial.println("     - Cable de señal desconectado?");
-                Serial.println("     - Cortocircuito a VCC?");
+                LOG_W(SENSOR, "  → ADC muy alto (> %d). Verificar:", MAX_CONNECTED_ADC);
+                LOG_W(SENSOR, "     - Cable de señal desconectado?");
+                LOG_W(SENSOR, "     - Cortocircuito a VCC?");
             }
         }
     }
 
     if (connected)
     {
-        gravityTds.setTemperature(temperature);
-        gravityTds.update();
-        float rawTds = gravityTds.getTdsValue();
-        
+        float rawTds;
+        if (hub && hub->isRunning())
+        {
+            // El hub ya promedió el canal; GravityTDS volvería a leer el ADC
+            rawTds = asFloat(convert.step(rawCounts));
+        }
+        else
+        {
+            gravityTds.setTemperature(temperature);
+            gravityTds.update();
+            rawTds = gravityTds.getTdsValue();
+        }
+
         // Validar que el valor TDS sea válido (no NaN, no infinito, y positivo)
         if (isfinite(rawTds) && rawTds >= 0.0f && rawTds <= 2000.0f)
         {
@@ -98,14 +122,14 @@ void TDSSensor::update()
                 }
                 else
                 {
-                    Serial.printf("TDSSensor: Error - TDS calculado inválido (%.2f). ADC: %d, Voltaje: %.3fV\n", 
+                    LOG_E(SENSOR, "TDSSensor: Error - TDS calculado inválido (%.2f). ADC: %d, Voltaje: %.3fV", 
                                  calculatedTds, rawADC, voltage);
                     tdsValue = 0.0f;
                 }
             }
             else
             {
-                Serial.printf("TDSSensor: Error - Voltaje inválido (%.3fV). ADC: %d\n", voltage, rawADC);
+                LOG_E(SENSOR, "TDSSensor: Error - Voltaje inválido (%.3fV). ADC: %d", voltage, rawADC);
                 tdsValue = 0.0f;
             }
         }
@@ -118,6 +142,42 @@ void TDSSensor::update()
     lastUpdate = millis();
 }
 
+float TDSSensor::readRaw()
+{
+    uint8_t n = oversampling.samples();
+
+    if (!hub || !hub->isRunning())
+    {
+        // n lecturas directas repartidas en un periodo de red
+        uint16_t samples[OVERSAMPLE_MAX];
+        sampleRateHz = SensorHub::readSpread(pin, samples, n, SensorHub::mainsWindowUs(1));
+        uint32_t sum = 0;
+        for (uint8_t i = 0; i < n; i++)
+        {
+            oversampling.push(samples[i]);
+            sum += samples[i];
+        }
+        return float(sum) / n;
+    }
+
+    // Media recortada de los n frames más recientes del hub
+    acquire.get<AcquireWindow>().setWindow(n);
+    sampleRateHz = hub->getFrameRate();
+
+    uint16_t raw[OVERSAMPLE_MAX];
+    uint8_t count = hub->copySince(SensorHub::CH_TDS, hubCursor, raw, n);
+    if (count == 0)
+        return rawCounts;
+
+    float value = 0.0f;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        oversampling.push(raw[i]);
+        value = acquire.step(raw[i]);
+    }
+    return value; // Sin redondear: el promedio da resolución por debajo de 1 cuenta
+}
+
 void TDSSensor::checkConnection()
 {
     connected = (rawADC > MIN_CONNECTED_ADC && rawADC < MAX_CONNECTED_ADC);
@@ -126,6 +186,7 @@ void TDSSensor::checkConnection()
 void TDSSensor::setTemperature(float temp)
 {
     temperature = temp;
+    convert.get<TdsStage>().setTemperature(temp);
 }
 
 bool TDSSensor::shouldUpdate()
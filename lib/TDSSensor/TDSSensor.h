@@ -2,8 +2,11 @@
 #define TDS_SENSOR_H
 
 #include <Arduino.h>
+#include "SensorPipeline.h"
 #include "GravityTDS.h"
 
+class SensorHub;
+
 class TDSSensor
 {
 public:
@@ -12,6 +15,7 @@ public:
 
     // Inicialización
     void begin();
+    void attachHub(SensorHub *hub);
 
     // Actualización
     void update();
@@ -24,10 +28,30 @@ public:
     // Configuración
     void setTemperature(float temp);
     void setUpdateInterval(unsigned long interval) { updateInterval = interval; }
+    unsigned long getUpdateInterval() const { return updateInterval; } // ms
 
     // Control de timing
     bool shouldUpdate();
 
+    // Sobremuestreo adaptativo
+    const OversampleBudget &getOversampling() const { return oversampling; }
+    float getSampleRate() const { return sampleRateHz; }
+    void setTargetError(float counts) { oversampling.setTarget(counts); }
+
+    // Etapas de conversión (float o Q16.16 según SENSOR_FIXED_POINT)
+#if SENSOR_FIXED_POINT
+    using VoltsStage = AdcToVoltsQ16<4096>;
+    using TdsStage = GravityTdsPolyQ16;
+#else
+    using VoltsStage = AdcToVoltsT<4096>;
+    using TdsStage = GravityTdsPoly;
+#endif
+
+    // Cadenas de procesamiento (solo con hub)
+    using AcquireWindow = TrimmedMean<32>;                  // Hasta OVERSAMPLE_MAX
+    using AcquirePipeline = Pipeline<Notch, AcquireWindow>; // Por frame ADC
+    using ConvertPipeline = Pipeline<VoltsStage, TdsStage>; // Por update
+
 private:
     uint8_t pin;
     GravityTDS gravityTds;
@@ -35,16 +59,28 @@ private:
     bool connected;
     bool initialized;
     int rawADC;
+    float rawCounts; // Media sin redondear; rawADC es su redondeo (conexión y logs)
     float temperature;
     unsigned long lastUpdate;
     unsigned long updateInterval;
+    SensorHub *hub;
+    uint32_t hubCursor;
+    AcquirePipeline acquire;
+    OversampleBudget oversampling;
+    float sampleRateHz;
+    ConvertPipeline convert;
 
     // Constantes para detección de conexión
     // Bajado a 100 para detectar agua muy pura (baja mineralización)
     static constexpr int MIN_CONNECTED_ADC = 100;
     static constexpr int MAX_CONNECTED_ADC = 4000;
 
+    static constexpr uint8_t OVERSAMPLE_MIN = 4;
+    static constexpr uint8_t OVERSAMPLE_MAX = 32;
+    static constexpr float TARGET_ERROR_COUNTS = 1.0f; // ~0.3 ppm a 1 V
+
     void checkConnection();
+    float readRaw();
 };
 
 #endif // TDS_SENSOR_H
\ No newline at end of file
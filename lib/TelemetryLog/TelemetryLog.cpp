@@ -0,0 +1,336 @@
+#include "TelemetryLog.h"
+#include "Log.h"
+#include <stddef.h>
+
+namespace
+{
+    constexpr size_t RECORD_BYTES = sizeof(TelemetryLog::Record);
+    constexpr size_t CRC_BYTES = offsetof(TelemetryLog::Record, crc);
+
+    struct AckFile
+    {
+        uint32_t seq;
+        uint32_t crc;
+    };
+}
+
+TelemetryLog::TelemetryLog() : TelemetryLog(Config())
+{
+}
+
+TelemetryLog::TelemetryLog(const Config &config)
+    : config(config), ready(false), head(0), oldest(0), acked(0), buffered(0), replayStarted(false),
+      lastReplayMs(0)
+{
+    if (this->config.recordsPerSegment < 1)
+        this->config.recordsPerSegment = 1;
+    if (this->config.segments < 2)
+        this->config.segments = 2;
+    if (this->config.flushRecords < 1)
+        this->config.flushRecords = 1;
+    if (this->config.flushRecords > MAX_BUFFER)
+        this->config.flushRecords = MAX_BUFFER;
+    if (this->config.replayBatch < 1)
+        this->config.replayBatch = 1;
+    if (this->config.replayBatch > MAX_BATCH)
+        this->config.replayBatch = MAX_BATCH;
+}
+
+bool TelemetryLog::begin()
+{
+    if (!LittleFS.begin(true))
+    {
+        LOG_E(STORE, "TelemetryLog: Error - No se pudo montar LittleFS");
+        return false;
+    }
+    LittleFS.mkdir(config.dir);
+    recover();
+    ready = true;
+    LOG_I(STORE, "TelemetryLog: %lu registros pendientes (retencion %lu registros, %lu KB)",
+                 (unsigned long)pending(), (unsigned long)capacity(), (unsigned long)(retentionBytes() / 1024));
+    return true;
+}
+
+// ============================================================================
+// ESCRITURA
+// ============================================================================
+
+bool TelemetryLog::append(uint64_t epochMs, uint32_t bootId, uint32_t sampleSeq, float ph, float tds, int32_t ldr,
+                          bool monotonic)
+{
+    if (!ready)
+        return false;
+
+    Record &r = buffer[buffered++];
+    r.seq = head++;
+    r.bootId = bootId;
+    r.epochMs = epochMs;
+    r.sampleSeq = sampleSeq;
+    r.ph = ph;
+    r.tds = tds;
+    r.ldr = ldr;
+    r.flags = monotonic ? MONOTONIC : 0;
+    r.crc = crc32(reinterpret_cast<const uint8_t *>(&r), CRC_BYTES);
+    stats.appended++;
+
+    if (buffered >= config.flushRecords)
+        return flush();
+    return true;
+}
+
+bool TelemetryLog::flush()
+{
+    bool ok = true;
+    uint8_t i = 0;
+    while (i < buffered)
+    {
+        // Registros consecutivos del mismo segmento: una sola escritura
+        uint32_t start = slotStart(buffer[i].seq);
+        uint8_t j = i;
+        while (j < buffered && slotStart(buffer[j].seq) == start)
+            j++;
+
+        bool fresh = buffer[i].seq == start;
+        if (fresh)
+            openSlot(start);
+
+        char path[32];
+        segmentPath(start, path, sizeof(path));
+        File f = LittleFS.open(path, fresh ? FILE_WRITE : FILE_APPEND);
+        size_t bytes = (j - i) * RECORD_BYTES;
+        bool wrote = f && f.size() == (buffer[i].seq - start) * RECORD_BYTES &&
+                     f.write(reinterpret_cast<const uint8_t *>(&buffer[i]), bytes) == bytes;
+        f.close();
+        stats.segmentWrites++;
+
+        if (!wrote)
+        {
+            // Segmento inconsistente: lo que siga va al próximo
+            ok = false;
+            stats.writeErrors++;
+            if (head < start + config.recordsPerSegment)
+                head = start + config.recordsPerSegment;
+        }
+        i = j;
+    }
+    buffered = 0;
+    return ok;
+}
+
+void TelemetryLog::openSlot(uint32_t start)
+{
+    // Reabrir un segmento borra la vuelta anterior
+    uint32_t span = uint32_t(config.segments - 1) * config.recordsPerSegment;
+    uint32_t newOldest = start >= span ? start - span : 0;
+    if (newOldest <= oldest)
+        return;
+    uint32_t from = tail();
+    if (from < newOldest)
+        stats.dropped += newOldest - from;
+    oldest = newOldest;
+}
+
+// ============================================================================
+// REENVÍO
+// ============================================================================
+
+uint16_t TelemetryLog::readBatch(Record *out, uint16_t max, uint32_t &nextSeq)
+{
+    // Lo que sigue en RAM se lee de ahí: un reenvío fallido no fuerza escrituras
+    uint32_t flashHead = head - buffered;
+
+    uint16_t n = 0;
+    uint32_t seq = tail();
+    uint32_t openStart = UINT32_MAX;
+    File f;
+    while (seq < flashHead && n < max)
+    {
+        uint32_t start = slotStart(seq);
+        if (start != openStart)
+        {
+            char path[32];
+            segmentPath(start, path, sizeof(path));
+            f.close();
+            f = LittleFS.open(path, FILE_READ);
+            openStart = start;
+        }
+
+        if (f && readRecord(f, seq, out[n]))
+        {
+            n++;
+            seq++;
+            continue;
+        }
+
+        // Hueco: si el archivo no llega hasta aquí, el resto del segmento tampoco existe
+        if (!f || f.size() <= (seq - start) * RECORD_BYTES)
+            seq = start + config.recordsPerSegment < flashHead ? start + config.recordsPerSegment : flashHead;
+        else
+            seq++;
+    }
+    f.close();
+
+    for (uint8_t i = 0; i < buffered && n < max; i++)
+    {
+        if (buffer[i].seq >= seq)
+        {
+            out[n++] = buffer[i];
+            seq = buffer[i].seq + 1;
+        }
+    }
+    nextSeq = seq;
+    return n;
+}
+
+bool TelemetryLog::ack(uint32_t nextSeq)
+{
+    if (nextSeq > head)
+        nextSeq = head;
+    uint32_t from = tail();
+    if (nextSeq <= from)
+        return true;
+    stats.replayed += nextSeq - from;
+    acked = nextSeq;
+    return saveAck();
+}
+
+bool TelemetryLog::saveAck()
+{
+    // Archivo temporal + rename: el ack en flash es el viejo o el nuevo, nunca uno a medias
+    AckFile a = {acked, 0};
+    a.crc = crc32(reinterpret_cast<const uint8_t *>(&a.seq), sizeof(a.seq));
+
+    char tmp[32], path[32];
+    ackPath(tmp, sizeof(tmp), true);
+    ackPath(path, sizeof(path), false);
+    File f = LittleFS.open(tmp, FILE_WRITE);
+    bool ok = f && f.write(reinterpret_cast<const uint8_t *>(&a), sizeof(a)) == sizeof(a);
+    f.close();
+    ok = ok && LittleFS.rename(tmp, path);
+    stats.ackWrites++;
+    if (!ok)
+        stats.writeErrors++;
+    return ok;
+}
+
+// ============================================================================
+// RECUPERACIÓN
+// ============================================================================
+
+void TelemetryLog::recover()
+{
+    head = 0;
+    oldest = 0;
+    acked = 0;
+    buffered = 0;
+
+    // Segmento más nuevo: el de mayor secuencia en su primer registro
+    bool found = false;
+    uint32_t newest = 0;
+    for (uint8_t slot = 0; slot < config.segments; slot++)
+    {
+        char path[32];
+        segmentPath(uint32_t(slot) * config.recordsPerSegment, path, sizeof(path));
+        File f = LittleFS.open(path, FILE_READ);
+        if (!f)
+            continue;
+        Record r;
+        if (f.read(reinterpret_cast<uint8_t *>(&r), RECORD_BYTES) == RECORD_BYTES && valid(r) &&
+            r.seq % config.recordsPerSegment == 0 &&
+            (r.seq / config.recordsPerSegment) % config.segments == slot && (!found || r.seq > newest))
+        {
+            newest = r.seq;
+            found = true;
+        }
+        f.close();
+    }
+
+    if (found)
+    {
+        char path[32];
+        segmentPath(newest, path, sizeof(path));
+        File f = LittleFS.open(path, FILE_READ);
+        uint32_t n = 0;
+        Record r;
+        while (n < config.recordsPerSegment && readRecord(f, newest + n, r))
+            n++;
+        if (f.size() == n * RECORD_BYTES)
+        {
+            head = newest + n;
+        }
+        else
+        {
+            // Cola rota (corte a mitad de escritura): seguir en el próximo segmento
+            head = newest + config.recordsPerSegment;
+            stats.corrupt++;
+        }
+        f.close();
+
+        uint32_t span = uint32_t(config.segments - 1) * config.recordsPerSegment;
+        oldest = newest >= span ? newest - span : 0;
+    }
+
+    char path[32];
+    ackPath(path, sizeof(path), false);
+    File f = LittleFS.open(path, FILE_READ);
+    AckFile a;
+    if (f && f.read(reinterpret_cast<uint8_t *>(&a), sizeof(a)) == sizeof(a) &&
+        a.crc == crc32(reinterpret_cast<const uint8_t *>(&a.seq), sizeof(a.seq)))
+    {
+        // Un ack más allá del registro (archivos borrados) se descarta
+        acked = a.seq <= head ? a.seq : head;
+    }
+    f.close();
+}
+
+bool TelemetryLog::readRecord(File &file, uint32_t seq, Record &record)
+{
+    if (!file.seek((seq - slotStart(seq)) * RECORD_BYTES))
+        return false;
+    if (file.read(reinterpret_cast<uint8_t *>(&record), RECORD_BYTES) != RECORD_BYTES)
+        return false;
+    return valid(record) && record.seq == seq;
+}
+
+bool TelemetryLog::valid(const Record &record)
+{
+    return record.crc == crc32(reinterpret_cast<const uint8_t *>(&record), CRC_BYTES);
+}
+
+// ============================================================================
+// UTILIDADES
+// ============================================================================
+
+bool TelemetryLog::toEpoch(Record &record, uint32_t bootId, int64_t offsetMs)
+{
+    if (!(record.flags & MONOTONIC))
+        return true;
+    if (record.bootId != bootId)
+        return false;
+    record.epochMs = uint64_t(int64_t(record.epochMs) + offsetMs);
+    record.flags &= ~MONOTONIC;
+    return true;
+}
+
+void TelemetryLog::segmentPath(uint32_t seq, char *path, size_t len) const
+{
+    unsigned slot = (seq / config.recordsPerSegment) % config.segments;
+    snprintf(path, len, "%s/seg%02u.bin", config.dir, slot);
+}
+
+void TelemetryLog::ackPath(char *path, size_t len, bool temp) const
+{
+    snprintf(path, len, "%s/%s", config.dir, temp ? "ack.tmp" : "ack.bin");
+}
+
+uint32_t TelemetryLog::crc32(const uint8_t *data, size_t len)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (uint8_t b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+    return ~crc;
+}
@@ -0,0 +1,150 @@
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+/**
+ * @brief Registro circular en LittleFS para el historial que no se pudo enviar
+ *
+ * Mientras no hay WiFi o Firebase, cada punto de historial se agrega al
+ * registro; al volver la conexión replay() lo reenvía por lotes desde el más
+ * antiguo, un lote cada replayIntervalMs para no acaparar la red.
+ *
+ * Formato: `segments` archivos de `recordsPerSegment` registros de tamaño
+ * fijo con CRC32. El registro de secuencia N va en el segmento
+ * (N / recordsPerSegment) % segments, en la posición N % recordsPerSegment;
+ * al llegar al inicio de un segmento se reabre con "w" y se pierde la vuelta
+ * anterior (retención = segments × recordsPerSegment registros).
+ *
+ * - Solo se agrega: cada registro se escribe una vez, agrupado de a
+ *   flushRecords para no copiar el bloque final de LittleFS en cada punto
+ * - Tras un corte, begin() busca el segmento más nuevo y cuenta los
+ *   registros válidos; una cola rota se salta hasta el siguiente segmento
+ * - El puntero de reenvío (ack) se escribe en un archivo aparte y se
+ *   reemplaza con rename(), que en LittleFS es atómico
+ * - Reenviar dos veces es inofensivo: cada punto lleva su sello
+ *   {epoch_ms, boot_id, seq}, así que un ack perdido solo repite muestras
+ *   que el dashboard une por (boot_id, seq)
+ * - Lo guardado antes de la primera hora SNTP lleva MONOTONIC: epochMs son
+ *   ms desde el arranque bootId, y toEpoch() lo fecha al reenviar si sigue
+ *   siendo el mismo arranque
+ */
+class TelemetryLog
+{
+public:
+    struct Record
+    {
+        uint32_t seq;       // Posición en el registro
+        uint32_t bootId;    // Sello de la muestra (TimeService)
+        uint64_t epochMs;
+        uint32_t sampleSeq;
+        float ph;
+        float tds;
+        int32_t ldr;
+        uint32_t flags;     // MONOTONIC o 0; completa 40 B sin relleno del compilador
+        uint32_t crc;       // CRC32 de los campos anteriores
+    };
+
+    struct Config
+    {
+        uint16_t recordsPerSegment = 102; // 102 × 40 B ≈ un bloque de 4 KB
+        uint8_t segments = 80;            // 8160 registros: ~22 h a 10 s
+        uint8_t flushRecords = 6;         // Registros en RAM antes de escribir (pérdida máxima en un corte)
+        uint16_t replayBatch = 60;        // Registros por escritura multi-ruta (<= MAX_BATCH)
+        unsigned long replayIntervalMs = 1000;
+        const char *dir = "/tlog";
+    };
+
+    struct Stats
+    {
+        uint32_t appended = 0;
+        uint32_t replayed = 0;     // Confirmados con ack()
+        uint32_t dropped = 0;      // Sobrescritos antes de reenviarse
+        uint32_t corrupt = 0;      // Registros o colas inválidos encontrados
+        uint32_t writeErrors = 0;
+        uint32_t segmentWrites = 0; // Aperturas de segmento para escribir
+        uint32_t ackWrites = 0;
+    };
+
+    static constexpr uint32_t MONOTONIC = 1; // flags: sin hora SNTP, epochMs es tiempo desde el arranque
+
+    static constexpr uint8_t MAX_BUFFER = 16;
+    static constexpr uint16_t MAX_BATCH = 64;
+
+    TelemetryLog();
+    explicit TelemetryLog(const Config &config);
+
+    // Monta LittleFS (formatea si no hay sistema de archivos) y recupera el estado
+    bool begin();
+
+    bool append(uint64_t epochMs, uint32_t bootId, uint32_t sampleSeq, float ph, float tds, int32_t ldr,
+                bool monotonic = false);
+    bool flush(); // Escribe lo que queda en RAM
+
+    // Reenvío: hasta max registros desde el más antiguo sin confirmar.
+    // nextSeq es lo que hay que pasar a ack() si el envío salió bien.
+    uint16_t readBatch(Record *out, uint16_t max, uint32_t &nextSeq);
+    bool ack(uint32_t nextSeq);
+
+    /**
+     * @brief Un lote de reenvío si toca y hay pendientes
+     * @param send bool(const Record *records, uint16_t count): true si se publicó
+     * @return Registros confirmados (0 si no tocaba, no había o falló el envío)
+     */
+    template <typename SendFn>
+    uint16_t replay(unsigned long nowMs, SendFn send)
+    {
+        if (!ready || !pending() || (replayStarted && nowMs - lastReplayMs < config.replayIntervalMs))
+            return 0;
+        replayStarted = true;
+        lastReplayMs = nowMs;
+
+        uint32_t nextSeq;
+        uint16_t n = readBatch(batch, config.replayBatch, nextSeq);
+        if (n && !send(batch, n))
+            return 0;
+        ack(nextSeq); // Con n == 0 solo salta huecos
+        return n;
+    }
+
+    uint32_t pending() const { return head - tail(); }
+    uint32_t capacity() const { return uint32_t(config.segments) * config.recordsPerSegment; }
+    size_t retentionBytes() const { return size_t(capacity()) * sizeof(Record); }
+    bool isReady() const { return ready; }
+
+    const Config &getConfig() const { return config; }
+    const Stats &getStats() const { return stats; }
+
+    // Fecha un registro MONOTONIC con offsetMs (TimeService::offsetMs()) si es del arranque
+    // bootId; false si no se puede fechar (otro arranque, su offset se perdió)
+    static bool toEpoch(Record &record, uint32_t bootId, int64_t offsetMs);
+
+    static uint32_t crc32(const uint8_t *data, size_t len);
+
+private:
+    Config config;
+    Stats stats;
+    bool ready;
+    uint32_t head;   // Próxima secuencia a escribir
+    uint32_t oldest; // Secuencia más antigua que sigue en flash
+    uint32_t acked;  // Próxima secuencia a reenviar
+    Record buffer[MAX_BUFFER];
+    uint8_t buffered;
+    Record batch[MAX_BATCH];
+    bool replayStarted;
+    unsigned long lastReplayMs;
+
+    uint32_t tail() const { return acked > oldest ? acked : oldest; }
+    uint32_t slotStart(uint32_t seq) const { return seq - seq % config.recordsPerSegment; }
+    void segmentPath(uint32_t seq, char *path, size_t len) const;
+    void ackPath(char *path, size_t len, bool temp) const;
+
+    void recover();
+    bool readRecord(File &file, uint32_t seq, Record &record);
+    void openSlot(uint32_t start);
+    bool saveAck();
+    static bool valid(const Record &record);
+};
+
+#endif // TELEMETRY_LOG_H
@@ -0,0 +1,149 @@
+#include "TelemetryShadow.h"
+#include "Log.h"
+
+TelemetryShadow::TelemetryShadow(unsigned long keyframeIntervalMs)
+    : count(0), keyframeIntervalMs(keyframeIntervalMs), lastKeyframeMs(0), cycleMs(0),
+      keyframePending(true), keyframe(false)
+{
+}
+
+TelemetryShadow::Field *TelemetryShadow::fieldFor(const char *path, Type type, float deadband)
+{
+    // Mismo literal en cada ciclo: basta comparar punteros en el caso normal
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (fields[i].path == path || strcmp(fields[i].path, path) == 0)
+            return fields[i].type == type ? &fields[i] : nullptr;
+    }
+
+    if (count >= MAX_FIELDS)
+    {
+        LOG_E(STORE, "TelemetryShadow: Error - Sin espacio para %s", path);
+        return nullptr;
+    }
+
+    Field &f = fields[count++];
+    memset(&f, 0, sizeof(f));
+    f.path = path;
+    f.type = type;
+    f.deadband = deadband;
+    return &f;
+}
+
+bool TelemetryShadow::setFloat(const char *path, float value, float deadband)
+{
+    Field *f = fieldFor(path, FLOAT, deadband);
+    if (!f)
+        return false;
+    f->value.f = value;
+    f->hasValue = true;
+    return true;
+}
+
+bool TelemetryShadow::setInt(const char *path, int32_t value, int32_t deadband)
+{
+    Field *f = fieldFor(path, INT, float(deadband));
+    if (!f)
+        return false;
+    f->value.i = value;
+    f->hasValue = true;
+    return true;
+}
+
+bool TelemetryShadow::setBool(const char *path, bool value)
+{
+    Field *f = fieldFor(path, BOOL, 0.0f);
+    if (!f)
+        return false;
+    f->value.b = value;
+    f->hasValue = true;
+    return true;
+}
+
+bool TelemetryShadow::setText(const char *path, const char *value)
+{
+    Field *f = fieldFor(path, TEXT, 0.0f);
+    if (!f)
+        return false;
+    strncpy(f->text, value ? value : "", TEXT_LEN - 1);
+    f->text[TEXT_LEN - 1] = '\0';
+    f->hasValue = true;
+    return true;
+}
+
+bool TelemetryShadow::crossed(const Field &f)
+{
+    switch (f.type)
+    {
+    case FLOAT:
+    {
+        float now = f.value.f, last = f.published.f;
+        if (isnan(now) || isnan(last))
+            return isnan(now) != isnan(last);
+        return fabsf(now - last) > f.deadband;
+    }
+    case INT:
+        return fabsf(float(f.value.i) - float(f.published.i)) > f.deadband;
+    case BOOL:
+        return f.value.b != f.published.b;
+    case TEXT:
+        return strcmp(f.text, f.publishedText) != 0;
+    }
+    return true;
+}
+
+uint8_t TelemetryShadow::collect(unsigned long nowMs)
+{
+    cycleMs = nowMs;
+    keyframe = keyframePending || (nowMs - lastKeyframeMs >= keyframeIntervalMs);
+
+    uint8_t dueCount = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        Field &f = fields[i];
+        f.due = f.hasValue && (keyframe || !f.hasPublished || f.unsent || crossed(f));
+        if (f.due)
+            dueCount++;
+    }
+
+    stats.cycles++;
+    return dueCount;
+}
+
+void TelemetryShadow::markUnsent(const Field &field)
+{
+    Field &f = fields[&field - fields];
+    if (!f.due)
+        return;
+    f.due = false;
+    f.unsent = true;
+    stats.fieldsDeferred++;
+}
+
+void TelemetryShadow::commit()
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        Field &f = fields[i];
+        if (!f.due)
+        {
+            if (f.hasValue && !f.unsent)
+                stats.fieldsSuppressed++;
+            continue;
+        }
+        f.published = f.value;
+        if (f.type == TEXT)
+            memcpy(f.publishedText, f.text, TEXT_LEN);
+        f.hasPublished = true;
+        f.due = false;
+        f.unsent = false;
+        stats.fieldsSent++;
+    }
+    // El intervalo cuenta desde el último keyframe confirmado
+    if (keyframe)
+    {
+        lastKeyframeMs = cycleMs;
+        keyframePending = false;
+        stats.keyframes++;
+    }
+}
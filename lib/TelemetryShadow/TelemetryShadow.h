@@ -0,0 +1,114 @@
+#ifndef TELEMETRY_SHADOW_H
+#define TELEMETRY_SHADOW_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Copia del último valor publicado de cada campo de telemetría
+ *
+ * Cada ciclo se cargan todos los valores; solo salen los que se movieron más
+ * que su banda muerta desde la última publicación confirmada, más un
+ * keyframe completo cada keyframeIntervalMs para que un panel recién abierto
+ * (o un valor perdido) se ponga al día.
+ *
+ *   shadow.setFloat("sensores/ph4502c/ph", ph, 0.02f);
+ *   shadow.setText("diagnostico/chip", "ESP32-D0WD-V3");
+ *   if (shadow.collect(millis()))
+ *   {
+ *       shadow.forEachDue([&](const TelemetryShadow::Field &f) {
+ *           if (!agregar(f)) shadow.markUnsent(f);   // No cupo: sigue pendiente
+ *       });
+ *       if (enviado) shadow.commit();   // Sin commit, se reintenta el próximo ciclo
+ *   }
+ *
+ * Los campos se registran en el primer set; la ruta debe ser un literal (se
+ * guarda el puntero, no una copia).
+ */
+class TelemetryShadow
+{
+public:
+    static constexpr uint8_t MAX_FIELDS = 40;
+    static constexpr uint8_t TEXT_LEN = 24;
+
+    enum Type : uint8_t
+    {
+        FLOAT,
+        INT,
+        BOOL,
+        TEXT
+    };
+
+    struct Field
+    {
+        const char *path;
+        Type type;
+        float deadband; // |actual - publicado| > deadband para publicar (0: cualquier cambio)
+        bool hasValue;
+        bool hasPublished;
+        bool due;
+        bool unsent; // No entró en la publicación anterior: sale en la próxima aunque no cruce su banda
+        union
+        {
+            float f;
+            int32_t i;
+            bool b;
+        } value, published;
+        char text[TEXT_LEN];
+        char publishedText[TEXT_LEN];
+    };
+
+    struct Stats
+    {
+        uint32_t cycles = 0;
+        uint32_t keyframes = 0;
+        uint32_t fieldsSent = 0;
+        uint32_t fieldsSuppressed = 0;
+        uint32_t fieldsDeferred = 0; // markUnsent(): no cupieron en el envío
+    };
+
+    explicit TelemetryShadow(unsigned long keyframeIntervalMs = 300000UL);
+
+    // Carga de valores (registra el campo la primera vez)
+    bool setFloat(const char *path, float value, float deadband = 0.0f);
+    bool setInt(const char *path, int32_t value, int32_t deadband = 0);
+    bool setBool(const char *path, bool value);
+    bool setText(const char *path, const char *value);
+
+    // Ciclo de publicación
+    uint8_t collect(unsigned long nowMs); // Marca los campos a enviar; devuelve cuántos
+    bool isKeyframe() const { return keyframe; }
+    template <typename Fn>
+    void forEachDue(Fn fn) const
+    {
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (fields[i].due)
+                fn(fields[i]);
+        }
+    }
+    // Desde forEachDue: el campo no entró en el envío; commit() no lo da por publicado
+    void markUnsent(const Field &field);
+    void commit(); // Tras una publicación correcta
+    void forceKeyframe() { keyframePending = true; }
+
+    // Configuración y estado
+    void setKeyframeInterval(unsigned long ms) { keyframeIntervalMs = ms; }
+    unsigned long getKeyframeInterval() const { return keyframeIntervalMs; }
+    uint8_t size() const { return count; }
+    const Stats &getStats() const { return stats; }
+
+private:
+    Field fields[MAX_FIELDS];
+    uint8_t count;
+    unsigned long keyframeIntervalMs;
+    unsigned long lastKeyframeMs;
+    unsigned long cycleMs; // millis() del collect() en curso
+    bool keyframePending; // Sin keyframe confirmado todavía, o forzado
+    bool keyframe;        // El ciclo en curso es keyframe
+    Stats stats;
+
+    Field *fieldFor(const char *path, Type type, float deadband);
+    static bool crossed(const Field &f);
+};
+
+#endif // TELEMETRY_SHADOW_H
@@ -0,0 +1,142 @@
+#include "TelemetrySink.h"
+
+PatchBuilder::PatchBuilder(char *buffer, size_t capacity)
+    : buffer(buffer), capacity(capacity), len(0), entries(0), overflowed(false)
+{
+    clear();
+}
+
+void PatchBuilder::clear()
+{
+    len = 0;
+    entries = 0;
+    overflowed = capacity < 3;
+    if (capacity >= 3)
+    {
+        buffer[0] = '{';
+        buffer[1] = '}';
+        buffer[2] = '\0';
+        len = 1; // La llave de cierre se reescribe en cada entrada
+    }
+    else if (capacity)
+    {
+        buffer[0] = '\0';
+    }
+}
+
+bool PatchBuilder::append(const char *text, size_t n)
+{
+    // Siempre quedan dos bytes libres para "}\0"
+    if (len + n + 2 > capacity)
+        return false;
+    memcpy(buffer + len, text, n);
+    len += n;
+    return true;
+}
+
+bool PatchBuilder::appendEscaped(const char *text)
+{
+    if (!append("\"", 1))
+        return false;
+    for (const char *p = text; *p; p++)
+    {
+        unsigned char c = static_cast<unsigned char>(*p);
+        char esc[8];
+        size_t n;
+        if (c == '"' || c == '\\')
+        {
+            esc[0] = '\\';
+            esc[1] = char(c);
+            n = 2;
+        }
+        else if (c < 0x20)
+        {
+            n = snprintf(esc, sizeof(esc), "\\u%04x", c);
+        }
+        else
+        {
+            esc[0] = char(c);
+            n = 1;
+        }
+        if (!append(esc, n))
+            return false;
+    }
+    return append("\"", 1);
+}
+
+bool PatchBuilder::beginEntry(const char *key, size_t &mark)
+{
+    mark = len;
+    if (capacity < 3)
+        return false;
+    return (!entries || append(",", 1)) && appendEscaped(key) && append(":", 1);
+}
+
+bool PatchBuilder::endEntry(size_t mark, bool ok)
+{
+    if (ok)
+        entries++;
+    else
+    {
+        len = mark; // La entrada que no cupo se descarta entera
+        overflowed = true;
+    }
+    if (capacity >= 3)
+    {
+        buffer[len] = '}';
+        buffer[len + 1] = '\0';
+    }
+    return ok;
+}
+
+bool PatchBuilder::addInt(const char *key, int32_t value)
+{
+    char num[16];
+    size_t mark;
+    bool ok = beginEntry(key, mark);
+    ok = ok && append(num, snprintf(num, sizeof(num), "%ld", (long)value));
+    return endEntry(mark, ok);
+}
+
+bool PatchBuilder::addU64(const char *key, uint64_t value)
+{
+    char num[24];
+    size_t mark;
+    bool ok = beginEntry(key, mark);
+    ok = ok && append(num, snprintf(num, sizeof(num), "%llu", (unsigned long long)value));
+    return endEntry(mark, ok);
+}
+
+bool PatchBuilder::addFloat(const char *key, float value)
+{
+    char num[24];
+    size_t mark;
+    bool ok = beginEntry(key, mark);
+    if (isfinite(value))
+        ok = ok && append(num, snprintf(num, sizeof(num), "%.7g", value));
+    else
+        ok = ok && append("null", 4); // JSON no tiene NaN
+    return endEntry(mark, ok);
+}
+
+bool PatchBuilder::addBool(const char *key, bool value)
+{
+    size_t mark;
+    bool ok = beginEntry(key, mark);
+    ok = ok && (value ? append("true", 4) : append("false", 5));
+    return endEntry(mark, ok);
+}
+
+bool PatchBuilder::addText(const char *key, const char *value)
+{
+    size_t mark;
+    bool ok = beginEntry(key, mark) && appendEscaped(value);
+    return endEntry(mark, ok);
+}
+
+bool PatchBuilder::addRaw(const char *key, const char *json)
+{
+    size_t mark;
+    bool ok = beginEntry(key, mark) && append(json, strlen(json));
+    return endEntry(mark, ok);
+}
@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_SINK_H
+#define TELEMETRY_SINK_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Interfaces de transporte hacia la base de datos (estilo RTDB)
+ *
+ * main.cpp publica y recibe comandos solo a través de estas dos interfaces;
+ * FirebaseTransport las implementa con Firebase_ESP_Client y RestTransport
+ * con HTTP/SSE plano contra un servidor local (tools/rtdb_server), que es lo
+ * que permite medir el camino de publicación en el host.
+ *
+ * Los cuerpos son texto JSON ya armado: update() es un PATCH multi-ruta
+ * ({"a/b":1,"c":{...}} actualiza solo esas hojas) y set() reemplaza el nodo.
+ *
+ *   static char cuerpo[2048];
+ *   PatchBuilder patch(cuerpo, sizeof(cuerpo));
+ *   patch.addFloat("sensores/ph", 6.02f);
+ *   if (!sink.update("/hydroponic_data", patch.c_str())) Serial.println(sink.lastError());
+ */
+class TelemetrySink
+{
+public:
+    virtual ~TelemetrySink() {}
+
+    // Red y credenciales listas para publicar
+    virtual bool ready() = 0;
+    virtual bool update(const char *path, const char *json) = 0;
+    virtual bool set(const char *path, const char *json) = 0;
+
+    virtual int lastStatus() const = 0; // Código HTTP (o negativo si no hubo respuesta)
+    virtual const char *lastError() const = 0;
+};
+
+/**
+ * @brief Stream de cambios de un nodo (SSE de RTDB)
+ *
+ * read() no bloquea: entrega como mucho un evento por llamada, con la ruta
+ * relativa al stream, el tipo de dato de RTDB ("boolean", "json", "null"...)
+ * y el payload tal como lo espera CommandStream::parse().
+ */
+class CommandSource
+{
+public:
+    enum Result
+    {
+        NONE,    // Sin eventos nuevos
+        DATA,    // message tiene un evento
+        TIMEOUT, // Keep-alive perdido; se reanuda solo
+        BROKEN   // Stream caído: llamar a end() y volver a begin()
+    };
+
+    struct Message
+    {
+        const char *path;
+        const char *type;
+        const char *payload;
+    };
+
+    virtual ~CommandSource() {}
+
+    virtual bool begin(const char *path) = 0;
+    virtual Result read(Message &message) = 0;
+    virtual void end() = 0;
+    virtual const char *lastError() const = 0;
+};
+
+/**
+ * @brief Arma un PATCH multi-ruta en un buffer fijo, sin memoria dinámica
+ *
+ * El buffer siempre contiene JSON válido: cada add*() reescribe la llave de
+ * cierre. Si una entrada no cabe se descarta entera y overflow() queda en
+ * true (el resto del cuerpo sigue siendo publicable).
+ */
+class PatchBuilder
+{
+public:
+    PatchBuilder(char *buffer, size_t capacity);
+
+    void clear();
+    bool addInt(const char *key, int32_t value);
+    bool addU64(const char *key, uint64_t value);
+    bool addFloat(const char *key, float value); // NaN o infinito: null
+    bool addBool(const char *key, bool value);
+    bool addText(const char *key, const char *value);
+    bool addRaw(const char *key, const char *json); // Valor JSON ya armado
+
+    const char *c_str() const { return buffer; }
+    size_t length() const { return len; }
+    uint16_t count() const { return entries; }
+    bool overflow() const { return overflowed; }
+
+private:
+    char *buffer;
+    size_t capacity;
+    size_t len;
+    uint16_t entries;
+    bool overflowed;
+
+    bool beginEntry(const char *key, size_t &mark);
+    bool append(const char *text, size_t n);
+    bool appendEscaped(const char *text);
+    bool endEntry(size_t mark, bool ok);
+};
+
+#endif // TELEMETRY_SINK_H
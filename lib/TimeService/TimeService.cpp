@@ -0,0 +1,163 @@
+#include "TimeService.h"
+#include "Log.h"
+#include <LittleFS.h>
+#include <sys/time.h>
+
+namespace
+{
+    constexpr int64_t NOISE_MS = 2;            // Redondeo entre millis() y la hora del sistema
+    constexpr uint64_t MIN_DRIFT_SPAN_MS = 60000; // Ventana mínima para estimar la deriva
+
+    struct BootFile
+    {
+        uint32_t id;
+        uint32_t check; // ~id: detecta un archivo corrupto
+    };
+}
+
+TimeService::TimeService(EpochSource source, unsigned long checkIntervalMs, uint32_t stepMs)
+    : source(source), checkIntervalMs(checkIntervalMs), stepMs(stepMs), boot(0), seq(0), synced(false), offset(0),
+      lastIssuedMs(0), anchorMonoMs(0), lastCheckMs(0), checked(false), monoStarted(false), lastMillis(0),
+      wraps(0)
+{
+}
+
+void TimeService::begin(uint32_t bootId, const char *server1, const char *server2)
+{
+    boot = bootId;
+    if (server1)
+        startSntp(server1, server2);
+    LOG_I(TIME, "TimeService: boot_id %lu, esperando hora SNTP", (unsigned long)boot);
+}
+
+void TimeService::startSntp(const char *server1, const char *server2)
+{
+    // UTC; el resultado llega en segundo plano y update() lo toma
+    configTime(0, 0, server1, server2);
+}
+
+// ============================================================================
+// RELOJ
+// ============================================================================
+
+uint64_t TimeService::monotonicMs(unsigned long nowMs)
+{
+    // millis() da la vuelta a los 49.7 días. Un retroceso chico no es una
+    // vuelta sino un nowMs tomado un poco antes que el de la llamada anterior
+    uint32_t now = uint32_t(nowMs);
+    if (!monoStarted || uint32_t(now - lastMillis) < 0x80000000u)
+    {
+        if (monoStarted && now < lastMillis)
+            wraps++;
+        monoStarted = true;
+        lastMillis = now;
+        return (uint64_t(wraps) << 32) | now;
+    }
+    uint32_t w = now > lastMillis ? wraps - 1 : wraps; // Vieja y de antes de la vuelta
+    return (uint64_t(w) << 32) | now;
+}
+
+void TimeService::update(unsigned long nowMs)
+{
+    if (checked && nowMs - lastCheckMs < checkIntervalMs)
+        return;
+    checked = true;
+    lastCheckMs = nowMs;
+
+    uint64_t system;
+    if (!source || !source(system) || system < MIN_VALID_EPOCH_MS)
+        return; // Sin hora (o reloj del sistema reiniciado): sigue el monotónico
+    uint64_t mono = monotonicMs(nowMs);
+    stats.syncs++;
+
+    if (!synced)
+    {
+        offset = int64_t(system) - int64_t(mono);
+        anchorMonoMs = mono;
+        synced = true;
+        stats.firstSyncMs = nowMs;
+        LOG_I(TIME, "TimeService: hora SNTP obtenida a los %lu ms del arranque", nowMs);
+        return;
+    }
+
+    int64_t error = int64_t(system) - (int64_t(mono) + offset);
+    if (error >= -NOISE_MS && error <= NOISE_MS)
+        return;
+
+    // SNTP corrigió el reloj del sistema: error acumulado desde la última corrección
+    uint64_t span = mono - anchorMonoMs;
+    if (span >= MIN_DRIFT_SPAN_MS)
+        stats.driftPpm = float(double(error) * 1e6 / double(span));
+    stats.lastErrorMs = int32_t(error);
+    if (error < 0 || error > int64_t(stepMs))
+        stats.steps++;
+    offset += error;
+    anchorMonoMs = mono;
+}
+
+uint64_t TimeService::epochMs(unsigned long nowMs)
+{
+    if (!synced)
+        return 0;
+    uint64_t epoch = uint64_t(int64_t(monotonicMs(nowMs)) + offset);
+    return epoch > lastIssuedMs ? epoch : lastIssuedMs;
+}
+
+TimeService::Stamp TimeService::stamp(unsigned long nowMs)
+{
+    Stamp s;
+    s.monoMs = monotonicMs(nowMs);
+    s.epochMs = 0;
+    if (synced)
+    {
+        // Una corrección hacia atrás no reordena: se repite el último valor
+        uint64_t epoch = uint64_t(int64_t(s.monoMs) + offset);
+        s.epochMs = epoch > lastIssuedMs ? epoch : lastIssuedMs;
+        lastIssuedMs = s.epochMs;
+    }
+    s.bootId = boot;
+    s.seq = seq++;
+    return s;
+}
+
+int32_t TimeService::dayIndex(uint64_t epochMs, int32_t utcOffsetS)
+{
+    int64_t local = int64_t(epochMs / 1000) + utcOffsetS;
+    return int32_t(local >= 0 ? local / 86400 : (local - 86399) / 86400);
+}
+
+// ============================================================================
+// ARRANQUE Y HORA DEL SISTEMA
+// ============================================================================
+
+uint32_t TimeService::nextBootId(const char *path)
+{
+    if (!LittleFS.begin(true))
+        return 0;
+
+    BootFile b = {0, 0};
+    File f = LittleFS.open(path, FILE_READ);
+    if (!f || f.read(reinterpret_cast<uint8_t *>(&b), sizeof(b)) != sizeof(b) || b.check != ~b.id)
+        b.id = 0; // Primer arranque o archivo dañado: se reinicia el contador
+    f.close();
+
+    b.id++;
+    b.check = ~b.id;
+    char tmp[40];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    f = LittleFS.open(tmp, FILE_WRITE);
+    bool ok = f && f.write(reinterpret_cast<const uint8_t *>(&b), sizeof(b)) == sizeof(b);
+    f.close();
+    if (!ok || !LittleFS.rename(tmp, path))
+        LOG_E(TIME, "TimeService: Error - No se pudo guardar boot_id");
+    return b.id;
+}
+
+bool TimeService::systemEpochMs(uint64_t &epochMs)
+{
+    struct timeval tv;
+    if (gettimeofday(&tv, nullptr) != 0)
+        return false;
+    epochMs = uint64_t(tv.tv_sec) * 1000ULL + uint64_t(tv.tv_usec) / 1000ULL;
+    return epochMs >= MIN_VALID_EPOCH_MS;
+}
@@ -0,0 +1,94 @@
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Reloj epoch respaldado por SNTP, con sello {epoch_ms, boot_id, seq}
+ *
+ * - begin() arranca SNTP sin esperar: hasta la primera hora válida el reloj
+ *   es monotónico desde el arranque (millis() extendido a 64 bits)
+ * - update() revisa la hora del sistema cada checkIntervalMs; con la primera
+ *   hora válida ancla epoch = monotónico + offset y luego mide cuánto corrige
+ *   SNTP al reloj local (deriva en ppm)
+ * - stamp() numera cada registro: boot_id cambia en cada arranque (contador
+ *   en LittleFS) y seq crece dentro del arranque, así (boot_id, seq) es único
+ *   y ordena sin depender de la hora; epoch_ms nunca retrocede
+ *
+ * Un único hilo: update() y stamp() se llaman desde el loop() y el resto del
+ * sistema recibe los sellos ya hechos (p. ej. en el TelemetrySnapshot).
+ *
+ *   timeService.begin(TimeService::nextBootId());
+ *   timeService.update(millis());                 // En cada vuelta del loop()
+ *   TimeService::Stamp s = timeService.stamp(millis());
+ */
+class TimeService
+{
+public:
+    struct Stamp
+    {
+        uint64_t epochMs; // 0 si todavía no hay hora
+        uint64_t monoMs;  // Desde el arranque, siempre válido
+        uint32_t bootId;
+        uint32_t seq;
+    };
+
+    struct Stats
+    {
+        uint32_t syncs = 0;       // Lecturas válidas de la hora del sistema
+        uint32_t steps = 0;       // Correcciones mayores a stepMs (o hacia atrás)
+        int32_t lastErrorMs = 0;  // Última corrección de SNTP sobre el reloj local
+        float driftPpm = 0.0f;    // Deriva estimada del reloj local
+        unsigned long firstSyncMs = 0; // millis() al obtener la primera hora
+    };
+
+    // Hora del sistema en ms epoch; false si todavía no es válida
+    typedef bool (*EpochSource)(uint64_t &epochMs);
+
+    static constexpr uint64_t MIN_VALID_EPOCH_MS = 1700000000000ULL; // Nov 2023
+
+    explicit TimeService(EpochSource source = &systemEpochMs, unsigned long checkIntervalMs = 1000,
+                         uint32_t stepMs = 1000);
+
+    // Arranca SNTP (no bloquea); server1 nullptr lo deja para startSntp() (sin red aún, o en el host)
+    void begin(uint32_t bootId, const char *server1 = "pool.ntp.org", const char *server2 = "time.google.com");
+    void startSntp(const char *server1 = "pool.ntp.org", const char *server2 = "time.google.com");
+    void update(unsigned long nowMs);
+
+    Stamp stamp(unsigned long nowMs);
+    uint64_t monotonicMs(unsigned long nowMs);
+    uint64_t epochMs(unsigned long nowMs); // 0 si no hay hora
+    // epoch - monotónico: convierte sellos tomados antes de sincronizar
+    int64_t offsetMs() const { return offset; }
+
+    bool isSynced() const { return synced; }
+    uint32_t bootId() const { return boot; }
+    const Stats &getStats() const { return stats; }
+
+    // Día calendario (días desde 1970-01-01) en la zona dada
+    static int32_t dayIndex(uint64_t epochMs, int32_t utcOffsetS);
+
+    // Siguiente boot_id: lee, incrementa y guarda el contador (tmp + rename)
+    static uint32_t nextBootId(const char *path = "/boot_id.bin");
+
+    static bool systemEpochMs(uint64_t &epochMs);
+
+private:
+    EpochSource source;
+    unsigned long checkIntervalMs;
+    uint32_t stepMs;
+    uint32_t boot;
+    uint32_t seq;
+    bool synced;
+    int64_t offset;
+    uint64_t lastIssuedMs;
+    uint64_t anchorMonoMs; // Monotónico de la última corrección (para la deriva)
+    unsigned long lastCheckMs;
+    bool checked;
+    bool monoStarted;
+    uint32_t lastMillis;
+    uint32_t wraps;
+    Stats stats;
+};
+
+#endif // TIME_SERVICE_H
@@ -14,149 +14,307 @@
 #include "LevelSensor.h"
 #include "LDRSensor.h"
 #include "SerialCommands.h"
+#include "SensorHub.h"
+#include "TelemetryShadow.h"
+#include "NetTask.h"
+#include "LoopJitter.h"
+#include "CommandStream.h"
+#include "TelemetryLog.h"
+#include "HistoryChunker.h"
+#include "TimeService.h"
+#include "TelemetrySink.h"
+#include "ConnectionManager.h"
+#include "Log.h"
+#include "SerialStream.h"
+#include "Scheduler.h"
+#include "PerfStage.h"
+#if TRANSPORT_LOCAL
+#include "RestTransport.h"
+#else
+#include "FirebaseTransport.h"
+#endif
 
 // Objetos Firebase
 FirebaseData fbData;
+FirebaseData streamData; // Stream SSE de /comandos (conexión propia)
 FirebaseAuth auth;
 FirebaseConfig config;
 
+// Publicación y comandos: Firebase o el servidor local de pruebas (TRANSPORT_LOCAL)
+#if TRANSPORT_LOCAL
+RestSink telemetrySink(LOCAL_RTDB_HOST, LOCAL_RTDB_PORT);
+RestCommandSource commandSource(LOCAL_RTDB_HOST, LOCAL_RTDB_PORT);
+#else
+FirebaseSink telemetrySink(fbData);
+FirebaseCommandSource commandSource(streamData);
+#endif
+
 // Objetos de nuestros modulos
+SensorHub sensorHub(PH_PIN, TDS_PIN, LDR_PIN);
 PHSensor phSensor(PH_PIN, 0); // EEPROM addr 0
 TDSSensor tdsSensor(TDS_PIN);
 PumpController pumpController(RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS);
 MultiLevelSensor levelSensors;
 LDRSensor ldrSensor(LDR_PIN);
 SerialCommands serialCommands;
+TelemetryShadow telemetry(300000UL); // Keyframe completo cada 5 min
+TelemetryLog telemetryLog;           // Historial sin conexión (LittleFS)
+HistoryChunker historyChunker(30);   // Historial en bloques de 30 muestras (5 min)
+TimeService timeService;             // Hora SNTP y sellos {epoch_ms, boot_id, seq}
+ConnectionManager connection;        // WiFi y base de datos sin bloquear, con backoff
 
 // Timing
-unsigned long lastSensorUpdate = 0;
-unsigned long lastFirebaseUpdate = 0;
-unsigned long lastSerialOutput = 0;
-unsigned long lastCommandCheck = 0;
+unsigned long lastPublishLatency = 0;              // Ida y vuelta del último PATCH (ms)
+long bootToControlMs = -1;                         // millis() del primer ciclo de control (-1: todavía no)
 const unsigned long SENSOR_INTERVAL = 500;         // 500ms para sensores
 const unsigned long FIREBASE_INTERVAL = 10000;     // 10s para Firebase
 const unsigned long SERIAL_INTERVAL = 5000;        // 5s para salida serial
-const unsigned long COMMAND_CHECK_INTERVAL = 2000; // 2s para verificar comandos
+const unsigned long COMMAND_STREAM_INTERVAL = 20;  // Lectura del stream de comandos (no bloquea)
+const unsigned long STREAM_RETRY_INTERVAL = 5000;  // Espera antes de reabrir el stream
+const uint32_t SENSOR_FRAME_RATE = 100;            // Frames ADC por segundo sin sincronizar con la red
+const unsigned long SERIAL_POLL_INTERVAL = 10;     // Lectura de comandos seriales
+const unsigned long COMMAND_APPLY_INTERVAL = 20;   // Órdenes que llegan de la red
+const unsigned long CLOCK_INTERVAL = 250;          // Revisión de la hora SNTP
+const unsigned long LOG_INTERVAL = 10;             // Vaciado del log sin tarea propia
+const unsigned long STREAM_IDLE_INTERVAL = 50;     // Modo STREAM apagado: revisa si se encendió
+
+// Planificador del loop(): prioridades cuando varias tareas vencen juntas
+Scheduler scheduler;
+Scheduler::TaskId tareaStreamId = Scheduler::INVALID_TASK;
+const uint8_t PRIO_CONTROL = 5;
+const uint8_t PRIO_ORDENES = 4;
+const uint8_t PRIO_SENSORES = 3;
+const uint8_t PRIO_STREAM = 2;
+const uint8_t PRIO_SERVICIO = 1;
+const uint8_t PRIO_ESTADO = 0;
+
+// Red en el núcleo 0 (o en línea si NET_TASK_DEDICATED=0) y jitter del control
+NetTask netTask(FIREBASE_INTERVAL, COMMAND_STREAM_INTERVAL);
+LoopJitter controlJitter(SENSOR_INTERVAL * 1000UL);
+
+// Latencia por etapa (comando PERF; con PERF_TELEMETRY también en la telemetría)
+PERF_STAGE(perfControl, "control");
+PERF_STAGE(perfPh, "ph");
+PERF_STAGE(perfTds, "tds");
+PERF_STAGE(perfLdr, "ldr");
+PERF_STAGE(perfSerie, "serie");
+PERF_STAGE(perfEnviar, "enviar");
+PERF_STAGE(perfConsulta, "consulta");
+
+// Registros binarios por Serial (STREAM,ON,<hz>) para captura en banco
+SerialStream serialStream;
+uint32_t loopMaxUs = 0; // Pasada más larga del loop() (sin la espera) desde el último registro
+
+// Comandos por stream en lugar de consultas periódicas
+CommandStream commandStream;
+bool streamActivo = false;
+unsigned long lastStreamAttempt = 0;
+
+// Contadores de la red para el estado del sistema: los escribe el contexto de red y loop() imprime la última copia
+struct EstadoRed
+{
+  NetTask::Stats net;
+  uint8_t historialEnRam;
+  bool historialFechado;
+  uint32_t historialBloques;
+  uint32_t historialEnFlash;
+  ConnectionManager::State conexion;
+  ConnectionManager::Stats conexionStats;
+  CommandStream::Stats comandos;
+  bool streamActivo;
+};
+TripleBuffer<EstadoRed> canalEstadoRed;
 
 // Monitoreo de exposición solar
 unsigned long solarExposureStartTime = 0;        // Inicio de exposición solar
 unsigned long totalSolarExposureToday = 0;       // Total acumulado hoy (en segundos)
 bool isSolarExposure = false;                    // Bandera de exposición activa
 const int SOLAR_THRESHOLD = 500;                 // Umbral de LDR para considerar luz solar
-const unsigned long SOLAR_RESET_TIME = 86400000; // 24 horas en ms para resetear contador
+const unsigned long SOLAR_RESET_TIME = 86400000; // Sin hora SNTP: resetear cada 24 horas desde el arranque
+const int32_t ZONA_HORARIA_S = -5 * 3600;        // Día local para el contador (Colombia, UTC-5)
+
+// ============ Hooks de ConnectionManager (contexto de red, nunca esperan) ============
 
-void conectarWiFi()
+void iniciarWiFi()
 {
-  Serial.println("\nConectando a WiFi...");
+  LOG_I(NET, "Conectando a WiFi...");
+  WiFi.mode(WIFI_STA);
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  int intentos = 0;
-  while (WiFi.status() != WL_CONNECTED && intentos < 20)
-  {
-    delay(500);
-    Serial.print(".");
-    intentos++;
-  }
-  if (WiFi.status() == WL_CONNECTED)
+}
+
+bool wifiConectado()
+{
+  return WiFi.status() == WL_CONNECTED;
+}
+
+void cortarWiFi()
+{
+  WiFi.disconnect();
+}
+
+// Con la primera conexión: SNTP y cliente de la base de datos
+void iniciarServicios()
+{
+  LOG_I(NET, "Conectado a WiFi, IP: %s", WiFi.localIP().toString().c_str());
+  timeService.startSntp();
+#if TRANSPORT_LOCAL
+  // Servidor local (tools/rtdb_server): sin credenciales
+  LOG_I(NET, "Transporte local: http://%s:%d", LOCAL_RTDB_HOST, LOCAL_RTDB_PORT);
+#else
+  LOG_I(NET, "Configurando Firebase...");
+  config.database_url = DATABASE_URL;
+  config.host = DATABASE_HOST;
+  config.signer.tokens.legacy_token = DATABASE_SECRET;
+  config.token_status_callback = tokenStatusCallback;
+  Firebase.begin(&config, &auth);
+  Firebase.reconnectWiFi(false); // Las reconexiones las lleva ConnectionManager
+#endif
+}
+
+bool baseDeDatosLista()
+{
+  return telemetrySink.ready();
+}
+
+// Un campo de la sombra de telemetría como entrada del PATCH; false si no cupo
+bool agregarCampo(PatchBuilder &patch, const TelemetryShadow::Field &f)
+{
+  switch (f.type)
   {
-    Serial.println("\nConectado a WiFi");
-    Serial.print("IP: ");
-    Serial.println(WiFi.localIP());
+  case TelemetryShadow::FLOAT:
+    return patch.addFloat(f.path, f.value.f);
+  case TelemetryShadow::INT:
+    return patch.addInt(f.path, f.value.i);
+  case TelemetryShadow::BOOL:
+    return patch.addBool(f.path, f.value.b);
+  case TelemetryShadow::TEXT:
+    return patch.addText(f.path, f.text);
   }
-  else
+  return false;
+}
+
+// TDS válido para publicar (evitar NaN o valores inválidos)
+float validarTDS(float tds)
+{
+  return (isfinite(tds) && tds >= 0.0f && tds <= 2000.0f) ? tds : 0.0f;
+}
+
+// El bloque de historial listo que no se pudo enviar pasa a flash, con su sello
+// (sin hora SNTP, con el tiempo desde el arranque: se fecha al reenviarlo)
+void guardarBloqueEnFlash()
+{
+  static HistoryChunker::Point puntos[HistoryChunker::MAX_CHUNK]; // Contexto de red: fuera de la pila
+  uint8_t n = historyChunker.peek(puntos, HistoryChunker::MAX_CHUNK);
+  for (uint8_t i = 0; i < n; i++)
   {
-    Serial.println("\nFallo WiFi. Reinicia la placa.");
+    telemetryLog.append(puntos[i].epochMs, puntos[i].bootId, puntos[i].seq, puntos[i].ph, puntos[i].tds,
+                        puntos[i].ldr, puntos[i].monotonic);
   }
+  historyChunker.commit(n);
 }
 
-void enviarDatos()
+// Corre en el contexto de red: solo usa el snapshot, nunca los módulos
+void enviarDatos(const TelemetrySnapshot &s)
 {
-  if (!Firebase.ready())
+  PERF_SCOPE(perfEnviar);
+
+  // El historial se junta en RAM con el sello de la lectura, no del envío;
+  // con hora SNTP también se fecha lo sellado antes de sincronizar
+  if (s.clockSynced)
   {
-    Serial.println("Firebase no listo");
-    return;
+    historyChunker.setClock(s.clockOffsetMs);
   }
+  historyChunker.add(s.stamp, s.ph, validarTDS(s.tds), s.ldrRaw);
 
-  Serial.println("--- Enviando datos a Firebase ---");
-
-  String mac = WiFi.macAddress();
-  bool ok = true;
+  // Sin red o sin hora SNTP: los bloques completos quedan en flash y se
+  // reenvían al volver (sin hora, una vez que se pueda fechar)
+  if (!connection.isOnline() || !historyChunker.hasClock())
+  {
+    while (historyChunker.ready())
+    {
+      guardarBloqueEnFlash();
+    }
+  }
+  if (!connection.isOnline())
+  {
+    LOG_W(NET, "Base de datos no lista: historial guardado (%u en RAM, %lu en flash)", historyChunker.count(),
+               (unsigned long)telemetryLog.pending());
+    return;
+  }
 
-  // DATOS DE DIAGNOSTICO
-  ok &= Firebase.RTDB.setString(&fbData, "/hydroponic_data/diagnostico/chip", "ESP32-D0WD-V3");
-  ok &= Firebase.RTDB.setString(&fbData, "/hydroponic_data/diagnostico/mac", mac);
-  ok &= Firebase.RTDB.setFloat(&fbData, "/hydroponic_data/diagnostico/senal", WiFi.RSSI());
-  ok &= Firebase.RTDB.setString(&fbData, "/hydroponic_data/diagnostico/ip", WiFi.localIP().toString());
-  ok &= Firebase.RTDB.setString(&fbData, "/hydroponic_data/diagnostico/estado", "Conectado");
-  ok &= Firebase.RTDB.setInt(&fbData, "/hydroponic_data/diagnostico/timestamp", millis());
+  LOG_I(NET, "--- Enviando datos ---");
+
+  // DATOS DE DIAGNOSTICO (estáticos: solo salen en keyframes)
+  telemetry.setText("diagnostico/chip", "ESP32-D0WD-V3");
+  telemetry.setText("diagnostico/mac", WiFi.macAddress().c_str());
+  telemetry.setFloat("diagnostico/senal", WiFi.RSSI(), 3.0f);
+  telemetry.setText("diagnostico/ip", WiFi.localIP().toString().c_str());
+  telemetry.setText("diagnostico/estado", "Conectado");
+  telemetry.setInt("diagnostico/boot_id", s.stamp.bootId);
+  telemetry.setBool("diagnostico/hora_sincronizada", s.clockSynced);
+  telemetry.setFloat("diagnostico/deriva_ppm", s.clockDriftPpm, 1.0f);
+  telemetry.setInt("diagnostico/latencia_ms", lastPublishLatency, 100);
+  telemetry.setInt("diagnostico/jitter_control_ms", s.loopLateMaxUs / 1000UL, 50);
+  const ConnectionManager::Stats &red = connection.getStats();
+  telemetry.setInt("diagnostico/arranque_control_ms", s.bootControlMs);
+  telemetry.setInt("diagnostico/arranque_publicacion_ms", red.bootToFirstPublishMs);
+  telemetry.setInt("diagnostico/reconexiones_wifi", red.wifiLost);
+#if PERF_ENABLED && PERF_TELEMETRY
+  // Latencia por etapa, compacta: "p50/p99/max" en µs (p50 y p99 son cotas de cubeta y cambian poco)
+  for (uint8_t i = 0; i < s.perfStages; i++)
+  {
+    char perf[TelemetryShadow::TEXT_LEN];
+    snprintf(perf, sizeof(perf), "%lu/%lu/%lu", (unsigned long)s.perf[i].p50Us, (unsigned long)s.perf[i].p99Us,
+             (unsigned long)s.perf[i].maxUs);
+    telemetry.setText(s.perf[i].path, perf);
+  }
+#endif
 
   // DATOS DE SENSORES
   float ph_value, tds_value;
   int nivel_liquido_pct, nivel_tranque;
 
   // Siempre leer sensores
-  ph_value = phSensor.getFilteredPH();
-  tds_value = tdsSensor.getTDSValue();
-  
-  // Validar TDS antes de enviar (evitar NaN o valores inválidos)
-  if (!isfinite(tds_value) || tds_value < 0.0f || tds_value > 2000.0f)
-  {
-    tds_value = 0.0f; // Establecer a 0 si es inválido
-  }
+  ph_value = s.ph;
+  tds_value = validarTDS(s.tds);
 
   // Niveles de tanques de dosificacion
-  bool nivel_ph_minus = levelSensors.isLevelOK("pH-");
-  bool nivel_ph_plus = levelSensors.isLevelOK("pH+");
+  bool nivel_ph_minus = s.levelMinus;
+  bool nivel_ph_plus = s.levelPlus;
 
   // Para compatibilidad con dashboard - usar 0 si no hay sensores de nivel general
   nivel_liquido_pct = 0; // Indicar que no hay sensor
   nivel_tranque = 0;     // Indicar que no hay sensor
 
-  Serial.println("ENVIANDO DATOS DE SENSORES");
-
   // Valor de la fotoresistencia (LDR) - LEER PRIMERO
-  int ldr_value = ldrSensor.getRawValue();
-  String ldr_level = ldrSensor.getLightLevelString();
-
-  // Generar timestamp para el historial
-  unsigned long dataTimestamp = millis();
-  char phHistPath[80];
-  char tdsHistPath[80];
-  char ldrHistPath[80];
-  sprintf(phHistPath, "/hydroponic_data/historial/ph/%lu", dataTimestamp);
-  sprintf(tdsHistPath, "/hydroponic_data/historial/tds/%lu", dataTimestamp);
-  sprintf(ldrHistPath, "/hydroponic_data/historial/ldr/%lu", dataTimestamp);
-
-  // Enviar datos de sensores (datos actuales)
-  ok &= Firebase.RTDB.setFloat(&fbData, "/hydroponic_data/sensores/ph4502c/ph", ph_value);
-  ok &= Firebase.RTDB.setFloat(&fbData, "/hydroponic_data/sensores/sen0244/tds", tds_value);
-  ok &= Firebase.RTDB.setInt(&fbData, "/hydroponic_data/sensores/sen0205/nivel_liquido", nivel_liquido_pct);
-  ok &= Firebase.RTDB.setInt(&fbData, "/hydroponic_data/sensores/ultrasonico/nivel_tranque", nivel_tranque);
-
-  // Guardar historial con timestamp (paths generados con sprintf)
-  ok &= Firebase.RTDB.setFloat(&fbData, phHistPath, ph_value);
-  ok &= Firebase.RTDB.setFloat(&fbData, tdsHistPath, tds_value);
-  ok &= Firebase.RTDB.setInt(&fbData, ldrHistPath, ldr_value);
+  int ldr_value = s.ldrRaw;
+
+  // Datos de sensores (datos actuales), con su banda muerta
+  telemetry.setFloat("sensores/ph4502c/ph", ph_value, 0.02f);
+  telemetry.setFloat("sensores/sen0244/tds", tds_value, 5.0f);
+  telemetry.setInt("sensores/sen0205/nivel_liquido", nivel_liquido_pct);
+  telemetry.setInt("sensores/ultrasonico/nivel_tranque", nivel_tranque);
 
   // Estados de las bombas (usar estado lógico, no físico)
-  int bomba_agua = pumpController.isCirculationOn() ? 1 : 0;
-  int bomba_sustrato = pumpController.isPumpMinusActive() ? 1 : 0; // Estado lógico de control
-  int bomba_solucion = pumpController.isPumpPlusActive() ? 1 : 0;  // Estado lógico de control
+  int bomba_agua = s.circulation ? 1 : 0;
+  int bomba_sustrato = s.pumpMinus ? 1 : 0; // Estado lógico de control
+  int bomba_solucion = s.pumpPlus ? 1 : 0;  // Estado lógico de control
 
-  ok &= Firebase.RTDB.setInt(&fbData, "/hydroponic_data/actuadores/bomba_agua/estado", bomba_agua);
-  ok &= Firebase.RTDB.setInt(&fbData, "/hydroponic_data/actuadores/bomba_sustrato/estado", bomba_sustrato);
-  ok &= Firebase.RTDB.setInt(&fbData, "/hydroponic_data/actuadores/bomba_solucion/estado", bomba_solucion);
+  telemetry.setInt("actuadores/bomba_agua/estado", bomba_agua);
+  telemetry.setInt("actuadores/bomba_sustrato/estado", bomba_sustrato);
+  telemetry.setInt("actuadores/bomba_solucion/estado", bomba_solucion);
 
   // Estado de emergencia
-  ok &= Firebase.RTDB.setBool(&fbData, "/hydroponic_data/sistema/emergencia", pumpController.isEmergencyMode());
+  telemetry.setBool("sistema/emergencia", s.emergency);
 
   // Datos adicionales del sistema real
-  ok &= Firebase.RTDB.setBool(&fbData, "/hydroponic_data/sensores/tds_conectado", tdsSensor.isConnected());
-  ok &= Firebase.RTDB.setBool(&fbData, "/hydroponic_data/sensores/ph_calibrado", phSensor.isCalibrationValid());
-  ok &= Firebase.RTDB.setString(&fbData, "/hydroponic_data/sistema/modo", "conectados");
+  telemetry.setBool("sensores/tds_conectado", s.tdsConnected);
+  telemetry.setBool("sensores/ph_calibrado", s.phCalibrated);
+  telemetry.setText("sistema/modo", "conectados");
 
-  // Enviar datos de LDR a sensores en tiempo real
-  ok &= Firebase.RTDB.setInt(&fbData, "/hydroponic_data/sensores/ldr/valor_bruto", ldr_value);
-  ok &= Firebase.RTDB.setString(&fbData, "/hydroponic_data/sensores/ldr/nivel_luz", ldr_level);
+  // Datos de LDR en tiempo real
+  telemetry.setInt("sensores/ldr/valor_bruto", ldr_value, 20);
+  telemetry.setText("sensores/ldr/nivel_luz", s.ldrLevel);
 
   // Calcular tiempo de exposición solar
   unsigned long currentTime = millis();
@@ -167,7 +325,7 @@ void enviarDatos()
     // Inicio de exposición solar
     solarExposureStartTime = currentTime;
     isSolarExposure = true;
-    Serial.println("☀️ Inicio de exposición solar detectado");
+    LOG_I(MAIN, "☀️ Inicio de exposición solar detectado");
   }
   else if (!hasSolarExposure && isSolarExposure)
   {
@@ -175,16 +333,28 @@ void enviarDatos()
     unsigned long exposureTime = (currentTime - solarExposureStartTime) / 1000; // Convertir a segundos
     totalSolarExposureToday += exposureTime;
     isSolarExposure = false;
-    Serial.printf("☀️ Exposición solar finalizada. Tiempo: %lu segundos\n", exposureTime);
+    LOG_I(MAIN, "☀️ Exposición solar finalizada. Tiempo: %lu segundos", exposureTime);
   }
 
-  // Resetear contador cada 24 horas
+  // Resetear contador al cambiar el día local; sin hora SNTP, cada 24 horas
   static unsigned long lastResetTime = 0;
-  if ((currentTime - lastResetTime) > SOLAR_RESET_TIME)
+  static int32_t diaSolar = -1;
+  bool resetearSolar;
+  if (s.stamp.epochMs)
+  {
+    int32_t dia = TimeService::dayIndex(s.stamp.epochMs, ZONA_HORARIA_S);
+    resetearSolar = diaSolar >= 0 && dia != diaSolar;
+    diaSolar = dia;
+  }
+  else
+  {
+    resetearSolar = (currentTime - lastResetTime) > SOLAR_RESET_TIME;
+  }
+  if (resetearSolar)
   {
     totalSolarExposureToday = 0;
     lastResetTime = currentTime;
-    Serial.println("🔄 Contador de exposición solar reseteado");
+    LOG_I(MAIN, "🔄 Contador de exposición solar reseteado");
   }
 
   // Calcular tiempo restante para 6 horas máximo (21600 segundos)
@@ -193,289 +363,635 @@ void enviarDatos()
                                          ? (maxSolarExposure - totalSolarExposureToday)
                                          : 0;
 
-  // Enviar datos de exposición solar a Firebase
-  ok &= Firebase.RTDB.setInt(&fbData, "/hydroponic_data/sensores/ldr/exposicion_solar_hoy_segundos", totalSolarExposureToday);
-  ok &= Firebase.RTDB.setInt(&fbData, "/hydroponic_data/sensores/ldr/tiempo_restante_segundos", remainingSolarTime);
-  ok &= Firebase.RTDB.setBool(&fbData, "/hydroponic_data/sensores/ldr/exposicion_activa", isSolarExposure);
+  // Exposición solar
+  telemetry.setInt("sensores/ldr/exposicion_solar_hoy_segundos", totalSolarExposureToday, 60);
+  telemetry.setInt("sensores/ldr/tiempo_restante_segundos", remainingSolarTime, 60);
+  telemetry.setBool("sensores/ldr/exposicion_activa", isSolarExposure);
 
   // Estados de sensores de nivel de tanques de dosificacion
-  ok &= Firebase.RTDB.setBool(&fbData, "/hydroponic_data/sensores/nivel_ph_minus/estado", nivel_ph_minus);
-  ok &= Firebase.RTDB.setBool(&fbData, "/hydroponic_data/sensores/nivel_ph_plus/estado", nivel_ph_plus);
+  telemetry.setBool("sensores/nivel_ph_minus/estado", nivel_ph_minus);
+  telemetry.setBool("sensores/nivel_ph_plus/estado", nivel_ph_plus);
+
+  // Solo los campos que cruzaron su banda muerta (o todos en keyframe).
+  // Todo va en un único PATCH multi-ruta sobre /hydroponic_data: cada
+  // clave es una ruta, así cada entrada actualiza solo esa hoja.
+  uint8_t campos = telemetry.collect(millis());
+  static char cuerpo[2048 + HistoryChunker::KEY_MAX + HistoryChunker::JSON_MAX]; // Contexto de red: fuera de la pila
+  PatchBuilder patch(cuerpo, sizeof(cuerpo));
+  telemetry.forEachDue([&patch, &campos](const TelemetryShadow::Field &f)
+  {
+    // Lo que no cabe queda pendiente: commit() no lo da por publicado
+    if (!agregarCampo(patch, f))
+    {
+      telemetry.markUnsent(f);
+      campos--;
+    }
+  });
+
+  // Latido con su sello: cambia en cada ciclo, no pasa por la sombra.
+  // Sin hora SNTP el timestamp es el tiempo desde el arranque.
+  patch.addU64("diagnostico/timestamp", s.stamp.epochMs ? s.stamp.epochMs : s.stamp.monoMs);
+  patch.addU64("diagnostico/seq", s.stamp.seq);
+
+  // Historial: un bloque por día y cada chunkSize() muestras, en el mismo PATCH
+  uint8_t muestras = 0;
+  if (historyChunker.ready())
+  {
+    static HistoryChunker::Point puntos[HistoryChunker::MAX_CHUNK]; // Contexto de red: fuera de la pila
+    static char bloque[HistoryChunker::JSON_MAX];
+    char clave[HistoryChunker::KEY_MAX];
+    muestras = historyChunker.peek(puntos, HistoryChunker::MAX_CHUNK);
+    muestras = HistoryChunker::format(puntos, muestras, clave, sizeof(clave), bloque, sizeof(bloque),
+                                      HISTORY_PACKED);
+    if (muestras && !patch.addRaw(clave, bloque))
+    {
+      muestras = 0; // No cupo: sigue en RAM para el próximo envío
+    }
+  }
+  if (patch.overflow())
+  {
+    LOG_W(NET, "PATCH sin espacio: algunos campos salen en el próximo envío");
+  }
+
+  unsigned long t0 = millis();
+  bool ok = telemetrySink.update("/hydroponic_data", patch.c_str());
+  lastPublishLatency = millis() - t0;
 
   if (ok)
   {
-    Serial.println("Datos enviados correctamente a Firebase");
+    connection.notePublish(millis());
+    telemetry.commit();
+    historyChunker.commit(muestras);
+    LOG_I(NET, "Datos enviados correctamente (%u/%u campos%s, %lu ms)", campos,
+               telemetry.size(), telemetry.isKeyframe() ? ", keyframe" : "", lastPublishLatency);
   }
   else
   {
-    Serial.printf("Error Firebase: %s (HTTP: %d)\n", fbData.errorReason().c_str(), fbData.httpCode());
+    LOG_E(NET, "Error al publicar: %s (HTTP: %d, %lu ms)", telemetrySink.lastError(),
+               telemetrySink.lastStatus(), lastPublishLatency);
+    // Los campos actuales se reintentan solos; el bloque de historial va a flash
+    if (muestras)
+    {
+      guardarBloqueEnFlash();
+    }
   }
 }
 
-void imprimirEstadoSistema()
+// Corre en el contexto de red: un lote del historial guardado sin conexión,
+// como máximo uno por segundo para no acaparar la red. Espera la hora SNTP:
+// lo guardado sin hora en este arranque se fecha con su offset
+void reenviarHistorial(const TelemetrySnapshot &s)
 {
-  Serial.println("\n=== ESTADO DEL SISTEMA HIDROPONICO ===");
+  if (!telemetryLog.pending() || !connection.isOnline() || !s.clockSynced)
+  {
+    return;
+  }
 
-  // Estado de sensores
-  Serial.printf("pH: %.2f (%.3fV) [%s]\n",
-                phSensor.getFilteredPH(),
-                phSensor.getVoltage(),
-                phSensor.isCalibrationValid() ? "Calibrado" : "No calibrado");
+  uint16_t n = telemetryLog.replay(millis(), [&s](const TelemetryLog::Record *r, uint16_t count) {
+    // Se vuelven a agrupar en bloques por día y arranque, igual que en vivo;
+    // lo que no se puede fechar (sin hora, de otro arranque) se descarta
+    static HistoryChunker::Point puntos[TelemetryLog::MAX_BATCH]; // Contexto de red: fuera de la pila
+    static char bloque[HistoryChunker::JSON_MAX];
+    uint16_t validos = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+      TelemetryLog::Record registro = r[i];
+      if (TelemetryLog::toEpoch(registro, s.stamp.bootId, s.clockOffsetMs) &&
+          registro.epochMs >= TimeService::MIN_VALID_EPOCH_MS)
+      {
+        puntos[validos++] = {registro.epochMs, registro.bootId, registro.sampleSeq, registro.ph, registro.tds,
+                             registro.ldr, false};
+      }
+    }
+    if (!validos)
+    {
+      return true;
+    }
 
-  float tds_val = tdsSensor.getTDSValue();
-  if (isfinite(tds_val) && tds_val >= 0.0f)
+    // Casi siempre un solo PATCH; si los bloques no caben se envía por partes
+    static char cuerpo[2 * (HistoryChunker::KEY_MAX + HistoryChunker::JSON_MAX)];
+    PatchBuilder patch(cuerpo, sizeof(cuerpo));
+    char clave[HistoryChunker::KEY_MAX];
+    for (uint16_t i = 0; i < validos;)
+    {
+      uint16_t resto = validos - i;
+      uint8_t maximo = resto < historyChunker.chunkSize() ? resto : historyChunker.chunkSize();
+      uint8_t k = HistoryChunker::format(&puntos[i], maximo, clave, sizeof(clave), bloque, sizeof(bloque),
+                                         HISTORY_PACKED);
+      if (!k)
+      {
+        return false;
+      }
+      if (!patch.addRaw(clave, bloque))
+      {
+        if (!telemetrySink.update("/hydroponic_data", patch.c_str()))
+        {
+          return false;
+        }
+        patch.clear();
+        patch.addRaw(clave, bloque);
+      }
+      i += k;
+    }
+    return telemetrySink.update("/hydroponic_data", patch.c_str());
+  });
+
+  if (n)
   {
-    Serial.printf("TDS: %.0f ppm [%s] (ADC: %d)\n",
-                  tds_val,
-                  tdsSensor.isConnected() ? "Conectado" : "Desconectado",
-                  tdsSensor.getRawADC());
+    LOG_I(NET, "Historial reenviado: %u puntos (%lu pendientes)", n, (unsigned long)telemetryLog.pending());
   }
-  else
+}
+
+// Corre en el contexto de red: abre (o reabre) el stream de /comandos y
+// pasa al loop() las órdenes que llegan
+void consultarComandos(NetTask &net, const TelemetrySnapshot &)
+{
+  PERF_SCOPE(perfConsulta);
+
+  if (!connection.isOnline())
   {
-    Serial.printf("TDS: ERROR (NaN/Inf) [%s] (ADC: %d)\n",
-                  tdsSensor.isConnected() ? "Conectado" : "Desconectado",
-                  tdsSensor.getRawADC());
+    return;
   }
 
-  Serial.printf("LDR: %d (%s)\n",
-                ldrSensor.getRawValue(),
-                ldrSensor.getLightLevelString().c_str());
+  if (!streamActivo)
+  {
+    unsigned long now = millis();
+    if (commandStream.getStats().restarts > 0 && now - lastStreamAttempt < STREAM_RETRY_INTERVAL)
+    {
+      return;
+    }
+    lastStreamAttempt = now;
+    commandStream.noteRestart();
+    if (!commandSource.begin("/hydroponic_data/comandos"))
+    {
+      LOG_E(NET, "Error abriendo stream de comandos: %s", commandSource.lastError());
+      return;
+    }
+    // El primer evento trae el nodo completo: el estado se sincroniza solo
+    streamActivo = true;
+    LOG_I(NET, "Stream de comandos activo en /hydroponic_data/comandos");
+  }
 
-  // Estado de niveles de tanques de dosificacion - CON DEBUGGING
-  bool nivelMinus = levelSensors.isLevelOK("pH-");
-  bool nivelPlus = levelSensors.isLevelOK("pH+");
-  int rawMinus = digitalRead(18); // LVL_PH_MINUS
-  int rawPlus = digitalRead(21);  // LVL_PH_PLUS
+  // No bloquea si no hay datos; tras un timeout de keep-alive el stream se reanuda solo
+  CommandSource::Message msg;
+  CommandSource::Result r = commandSource.read(msg);
+  if (r == CommandSource::BROKEN)
+  {
+    LOG_E(NET, "Error en stream de comandos: %s, reabriendo", commandSource.lastError());
+    commandSource.end();
+    streamActivo = false;
+    return;
+  }
 
-  Serial.printf("Niveles - pH-: %s (pin18=%d) | pH+: %s (pin21=%d)\n",
-                nivelMinus ? "OK" : "BAJO", rawMinus,
-                nivelPlus ? "OK" : "BAJO", rawPlus);
+  if (r == CommandSource::TIMEOUT)
+  {
+    LOG_W(NET, "Stream de comandos: timeout, reanudando...");
+    commandStream.noteTimeout();
+  }
 
-  // Estado de bombas
-  Serial.printf("Bombas - Circulacion: %s | pH-: %s | pH+: %s\n",
-                pumpController.isCirculationOn() ? "ON" : "OFF",
-                pumpController.isPumpMinusActive() ? "ON" : "OFF",
-                pumpController.isPumpPlusActive() ? "ON" : "OFF");
+  if (r != CommandSource::DATA)
+  {
+    return;
+  }
 
-  // Estado de control
-  if (pumpController.getCurrentDoseState() == PumpController::DOSING)
+  CommandStream::Event ev;
+  if (!commandStream.parse(msg.path, msg.type, msg.payload, ev))
   {
-    const char *tipoStr = (pumpController.getCurrentDoseType() == PumpController::DOSE_PLUS) ? "pH+" : "pH-";
-    Serial.printf("Dosificacion activa: %s (Pulso: %lums, Sesion: %lums)\n",
-                  tipoStr,
-                  pumpController.getElapsedPulse(),
-                  pumpController.getElapsedSession());
+    return;
   }
-  else
+
+  // Comando de reinicio
+  if (ev.reset)
   {
-    Serial.println("Estado de dosificacion: IDLE");
+    LOG_W(MAIN, "\n⚠️ COMANDO DE REINICIO RECIBIDO DESDE FIREBASE");
+
+    // Limpiar el comando para evitar reinicios múltiples
+    telemetrySink.set("/hydroponic_data/comandos/reset", "false");
+    net.sendCommand(NetCommand::RESTART);
   }
 
-  Serial.printf("Modo: SENSORES REALES\n");
-  Serial.println("=====================================\n");
+  // Comando de emergencia: cada evento es un cambio (o la sincronización al
+  // abrir el stream); el loop() lo ignora si ya está en ese estado
+  if (ev.hasEmergency)
+  {
+    net.sendCommand(ev.emergency ? NetCommand::EMERGENCY_STOP : NetCommand::EMERGENCY_RESUME);
+    // Confirmar en la base de datos
+    telemetrySink.set("/hydroponic_data/sistema/emergencia", ev.emergency ? "true" : "false");
+  }
 }
 
-void setup()
+// Tareas de red periódicas (cada COMMAND_STREAM_INTERVAL)
+void atenderRed(NetTask &net, const TelemetrySnapshot &s)
 {
-  Serial.begin(115200);
-  delay(2000);
-
-  Serial.println("\n========================================");
-  Serial.println("       ­SISTEMA HIDROPONICO MODULAR ­      ");
-  Serial.println("========================================");
-
-  // Inicializar EEPROM para calibraciones
-  EEPROM.begin(512);
+  connection.update(millis());
+  consultarComandos(net, s);
+  reenviarHistorial(s);
+
+  EstadoRed estado;
+  estado.net = net.getStats();
+  estado.historialEnRam = historyChunker.count();
+  estado.historialFechado = historyChunker.hasClock();
+  estado.historialBloques = historyChunker.getStats().chunks;
+  estado.historialEnFlash = telemetryLog.pending();
+  estado.conexion = connection.state();
+  estado.conexionStats = connection.getStats();
+  estado.comandos = commandStream.getStats();
+  estado.streamActivo = streamActivo;
+  canalEstadoRed.write(estado);
+}
 
-  // Inicializar sensores
-  Serial.println("Inicializando sensores...");
-  phSensor.begin();
-  tdsSensor.begin();
-  ldrSensor.begin();
+// Estado del sistema para la red (en el loop(), tras el ciclo de control)
+TelemetrySnapshot tomarSnapshot()
+{
+  TelemetrySnapshot s = {};
+  s.takenMs = millis();
+  s.ph = phSensor.getFilteredPH();
+  s.tds = tdsSensor.getTDSValue();
+  s.ldrRaw = ldrSensor.getRawValue();
+  strncpy(s.ldrLevel, ldrSensor.getLightLevelString().c_str(), sizeof(s.ldrLevel) - 1);
+  s.tdsConnected = tdsSensor.isConnected();
+  s.phCalibrated = phSensor.isCalibrationValid();
+  s.circulation = pumpController.isCirculationOn();
+  s.pumpMinus = pumpController.isPumpMinusActive();
+  s.pumpPlus = pumpController.isPumpPlusActive();
+  s.emergency = pumpController.isEmergencyMode();
+  s.levelMinus = levelSensors.isLevelOK("pH-");
+  s.levelPlus = levelSensors.isLevelOK("pH+");
+  s.loopLateMaxUs = controlJitter.getStats().lateMaxUs;
+  s.stamp = timeService.stamp(s.takenMs);
+  s.clockSynced = timeService.isSynced();
+  s.clockOffsetMs = timeService.offsetMs();
+  s.clockDriftPpm = timeService.getStats().driftPpm;
+  s.bootControlMs = bootToControlMs;
+#if PERF_ENABLED && PERF_TELEMETRY
+  s.perfStages = PerfStage::summarize(s.perf, PerfStage::MAX_SUMMARY);
+#endif
+  return s;
+}
 
-  // Configurar sensores de nivel SEN0205 para tanques de dosificacion
-  levelSensors.addSensor(LVL_PH_MINUS, true, "pH-");
-  levelSensors.addSensor(LVL_PH_PLUS, true, "pH+");
-  levelSensors.begin();
+// Registro del modo STREAM: ADC del último frame, filtrados, niveles, relés y tiempos
+void enviarRegistroStream(uint32_t nowUs)
+{
+  StreamFrame::Record r;
+  r.timeUs = nowUs;
+  if (sensorHub.isRunning())
+  {
+    r.rawPh = sensorHub.getLatest(SensorHub::CH_PH);
+    r.rawTds = sensorHub.getLatest(SensorHub::CH_TDS);
+    r.rawLdr = sensorHub.getLatest(SensorHub::CH_LDR);
+  }
+  else
+  {
+    r.rawPh = analogRead(PH_PIN);
+    r.rawTds = analogRead(TDS_PIN);
+    r.rawLdr = analogRead(LDR_PIN);
+  }
+  r.ph = phSensor.getFilteredPH();
+  r.tds = tdsSensor.getTDSValue();
+  r.ldr = ldrSensor.getRawValue();
+  r.levels = (levelSensors.isLevelOK("pH-") ? StreamFrame::LEVEL_PH_MINUS_OK : 0) |
+             (levelSensors.isLevelOK("pH+") ? StreamFrame::LEVEL_PH_PLUS_OK : 0);
+  r.relays = (pumpController.isCirculationOn() ? StreamFrame::PUMP_CIRCULATION_ON : 0) |
+             (pumpController.isPumpMinusOn() ? StreamFrame::PUMP_PH_MINUS_ON : 0) |
+             (pumpController.isPumpPlusOn() ? StreamFrame::PUMP_PH_PLUS_ON : 0) |
+             (pumpController.isEmergencyMode() ? StreamFrame::EMERGENCY_STOP : 0);
+  r.loopMaxUs = loopMaxUs;
+  r.controlLateUs = controlJitter.getStats().lateLastUs;
+  serialStream.send(r);
+  loopMaxUs = 0;
+}
 
-  // Inicializar controlador de bombas
-  Serial.println("Inicializando bombas...");
-  pumpController.begin();
+void reiniciar(void *)
+{
+  logger.end(); // Detiene la tarea del log y vacía la cola; si no se detiene a tiempo, reinicia igual
+  ESP.restart();
+}
 
-  // Inicializar comandos seriales
-  serialCommands.begin(&phSensor, &pumpController, &tdsSensor);
+// RESET desde el dashboard o por Serial: el loop() sigue durante el segundo de espera
+void programarReinicio()
+{
+  LOG_W(MAIN, "Reiniciando ESP32 en 1 segundo...");
+  scheduler.after("reinicio", 1000000UL, PRIO_CONTROL, &reiniciar);
+}
 
-  // Conectar WiFi
-  conectarWiFi();
-  if (WiFi.status() != WL_CONNECTED)
+// Órdenes que llegaron desde la red
+void aplicarComandos()
+{
+  NetCommand cmd;
+  while (netTask.receiveCommand(cmd))
   {
-    Serial.println("Sin WiFi - Sistema requiere conexion para datos reales");
-    Serial.println("con WIFI REQUERIDO PARA FUNCIONAMIENTO REAL");
-    while (true)
+    switch (cmd.type)
     {
-      delay(1000);
-      Serial.println("Reintentando WiFi...");
-      conectarWiFi();
-      if (WiFi.status() == WL_CONNECTED)
+    case NetCommand::EMERGENCY_STOP:
+      if (!pumpController.isEmergencyMode())
+      {
+        pumpController.emergencyStop();
+      }
+      break;
+    case NetCommand::EMERGENCY_RESUME:
+      if (pumpController.isEmergencyMode())
       {
-        Serial.println("WiFi conectado, continuando...");
-        break;
+        pumpController.emergencyResume();
       }
+      break;
+    case NetCommand::RESTART:
+      programarReinicio();
+      break;
     }
   }
+}
 
-  // Configurar Firebase
-  Serial.println("\nConfigurando Firebase...");
-  config.database_url = DATABASE_URL;
-  config.host = DATABASE_HOST;
-  config.signer.tokens.legacy_token = DATABASE_SECRET;
-  config.token_status_callback = tokenStatusCallback;
+void imprimirEstadoSistema()
+{
+  LOG_PRINT(MAIN, "\n=== ESTADO DEL SISTEMA HIDROPONICO ===");
 
-  Firebase.begin(&config, &auth);
-  Firebase.reconnectWiFi(true);
+  // Estado de sensores
+  LOG_PRINT(MAIN, "pH: %.2f (%.3fV) [%s] %+.3f pH/min %s",
+                  phSensor.getFilteredPH(),
+                  phSensor.getVoltage(),
+                  phSensor.isCalibrationValid() ? "Calibrado" : "No calibrado",
+                  phSensor.getPHRate() * 60.0f,
+                  phSensor.isSettled() ? "estable" : "en cambio");
 
-  // Esperar conexion Firebase
-  Serial.println("Esperando Firebase...");
-  int espera = 0;
-  while (!Firebase.ready() && espera < 30)
+  float tds_val = tdsSensor.getTDSValue();
+  if (isfinite(tds_val) && tds_val >= 0.0f)
+  {
+    LOG_PRINT(MAIN, "TDS: %.0f ppm [%s] (ADC: %d)",
+                    tds_val,
+                    tdsSensor.isConnected() ? "Conectado" : "Desconectado",
+                    tdsSensor.getRawADC());
+  }
+  else
   {
-    delay(500);
-    Serial.print(".");
-    espera++;
+    LOG_PRINT(MAIN, "TDS: ERROR (NaN/Inf) [%s] (ADC: %d)",
+                    tdsSensor.isConnected() ? "Conectado" : "Desconectado",
+                    tdsSensor.getRawADC());
   }
 
-  if (Firebase.ready())
+  LOG_PRINT(MAIN, "LDR: %d (%s)",
+                  ldrSensor.getRawValue(),
+                  ldrSensor.getLightLevelString().c_str());
+
+  // Estado de niveles de tanques de dosificacion - CON DEBUGGING
+  bool nivelMinus = levelSensors.isLevelOK("pH-");
+  bool nivelPlus = levelSensors.isLevelOK("pH+");
+  int rawMinus = digitalRead(18); // LVL_PH_MINUS
+  int rawPlus = digitalRead(21);  // LVL_PH_PLUS
+
+  LOG_PRINT(MAIN, "Niveles - pH-: %s (pin18=%d) | pH+: %s (pin21=%d)",
+                  nivelMinus ? "OK" : "BAJO", rawMinus,
+                  nivelPlus ? "OK" : "BAJO", rawPlus);
+
+  // Estado de bombas
+  LOG_PRINT(MAIN, "Bombas - Circulacion: %s | pH-: %s | pH+: %s",
+                  pumpController.isCirculationOn() ? "ON" : "OFF",
+                  pumpController.isPumpMinusActive() ? "ON" : "OFF",
+                  pumpController.isPumpPlusActive() ? "ON" : "OFF");
+
+  // Estado de control
+  if (pumpController.getCurrentDoseState() == PumpController::DOSING)
   {
-    Serial.println("\n Firebase conectado");
-    Serial.println("­Sistema funcionando con SENSORES");
-    enviarDatos(); // Envio inicial
+    const char *tipoStr = (pumpController.getCurrentDoseType() == PumpController::DOSE_PLUS) ? "pH+" : "pH-";
+    LOG_PRINT(MAIN, "Dosificacion activa: %s (Pulso: %lums, Sesion: %lums)",
+                    tipoStr,
+                    pumpController.getElapsedPulse(),
+                    pumpController.getElapsedSession());
   }
   else
   {
-    Serial.println("\n Firebase requerido para datos reales");
-    Serial.println("Reintentando conexion Firebase...");
-    while (!Firebase.ready())
-    {
-      delay(2000);
-      Serial.print(".");
-      if (Firebase.ready())
-      {
-        Serial.println("\nFirebase conectado");
-        break;
-      }
-    }
+    LOG_PRINT(MAIN, "Estado de dosificacion: IDLE");
   }
 
-  Serial.println("\nSistema inicializado completamente");
-  Serial.println("Escribe HELP para ver comandos disponibles\n");
+  LOG_PRINT(MAIN, "Modo: SENSORES REALES");
+
+  // Jitter del ciclo de control y costo de la red (fuera del loop si es tarea propia)
+  controlJitter.print(netTask.isDedicated() ? "Control (red en nucleo 0)" : "Control (red en linea)");
+  scheduler.print("Tareas");
+  // Los módulos de red los mueve el otro contexto: solo la copia que publica atenderRed()
+  static EstadoRed red = {};
+  canalEstadoRed.read(red);
+  LOG_PRINT(MAIN, "Red: %lu envios (ultimo %lu ms, max %lu ms), consulta max %lu ms",
+                  (unsigned long)red.net.publishes, red.net.lastPublishMs, red.net.maxPublishMs, red.net.maxPollMs);
+  LOG_PRINT(MAIN, "Historial: %u muestras en RAM (bloque de %u, %s), %lu bloques enviados", red.historialEnRam,
+                  historyChunker.chunkSize(), red.historialFechado ? "fechadas" : "sin hora",
+                  (unsigned long)red.historialBloques);
+  const TimeService::Stats &reloj = timeService.getStats();
+  LOG_PRINT(MAIN, "Reloj: boot_id %lu, %s, deriva %.1f ppm, %lu correcciones bruscas",
+                  (unsigned long)timeService.bootId(), timeService.isSynced() ? "hora SNTP" : "monotonico (sin SNTP)",
+                  reloj.driftPpm, (unsigned long)reloj.steps);
+  LOG_PRINT(MAIN, "Conexion: %s, arranque -> control %ld ms, WiFi %ld ms, en linea %ld ms, 1a publicacion %ld ms; "
+                  "%lu caidas WiFi, %lu intentos fallidos",
+                  ConnectionManager::stateName(red.conexion), bootToControlMs, red.conexionStats.bootToWiFiMs,
+                  red.conexionStats.bootToOnlineMs, red.conexionStats.bootToFirstPublishMs,
+                  (unsigned long)red.conexionStats.wifiLost,
+                  (unsigned long)(red.conexionStats.wifiFailures + red.conexionStats.backendFailures));
+  if (red.historialEnFlash)
+  {
+    LOG_PRINT(MAIN, "Historial sin enviar: %lu puntos en flash", (unsigned long)red.historialEnFlash);
+  }
+  LOG_PRINT(MAIN, "Comandos: stream %s, %lu eventos (%lu ordenes), %lu timeouts, %lu aperturas",
+                  red.streamActivo ? "activo" : "inactivo", (unsigned long)red.comandos.events,
+                  (unsigned long)red.comandos.commands, (unsigned long)red.comandos.timeouts,
+                  (unsigned long)red.comandos.restarts);
+  const Logger::Stats &salida = logger.getStats();
+  LOG_PRINT(MAIN, "Log: %lu lineas, %lu repetidas agrupadas, %lu descartadas, cola max %lu/%u",
+                  (unsigned long)salida.printed, (unsigned long)salida.repeats, (unsigned long)salida.dropped,
+                  (unsigned long)salida.maxQueued, (unsigned)LOG_QUEUE_SIZE);
+  LOG_PRINT(MAIN, "=====================================");
 }
 
-void loop()
+// ============ Tareas del planificador ============
+
+// Ciclo de control: pH, dosificación y snapshot para la red
+void tareaControl(void *)
 {
+  PERF_SCOPE(perfControl);
   unsigned long now = millis();
-
-  // Procesar comandos seriales
-  serialCommands.processCommands();
-
-  // Actualizar sensores (siempre en modo real)
-  if (now - lastSensorUpdate >= SENSOR_INTERVAL)
+  controlJitter.tick(micros());
+  if (bootToControlMs < 0)
   {
-    lastSensorUpdate = now;
+    bootToControlMs = long(now);
+    LOG_I(MAIN, "Primer ciclo de control a los %ld ms del arranque", bootToControlMs);
+  }
 
-    // Actualizar sensores reales
+  {
+    PERF_SCOPE(perfPh);
     phSensor.update();
+  }
 
-    if (tdsSensor.shouldUpdate())
-    {
-      tdsSensor.update();
-    }
+  // Control de pH (solo si no está en modo emergencia)
+  if (!pumpController.isEmergencyMode())
+  {
+    bool nivelMinus = levelSensors.isLevelOK("pH-");
+    bool nivelPlus = levelSensors.isLevelOK("pH+");
 
-    if (ldrSensor.shouldUpdate())
+    // DEBUG: Mostrar estado de niveles (solo con -DLOG_LEVEL_LEVEL=LOG_LVL_DEBUG)
+    if (nivelMinus == false || nivelPlus == false)
     {
-      ldrSensor.update();
+      LOG_D(LEVEL, "DEBUG NIVELES - pH-: %s, pH+: %s",
+                   nivelMinus ? "OK" : "BAJO",
+                   nivelPlus ? "OK" : "BAJO");
     }
 
-    // Control de pH (solo si no está en modo emergencia)
-    if (!pumpController.isEmergencyMode())
-    {
-      bool nivelMinus = levelSensors.isLevelOK("pH-");
-      bool nivelPlus = levelSensors.isLevelOK("pH+");
+    pumpController.update(phSensor.getFilteredPH(), phSensor.getPHRate(), phSensor.isSettled(),
+                          nivelMinus, nivelPlus);
+  }
 
-      // DEBUG: Mostrar estado de niveles
-      if (nivelMinus == false || nivelPlus == false)
-      {
-        Serial.printf("DEBUG NIVELES - pH-: %s, pH+: %s\n",
-                      nivelMinus ? "OK" : "BAJO",
-                      nivelPlus ? "OK" : "BAJO");
-      }
+  // Estado para la red (no bloquea: sobrescribe el snapshot anterior)
+  netTask.publishSnapshot(tomarSnapshot());
+}
 
-      pumpController.update(phSensor.getFilteredPH(), nivelMinus, nivelPlus);
-    }
-  }
+void tareaTDS(void *)
+{
+  PERF_SCOPE(perfTds);
+  tdsSensor.update();
+}
+
+void tareaLDR(void *)
+{
+  PERF_SCOPE(perfLdr);
+  ldrSensor.update();
+}
+
+void tareaComandosSerie(void *)
+{
+  PERF_SCOPE(perfSerie);
+  serialCommands.processCommands();
+}
+
+void tareaOrdenes(void *)
+{
+  aplicarComandos();
+}
+
+void tareaHora(void *)
+{
+  timeService.update(millis());
+}
 
-  // Actualizar Firebase
-  if (now - lastFirebaseUpdate >= FIREBASE_INTERVAL)
+// Sin tarea propia, la red corre aquí y su latencia retrasa a las demás
+void tareaRed(void *)
+{
+  netTask.service(millis());
+}
+
+// Sin tarea propia, el log se vacía aquí (solo lo que cabe en el FIFO de TX)
+void tareaLog(void *)
+{
+  logger.service(millis());
+}
+
+// Modo STREAM: el período de la tarea sigue a la frecuencia pedida
+void tareaStream(void *)
+{
+  if (!serialStream.isActive())
   {
-    lastFirebaseUpdate = now;
-    if (WiFi.status() == WL_CONNECTED && Firebase.ready())
-    {
-      enviarDatos();
-    }
+    scheduler.setPeriod(tareaStreamId, STREAM_IDLE_INTERVAL * 1000UL);
+    return;
   }
+  scheduler.setPeriod(tareaStreamId, serialStream.getPeriodUs());
+  enviarRegistroStream(micros());
+}
 
-  // Salida por Serial
-  if (now - lastSerialOutput >= SERIAL_INTERVAL)
+// Estado del sistema (en pausa mientras corre el modo STREAM)
+void tareaEstado(void *)
+{
+  if (!serialStream.isActive())
   {
-    lastSerialOutput = now;
     imprimirEstadoSistema();
   }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+  // Desde aquí los mensajes van a la cola del log y no esperan al UART
+  logger.begin(LOG_TASK_DEDICATED);
+
+  LOG_PRINT(MAIN, "\n========================================");
+  LOG_PRINT(MAIN, "       ­SISTEMA HIDROPONICO MODULAR ­      ");
+  LOG_PRINT(MAIN, "========================================");
+
+  // Inicializar EEPROM para calibraciones
+  EEPROM.begin(512);
 
-  // Verificar comandos desde Firebase
-  if (now - lastCommandCheck >= COMMAND_CHECK_INTERVAL)
+  // Historial pendiente de un corte anterior (se reenvía al conectar)
+  telemetryLog.begin();
+
+  // Inicializar sensores
+  LOG_PRINT(MAIN, "Inicializando sensores...");
+  phSensor.begin();
+  tdsSensor.begin();
+  ldrSensor.begin();
+
+  // Adquisicion compartida de pH, TDS y LDR (ADC continuo por DMA, sincronizado con la red)
+  if (sensorHub.begin(SENSOR_FRAME_RATE, SENSOR_MAINS_HZ))
   {
-    lastCommandCheck = now;
-    if (WiFi.status() == WL_CONNECTED && Firebase.ready())
-    {
-      // Leer comando de reinicio desde Firebase
-      if (Firebase.RTDB.getBool(&fbData, "/hydroponic_data/comandos/reset"))
-      {
-        if (fbData.dataType() == "boolean" && fbData.boolData())
-        {
-          Serial.println("\n⚠️ COMANDO DE REINICIO RECIBIDO DESDE FIREBASE");
-          Serial.println("Reiniciando ESP32 en 1 segundo...");
+    phSensor.attachHub(&sensorHub);
+    tdsSensor.attachHub(&sensorHub);
+    ldrSensor.attachHub(&sensorHub);
+  }
 
-          // Limpiar el comando para evitar reinicios múltiples
-          Firebase.RTDB.setBool(&fbData, "/hydroponic_data/comandos/reset", false);
+  // Configurar sensores de nivel SEN0205 para tanques de dosificacion
+  levelSensors.addSensor(LVL_PH_MINUS, true, "pH-");
+  levelSensors.addSensor(LVL_PH_PLUS, true, "pH+");
+  levelSensors.begin();
 
-          delay(1000);
-          ESP.restart();
-        }
-      }
+  // Inicializar controlador de bombas
+  LOG_PRINT(MAIN, "Inicializando bombas...");
+  pumpController.begin();
 
-      // Leer comando de emergencia desde Firebase
-      if (Firebase.RTDB.getBool(&fbData, "/hydroponic_data/comandos/emergency"))
-      {
-        if (fbData.dataType() == "boolean")
-        {
-          bool emergencyCommand = fbData.boolData();
-          bool currentEmergency = pumpController.isEmergencyMode();
-
-          if (emergencyCommand && !currentEmergency)
-          {
-            // Activar modo emergencia
-            pumpController.emergencyStop();
-            // Confirmar en Firebase
-            Firebase.RTDB.setBool(&fbData, "/hydroponic_data/sistema/emergencia", true);
-          }
-          else if (!emergencyCommand && currentEmergency)
-          {
-            // Desactivar modo emergencia
-            pumpController.emergencyResume();
-            // Confirmar en Firebase
-            Firebase.RTDB.setBool(&fbData, "/hydroponic_data/sistema/emergencia", false);
-          }
-        }
-      }
-    }
+  // Inicializar comandos seriales
+  serialCommands.begin(&phSensor, &pumpController, &tdsSensor, &ldrSensor, &programarReinicio);
+  serialCommands.attachStream(&serialStream);
+
+  // boot_id es un contador en LittleFS, ya montado por telemetryLog; SNTP
+  // arranca con la primera conexión (hasta entonces los sellos son monotónicos)
+  timeService.begin(TimeService::nextBootId(), nullptr);
+
+  // WiFi y base de datos avanzan en atenderRed() sin bloquear: el control
+  // arranca en el primer loop() y, sin red, el historial va a flash
+  static const ConnectionManager::Hooks hooksRed = {&iniciarWiFi, &wifiConectado, &cortarWiFi, &iniciarServicios,
+                                                    &baseDeDatosLista};
+  connection.begin(hooksRed, millis());
+
+  // Red: el primer envío sale con el primer snapshot del loop()
+  netTask.begin(&enviarDatos, &atenderRed, NET_TASK_DEDICATED);
+
+  // Todo el trabajo periódico del loop(); la primera pasada corre todas por prioridad
+  scheduler.begin();
+  scheduler.every("control", SENSOR_INTERVAL * 1000UL, PRIO_CONTROL, &tareaControl);
+  scheduler.every("ordenes", COMMAND_APPLY_INTERVAL * 1000UL, PRIO_ORDENES, &tareaOrdenes);
+  scheduler.every("serie", SERIAL_POLL_INTERVAL * 1000UL, PRIO_ORDENES, &tareaComandosSerie);
+  scheduler.every("tds", tdsSensor.getUpdateInterval() * 1000UL, PRIO_SENSORES, &tareaTDS);
+  scheduler.every("ldr", ldrSensor.getUpdateInterval() * 1000UL, PRIO_SENSORES, &tareaLDR);
+  tareaStreamId = scheduler.every("stream", STREAM_IDLE_INTERVAL * 1000UL, PRIO_STREAM, &tareaStream);
+  scheduler.every("hora", CLOCK_INTERVAL * 1000UL, PRIO_SERVICIO, &tareaHora);
+  if (!netTask.isDedicated())
+  {
+    scheduler.every("red", COMMAND_STREAM_INTERVAL * 1000UL, PRIO_SERVICIO, &tareaRed);
+  }
+  if (!logger.isDedicated())
+  {
+    scheduler.every("log", LOG_INTERVAL * 1000UL, PRIO_SERVICIO, &tareaLog);
   }
+  scheduler.every("estado", SERIAL_INTERVAL * 1000UL, PRIO_ESTADO, &tareaEstado);
+
+  LOG_PRINT(MAIN, "\nSistema inicializado completamente");
+  LOG_PRINT(MAIN, "Escribe HELP para ver comandos disponibles");
+}
+
+void loop()
+{
+  // Tareas vencidas, por prioridad
+  uint32_t inicioUs = micros();
+  scheduler.run(inicioUs);
+  uint32_t pasadaUs = micros() - inicioUs;
+  if (pasadaUs > loopMaxUs)
+  {
+    loopMaxUs = pasadaUs;
+  }
+
+  // Sin nada vencido, el núcleo espera (idle o light sleep) hasta el próximo vencimiento
+  scheduler.idle(micros());
 }
@@ -0,0 +1,152 @@
+/**
+ * @file bench_filters.cpp
+ * @brief Benchmark de host: media recortada deslizante vs. ordenar cada vez
+ *
+ * Mide el costo por muestra de SlidingTrimmedMean frente al método original
+ * de PHSensor (copiar la ventana, ordenar por inserción y promediar la mitad
+ * central) para ventanas de 10 a 64 muestras, y verifica que ambos den el
+ * mismo resultado. También comprueba la longitud variable de la ventana y
+ * que OversampleBudget elija más muestras cuanto más ruidosa es la señal.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *   g++ -O2 -std=gnu++17 -Ilib/SensorFilters test/host/bench_filters.cpp -o bench_filters
+ *   ./bench_filters
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "SensorFilters.h"
+
+namespace
+{
+    constexpr size_t SAMPLES = 200000;
+    volatile float sink;
+
+    std::vector<uint16_t> makeSignal()
+    {
+        // Señal ADC de pH (~2.5 V) con ruido y picos ocasionales
+        std::vector<uint16_t> v(SAMPLES);
+        srand(1234);
+        for (size_t i = 0; i < SAMPLES; i++)
+        {
+            int x = 3100 + int(40.0 * sin(i * 0.001)) + (rand() % 61) - 30;
+            if (rand() % 100 == 0)
+                x += (rand() % 2) ? 600 : -600;
+            v[i] = uint16_t(x);
+        }
+        return v;
+    }
+
+    template <uint8_t N>
+    bool runWindow(const std::vector<uint16_t> &signal)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Método original: ventana circular + ordenar en cada muestra
+        uint16_t ring[N] = {};
+        uint16_t work[N];
+        std::vector<float> reference(SAMPLES);
+        auto t0 = Clock::now();
+        for (size_t i = 0; i < SAMPLES; i++)
+        {
+            ring[i % N] = signal[i];
+            uint8_t n = i + 1 < N ? uint8_t(i + 1) : N;
+            memcpy(work, ring, n * sizeof(uint16_t));
+            reference[i] = trimmedMeanSort(work, n);
+        }
+        auto t1 = Clock::now();
+
+        // Filtro incremental
+        SlidingTrimmedMean<uint16_t, N> filter;
+        std::vector<float> sliding(SAMPLES);
+        auto t2 = Clock::now();
+        for (size_t i = 0; i < SAMPLES; i++)
+        {
+            filter.push(signal[i]);
+            sliding[i] = filter.trimmedMean();
+        }
+        auto t3 = Clock::now();
+
+        size_t mismatches = 0;
+        for (size_t i = 0; i < SAMPLES; i++)
+        {
+            if (fabsf(reference[i] - sliding[i]) > 1e-3f)
+                mismatches++;
+        }
+        sink = sliding.back();
+
+        double sortNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / SAMPLES;
+        double slideNs = std::chrono::duration<double, std::nano>(t3 - t2).count() / SAMPLES;
+        printf("N=%2u  ordenar: %7.1f ns/muestra  deslizante: %6.1f ns/muestra  (x%.1f)  %s\n",
+               N, sortNs, slideNs, sortNs / slideNs, mismatches ? "DIFIERE" : "OK");
+        return mismatches == 0;
+    }
+
+    // Ventana de capacidad 32 reducida a 10 == ventana fija de 10
+    bool checkSetLength(const std::vector<uint16_t> &signal)
+    {
+        SlidingTrimmedMean<uint16_t, 32> variable;
+        SlidingTrimmedMean<uint16_t, 10> fixed;
+        variable.setLength(10);
+        for (size_t i = 0; i < SAMPLES; i++)
+        {
+            variable.push(signal[i]);
+            fixed.push(signal[i]);
+            if (variable.trimmedMean() != fixed.trimmedMean())
+            {
+                printf("setLength: DIFIERE en la muestra %zu\n", i);
+                return false;
+            }
+        }
+        printf("setLength(10) sobre capacidad 32: OK\n");
+        return true;
+    }
+
+    // Ruido gaussiano de σ conocida: n ≈ (σ / objetivo)²
+    bool checkBudget()
+    {
+        bool ok = true;
+        srand(99);
+        const float sigmas[] = {0.5f, 2.0f, 4.0f, 12.0f};
+        for (float sigma : sigmas)
+        {
+            OversampleBudget budget(1.0f, 2, 64);
+            for (int i = 0; i < 2000; i++)
+            {
+                float u1 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+                float u2 = (rand() + 1.0f) / (RAND_MAX + 2.0f);
+                budget.push(2000.0f + sigma * sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2));
+            }
+            float expected = fminf(fmaxf(ceilf(sigma * sigma), 2.0f), 64.0f);
+            uint8_t n = budget.samples();
+            bool pass = fabsf(n - expected) <= 0.35f * expected + 1.0f;
+            printf("σ=%5.1f  muestras=%2u (esperado ~%2.0f)  error=%.2f  %s\n",
+                   sigma, n, expected, budget.standardError(), pass ? "OK" : "FUERA DE RANGO");
+            ok &= pass;
+        }
+        return ok;
+    }
+}
+
+int main()
+{
+    std::vector<uint16_t> signal = makeSignal();
+    bool ok = true;
+
+    ok &= runWindow<10>(signal);
+    ok &= runWindow<16>(signal);
+    ok &= runWindow<24>(signal);
+    ok &= runWindow<32>(signal);
+    ok &= runWindow<48>(signal);
+    ok &= runWindow<64>(signal);
+
+    printf("\n");
+    ok &= checkSetLength(signal);
+    ok &= checkBudget();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file bench_fixed_point.cpp
+ * @brief Benchmark de host: conversión pH/TDS en float frente a Q16.16
+ *
+ * Recorre todo el rango del ADC (0-4095) y de temperatura (-10 a 80 °C),
+ * compara las etapas de FixedPointStages.h con las de SensorPipeline.h y
+ * falla si el error supera la cota documentada. Después mide el costo por
+ * muestra de ambas cadenas.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *   g++ -O2 -std=gnu++17 -Ilib/SensorFilters -Ilib/SensorPipeline test/host/bench_fixed_point.cpp -o bench_fixed_point
+ *   ./bench_fixed_point
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "SensorPipeline.h"
+
+namespace
+{
+    constexpr size_t SAMPLES = 1000000;
+    constexpr float PH_MAX_ERROR = 0.002f;
+    constexpr float TDS_MAX_ERROR_PPM = 0.5f;
+    constexpr float TDS_MAX_ERROR_REL = 0.0005f;
+    volatile float sink;
+
+    using PhFloat = Pipeline<AdcToVolts, Scale, PhCalib, Ema>;
+    using PhFixed = Pipeline<AdcToVoltsQ16<4095>, ScaleQ16, PhCalibQ16, EmaQ16>;
+    using TdsFloat = Pipeline<AdcToVoltsT<4096>, GravityTdsPoly>;
+    using TdsFixed = Pipeline<AdcToVoltsQ16<4096>, GravityTdsPolyQ16>;
+
+    // Misma configuración que PHSensor / TDSSensor
+    template <typename P, typename ScaleT, typename CalibT, typename EmaT>
+    void setupPh(P &p, float tempC)
+    {
+        p.template get<ScaleT>().setFactor(1.0f);
+        p.template get<CalibT>().setCalibration(2.50f, 0.18f);
+        p.template get<CalibT>().setTemperature(tempC);
+        p.template get<EmaT>().setAlpha(0.25f);
+        p.template get<EmaT>().setInitial(7.0f);
+    }
+
+    template <typename P, typename TdsT>
+    void setupTds(P &p, float tempC)
+    {
+        p.template get<TdsT>().setKValue(1.0f);
+        p.template get<TdsT>().setTemperature(tempC);
+    }
+
+    std::vector<float> makeRaw()
+    {
+        std::vector<float> v(SAMPLES);
+        srand(42);
+        for (size_t i = 0; i < SAMPLES; i++)
+        {
+            v[i] = float(rand() % 4096) + float(rand() % 8) / 8.0f;
+        }
+        return v;
+    }
+
+    template <typename P>
+    double timeNs(P &pipeline, const std::vector<float> &input)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        float acc = 0.0f;
+        for (float x : input)
+        {
+            acc += asFloat(pipeline.step(x));
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        sink = acc;
+        return std::chrono::duration<double, std::nano>(t1 - t0).count() / input.size();
+    }
+}
+
+int main()
+{
+    // ------------------------------------------------------------------------
+    // Error máximo en todo el rango
+    // ------------------------------------------------------------------------
+    float phInstantErr = 0.0f;
+    float phEmaErr = 0.0f;
+    float tdsErr = 0.0f;
+    bool ok = true;
+
+    for (float tempC = -10.0f; tempC <= 80.0f; tempC += 0.5f)
+    {
+        PhFloat phF;
+        PhFixed phQ;
+        setupPh<PhFloat, Scale, PhCalib, Ema>(phF, tempC);
+        setupPh<PhFixed, ScaleQ16, PhCalibQ16, EmaQ16>(phQ, tempC);
+
+        TdsFloat tdsF;
+        TdsFixed tdsQ;
+        setupTds<TdsFloat, GravityTdsPoly>(tdsF, tempC);
+        setupTds<TdsFixed, GravityTdsPolyQ16>(tdsQ, tempC);
+
+        for (int raw = 0; raw <= 4095; raw++)
+        {
+            float ema = phF.step(float(raw));
+            float emaQ = asFloat(phQ.step(float(raw)));
+            float inst = phF.get<Ema>().lastInput();
+            float instQ = phQ.get<EmaQ16>().lastInput();
+            phInstantErr = fmaxf(phInstantErr, fabsf(inst - instQ));
+            phEmaErr = fmaxf(phEmaErr, fabsf(ema - emaQ));
+
+            float ppm = tdsF.step(float(raw));
+            float ppmQ = asFloat(tdsQ.step(float(raw)));
+            float err = fabsf(ppm - ppmQ);
+            float bound = fmaxf(TDS_MAX_ERROR_PPM, fabsf(ppm) * TDS_MAX_ERROR_REL);
+            tdsErr = fmaxf(tdsErr, err);
+            if (err > bound)
+            {
+                printf("ERROR: TDS raw=%d T=%.1f float=%.3f q16=%.3f\n", raw, tempC, ppm, ppmQ);
+                ok = false;
+            }
+        }
+    }
+
+    printf("Error máximo Q16.16 frente a float (ADC 0-4095, -10 a 80 °C):\n");
+    printf("  pH instantáneo   %.5f pH\n", phInstantErr);
+    printf("  pH filtrado      %.5f pH\n", phEmaErr);
+    printf("  TDS              %.3f ppm\n", tdsErr);
+
+    if (phInstantErr > PH_MAX_ERROR || phEmaErr > PH_MAX_ERROR)
+    {
+        printf("ERROR: el pH supera la cota de %.3f\n", PH_MAX_ERROR);
+        ok = false;
+    }
+
+    // ------------------------------------------------------------------------
+    // Costo por muestra
+    // ------------------------------------------------------------------------
+    std::vector<float> raw = makeRaw();
+
+    PhFloat phF;
+    PhFixed phQ;
+    setupPh<PhFloat, Scale, PhCalib, Ema>(phF, 25.0f);
+    setupPh<PhFixed, ScaleQ16, PhCalibQ16, EmaQ16>(phQ, 25.0f);
+    TdsFloat tdsF;
+    TdsFixed tdsQ;
+    setupTds<TdsFloat, GravityTdsPoly>(tdsF, 25.0f);
+    setupTds<TdsFixed, GravityTdsPolyQ16>(tdsQ, 25.0f);
+
+    printf("\nCosto por muestra:\n");
+    printf("  pH  float        %6.2f ns\n", timeNs(phF, raw));
+    printf("  pH  Q16.16       %6.2f ns\n", timeNs(phQ, raw));
+    printf("  TDS float        %6.2f ns\n", timeNs(tdsF, raw));
+    printf("  TDS Q16.16       %6.2f ns\n", timeNs(tdsQ, raw));
+    printf("\n(En el host la FPU de 64 bits gana; en el ESP32 la FPU es de\n"
+           " precisión simple y el camino entero evita además guardar sus\n"
+           " registros en cambios de contexto. Medir en placa antes de\n"
+           " activar SENSOR_FIXED_POINT.)\n");
+
+    return ok ? 0 : 1;
+}
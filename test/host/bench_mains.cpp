@@ -0,0 +1,246 @@
+/**
+ * @file bench_mains.cpp
+ * @brief Prueba de host: rechazo de zumbido de red (50/60 Hz)
+ *
+ * Genera vectores sintéticos (nivel DC + zumbido de red con fase aleatoria +
+ * ruido gaussiano, cuantizados a 12 bits) y compara el error de cada forma
+ * de adquisición frente a la duración de la ventana de lectura:
+ *
+ *   - Lectura bloqueante original de PHSensor (10 muestras cada 8 ms)
+ *   - Lectura bloqueante sincronizada (muestras repartidas en 2 periodos)
+ *   - Hub DMA a 100 frames/s (cada frame promedia 10 ms)
+ *   - Hub DMA sincronizado (cada frame promedia un periodo de red)
+ *   - Hub timer a 100 Hz sin filtro
+ *   - Hub timer a 2× red con la etapa Notch
+ *
+ * Cada caso se corre solo con zumbido (aísla el rechazo de red) y con
+ * zumbido + ruido. También mide la respuesta del Notch en f0 y en DC.
+ * Devuelve distinto de 0 si, solo con zumbido, la adquisición sincronizada
+ * deja más de 0.5 cuentas RMS, la lectura bloqueante sincronizada no mejora
+ * a la original con una ventana más corta, o el notch atenúa menos de 40 dB.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *   g++ -O2 -std=gnu++17 -Ilib/SensorFilters -Ilib/SensorPipeline test/host/bench_mains.cpp -o bench_mains
+ *   ./bench_mains
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "SensorPipeline.h"
+
+namespace
+{
+    constexpr int TRIALS = 2000;
+    constexpr float DC = 2000.0f;     // Cuentas
+    constexpr float HUM = 60.0f;      // Amplitud del zumbido (cuentas)
+    float noiseSigma = 2.0f;          // σ del ruido blanco (cuentas)
+    constexpr float CONV_HZ = 20000.0f / 3.0f; // Conversiones DMA por canal
+
+    std::mt19937 rng(2024);
+
+    struct Signal
+    {
+        float mainsHz;
+        float dc;
+        float phase;
+        std::normal_distribution<float> noise{0.0f, 1.0f};
+
+        uint16_t at(float t)
+        {
+            float v = dc + HUM * sinf(6.2831853f * mainsHz * t + phase) + noiseSigma * noise(rng);
+            if (v < 0.0f)
+                v = 0.0f;
+            if (v > 4095.0f)
+                v = 4095.0f;
+            return uint16_t(v + 0.5f);
+        }
+
+        // Frame DMA: promedio redondeado de las conversiones de [t, t + len)
+        uint16_t frame(float t, float len)
+        {
+            int n = int(len * CONV_HZ + 0.5f);
+            uint32_t sum = 0;
+            for (int i = 0; i < n; i++)
+            {
+                sum += at(t + i / CONV_HZ);
+            }
+            return uint16_t((sum + n / 2) / n);
+        }
+    };
+
+    Signal makeSignal(float mainsHz)
+    {
+        std::uniform_real_distribution<float> phase(0.0f, 6.2831853f);
+        std::uniform_real_distribution<float> frac(-0.5f, 0.5f);
+        return Signal{mainsHz, DC + frac(rng), phase(rng)};
+    }
+
+    struct Result
+    {
+        float rms;
+        float windowMs;
+    };
+
+    // Lectura bloqueante: n muestras separadas spacing s, media recortada
+    Result blocking(float mainsHz, int n, float spacing)
+    {
+        double sq = 0.0;
+        for (int k = 0; k < TRIALS; k++)
+        {
+            Signal s = makeSignal(mainsHz);
+            uint16_t buf[64];
+            for (int i = 0; i < n; i++)
+            {
+                buf[i] = s.at(i * spacing);
+            }
+            float e = trimmedMeanSort(buf, uint8_t(n)) - s.dc;
+            sq += e * e;
+        }
+        return {float(sqrt(sq / TRIALS)), n * spacing * 1000.0f};
+    }
+
+    // Hub DMA: frames de frameLen s, media recortada de los últimos n
+    Result dmaFrames(float mainsHz, float frameLen, int n)
+    {
+        double sq = 0.0;
+        for (int k = 0; k < TRIALS / 10; k++)
+        {
+            Signal s = makeSignal(mainsHz);
+            Pipeline<TrimmedMean<32>> acquire;
+            acquire.get<TrimmedMean<32>>().setWindow(uint8_t(n));
+            float y = 0.0f;
+            for (int i = 0; i < n; i++)
+            {
+                y = acquire.step(s.frame(i * frameLen, frameLen));
+            }
+            float e = y - s.dc;
+            sq += e * e;
+        }
+        return {float(sqrt(sq / (TRIALS / 10))), n * frameLen * 1000.0f};
+    }
+
+    // Hub timer: una muestra por frame a rateHz; notch opcional en régimen
+    Result timerFrames(float mainsHz, float rateHz, int n, bool notch)
+    {
+        double sq = 0.0;
+        for (int k = 0; k < TRIALS; k++)
+        {
+            Signal s = makeSignal(mainsHz);
+            Pipeline<Notch, TrimmedMean<32>> acquire;
+            if (notch)
+                acquire.get<Notch>().configure(rateHz, mainsHz);
+            acquire.get<TrimmedMean<32>>().setWindow(uint8_t(n));
+
+            // El hub corre continuamente: 1 s previo para el régimen del filtro
+            int warm = int(rateHz);
+            float y = 0.0f;
+            for (int i = 0; i < warm + n; i++)
+            {
+                y = acquire.step(s.at(i / rateHz));
+            }
+            float e = y - s.dc;
+            sq += e * e;
+        }
+        return {float(sqrt(sq / TRIALS)), n / rateHz * 1000.0f};
+    }
+
+    // Ganancia en régimen de una sinusoide de frecuencia f a fs
+    float notchGain(float fs, float f0, float f)
+    {
+        Notch filter;
+        filter.configure(fs, f0);
+        float peak = 0.0f;
+        int n = int(fs * 4);
+        for (int i = 0; i < n; i++)
+        {
+            // Coseno con desfase para no muestrear solo los cruces por cero en fs/2
+            float y = filter.step(1000.0f + 100.0f * cosf(6.2831853f * f * i / fs + 0.3f)) - 1000.0f;
+            if (i > n / 2 && fabsf(y) > peak)
+                peak = fabsf(y);
+        }
+        return peak / (100.0f * fmaxf(fabsf(cosf(0.3f)), 1e-3f));
+    }
+
+    void print(const char *name, Result r)
+    {
+        printf("  %-36s ventana %6.1f ms   error RMS %7.3f cuentas\n", name, r.windowMs, r.rms);
+    }
+}
+
+int main()
+{
+    bool ok = true;
+
+    printf("Respuesta del Notch (BW 2 Hz):\n");
+    struct
+    {
+        float fs, f0;
+    } cases[] = {{120.0f, 60.0f}, {100.0f, 50.0f}, {100.0f, 40.0f}, {1000.0f, 60.0f}};
+    for (auto &c : cases)
+    {
+        float g = notchGain(c.fs, c.f0, c.f0);
+        float db = 20.0f * log10f(fmaxf(g, 1e-6f));
+        float g5 = notchGain(c.fs, c.f0, c.f0 * 0.5f);
+        printf("  fs=%6.0f f0=%4.0f  en f0: %6.1f dB   en f0/2: %5.3f\n", c.fs, c.f0, db, g5);
+        ok &= db <= -40.0f;
+    }
+    Notch dc;
+    dc.configure(120.0f, 60.0f);
+    float y = 0.0f;
+    for (int i = 0; i < 200; i++)
+    {
+        y = dc.step(1234.0f);
+    }
+    printf("  Ganancia en DC: %.5f\n", y / 1234.0f);
+    ok &= fabsf(y - 1234.0f) < 0.01f;
+
+    const float mains[] = {60.0f, 50.0f};
+    const float noises[] = {0.0f, 2.0f};
+    for (float f : mains)
+    {
+        for (float sigma : noises)
+        {
+            noiseSigma = sigma;
+            float period = 1.0f / f;
+            printf("\nRed %.0f Hz, zumbido %.0f cuentas, ruido σ=%.0f:\n", f, HUM, sigma);
+
+            Result legacyBlock = blocking(f, 10, 0.008f);
+            Result syncBlock = blocking(f, 8, 2.0f * period / 8);
+            Result legacyDma = dmaFrames(f, 0.010f, 10);
+            Result syncDma = dmaFrames(f, period, 2);
+            Result legacyTimer = timerFrames(f, 100.0f, 10, false);
+            Result notchTimer = timerFrames(f, 2.0f * f, 8, true);
+
+            print("Bloqueante 10 x 8 ms (original)", legacyBlock);
+            print("Bloqueante sincronizado, 8 en 2 per.", syncBlock);
+            print("Hub DMA 100 frames/s, 10 frames", legacyDma);
+            print("Hub DMA sincronizado, 2 frames", syncDma);
+            print("Hub timer 100 Hz, 10 frames", legacyTimer);
+            print("Hub timer 2x red + Notch, 8 frames", notchTimer);
+
+            if (sigma > 0.0f)
+                continue;
+
+            const Result *synced[] = {&syncBlock, &syncDma, &notchTimer};
+            for (const Result *r : synced)
+            {
+                if (r->rms > 0.5f)
+                {
+                    printf("ERROR: adquisición sincronizada con %.3f cuentas RMS de zumbido\n", r->rms);
+                    ok = false;
+                }
+            }
+            if (syncBlock.rms * 3.0f > legacyBlock.rms || syncBlock.windowMs >= legacyBlock.windowMs)
+            {
+                printf("ERROR: la lectura bloqueante sincronizada no mejora a la original\n");
+                ok = false;
+            }
+        }
+    }
+
+    return ok ? 0 : 1;
+}
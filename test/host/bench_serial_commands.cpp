@@ -0,0 +1,317 @@
+/**
+ * @file bench_serial_commands.cpp
+ * @brief Benchmark de host: lector de comandos serie anterior vs CommandParser
+ *
+ * Pasa la misma mezcla de líneas (comandos válidos, minúsculas, espacios,
+ * argumentos malos y desconocidos) por:
+ *
+ *   - El camino anterior: String por línea (como readStringUntil), trim(),
+ *     toUpperCase() y la cadena de startsWith()/== con substring().toFloat()
+ *   - CommandParser: feed() byte a byte y dispatch() por la tabla
+ *
+ * y mide ns por línea y reservas de memoria (operator new contado). El
+ * camino anterior usa ArduinoString, que reserva como el String de Arduino
+ * (WString.cpp: cada instancia pide su buffer con realloc, aun vacía); el
+ * String de la HAL usa std::string y con líneas tan cortas no reservaría
+ * nada, así que no sirve para comparar. Los dos caminos deben elegir el
+ * mismo comando con el mismo argumento; además se mide una línea a medias,
+ * que antes bloqueaba el loop() hasta el timeout del Stream (1 s por
+ * defecto). Devuelve distinto de 0 si CommandParser reserva memoria, si el
+ * camino anterior no reserva (la comparación no mostraría nada) o si algún
+ * comando difiere.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *   g++ -O2 -std=gnu++17 -Ilib/ArduinoHAL -Ilib/CommandParser test/host/bench_serial_commands.cpp lib/CommandParser/CommandParser.cpp lib/ArduinoHAL/ArduinoHAL.cpp -o bench_serial_commands
+ *   ./bench_serial_commands
+ */
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "CommandParser.h"
+
+// ============================================================================
+// RESERVAS DE MEMORIA
+// ============================================================================
+
+static unsigned long allocations = 0;
+
+void *operator new(size_t size)
+{
+    allocations++;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+// Lo que usa el camino anterior del String de Arduino, con sus reservas:
+// un buffer propio por instancia (también los temporales de startsWith()
+// con un literal y de substring())
+class ArduinoString
+{
+public:
+    ArduinoString(const char *s) { copy(s, strlen(s)); }
+    ArduinoString(const ArduinoString &other) { copy(other.buf, other.len); }
+    ArduinoString &operator=(const ArduinoString &) = delete;
+    ~ArduinoString() { delete[] buf; }
+
+    void trim()
+    {
+        unsigned start = 0;
+        while (start < len && isspace((unsigned char)buf[start]))
+            start++;
+        unsigned end = len;
+        while (end > start && isspace((unsigned char)buf[end - 1]))
+            end--;
+        len = end - start;
+        memmove(buf, buf + start, len);
+        buf[len] = 0;
+    }
+    void toUpperCase()
+    {
+        for (unsigned i = 0; i < len; i++)
+            buf[i] = toupper((unsigned char)buf[i]);
+    }
+    bool startsWith(const ArduinoString &prefix) const
+    {
+        return prefix.len <= len && memcmp(buf, prefix.buf, prefix.len) == 0;
+    }
+    int indexOf(char c) const
+    {
+        const char *p = strchr(buf, c);
+        return p ? int(p - buf) : -1;
+    }
+    ArduinoString substring(unsigned from) const { return ArduinoString(from < len ? buf + from : ""); }
+    float toFloat() const { return strtof(buf, nullptr); }
+    bool operator==(const char *other) const { return strcmp(buf, other) == 0; }
+
+private:
+    char *buf;
+    unsigned len;
+
+    void copy(const char *s, unsigned n)
+    {
+        len = n;
+        buf = new char[n + 1];
+        memcpy(buf, s, n);
+        buf[n] = 0;
+    }
+};
+
+// ============================================================================
+// RESULTADO COMÚN: qué comando se eligió y con qué argumento
+// ============================================================================
+
+enum Id
+{
+    NONE,
+    PHCAL,
+    PHSAVE,
+    SETT,
+    PPLUS_ON,
+    PPLUS_OFF,
+    PMINUS_ON,
+    PMINUS_OFF,
+    RELCFG_LOW,
+    RELCFG_HIGH,
+    EMERGENCY_ON,
+    EMERGENCY_OFF,
+    NOISE,
+    HELP
+};
+
+struct Outcome
+{
+    Id id;
+    float value;
+};
+
+static Outcome outcome;
+
+// ============================================================================
+// CAMINO ANTERIOR (SerialCommands::processCommand con String)
+// ============================================================================
+
+static void oldProcess(const char *raw)
+{
+    ArduinoString cmd(raw); // readStringUntil('\n')
+    cmd.trim();
+    cmd.toUpperCase();
+
+    if (cmd.startsWith("PHCAL"))
+    {
+        int comma = cmd.indexOf(',');
+        if (comma >= 0)
+            outcome = {PHCAL, cmd.substring(comma + 1).toFloat()};
+    }
+    else if (cmd == "PHSAVE")
+        outcome = {PHSAVE, 0};
+    else if (cmd.startsWith("SETT,"))
+        outcome = {SETT, cmd.substring(5).toFloat()};
+    else if (cmd == "PPLUS,ON")
+        outcome = {PPLUS_ON, 0};
+    else if (cmd == "PPLUS,OFF")
+        outcome = {PPLUS_OFF, 0};
+    else if (cmd == "PMINUS,ON")
+        outcome = {PMINUS_ON, 0};
+    else if (cmd == "PMINUS,OFF")
+        outcome = {PMINUS_OFF, 0};
+    else if (cmd == "RELCFG,LOW")
+        outcome = {RELCFG_LOW, 0};
+    else if (cmd == "RELCFG,HIGH")
+        outcome = {RELCFG_HIGH, 0};
+    else if (cmd == "EMERGENCY" || cmd == "EMERGENCY,ON")
+        outcome = {EMERGENCY_ON, 0};
+    else if (cmd == "EMERGENCY,OFF" || cmd == "RESUME")
+        outcome = {EMERGENCY_OFF, 0};
+    else if (cmd == "NOISE")
+        outcome = {NOISE, 0};
+    else if (cmd == "HELP")
+        outcome = {HELP, 0};
+}
+
+// ============================================================================
+// COMMANDPARSER (misma tabla que SerialCommands)
+// ============================================================================
+
+static void onPhCal(void *, const CommandParser::Args &a) { outcome = {PHCAL, a[0].number}; }
+static void onPhSave(void *, const CommandParser::Args &) { outcome = {PHSAVE, 0}; }
+static void onSetT(void *, const CommandParser::Args &a) { outcome = {SETT, a[0].number}; }
+static void onPPlus(void *, const CommandParser::Args &a) { outcome = {a[0].on ? PPLUS_ON : PPLUS_OFF, 0}; }
+static void onPMinus(void *, const CommandParser::Args &a) { outcome = {a[0].on ? PMINUS_ON : PMINUS_OFF, 0}; }
+static void onRelCfg(void *, const CommandParser::Args &a)
+{
+    if (strcmp(a[0].text, "LOW") == 0)
+        outcome = {RELCFG_LOW, 0};
+    else if (strcmp(a[0].text, "HIGH") == 0)
+        outcome = {RELCFG_HIGH, 0};
+}
+static void onEmergency(void *, const CommandParser::Args &a)
+{
+    outcome = {a.count && !a[0].on ? EMERGENCY_OFF : EMERGENCY_ON, 0};
+}
+static void onResume(void *, const CommandParser::Args &) { outcome = {EMERGENCY_OFF, 0}; }
+static void onNoise(void *, const CommandParser::Args &) { outcome = {NOISE, 0}; }
+static void onHelp(void *, const CommandParser::Args &) { outcome = {HELP, 0}; }
+
+static constexpr CommandParser::Command COMMANDS[] = {
+    {"PHCAL", "f", &onPhCal, ""},       {"PHSAVE", "", &onPhSave, ""},        {"SETT", "f", &onSetT, ""},
+    {"PPLUS", "b", &onPPlus, ""},       {"PMINUS", "b", &onPMinus, ""},       {"RELCFG", "w", &onRelCfg, ""},
+    {"EMERGENCY", "?b", &onEmergency, ""}, {"RESUME", "", &onResume, ""},     {"NOISE", "", &onNoise, ""},
+    {"HELP", "", &onHelp, ""},
+};
+
+static CommandParser parser;
+
+static void newProcess(const char *raw)
+{
+    for (const char *c = raw;; c++)
+    {
+        if (parser.feed(*c ? *c : '\n'))
+            parser.dispatch(parser.line(), COMMANDS, nullptr);
+        if (!*c)
+            break;
+    }
+}
+
+// ============================================================================
+// MEDICIÓN
+// ============================================================================
+
+// Mezcla de lo que llega por el monitor serie; las últimas no eligen comando en ninguno
+static const char *const LINES[] = {
+    "PHCAL,7",   "phcal,4",       "  SETT,23.5 ", "PPLUS,ON",    "PPLUS,OFF",           "pminus,on",
+    "PMINUS,OFF", "RELCFG,HIGH",  "RELCFG,LOW",   "EMERGENCY",   "EMERGENCY,OFF",       "RESUME",
+    "NOISE",     "help",          "PHSAVE",       "FOO,1",       "PPLUS,MAYBE",         "SETT,25.5,1",
+};
+static const int NUM_LINES = sizeof(LINES) / sizeof(LINES[0]);
+static const int VALID_LINES = 15;
+
+struct Result
+{
+    double nsPerLine;
+    double allocsPerLine;
+};
+
+template <typename F>
+static Result measure(F process, int rounds)
+{
+    unsigned long before = allocations;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++)
+        for (int i = 0; i < NUM_LINES; i++)
+            process(LINES[i]);
+    auto t1 = std::chrono::steady_clock::now();
+    double lines = double(rounds) * NUM_LINES;
+    return {std::chrono::duration<double, std::nano>(t1 - t0).count() / lines, (allocations - before) / lines};
+}
+
+int main()
+{
+    int failures = 0;
+
+    // Los dos caminos eligen lo mismo en las líneas válidas
+    for (int i = 0; i < VALID_LINES; i++)
+    {
+        outcome = {NONE, 0};
+        oldProcess(LINES[i]);
+        Outcome a = outcome;
+        outcome = {NONE, 0};
+        newProcess(LINES[i]);
+        Outcome b = outcome;
+        if (a.id == NONE || a.id != b.id || a.value != b.value)
+        {
+            printf("DIFIERE: \"%s\" -> anterior %d (%.2f), CommandParser %d (%.2f)\n", LINES[i], a.id, a.value, b.id,
+                   b.value);
+            failures++;
+        }
+    }
+
+    const int ROUNDS = 200000;
+    measure(oldProcess, 1000); // Calentamiento
+    measure(newProcess, 1000);
+    Result before = measure(oldProcess, ROUNDS);
+    Result after = measure(newProcess, ROUNDS);
+
+    printf("=== Comandos serie: %d líneas x %d ===\n", NUM_LINES, ROUNDS);
+    printf("%-34s %10s %14s\n", "Camino", "ns/línea", "reservas/línea");
+    printf("%-34s %10.1f %14.2f\n", "String + startsWith (anterior)", before.nsPerLine, before.allocsPerLine);
+    printf("%-34s %10.1f %14.2f\n", "CommandParser (tabla)", after.nsPerLine, after.allocsPerLine);
+    if (after.allocsPerLine != 0.0)
+    {
+        printf("ERROR: CommandParser reservó memoria\n");
+        failures++;
+    }
+    if (before.allocsPerLine == 0.0)
+    {
+        printf("ERROR: el camino anterior no reservó memoria; la comparación no muestra nada\n");
+        failures++;
+    }
+
+    // Línea a medias: antes readStringUntil() esperaba el timeout del Stream
+    const char *partial = "PHCAL,";
+    unsigned long allocsBefore = allocations;
+    auto t0 = std::chrono::steady_clock::now();
+    bool ready = false;
+    for (const char *c = partial; *c; c++)
+        ready |= parser.feed(*c);
+    auto t1 = std::chrono::steady_clock::now();
+    parser.clear();
+    printf("Línea a medias \"%s\": %.0f ns sin bloquear (antes: hasta 1000 ms de timeout), %lu reservas\n", partial,
+           std::chrono::duration<double, std::nano>(t1 - t0).count(), allocations - allocsBefore);
+    if (ready || allocations != allocsBefore)
+        failures++;
+
+    printf("%s\n", failures ? "FALLO" : "OK");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file bench_series_codec.cpp
+ * @brief Benchmark de host: tamaño y costo del historial empaquetado (SeriesCodec)
+ *
+ * Genera un día de pH, TDS y LDR a 10 s por muestra (paseo aleatorio con
+ * ruido de sensor y ciclo día/noche en la LDR), sellado como TimeService
+ * (epoch en ms con unos ms de jitter del loop(), seq de a 20 snapshots), y
+ * lo parte en bloques de 30 como HistoryChunker. Compara los bytes por muestra de:
+ *
+ *   - Claves sueltas historial/{ph,tds,ldr}/<ms> (formato anterior)
+ *   - Bloque JSON con arreglos (HISTORY_PACKED=0)
+ *   - Bloque empaquetado: SeriesCodec + base64 (HISTORY_PACKED=1)
+ *   - SeriesCodec con floats sin cuantizar (para ver cuánto aporta redondear)
+ *
+ * Después mide el tiempo de codificar y decodificar un bloque. Devuelve
+ * distinto de 0 si algún bloque no vuelve idéntico al decodificarlo.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *   g++ -O2 -std=gnu++17 -Ilib/ArduinoHAL -Ilib/Log -Ilib/SeriesCodec -Ilib/HistoryChunker -Ilib/TimeService test/host/bench_series_codec.cpp lib/SeriesCodec/SeriesCodec.cpp lib/HistoryChunker/HistoryChunker.cpp lib/TimeService/TimeService.cpp lib/Log/Log.cpp lib/ArduinoHAL/ArduinoHAL.cpp -o bench_series_codec
+ *   ./bench_series_codec
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "HistoryChunker.h"
+#include "SeriesCodec.h"
+
+namespace
+{
+    constexpr uint32_t DAY_SAMPLES = 8640; // 24 h a 10 s
+    constexpr uint8_t CHUNK = 30;
+    constexpr uint64_t EPOCH_MS = 1792195200000ULL; // 2026-10-17 00:00:00 UTC
+    constexpr uint32_t BOOT = 12;
+    constexpr int REPEAT = 2000;
+    volatile size_t sink;
+
+    std::vector<HistoryChunker::Point> makeDay()
+    {
+        std::mt19937 rng(42);
+        std::normal_distribution<float> noise(0.0f, 1.0f);
+        std::uniform_int_distribution<int> jitterMs(0, 20);
+        std::vector<HistoryChunker::Point> day(DAY_SAMPLES);
+        float ph = 6.2f, tds = 800.0f;
+        for (uint32_t i = 0; i < DAY_SAMPLES; i++)
+        {
+            ph += 0.0005f * noise(rng);
+            tds += 0.05f * noise(rng) - 0.0004f; // Consumo lento de nutrientes
+            float sun = std::sin(float(M_PI) * (float(i) / DAY_SAMPLES * 24.0f - 6.0f) / 12.0f);
+            int32_t ldr = int32_t(std::max(0.0f, 3500.0f * sun) + 150.0f + 8.0f * noise(rng));
+            day[i] = {EPOCH_MS + i * 10000ULL + jitterMs(rng), BOOT, i * 20u, ph + 0.01f * noise(rng),
+                      tds + 1.5f * noise(rng), ldr, false};
+        }
+        return day;
+    }
+
+    size_t legacyBytes(const HistoryChunker::Point &p)
+    {
+        // Lo que añadía cada muestra al PATCH: "historial/ph/123456789":6.123456,...
+        char buf[160];
+        unsigned long ms = (unsigned long)(p.epochMs - EPOCH_MS);
+        return snprintf(buf, sizeof(buf),
+                        "\"historial/ph/%lu\":%f,\"historial/tds/%lu\":%f,\"historial/ldr/%lu\":%ld,", ms, p.ph, ms,
+                        p.tds, ms, long(p.ldr));
+    }
+
+    bool sameBits(float a, float b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+    template <typename Fn>
+    double usPerCall(Fn fn)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < REPEAT; i++)
+            fn();
+        auto t1 = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::micro>(t1 - t0).count() / REPEAT;
+    }
+}
+
+int main()
+{
+    std::vector<HistoryChunker::Point> day = makeDay();
+    size_t legacy = 0, json = 0, packed = 0, binary = 0, rawFloats = 0;
+    int errors = 0;
+
+    for (uint32_t start = 0; start < DAY_SAMPLES; start += CHUNK)
+    {
+        const HistoryChunker::Point *points = &day[start];
+        for (uint8_t i = 0; i < CHUNK; i++)
+            legacy += legacyBytes(points[i]);
+
+        char key[HistoryChunker::KEY_MAX];
+        char text[HistoryChunker::JSON_MAX];
+        HistoryChunker::format(points, CHUNK, key, sizeof(key), text, sizeof(text), false);
+        json += strlen(key) + strlen(text) + 4;
+        HistoryChunker::format(points, CHUNK, key, sizeof(key), text, sizeof(text), true);
+        packed += strlen(key) + strlen(text) + 4;
+
+        // Cuantizado como en el formato empaquetado, y crudo
+        SeriesCodec::Sample q[CHUNK], raw[CHUNK], out[CHUNK];
+        for (uint8_t i = 0; i < CHUNK; i++)
+        {
+            raw[i] = {points[i].epochMs, points[i].seq, points[i].ph, points[i].tds, points[i].ldr};
+            q[i] = {points[i].epochMs, points[i].seq, std::round(points[i].ph * 100.0f) / 100.0f,
+                    std::round(points[i].tds), points[i].ldr};
+        }
+        uint8_t bin[SeriesCodec::maxBytes(CHUNK)];
+        size_t len = SeriesCodec::encode(q, CHUNK, BOOT, bin, sizeof(bin));
+        binary += len;
+        uint32_t boot = 0;
+        if (SeriesCodec::decode(bin, len, out, CHUNK, &boot) != CHUNK || boot != BOOT)
+            errors++;
+        for (uint8_t i = 0; i < CHUNK; i++)
+            if (out[i].time != q[i].time || out[i].seq != q[i].seq || !sameBits(out[i].ph, q[i].ph) ||
+                !sameBits(out[i].tds, q[i].tds) || out[i].ldr != q[i].ldr)
+                errors++;
+
+        len = SeriesCodec::encode(raw, CHUNK, BOOT, bin, sizeof(bin));
+        rawFloats += len;
+        if (SeriesCodec::decode(bin, len, out, CHUNK) != CHUNK || !sameBits(out[CHUNK - 1].ph, raw[CHUNK - 1].ph))
+            errors++;
+    }
+
+    const double n = DAY_SAMPLES;
+    printf("Un día (%lu muestras, bloques de %u):\n", (unsigned long)DAY_SAMPLES, CHUNK);
+    printf("  %-34s %8zu B  %6.1f B/muestra\n", "Claves sueltas (anterior)", legacy, legacy / n);
+    printf("  %-34s %8zu B  %6.1f B/muestra\n", "Bloque JSON", json, json / n);
+    printf("  %-34s %8zu B  %6.1f B/muestra\n", "Bloque empaquetado (base64)", packed, packed / n);
+    printf("  %-34s %8zu B  %6.1f bits/muestra\n", "  binario (pH 0.01, TDS 1 ppm)", binary, binary * 8 / n);
+    printf("  %-34s %8zu B  %6.1f bits/muestra\n", "  binario con floats sin cuantizar", rawFloats,
+           rawFloats * 8 / n);
+
+    // Costo por bloque, medido en el host
+    const HistoryChunker::Point *points = &day[DAY_SAMPLES / 2];
+    SeriesCodec::Sample q[CHUNK], out[CHUNK];
+    for (uint8_t i = 0; i < CHUNK; i++)
+        q[i] = {points[i].epochMs, points[i].seq, std::round(points[i].ph * 100.0f) / 100.0f,
+                std::round(points[i].tds), points[i].ldr};
+    uint8_t bin[SeriesCodec::maxBytes(CHUNK)];
+    char text[SeriesCodec::base64Len(sizeof(bin)) + 1];
+    size_t len = SeriesCodec::encode(q, CHUNK, BOOT, bin, sizeof(bin));
+    double encUs = usPerCall([&] {
+        size_t l = SeriesCodec::encode(q, CHUNK, BOOT, bin, sizeof(bin));
+        sink = SeriesCodec::base64Encode(bin, l, text, sizeof(text));
+    });
+    double decUs = usPerCall([&] {
+        uint8_t b[sizeof(bin)];
+        size_t l = SeriesCodec::base64Decode(text, b, sizeof(b));
+        sink = SeriesCodec::decode(b, l, out, CHUNK);
+    });
+    char key[HistoryChunker::KEY_MAX], plain[HistoryChunker::JSON_MAX];
+    double jsonUs =
+        usPerCall([&] { sink = HistoryChunker::format(points, CHUNK, key, sizeof(key), plain, sizeof(plain)); });
+    printf("\nPor bloque de %u (%zu B): codificar+base64 %.2f us, base64+decodificar %.2f us, JSON %.2f us\n", CHUNK,
+           len, encUs, decUs, jsonUs);
+
+    if (errors)
+    {
+        printf("ERROR: %d bloques o muestras no vuelven idénticos\n", errors);
+        return 1;
+    }
+    return 0;
+}
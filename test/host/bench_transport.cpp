@@ -0,0 +1,290 @@
+/**
+ * @file bench_transport.cpp
+ * @brief Benchmark de host: camino de publicación contra tools/rtdb_server
+ *
+ * Publica con RestSink el mismo PATCH que arma enviarDatos() en un keyframe
+ * (campos de la sombra + latido + un bloque empaquetado de 30 muestras) y
+ * mide latencia (p50/p95/máx), rendimiento y qué pasa con cada falla que
+ * inyecta el servidor:
+ *
+ *   - Sin fallas
+ *   - Demora de 30 ms + hasta 20 ms de jitter
+ *   - 503 en el 20 % de las peticiones
+ *   - Conexión cerrada sin respuesta en el 10 % (se reintenta una vez)
+ *   - Sin respuesta en el 5 % (vence el timeout de 500 ms del sink)
+ *
+ * Luego mide cuánto tarda un comando en llegar por el stream SSE hasta
+ * CommandStream, y que tras perder el keep-alive el stream se reabra con el
+ * nodo completo. Los ajustes del servidor se cambian por /.settings.json,
+ * así una sola instancia sirve para todo. Devuelve distinto de 0 si falla
+ * una publicación sin fallas inyectadas, si una falla no se detecta o
+ * tarda más que el timeout, o si se pierde un comando.
+ *
+ * Compilar y ejecutar desde la raíz del proyecto:
+ *   g++ -O2 -std=gnu++17 -pthread tools/rtdb_server.cpp -o rtdb_server
+ *   g++ -O2 -std=gnu++17 -Ilib/ArduinoHAL -Ilib/Log -Ilib/TelemetrySink -Ilib/RestTransport -Ilib/CommandStream -Ilib/HistoryChunker -Ilib/SeriesCodec -Ilib/TimeService test/host/bench_transport.cpp lib/TelemetrySink/TelemetrySink.cpp lib/RestTransport/RestTransport.cpp lib/CommandStream/CommandStream.cpp lib/HistoryChunker/HistoryChunker.cpp lib/SeriesCodec/SeriesCodec.cpp lib/TimeService/TimeService.cpp lib/Log/Log.cpp lib/ArduinoHAL/ArduinoHAL.cpp -o bench_transport
+ *   ./rtdb_server --port 8787 --seed 7 &
+ *   ./bench_transport 127.0.0.1 8787
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "CommandStream.h"
+#include "HistoryChunker.h"
+#include "RestTransport.h"
+
+namespace
+{
+    constexpr uint64_t EPOCH_MS = 1792195200000ULL; // 2026-10-17 00:00:00 UTC
+    constexpr unsigned long SINK_TIMEOUT_MS = 500;
+    const char *host = "127.0.0.1";
+    uint16_t port = 8787;
+
+    typedef std::chrono::steady_clock Clock;
+
+    double msSince(Clock::time_point t0)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    }
+
+    // Keyframe de enviarDatos(): 30 campos, latido y un bloque de historial
+    size_t buildPatch(char *buf, size_t cap, uint32_t seq)
+    {
+        static char bloque[HistoryChunker::JSON_MAX];
+        static char clave[HistoryChunker::KEY_MAX];
+        HistoryChunker::Point puntos[30];
+        for (uint32_t i = 0; i < 30; i++)
+        {
+            uint32_t s = seq * 30 + i;
+            puntos[i] = {EPOCH_MS + s * 10000ULL, 3, s * 20, 6.2f + 0.01f * (s % 7), 800.0f - (s % 11),
+                         int32_t(1500 + (s % 13))};
+        }
+        HistoryChunker::format(puntos, 30, clave, sizeof(clave), bloque, sizeof(bloque), true);
+
+        PatchBuilder patch(buf, cap);
+        patch.addText("diagnostico/chip", "ESP32-D0WD-V3");
+        patch.addText("diagnostico/mac", "24:6F:28:AA:BB:CC");
+        patch.addFloat("diagnostico/senal", -61.0f);
+        patch.addText("diagnostico/ip", "192.168.1.77");
+        patch.addText("diagnostico/estado", "Conectado");
+        patch.addInt("diagnostico/boot_id", 3);
+        patch.addBool("diagnostico/hora_sincronizada", true);
+        patch.addFloat("diagnostico/deriva_ppm", 12.5f);
+        patch.addInt("diagnostico/latencia_ms", 180);
+        patch.addInt("diagnostico/jitter_control_ms", 2);
+        patch.addFloat("sensores/ph4502c/ph", 6.21f);
+        patch.addFloat("sensores/sen0244/tds", 804.0f);
+        patch.addInt("sensores/sen0205/nivel_liquido", 0);
+        patch.addInt("sensores/ultrasonico/nivel_tranque", 0);
+        patch.addInt("actuadores/bomba_agua/estado", 1);
+        patch.addInt("actuadores/bomba_sustrato/estado", 0);
+        patch.addInt("actuadores/bomba_solucion/estado", 0);
+        patch.addBool("sistema/emergencia", false);
+        patch.addBool("sensores/tds_conectado", true);
+        patch.addBool("sensores/ph_calibrado", true);
+        patch.addText("sistema/modo", "conectados");
+        patch.addInt("sensores/ldr/valor_bruto", 1512);
+        patch.addText("sensores/ldr/nivel_luz", "Luz media");
+        patch.addInt("sensores/ldr/exposicion_solar_hoy_segundos", 7200);
+        patch.addInt("sensores/ldr/tiempo_restante_segundos", 14400);
+        patch.addBool("sensores/ldr/exposicion_activa", true);
+        patch.addBool("sensores/nivel_ph_minus/estado", true);
+        patch.addBool("sensores/nivel_ph_plus/estado", true);
+        patch.addU64("diagnostico/timestamp", EPOCH_MS + seq * 10000ULL);
+        patch.addU64("diagnostico/seq", seq);
+        patch.addRaw(clave, bloque);
+        return patch.overflow() ? 0 : patch.length();
+    }
+
+    struct Result
+    {
+        int ok = 0;
+        int failed = 0;
+        int wrongStatus = 0; // Falla con un código que no es el inyectado
+        double p50 = 0, p95 = 0, max = 0, perSecond = 0;
+        RestSink::Stats stats;
+    };
+
+    bool configure(RestSink &admin, const char *json)
+    {
+        if (!admin.set("/.settings", json))
+        {
+            printf("ERROR: no se pudo ajustar el servidor: %s\n", admin.lastError());
+            return false;
+        }
+        return true;
+    }
+
+    Result publish(int n, int expectedFailStatus)
+    {
+        static char cuerpo[8192];
+        RestSink sink(host, port, SINK_TIMEOUT_MS, 0);
+        std::vector<double> latency;
+        Result r;
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < n; i++)
+        {
+            buildPatch(cuerpo, sizeof(cuerpo), uint32_t(i));
+            Clock::time_point t0 = Clock::now();
+            bool ok = sink.update("/bench/hydroponic_data", cuerpo);
+            latency.push_back(msSince(t0));
+            if (ok)
+                r.ok++;
+            else
+            {
+                r.failed++;
+                if (sink.lastStatus() >= 0 && sink.lastStatus() != expectedFailStatus)
+                    r.wrongStatus++;
+            }
+        }
+        double total = msSince(start);
+        std::sort(latency.begin(), latency.end());
+        r.p50 = latency[latency.size() / 2];
+        r.p95 = latency[latency.size() * 95 / 100];
+        r.max = latency.back();
+        r.perSecond = n * 1000.0 / total;
+        r.stats = sink.getStats();
+        return r;
+    }
+
+    void print(const char *name, int n, const Result &r)
+    {
+        printf("  %-30s %4d  %4d  %4d  %7.2f  %7.2f  %7.2f  %7.0f  %4lu  %4lu\n", name, n, r.ok, r.failed, r.p50,
+               r.p95, r.max, r.perSecond, (unsigned long)r.stats.timeouts, (unsigned long)r.stats.reconnects);
+    }
+
+    // Lee el stream hasta un evento de comando (o timeoutMs reales)
+    bool waitCommand(RestCommandSource &source, CommandStream &commands, CommandStream::Event &ev, double timeoutMs,
+                     int *timeouts = nullptr)
+    {
+        Clock::time_point t0 = Clock::now();
+        while (msSince(t0) < timeoutMs)
+        {
+            CommandSource::Message m;
+            CommandSource::Result r = source.read(m);
+            if (r == CommandSource::DATA && commands.parse(m.path, m.type, m.payload, ev))
+                return true;
+            if (r == CommandSource::TIMEOUT && timeouts)
+                (*timeouts)++;
+            if (r == CommandSource::BROKEN)
+                return false;
+            if (r != CommandSource::DATA)
+                delay(1);
+        }
+        return false;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        host = argv[1];
+    if (argc > 2)
+        port = uint16_t(atoi(argv[2]));
+
+    RestSink admin(host, port);
+    if (!admin.set("/bench", "null"))
+    {
+        printf("Sin servidor en %s:%u (%s). Arrancar tools/rtdb_server primero.\n", host, port, admin.lastError());
+        return 2;
+    }
+    static char cuerpo[8192];
+    printf("PATCH de un keyframe: %zu B\n\n", buildPatch(cuerpo, sizeof(cuerpo), 0));
+
+    int errors = 0;
+    printf("  %-30s %4s  %4s  %4s  %7s  %7s  %7s  %7s  %4s  %4s\n", "Escenario (ms)", "n", "ok", "err", "p50",
+           "p95", "max", "req/s", "tout", "reco");
+
+    configure(admin, "{\"delay_ms\":0,\"jitter_ms\":0,\"fail_rate\":0,\"drop_rate\":0,\"stall_rate\":0}");
+    Result base = publish(300, 0);
+    print("Sin fallas", 300, base);
+    if (base.failed)
+    {
+        printf("ERROR: %d publicaciones fallaron sin fallas inyectadas\n", base.failed);
+        errors++;
+    }
+
+    configure(admin, "{\"delay_ms\":30,\"jitter_ms\":20}");
+    Result slow = publish(60, 0);
+    print("Demora 30 ms + jitter 20", 60, slow);
+    errors += slow.failed;
+
+    configure(admin, "{\"delay_ms\":0,\"jitter_ms\":0,\"fail_rate\":0.2,\"fail_status\":503}");
+    Result fail = publish(200, 503);
+    print("503 en el 20 %", 200, fail);
+    if (!fail.failed || fail.wrongStatus)
+    {
+        printf("ERROR: las respuestas 503 no se reportan como falla con su código\n");
+        errors++;
+    }
+
+    configure(admin, "{\"fail_rate\":0,\"drop_rate\":0.1}");
+    Result drop = publish(200, -1);
+    print("Cierre sin respuesta 10 %", 200, drop);
+
+    configure(admin, "{\"drop_rate\":0,\"stall_rate\":0.05,\"stall_ms\":2000}");
+    Result stall = publish(60, -2);
+    print("Sin respuesta 5 % (timeout)", 60, stall);
+    if (stall.failed != int(stall.stats.timeouts) || stall.max > 2.0 * SINK_TIMEOUT_MS + 100)
+    {
+        printf("ERROR: una petición sin respuesta no terminó por timeout (máx %.0f ms)\n", stall.max);
+        errors++;
+    }
+    configure(admin, "{\"stall_rate\":0}");
+
+    // Comandos: PATCH del dashboard → SSE → CommandStream
+    printf("\nStream de comandos:\n");
+    admin.set("/bench/comandos", "{\"emergency\":false,\"reset\":false}");
+    RestCommandSource source(host, port, 2000, 300);
+    CommandStream commands;
+    CommandStream::Event ev;
+    if (!source.begin("/bench/comandos") || !waitCommand(source, commands, ev, 2000) || ev.emergency)
+    {
+        printf("ERROR: el stream no entregó el nodo inicial (%s)\n", source.lastError());
+        return 1;
+    }
+    std::vector<double> latency;
+    int lost = 0;
+    for (int i = 0; i < 50; i++)
+    {
+        bool want = (i % 2) == 0;
+        Clock::time_point t0 = Clock::now();
+        admin.update("/bench/comandos", want ? "{\"emergency\":true}" : "{\"emergency\":false}");
+        if (!waitCommand(source, commands, ev, 2000) || !ev.hasEmergency || ev.emergency != want)
+            lost++;
+        else
+            latency.push_back(msSince(t0));
+    }
+    std::sort(latency.begin(), latency.end());
+    if (!latency.empty())
+        printf("  %zu comandos: p50 %.2f ms, p95 %.2f ms, máx %.2f ms (PATCH + evento)\n", latency.size(),
+               latency[latency.size() / 2], latency[latency.size() * 95 / 100], latency.back());
+    if (lost)
+    {
+        printf("ERROR: %d comandos perdidos o con otro valor\n", lost);
+        errors++;
+    }
+
+    // Keep-alive cada 5 s y el source espera 300 ms: TIMEOUT, se reabre y
+    // el put inicial trae el estado actual
+    configure(admin, "{\"keepalive_s\":5}");
+    admin.update("/bench/comandos", "{\"emergency\":true}");
+    waitCommand(source, commands, ev, 500);
+    int timeouts = 0;
+    bool resync = waitCommand(source, commands, ev, 3000, &timeouts) && ev.hasEmergency && ev.emergency;
+    printf("  Sin keep-alive: %d timeout(s), reabierto con el nodo completo: %s\n", timeouts, resync ? "sí" : "no");
+    if (!timeouts || !resync)
+    {
+        printf("ERROR: el stream no se reabrió tras perder el keep-alive\n");
+        errors++;
+    }
+    configure(admin, "{\"keepalive_s\":30}");
+    source.end();
+
+    return errors ? 1 : 0;
+}
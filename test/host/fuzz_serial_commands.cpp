@@ -0,0 +1,225 @@
+/**
+ * @file fuzz_serial_commands.cpp
+ * @brief Fuzzing de host: CommandParser y SerialCommands con entradas arbitrarias
+ *
+ * Cada entrada se usa dos veces:
+ *
+ *   - Directo en CommandParser con una tabla que cubre todas las firmas
+ *     ('f', 'b', 'w' y opcionales), revisando invariantes: línea de menos
+ *     de LINE_SIZE sin minúsculas ni caracteres de control, a lo sumo
+ *     MAX_ARGS argumentos, números finitos y handler llamado solo con OK
+ *   - Por el Serial del HAL hacia SerialCommands con los módulos reales
+ *     (pH, TDS, bombas, LDR y el modo STREAM), partida en dos lecturas del loop()
+ *
+ * Un invariante roto llama a abort(); con los sanitizers, cualquier acceso
+ * fuera del buffer también termina el proceso.
+ *
+ * Con libFuzzer (clang), desde la raíz del proyecto:
+ *   clang++ -g -O1 -std=gnu++17 -fsanitize=fuzzer,address,undefined -DUSE_LIBFUZZER -Iinclude -Ilib/ArduinoHAL -Ilib/Log -Ilib/CommandParser -Ilib/SerialCommands -Ilib/PHSensor -Ilib/TDSSensor -Ilib/PumpController -Ilib/LDRSensor -Ilib/SensorHub -Ilib/SensorPipeline -Ilib/SensorFilters -Ilib/SerialStream -Ilib/PerfStage test/host/fuzz_serial_commands.cpp lib/CommandParser/CommandParser.cpp lib/SerialCommands/SerialCommands.cpp lib/PHSensor/PHSensor.cpp lib/TDSSensor/TDSSensor.cpp lib/PumpController/PumpController.cpp lib/LDRSensor/LDRSensor.cpp lib/SensorHub/SensorHub.cpp lib/SerialStream/SerialStream.cpp lib/SerialStream/StreamFrame.cpp lib/PerfStage/PerfStage.cpp lib/Log/Log.cpp lib/ArduinoHAL/ArduinoHAL.cpp -o fuzz_serial_commands
+ *   ./fuzz_serial_commands -max_len=256 -runs=2000000
+ *
+ * Sin clang, el mismo archivo trae un generador propio (líneas armadas con
+ * nombres y valores conocidos, bytes al azar y líneas largas):
+ *   g++ -g -O1 -std=gnu++17 -fsanitize=address,undefined <mismos -I y .cpp> -o fuzz_serial_commands
+ *   ./fuzz_serial_commands [iteraciones] [semilla]
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include <ArduinoHAL.h>
+#include <EEPROM.h>
+#include "pin_config.h"
+#include "CommandParser.h"
+#include "LDRSensor.h"
+#include "PHSensor.h"
+#include "PumpController.h"
+#include "SerialCommands.h"
+#include "SerialStream.h"
+#include "TDSSensor.h"
+
+#define CHECK(cond)                                                                                                   \
+    do                                                                                                                \
+    {                                                                                                                 \
+        if (!(cond))                                                                                                  \
+        {                                                                                                             \
+            fprintf(stderr, "Invariante roto: %s (%s:%d)\n", #cond, __FILE__, __LINE__);                          \
+            abort();                                                                                                  \
+        }                                                                                                             \
+    } while (0)
+
+// ============================================================================
+// COMMANDPARSER CON TODAS LAS FIRMAS
+// ============================================================================
+
+static const char *const SPECS[] = {"", "f", "b", "w", "?b", "b?f", "ff", "?fff"};
+static int handlerCalls;
+static int handlerSpec;
+
+static void checkArgs(void *context, const CommandParser::Args &args)
+{
+    const char *spec = SPECS[(intptr_t)context];
+    handlerCalls++;
+    handlerSpec = (int)(intptr_t)context;
+    CHECK(args.count <= CommandParser::MAX_ARGS);
+    uint8_t i = 0;
+    for (const char *s = spec; *s && i < args.count; s++)
+    {
+        if (*s == '?')
+            continue;
+        const CommandParser::Arg &a = args[i++];
+        CHECK(a.text != nullptr);
+        if (*s == 'f')
+            CHECK(std::isfinite(a.number));
+        if (*s == 'b')
+            CHECK(strcmp(a.text, a.on ? "ON" : "OFF") == 0);
+        if (*s == 'w')
+            CHECK(a.text[0] != '\0');
+    }
+}
+
+static constexpr CommandParser::Command TABLE[] = {
+    {"NADA", "", &checkArgs, ""},  {"NUM", "f", &checkArgs, ""},       {"SW", "b", &checkArgs, ""},
+    {"WORD", "w", &checkArgs, ""}, {"OPT", "?b", &checkArgs, ""},      {"STREAM", "b?f", &checkArgs, ""},
+    {"PAR", "ff", &checkArgs, ""}, {"VARIOS", "?fff", &checkArgs, ""},
+};
+
+static void fuzzParser(const uint8_t *data, size_t size)
+{
+    CommandParser parser;
+    for (size_t i = 0; i < size; i++)
+    {
+        if (!parser.feed((char)data[i]))
+            continue;
+
+        char *line = parser.line();
+        size_t len = strlen(line);
+        CHECK(len < CommandParser::LINE_SIZE);
+        CHECK(!parser.truncated() || len == 0);
+        for (size_t k = 0; k < len; k++)
+        {
+            CHECK(!(line[k] >= 'a' && line[k] <= 'z'));
+            CHECK((uint8_t)line[k] >= ' ' || line[k] == '\t');
+        }
+
+        // El contexto es el índice de la firma en SPECS: se busca el nombre
+        // en una copia para pasarlo a dispatch()
+        char probe[CommandParser::LINE_SIZE];
+        memcpy(probe, line, len + 1);
+        char *name;
+        CommandParser::tokenize(probe, &name, 1);
+        intptr_t index = 0;
+        for (intptr_t t = 0; t < (intptr_t)(sizeof(TABLE) / sizeof(TABLE[0])); t++)
+            if (strcmp(TABLE[t].name, name) == 0)
+                index = t;
+
+        const CommandParser::Command *command;
+        int callsBefore = handlerCalls;
+        CommandParser::Result r = parser.dispatch(line, TABLE, (void *)index, &command);
+
+        CHECK((r == CommandParser::OK) == (handlerCalls == callsBefore + 1));
+        CHECK(handlerCalls <= callsBefore + 1);
+        CHECK((command != nullptr) == (r == CommandParser::OK || r == CommandParser::BAD_ARGS));
+        if (r == CommandParser::OK)
+            CHECK(handlerSpec == index);
+    }
+}
+
+// ============================================================================
+// SERIALCOMMANDS DE EXTREMO A EXTREMO
+// ============================================================================
+
+static void fuzzSerialCommands(const uint8_t *data, size_t size)
+{
+    hal::reset();
+    EEPROM.begin(512);
+    hal::setAnalog(PH_PIN, 2000);
+    hal::setAnalog(TDS_PIN, 1200);
+    hal::setAnalog(LDR_PIN, 1500);
+
+    PHSensor ph(PH_PIN, 0);
+    TDSSensor tds(TDS_PIN);
+    PumpController pump(RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS);
+    LDRSensor ldr(LDR_PIN);
+    SerialCommands commands;
+    SerialStream stream;
+    ph.begin();
+    tds.begin();
+    ldr.begin();
+    pump.begin();
+    commands.begin(&ph, &pump, &tds, &ldr);
+    commands.attachStream(&stream);
+
+    // Dos lecturas del loop(): la línea puede quedar partida entre ellas
+    size_t half = size / 2;
+    hal::serialInput(std::string((const char *)data, half));
+    commands.processCommands();
+    hal::serialInput(std::string((const char *)data + half, size - half));
+    commands.processCommands();
+    CHECK(Serial.available() == 0);
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzzParser(data, size);
+    fuzzSerialCommands(data, size);
+    return 0;
+}
+
+// ============================================================================
+// GENERADOR PROPIO (sin libFuzzer)
+// ============================================================================
+
+#ifndef USE_LIBFUZZER
+static const char *const NAMES[] = {"PHCAL", "PHSAVE", "PHRESET", "PHEEPRCLR", "SETT", "PPLUS", "PMINUS",
+                                    "RELCFG", "EMERGENCY", "RESUME", "NOISE", "HELP", "pplus", "NADA", "NUM",
+                                    "SW", "WORD", "OPT", "STREAM", "PERF", "PAR", "VARIOS", "RESET"};
+static const char *const VALUES[] = {"on", "OFF", "LOW", "HIGH", "7", "4", "10", "-3.5", "1e39", "nan", "inf",
+                                     "0x1p3", "25.5", "", " 6 ", "\t1"};
+static const char *const ENDINGS[] = {"\n", "\r", "\r\n", ""};
+
+int main(int argc, char **argv)
+{
+    unsigned long iterations = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200000;
+    unsigned long seed = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1;
+    std::mt19937 rng(seed);
+
+    std::string input;
+    for (unsigned long it = 0; it < iterations; it++)
+    {
+        input.clear();
+        int pieces = 1 + rng() % 12;
+        for (int p = 0; p < pieces; p++)
+        {
+            switch (rng() % 8)
+            {
+            case 0: // Bytes al azar, incluidos '\0' y controles
+                for (int k = rng() % 6; k >= 0; k--)
+                    input += (char)(rng() & 0xFF);
+                break;
+            case 1: // Línea larga
+                input.append(CommandParser::LINE_SIZE - 4 + rng() % 12, (char)('A' + rng() % 26));
+                break;
+            default: // Comando con 0 a 5 argumentos; RESET casi nunca (espera 1 s virtual)
+                input += NAMES[rng() % (sizeof(NAMES) / sizeof(NAMES[0]) - (rng() % 64 ? 1 : 0))];
+                for (int k = rng() % 6; k > 0; k--)
+                {
+                    input += ',';
+                    input += VALUES[rng() % (sizeof(VALUES) / sizeof(VALUES[0]))];
+                }
+                input += ENDINGS[rng() % (sizeof(ENDINGS) / sizeof(ENDINGS[0]))];
+                break;
+            }
+        }
+        LLVMFuzzerTestOneInput((const uint8_t *)input.data(), input.size());
+    }
+    printf("%lu entradas (semilla %lu): %d comandos despachados, sin invariantes rotos\n", iterations, seed,
+           handlerCalls);
+    return 0;
+}
+#endif
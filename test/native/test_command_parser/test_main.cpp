@@ -0,0 +1,161 @@
+/**
+ * @file test_main.cpp
+ * @brief Lector de líneas, tokens en el lugar y firmas de argumentos
+ *
+ *   pio test -e native -f native/test_command_parser
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include "CommandParser.h"
+
+// Lo último que recibió cada handler
+static int calls;
+static const char *lastName;
+static CommandParser::Args lastArgs;
+
+static void record(const char *name, const CommandParser::Args &args)
+{
+    calls++;
+    lastName = name;
+    lastArgs = args;
+}
+static void onSet(void *, const CommandParser::Args &a) { record("SET", a); }
+static void onPump(void *, const CommandParser::Args &a) { record("PUMP", a); }
+static void onStream(void *, const CommandParser::Args &a) { record("STREAM", a); }
+static void onMode(void *, const CommandParser::Args &a) { record("MODE", a); }
+
+static constexpr CommandParser::Command TABLE[] = {
+    {"SET", "f", &onSet, "SET,<n>"},
+    {"PUMP", "b", &onPump, "PUMP,ON|OFF"},
+    {"STREAM", "b?f", &onStream, "STREAM,ON[,<hz>]"},
+    {"MODE", "w", &onMode, "MODE,<palabra>"},
+};
+
+void setUp()
+{
+    hal::reset();
+    calls = 0;
+    lastName = nullptr;
+}
+void tearDown() {}
+
+// Alimenta texto; devuelve la última línea completa o nullptr
+static char *feedText(CommandParser &p, const char *text)
+{
+    char *line = nullptr;
+    for (const char *c = text; *c; c++)
+        if (p.feed(*c))
+            line = p.line();
+    return line;
+}
+
+void test_partial_line_waits_for_terminator()
+{
+    CommandParser p;
+    TEST_ASSERT_NULL(feedText(p, "pum"));
+    TEST_ASSERT_NULL(feedText(p, "p,o"));
+    char *line = feedText(p, "n\r\n");
+    TEST_ASSERT_NOT_NULL(line);
+    TEST_ASSERT_EQUAL_STRING("PUMP,ON", line);
+    TEST_ASSERT_EQUAL(1, p.getStats().lines);
+
+    // "\r\n" y líneas en blanco no producen líneas
+    TEST_ASSERT_NULL(feedText(p, "\n\n\r"));
+    TEST_ASSERT_EQUAL(1, p.getStats().lines);
+}
+
+void test_tokenize_trims_in_place()
+{
+    char line[] = "  STREAM , ON ,  20.5  ";
+    char *tokens[4];
+    TEST_ASSERT_EQUAL(3, CommandParser::tokenize(line, tokens, 4));
+    TEST_ASSERT_EQUAL_STRING("STREAM", tokens[0]);
+    TEST_ASSERT_EQUAL_STRING("ON", tokens[1]);
+    TEST_ASSERT_EQUAL_STRING("20.5", tokens[2]);
+
+    char empty[] = "A,,";
+    TEST_ASSERT_EQUAL(3, CommandParser::tokenize(empty, tokens, 4));
+    TEST_ASSERT_EQUAL_STRING("", tokens[1]);
+    TEST_ASSERT_EQUAL_STRING("", tokens[2]);
+}
+
+void test_dispatch_typed_arguments()
+{
+    CommandParser p;
+    char a[] = "SET,-3.25";
+    TEST_ASSERT_EQUAL(CommandParser::OK, p.dispatch(a, TABLE, nullptr));
+    TEST_ASSERT_EQUAL_STRING("SET", lastName);
+    TEST_ASSERT_EQUAL(1, lastArgs.count);
+    TEST_ASSERT_EQUAL_FLOAT(-3.25f, lastArgs[0].number);
+
+    char b[] = "PUMP,OFF";
+    TEST_ASSERT_EQUAL(CommandParser::OK, p.dispatch(b, TABLE, nullptr));
+    TEST_ASSERT_FALSE(lastArgs[0].on);
+
+    // Argumento opcional presente y ausente
+    char c[] = "STREAM,ON,50";
+    TEST_ASSERT_EQUAL(CommandParser::OK, p.dispatch(c, TABLE, nullptr));
+    TEST_ASSERT_EQUAL(2, lastArgs.count);
+    TEST_ASSERT_TRUE(lastArgs[0].on);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, lastArgs[1].number);
+    char d[] = "STREAM,OFF";
+    TEST_ASSERT_EQUAL(CommandParser::OK, p.dispatch(d, TABLE, nullptr));
+    TEST_ASSERT_EQUAL(1, lastArgs.count);
+
+    char e[] = "MODE,AUTO";
+    TEST_ASSERT_EQUAL(CommandParser::OK, p.dispatch(e, TABLE, nullptr));
+    TEST_ASSERT_EQUAL_STRING("AUTO", lastArgs[0].text);
+    TEST_ASSERT_EQUAL(5, calls);
+}
+
+void test_dispatch_rejects_bad_arguments()
+{
+    CommandParser p;
+    const CommandParser::Command *cmd;
+    const char *bad[] = {"SET", "SET,", "SET,7X", "SET,NAN", "SET,1,2", "PUMP,MAYBE", "STREAM", "STREAM,ON,1,2",
+                         "MODE,", "SET,1,2,3,4,5,6"};
+    for (const char *text : bad)
+    {
+        char line[CommandParser::LINE_SIZE];
+        strcpy(line, text);
+        TEST_ASSERT_EQUAL_MESSAGE(CommandParser::BAD_ARGS, p.dispatch(line, TABLE, nullptr, &cmd), text);
+        TEST_ASSERT_NOT_NULL(cmd);
+    }
+    TEST_ASSERT_EQUAL(0, calls);
+    TEST_ASSERT_EQUAL(10, p.getStats().badArgs);
+
+    char unknown[] = "SETX,1";
+    TEST_ASSERT_EQUAL(CommandParser::UNKNOWN, p.dispatch(unknown, TABLE, nullptr, &cmd));
+    TEST_ASSERT_NULL(cmd);
+    char blank[] = "   ";
+    TEST_ASSERT_EQUAL(CommandParser::EMPTY, p.dispatch(blank, TABLE, nullptr));
+}
+
+void test_overlong_line_is_dropped_whole()
+{
+    CommandParser p;
+    std::string longLine(CommandParser::LINE_SIZE + 20, 'x');
+    TEST_ASSERT_NULL(feedText(p, longLine.c_str()));
+    char *line = feedText(p, "\n");
+    TEST_ASSERT_NOT_NULL(line);
+    TEST_ASSERT_TRUE(p.truncated());
+    TEST_ASSERT_EQUAL_STRING("", line);
+    TEST_ASSERT_EQUAL(1, p.getStats().overflows);
+
+    // La siguiente línea llega entera
+    line = feedText(p, "set,1\n");
+    TEST_ASSERT_FALSE(p.truncated());
+    TEST_ASSERT_EQUAL_STRING("SET,1", line);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_partial_line_waits_for_terminator);
+    RUN_TEST(test_tokenize_trims_in_place);
+    RUN_TEST(test_dispatch_typed_arguments);
+    RUN_TEST(test_dispatch_rejects_bad_arguments);
+    RUN_TEST(test_overlong_line_is_dropped_whole);
+    return UNITY_END();
+}
@@ -0,0 +1,78 @@
+/**
+ * @file test_main.cpp
+ * @brief Eventos del stream de /hydroponic_data/comandos
+ *
+ *   pio test -e native -f native/test_command_stream
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include "CommandStream.h"
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+void test_initial_put_syncs_full_node()
+{
+    CommandStream cs;
+    CommandStream::Event ev;
+    TEST_ASSERT_TRUE(cs.parse("/", "json", "{\"emergency\":true,\"reset\":false}", ev));
+    TEST_ASSERT_TRUE(ev.hasEmergency);
+    TEST_ASSERT_TRUE(ev.emergency);
+    TEST_ASSERT_FALSE(ev.reset);
+
+    // Al reanudar llega de nuevo el nodo completo, ya sin emergencia
+    TEST_ASSERT_TRUE(cs.parse("/", "json", "{ \"reset\" : false, \"emergency\" : false }", ev));
+    TEST_ASSERT_TRUE(ev.hasEmergency);
+    TEST_ASSERT_FALSE(ev.emergency);
+}
+
+void test_single_key_events()
+{
+    CommandStream cs;
+    CommandStream::Event ev;
+    TEST_ASSERT_TRUE(cs.parse("/emergency", "boolean", "true", ev));
+    TEST_ASSERT_TRUE(ev.hasEmergency && ev.emergency);
+
+    TEST_ASSERT_TRUE(cs.parse("/reset", "boolean", "true", ev));
+    TEST_ASSERT_TRUE(ev.reset);
+    TEST_ASSERT_FALSE(ev.hasEmergency);
+
+    // El propio firmware limpia reset: ese eco no es una orden
+    TEST_ASSERT_FALSE(cs.parse("/reset", "boolean", "false", ev));
+    TEST_ASSERT_EQUAL_UINT32(3, cs.getStats().events);
+    TEST_ASSERT_EQUAL_UINT32(2, cs.getStats().commands);
+}
+
+void test_unknown_and_null_are_ignored()
+{
+    CommandStream cs;
+    CommandStream::Event ev;
+    TEST_ASSERT_FALSE(cs.parse("/", "null", "null", ev));
+    TEST_ASSERT_FALSE(cs.parse("/otro", "boolean", "true", ev));
+    TEST_ASSERT_FALSE(cs.parse("/emergency", "string", "\"true\"", ev));
+    TEST_ASSERT_FALSE(cs.parse("/", "json", "{\"emergency\":{\"a\":true}}", ev));
+    TEST_ASSERT_FALSE(cs.parse(nullptr, "json", "{}", ev));
+    TEST_ASSERT_EQUAL_UINT32(5, cs.getStats().ignored);
+}
+
+void test_find_bool_only_top_level_keys()
+{
+    bool v = false;
+    // Clave anidada o como valor de texto: no cuenta
+    TEST_ASSERT_FALSE(CommandStream::findBool("{\"x\":{\"reset\":true}}", "reset", v));
+    TEST_ASSERT_FALSE(CommandStream::findBool("{\"nota\":\"reset\"}", "reset", v));
+    TEST_ASSERT_FALSE(CommandStream::findBool("{\"resetear\":true}", "reset", v));
+    TEST_ASSERT_TRUE(CommandStream::findBool("{\"nota\":\"a\\\"reset\\\"\",\"reset\":true}", "reset", v));
+    TEST_ASSERT_TRUE(v);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_initial_put_syncs_full_node);
+    RUN_TEST(test_single_key_events);
+    RUN_TEST(test_unknown_and_null_are_ignored);
+    RUN_TEST(test_find_bool_only_top_level_keys);
+    return UNITY_END();
+}
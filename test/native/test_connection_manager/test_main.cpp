@@ -0,0 +1,162 @@
+/**
+ * @file test_main.cpp
+ * @brief Máquina de estados de WiFi + base de datos con backoff
+ *
+ *   pio test -e native -f native/test_connection_manager
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include "ConnectionManager.h"
+
+// Red simulada: los hooks solo cuentan y devuelven lo que el test fija
+static bool wifiOk;
+static bool backendOk;
+static int wifiBegins;
+static int wifiDrops;
+static int servicesStarts;
+
+static void beginWiFi() { wifiBegins++; }
+static bool wifiConnected() { return wifiOk; }
+static void dropWiFi() { wifiDrops++; }
+static void startServices() { servicesStarts++; }
+static bool backendReady() { return backendOk; }
+
+static const ConnectionManager::Hooks HOOKS = {&beginWiFi, &wifiConnected, &dropWiFi, &startServices,
+                                               &backendReady};
+
+void setUp()
+{
+    hal::reset();
+    wifiOk = backendOk = false;
+    wifiBegins = wifiDrops = servicesStarts = 0;
+}
+void tearDown() {}
+
+// Avanza de a 10 ms como la tarea de red
+static void run(ConnectionManager &cm, unsigned long &now, unsigned long ms)
+{
+    for (unsigned long i = 0; i < ms / 10; i++)
+    {
+        now += 10;
+        cm.update(now);
+    }
+}
+
+void test_begin_does_not_block_and_reaches_online()
+{
+    ConnectionManager cm;
+    unsigned long now = 100;
+    cm.begin(HOOKS, now);
+    TEST_ASSERT_EQUAL(1, wifiBegins);
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_CONNECTING, cm.state());
+    TEST_ASSERT_FALSE(cm.isOnline());
+
+    run(cm, now, 2000);
+    wifiOk = true;
+    run(cm, now, 10);
+    TEST_ASSERT_EQUAL(ConnectionManager::BACKEND_CONNECTING, cm.state());
+    TEST_ASSERT_EQUAL(1, servicesStarts);
+
+    run(cm, now, 500);
+    backendOk = true;
+    run(cm, now, 10);
+    TEST_ASSERT_TRUE(cm.isOnline());
+
+    const ConnectionManager::Stats &st = cm.getStats();
+    TEST_ASSERT_EQUAL(2110, st.bootToWiFiMs);
+    TEST_ASSERT_EQUAL(2620, st.bootToOnlineMs);
+    TEST_ASSERT_EQUAL(-1, st.bootToFirstPublishMs);
+    cm.notePublish(2700);
+    cm.notePublish(12700);
+    TEST_ASSERT_EQUAL(2700, cm.getStats().bootToFirstPublishMs);
+}
+
+void test_wifi_backoff_doubles_up_to_max()
+{
+    ConnectionManager::Config cfg;
+    cfg.wifiTimeoutMs = 1000;
+    cfg.initialBackoffMs = 500;
+    cfg.maxBackoffMs = 4000;
+    ConnectionManager cm(cfg);
+    unsigned long now = 0;
+    cm.begin(HOOKS, now);
+
+    // Cada intento: 1 s conectando y luego 0.5, 1, 2, 4, 4 s de espera
+    const unsigned long waits[] = {500, 1000, 2000, 4000, 4000};
+    for (unsigned long w : waits)
+    {
+        run(cm, now, 1000);
+        TEST_ASSERT_EQUAL(ConnectionManager::WIFI_BACKOFF, cm.state());
+        TEST_ASSERT_EQUAL(w, cm.getStats().backoffMs);
+        run(cm, now, w);
+        TEST_ASSERT_EQUAL(ConnectionManager::WIFI_CONNECTING, cm.state());
+    }
+    TEST_ASSERT_EQUAL(6, wifiBegins);
+    TEST_ASSERT_EQUAL(5, wifiDrops);
+    TEST_ASSERT_EQUAL(5, cm.getStats().wifiFailures);
+    TEST_ASSERT_EQUAL(0, servicesStarts);
+
+    // Conecta: el contador de fallas vuelve a cero
+    wifiOk = backendOk = true;
+    run(cm, now, 20);
+    TEST_ASSERT_TRUE(cm.isOnline());
+    TEST_ASSERT_EQUAL(0, cm.getStats().backoffMs);
+}
+
+void test_wifi_lost_reconnects_without_restarting_services()
+{
+    ConnectionManager cm;
+    unsigned long now = 0;
+    wifiOk = backendOk = true;
+    cm.begin(HOOKS, now);
+    run(cm, now, 20);
+    TEST_ASSERT_TRUE(cm.isOnline());
+
+    wifiOk = false;
+    run(cm, now, 10);
+    TEST_ASSERT_EQUAL(ConnectionManager::WIFI_BACKOFF, cm.state());
+    TEST_ASSERT_EQUAL(1, cm.getStats().wifiLost);
+
+    // El driver reconecta solo durante la espera
+    wifiOk = true;
+    run(cm, now, 30);
+    TEST_ASSERT_TRUE(cm.isOnline());
+    TEST_ASSERT_EQUAL(1, wifiBegins);
+    TEST_ASSERT_EQUAL(1, servicesStarts);
+    TEST_ASSERT_EQUAL(10, cm.getStats().bootToWiFiMs);
+}
+
+void test_backend_timeout_backs_off_and_recovers()
+{
+    ConnectionManager::Config cfg;
+    cfg.backendTimeoutMs = 3000;
+    cfg.initialBackoffMs = 1000;
+    ConnectionManager cm(cfg);
+    unsigned long now = 0;
+    wifiOk = true;
+    cm.begin(HOOKS, now);
+    run(cm, now, 3100);
+    TEST_ASSERT_EQUAL(ConnectionManager::BACKEND_BACKOFF, cm.state());
+    TEST_ASSERT_EQUAL(1, cm.getStats().backendFailures);
+
+    // Caída de la base estando en línea: vuelve a esperarla sin tocar el WiFi
+    backendOk = true;
+    run(cm, now, 1100);
+    TEST_ASSERT_TRUE(cm.isOnline());
+    backendOk = false;
+    run(cm, now, 10);
+    TEST_ASSERT_EQUAL(ConnectionManager::BACKEND_CONNECTING, cm.state());
+    TEST_ASSERT_EQUAL(1, wifiBegins);
+    TEST_ASSERT_EQUAL(0, wifiDrops);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_does_not_block_and_reaches_online);
+    RUN_TEST(test_wifi_backoff_doubles_up_to_max);
+    RUN_TEST(test_wifi_lost_reconnects_without_restarting_services);
+    RUN_TEST(test_backend_timeout_backs_off_and_recovers);
+    return UNITY_END();
+}
@@ -0,0 +1,150 @@
+/**
+ * @file test_main.cpp
+ * @brief Pruebas de la capa ArduinoHAL (reloj virtual, ADC, GPIO, EEPROM, Serial)
+ *
+ *   pio test -e native -f native/test_hal
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <EEPROM.h>
+#include <esp_timer.h>
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+static int timerHits = 0;
+static uint64_t lastHitUs = 0;
+
+static void countHit(void *)
+{
+    timerHits++;
+    lastHitUs = micros();
+}
+
+void test_clock_advances_only_on_delay()
+{
+    TEST_ASSERT_EQUAL_UINT32(0, millis());
+    delay(250);
+    TEST_ASSERT_EQUAL_UINT32(250, millis());
+    delayMicroseconds(1500);
+    TEST_ASSERT_EQUAL_UINT32(251500, micros());
+    TEST_ASSERT_EQUAL_UINT32(251, millis());
+}
+
+void test_periodic_timer_fires_in_order()
+{
+    timerHits = 0;
+    esp_timer_create_args_t args = {};
+    args.callback = &countHit;
+    esp_timer_handle_t timer;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_timer_create(&args, &timer));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_timer_start_periodic(timer, 10000));
+
+    hal::advanceMs(105);
+    TEST_ASSERT_EQUAL(10, timerHits);
+    TEST_ASSERT_EQUAL_UINT64(100000, lastHitUs); // micros() dentro del callback = instante del disparo
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_timer_stop(timer));
+    hal::advanceMs(100);
+    TEST_ASSERT_EQUAL(10, timerHits);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_timer_delete(timer));
+    TEST_ASSERT_EQUAL(0, hal::activeTimers());
+}
+
+void test_analog_constant_and_scripted()
+{
+    hal::setAnalog(32, 1234);
+    TEST_ASSERT_EQUAL_UINT16(1234, analogRead(32));
+
+    hal::setAnalogSource(33, [](uint64_t us) { return uint16_t(us / 1000); });
+    delay(700);
+    TEST_ASSERT_EQUAL_UINT16(700, analogRead(33));
+    hal::setAnalogSource(33, [](uint64_t) { return uint16_t(9000); });
+    TEST_ASSERT_EQUAL_UINT16(4095, analogRead(33)); // Saturación a 12 bits
+    TEST_ASSERT_EQUAL_UINT32(2, hal::analogReadCount(33));
+}
+
+void test_analog_read_cost_advances_clock()
+{
+    hal::setAnalogReadUs(10);
+    for (int i = 0; i < 100; i++)
+        analogRead(32);
+    TEST_ASSERT_EQUAL_UINT32(1000, micros());
+}
+
+void test_gpio_outputs_and_inputs()
+{
+    pinMode(25, OUTPUT);
+    TEST_ASSERT_EQUAL(-1, hal::outputLevel(25));
+    digitalWrite(25, HIGH);
+    TEST_ASSERT_EQUAL(HIGH, hal::outputLevel(25));
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(25));
+    TEST_ASSERT_EQUAL_UINT32(1, hal::writeCount(25));
+
+    pinMode(18, INPUT_PULLUP);
+    hal::setDigital(18, HIGH);
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(18));
+    hal::setDigital(18, LOW);
+    TEST_ASSERT_EQUAL(LOW, digitalRead(18));
+}
+
+void test_eeprom_roundtrip()
+{
+    struct Blob
+    {
+        float a;
+        int b;
+    } in = {3.5f, 42}, out = {0, 0};
+
+    EEPROM.begin(64);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, EEPROM.read(0)); // Flash borrada
+    EEPROM.put(8, in);
+    TEST_ASSERT_TRUE(EEPROM.commit());
+    EEPROM.get(8, out);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 3.5f, out.a);
+    TEST_ASSERT_EQUAL(42, out.b);
+    TEST_ASSERT_EQUAL_UINT32(1, hal::eepromCommits());
+    TEST_ASSERT_EQUAL(64, hal::eepromData().size());
+}
+
+void test_serial_capture_and_input()
+{
+    Serial.printf("pH=%.2f", 6.5);
+    Serial.println(" ok");
+    Serial.print(255, 16);
+    TEST_ASSERT_EQUAL_STRING("pH=6.50 ok\nFF", hal::serialOutput().c_str());
+
+    hal::serialInput("  help \nNEXT");
+    String line = Serial.readStringUntil('\n');
+    line.trim();
+    line.toUpperCase();
+    TEST_ASSERT_TRUE(line == "HELP");
+    TEST_ASSERT_EQUAL(4, Serial.available());
+    TEST_ASSERT_EQUAL_STRING("NEXT", Serial.readString().c_str());
+    TEST_ASSERT_EQUAL(0, Serial.available());
+}
+
+void test_string_subset()
+{
+    String cmd("SETT,23.5");
+    TEST_ASSERT_TRUE(cmd.startsWith("SETT,"));
+    TEST_ASSERT_EQUAL(4, cmd.indexOf(','));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 23.5f, cmd.substring(5).toFloat());
+    TEST_ASSERT_EQUAL_STRING("ETT", cmd.substring(1, 4).c_str());
+    TEST_ASSERT_EQUAL_STRING("1.50", String(1.5f).c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_clock_advances_only_on_delay);
+    RUN_TEST(test_periodic_timer_fires_in_order);
+    RUN_TEST(test_analog_constant_and_scripted);
+    RUN_TEST(test_analog_read_cost_advances_clock);
+    RUN_TEST(test_gpio_outputs_and_inputs);
+    RUN_TEST(test_eeprom_roundtrip);
+    RUN_TEST(test_serial_capture_and_input);
+    RUN_TEST(test_string_subset);
+    return UNITY_END();
+}
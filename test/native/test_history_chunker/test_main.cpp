@@ -0,0 +1,221 @@
+/**
+ * @file test_main.cpp
+ * @brief Historial en bloques por día: claves, formato, sellos y anclaje a la hora SNTP
+ *
+ *   pio test -e native -f native/test_history_chunker
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include "HistoryChunker.h"
+
+static const uint32_t EPOCH_10H = 1792231200UL; // 2026-10-17 10:00:00 UTC
+static const uint64_t EPOCH_10H_MS = EPOCH_10H * 1000ULL;
+
+// Sello como lo da TimeService (epochMs 0: sin hora todavía)
+static TimeService::Stamp stampAt(uint64_t epochMs, uint64_t monoMs, uint32_t seq, uint32_t boot = 12)
+{
+    return {epochMs, monoMs, boot, seq};
+}
+
+// Offset para que monoMs corresponda a epochMs
+static int64_t offsetFor(uint64_t epochMs, uint64_t monoMs) { return int64_t(epochMs) - int64_t(monoMs); }
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+void test_chunk_key_and_json()
+{
+    HistoryChunker chunker(3);
+    chunker.setClock(offsetFor(EPOCH_10H_MS, 50000));
+    chunker.add(stampAt(EPOCH_10H_MS, 50000, 340), 6.12f, 803.4f, 1021);
+    chunker.add(stampAt(EPOCH_10H_MS + 10002, 60002, 360), 6.13f, 801.0f, 1019);
+    TEST_ASSERT_FALSE(chunker.ready());
+    chunker.add(stampAt(EPOCH_10H_MS + 20001, 70001, 380), 6.11f, 802.0f, 1024);
+    TEST_ASSERT_TRUE(chunker.ready());
+
+    HistoryChunker::Point points[HistoryChunker::MAX_CHUNK];
+    char key[HistoryChunker::KEY_MAX];
+    char json[HistoryChunker::JSON_MAX];
+    uint8_t n = chunker.peek(points, HistoryChunker::MAX_CHUNK);
+    TEST_ASSERT_EQUAL(3, HistoryChunker::format(points, n, key, sizeof(key), json, sizeof(json)));
+    TEST_ASSERT_EQUAL_STRING("historial/2026-10-17/36000", key);
+    TEST_ASSERT_EQUAL_STRING("{\"t0\":1792231200000,\"b\":12,\"s0\":340,\"dt\":[0,10002,20001],"
+                             "\"ds\":[0,20,40],\"ph\":[612,613,611],\"tds\":[803,801,802],"
+                             "\"ldr\":[1021,1019,1024]}",
+                             json);
+
+    // Sin commit el bloque sigue ahí; con commit se quita
+    TEST_ASSERT_EQUAL(3, chunker.count());
+    chunker.commit(n);
+    TEST_ASSERT_EQUAL(0, chunker.count());
+    TEST_ASSERT_FALSE(chunker.ready());
+    TEST_ASSERT_EQUAL_UINT32(1, chunker.getStats().chunks);
+}
+
+void test_samples_before_ntp_are_dated()
+{
+    HistoryChunker chunker(4);
+    for (uint32_t i = 0; i < 3; i++)
+        chunker.add(stampAt(0, i * 10000ULL, i), 6.0f, 800.0f, 1000);
+    TEST_ASSERT_FALSE(chunker.ready()); // Sin hora, solo un bloque completo
+
+    // La hora llega después: lo sellado antes queda fechado hacia atrás
+    chunker.setClock(offsetFor(EPOCH_10H_MS, 45000));
+    chunker.add(stampAt(EPOCH_10H_MS - 15000, 30000, 3), 6.0f, 800.0f, 1000);
+    TEST_ASSERT_TRUE(chunker.ready());
+    HistoryChunker::Point points[4];
+    TEST_ASSERT_EQUAL(4, chunker.peek(points, 4));
+    TEST_ASSERT_TRUE(points[0].epochMs == EPOCH_10H_MS - 45000);
+    TEST_ASSERT_TRUE(points[3].epochMs == EPOCH_10H_MS - 15000);
+    TEST_ASSERT_FALSE(points[0].monotonic);
+    TEST_ASSERT_EQUAL_UINT32(3, points[3].seq);
+    TEST_ASSERT_EQUAL_UINT32(12, points[3].bootId);
+}
+
+void test_full_chunk_without_clock_is_monotonic()
+{
+    HistoryChunker chunker(4);
+    for (uint32_t i = 0; i < 5; i++)
+        chunker.add(stampAt(0, 20000 + i * 10000ULL, i), 6.0f, 800.0f, 1000);
+    TEST_ASSERT_TRUE(chunker.ready());
+
+    // Sale con el tiempo desde el arranque (para flash) y no se puede formatear
+    HistoryChunker::Point points[HistoryChunker::MAX_CHUNK];
+    TEST_ASSERT_EQUAL(4, chunker.peek(points, HistoryChunker::MAX_CHUNK));
+    TEST_ASSERT_TRUE(points[0].monotonic && points[3].monotonic);
+    TEST_ASSERT_TRUE(points[0].epochMs == 20000);
+    TEST_ASSERT_TRUE(points[3].epochMs == 50000);
+    char key[HistoryChunker::KEY_MAX];
+    char json[HistoryChunker::JSON_MAX];
+    TEST_ASSERT_EQUAL(0, HistoryChunker::format(points, 4, key, sizeof(key), json, sizeof(json)));
+
+    chunker.commit(4);
+    TEST_ASSERT_EQUAL(1, chunker.count());
+    TEST_ASSERT_FALSE(chunker.ready());
+}
+
+void test_chunk_never_crosses_midnight()
+{
+    const uint64_t lastMs = 1709251190000ULL; // 2024-02-29 23:59:50 UTC
+    HistoryChunker chunker(30);
+    chunker.setClock(offsetFor(lastMs, 0));
+    chunker.add(stampAt(lastMs, 0, 0), 6.0f, 800.0f, 1000);
+    chunker.add(stampAt(lastMs + 5000, 5000, 1), 6.0f, 800.0f, 1000);
+    TEST_ASSERT_FALSE(chunker.ready());
+    chunker.add(stampAt(lastMs + 10000, 10000, 2), 6.1f, 810.0f, 1100); // 00:00:00 del 1 de marzo
+    TEST_ASSERT_TRUE(chunker.ready());                                  // Bloque corto: cambió el día
+
+    HistoryChunker::Point points[HistoryChunker::MAX_CHUNK];
+    char key[HistoryChunker::KEY_MAX];
+    char json[HistoryChunker::JSON_MAX];
+    uint8_t n = chunker.peek(points, HistoryChunker::MAX_CHUNK);
+    TEST_ASSERT_EQUAL(2, n);
+    HistoryChunker::format(points, n, key, sizeof(key), json, sizeof(json));
+    TEST_ASSERT_EQUAL_STRING("historial/2024-02-29/86390", key);
+    chunker.commit(n);
+
+    TEST_ASSERT_FALSE(chunker.ready());
+    n = chunker.peek(points, HistoryChunker::MAX_CHUNK);
+    HistoryChunker::format(points, n, key, sizeof(key), json, sizeof(json));
+    TEST_ASSERT_EQUAL_STRING("historial/2024-03-01/00000", key);
+}
+
+void test_format_limits_and_overflow()
+{
+    HistoryChunker::Point points[4] = {
+        {EPOCH_10H_MS, 3, 0xFFFFFFFFu, NAN, 2500.4f, 4095, false},
+        {EPOCH_10H_MS + 10000, 3, 19, 1e9f, -3.0f, 0, false},  // seq da la vuelta
+        {EPOCH_10H_MS + 20000, 4, 0, 7.0f, 800.0f, 1, false},  // Otro arranque: queda fuera
+        {EPOCH_10H_MS + 86400000, 3, 20, 7.0f, 800.0f, 1, false},
+    };
+    char key[HistoryChunker::KEY_MAX];
+    char json[HistoryChunker::JSON_MAX];
+    TEST_ASSERT_EQUAL(2, HistoryChunker::format(points, 4, key, sizeof(key), json, sizeof(json)));
+    TEST_ASSERT_EQUAL_STRING("{\"t0\":1792231200000,\"b\":3,\"s0\":4294967295,\"dt\":[0,10000],"
+                             "\"ds\":[0,20],\"ph\":[null,99999],\"tds\":[2500,-3],\"ldr\":[4095,0]}",
+                             json);
+    points[2].bootId = 3; // Mismo arranque, otro día: también fuera
+    TEST_ASSERT_EQUAL(3, HistoryChunker::format(points, 4, key, sizeof(key), json, sizeof(json)));
+
+    // Un buffer chico no deja JSON a medias: no se envía nada
+    char small[40];
+    TEST_ASSERT_EQUAL(0, HistoryChunker::format(points, 2, key, sizeof(key), small, sizeof(small)));
+
+    // Peor caso de ambos formatos con el bloque más largo
+    HistoryChunker::Point worst[HistoryChunker::MAX_CHUNK];
+    for (uint8_t i = 0; i < HistoryChunker::MAX_CHUNK; i++)
+        worst[i] = {EPOCH_10H_MS + i * 1000000ULL, 0xFFFFFFFFu, i * 0x7FFFFFFFu, -1e9f, -1e9f + i,
+                    i % 2 ? INT32_MIN : INT32_MAX, false};
+    TEST_ASSERT_EQUAL(HistoryChunker::MAX_CHUNK, HistoryChunker::format(worst, HistoryChunker::MAX_CHUNK, key,
+                                                                        sizeof(key), json, sizeof(json)));
+    TEST_ASSERT_EQUAL(HistoryChunker::MAX_CHUNK, HistoryChunker::format(worst, HistoryChunker::MAX_CHUNK, key,
+                                                                        sizeof(key), json, sizeof(json), true));
+
+    char date[12];
+    HistoryChunker::dayString(951868800UL, date, sizeof(date));
+    TEST_ASSERT_EQUAL_STRING("2000-03-01", date);
+}
+
+void test_full_buffer_drops_oldest()
+{
+    HistoryChunker chunker(30);
+    for (uint32_t i = 0; i < HistoryChunker::MAX_SAMPLES + 5; i++)
+        chunker.add(stampAt(0, i * 10000ULL, i), 6.0f, 800.0f, int32_t(i));
+    TEST_ASSERT_EQUAL(HistoryChunker::MAX_SAMPLES, chunker.count());
+    TEST_ASSERT_EQUAL_UINT32(5, chunker.getStats().dropped);
+
+    chunker.setClock(offsetFor(EPOCH_10H_MS, 0));
+    HistoryChunker::Point points[HistoryChunker::MAX_CHUNK];
+    TEST_ASSERT_EQUAL(30, chunker.peek(points, HistoryChunker::MAX_CHUNK));
+    TEST_ASSERT_EQUAL_INT32(5, points[0].ldr);
+    TEST_ASSERT_EQUAL_UINT32(5, points[0].seq);
+}
+
+void test_packed_chunk_decodes()
+{
+    HistoryChunker::Point points[30];
+    for (uint8_t i = 0; i < 30; i++)
+        points[i] = {EPOCH_10H_MS + i * 10000u + (i % 4), 12, 340u + i * 20u, 6.1234f + (i % 3) * 0.01f, 802.6f,
+                     1000 + (i % 5), false};
+    char key[HistoryChunker::KEY_MAX];
+    char json[HistoryChunker::JSON_MAX];
+    char plain[HistoryChunker::JSON_MAX];
+    TEST_ASSERT_EQUAL(30, HistoryChunker::format(points, 30, key, sizeof(key), json, sizeof(json), true));
+    TEST_ASSERT_EQUAL_STRING("historial/2026-10-17/36000", key);
+    HistoryChunker::format(points, 30, key, sizeof(key), plain, sizeof(plain));
+    printf("Bloque de 30: %u B en JSON, %u B empaquetado\n", (unsigned)strlen(plain), (unsigned)strlen(json));
+    TEST_ASSERT_TRUE(strlen(json) * 2 < strlen(plain));
+
+    const char *prefix = "{\"t0\":1792231200000,\"n\":30,\"z\":\"";
+    TEST_ASSERT_EQUAL(0, strncmp(json, prefix, strlen(prefix)));
+    char z[HistoryChunker::JSON_MAX];
+    strcpy(z, json + strlen(prefix));
+    z[strlen(z) - 2] = '\0'; // Sin "}
+
+    uint8_t bin[SeriesCodec::maxBytes(30)];
+    size_t len = SeriesCodec::base64Decode(z, bin, sizeof(bin));
+    SeriesCodec::Sample out[30];
+    uint32_t boot = 0;
+    TEST_ASSERT_EQUAL(30, SeriesCodec::decode(bin, len, out, 30, &boot));
+    TEST_ASSERT_EQUAL_UINT32(12, boot);
+    // Tiempos y seq exactos; misma resolución que el formato JSON en los valores
+    TEST_ASSERT_TRUE(out[29].time == EPOCH_10H_MS + 290001);
+    TEST_ASSERT_EQUAL_UINT32(340 + 29 * 20, out[29].seq);
+    TEST_ASSERT_EQUAL_FLOAT(6.14f, out[2].ph);
+    TEST_ASSERT_EQUAL_FLOAT(803.0f, out[0].tds);
+    TEST_ASSERT_EQUAL_INT32(1004, out[4].ldr);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_chunk_key_and_json);
+    RUN_TEST(test_samples_before_ntp_are_dated);
+    RUN_TEST(test_full_chunk_without_clock_is_monotonic);
+    RUN_TEST(test_chunk_never_crosses_midnight);
+    RUN_TEST(test_format_limits_and_overflow);
+    RUN_TEST(test_full_buffer_drops_oldest);
+    RUN_TEST(test_packed_chunk_decodes);
+    return UNITY_END();
+}
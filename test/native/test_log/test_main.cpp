@@ -0,0 +1,236 @@
+/**
+ * @file test_main.cpp
+ * @brief Log asíncrono: cola MPSC, niveles en compilación, agrupado y UART lleno
+ *
+ * La HAL no crea tareas: la cola se vacía con service() y los productores
+ * concurrentes son hilos reales del host. Solo la prueba de end() corre la
+ * tarea del log en un hilo (hal::setTaskThreads).
+ *
+ *   pio test -e native -f native/test_log
+ */
+
+// Nivel propio para probar la eliminación en compilación
+#define LOG_LEVEL_STORE LOG_LVL_WARN
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <thread>
+#include "Log.h"
+
+void setUp()
+{
+    logger.end();
+    hal::reset();
+}
+void tearDown() {}
+
+static size_t countLines(const std::string &text, const std::string &needle)
+{
+    size_t n = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1))
+        n++;
+    return n;
+}
+
+void test_direct_before_begin_queued_after()
+{
+    LOG_I(NET, "antes de begin %d", 1);
+    TEST_ASSERT_TRUE(hal::serialContains("antes de begin 1\n"));
+
+    logger.begin(false);
+    TEST_ASSERT_FALSE(logger.isDedicated());
+    logger.service(0);
+    TEST_ASSERT_TRUE(hal::serialContains("Log: cola de 64 mensajes"));
+    hal::clearSerialOutput();
+    LOG_W(CTRL, "primero");
+    LOG_E(SENSOR, "segundo\n");
+    TEST_ASSERT_EQUAL_STRING("", hal::serialOutput().c_str());
+
+    logger.service(millis());
+    TEST_ASSERT_EQUAL_STRING("primero\nsegundo\n", hal::serialOutput().c_str());
+}
+
+void test_levels_removed_at_compile_time()
+{
+    logger.begin(false);
+    logger.service(0);
+    hal::clearSerialOutput();
+
+    int evaluated = 0;
+    LOG_I(STORE, "no sale %d", ++evaluated);  // STORE en WARN
+    LOG_D(MAIN, "tampoco %d", ++evaluated);   // DEBUG por debajo de LOG_LEVEL
+    LOG_W(STORE, "sale %d", ++evaluated);
+    logger.service(0);
+    TEST_ASSERT_EQUAL(1, evaluated);
+    TEST_ASSERT_EQUAL_STRING("sale 1\n", hal::serialOutput().c_str());
+}
+
+static void alerta(float ph)
+{
+    LOG_W(CTRL, "ALERTA - pH+ bloqueado. pH=%.2f", ph);
+}
+
+void test_repeats_from_same_site_are_grouped()
+{
+    logger.begin(false);
+    logger.service(0);
+    hal::clearSerialOutput();
+    uint32_t repeatsBefore = logger.getStats().repeats;
+
+    // Cada 500 ms con un valor distinto: sale el primero y un resumen
+    for (int i = 0; i < 6; i++)
+    {
+        alerta(5.0f + i * 0.01f);
+        logger.service(i * 500);
+    }
+    LOG_I(MAIN, "otro mensaje");
+    logger.service(3000);
+    TEST_ASSERT_EQUAL_STRING("ALERTA - pH+ bloqueado. pH=5.00\n"
+                             "  ^ repetido 5 veces, ultimo: ALERTA - pH+ bloqueado. pH=5.05\n"
+                             "otro mensaje\n",
+                             hal::serialOutput().c_str());
+    TEST_ASSERT_EQUAL(5, logger.getStats().repeats - repeatsBefore);
+
+    // Sin otro mensaje detrás, el resumen sale al vencer la ventana y el
+    // siguiente vuelve a imprimirse
+    hal::clearSerialOutput();
+    alerta(4.0f);
+    alerta(4.1f);
+    logger.service(4000);
+    TEST_ASSERT_EQUAL(1, countLines(hal::serialOutput(), "ALERTA"));
+    logger.service(4000 + Logger::REPEAT_WINDOW_MS);
+    TEST_ASSERT_TRUE(hal::serialContains("repetido 1 veces, ultimo: ALERTA - pH+ bloqueado. pH=4.10"));
+    alerta(4.2f);
+    logger.service(4000 + Logger::REPEAT_WINDOW_MS + 10);
+    TEST_ASSERT_TRUE(hal::serialContains("ALERTA - pH+ bloqueado. pH=4.20\n"));
+
+    // LOG_PRINT no se agrupa
+    hal::clearSerialOutput();
+    for (int i = 0; i < 3; i++)
+        LOG_PRINT(MAIN, "linea de estado");
+    logger.service(20000);
+    TEST_ASSERT_EQUAL(3, countLines(hal::serialOutput(), "linea de estado"));
+}
+
+void test_full_uart_and_full_queue_never_block()
+{
+    logger.begin(false);
+    logger.service(0);
+    hal::clearSerialOutput();
+
+    // FIFO de TX casi lleno: no escribe y conserva el mensaje
+    hal::setSerialTxRoom(4);
+    LOG_PRINT(MAIN, "mensaje que no cabe todavia");
+    logger.service(0);
+    TEST_ASSERT_EQUAL_STRING("", hal::serialOutput().c_str());
+    hal::setSerialTxRoom(-1);
+    logger.service(0);
+    TEST_ASSERT_EQUAL_STRING("mensaje que no cabe todavia\n", hal::serialOutput().c_str());
+
+    // Cola llena: se descarta, se cuenta y se avisa al vaciar
+    hal::clearSerialOutput();
+    uint32_t droppedBefore = logger.getStats().dropped;
+    for (uint32_t i = 0; i < LOG_QUEUE_SIZE + 10; i++)
+        LOG_PRINT(MAIN, "n %lu", (unsigned long)i);
+    logger.service(0);
+    TEST_ASSERT_EQUAL(10, logger.getStats().dropped - droppedBefore);
+    TEST_ASSERT_EQUAL(LOG_QUEUE_SIZE, countLines(hal::serialOutput(), "n "));
+    TEST_ASSERT_TRUE(hal::serialContains("Log: 10 mensajes descartados"));
+    TEST_ASSERT_EQUAL(LOG_QUEUE_SIZE, logger.getStats().maxQueued);
+}
+
+void test_concurrent_producers()
+{
+    logger.begin(false);
+    logger.service(0);
+    hal::clearSerialOutput();
+    uint32_t droppedBefore = logger.getStats().dropped;
+
+    const int PRODUCERS = 3;
+    const int MESSAGES = 3000;
+    std::atomic<int> running(PRODUCERS);
+    std::thread producers[PRODUCERS];
+    for (int p = 0; p < PRODUCERS; p++)
+    {
+        producers[p] = std::thread([p, &running] {
+            for (int i = 0; i < MESSAGES; i++)
+                LOG_PRINT(NET, "p%d %d", p, i);
+            running--;
+        });
+    }
+    while (running > 0)
+        logger.service(0);
+    for (auto &t : producers)
+        t.join();
+    logger.service(0);
+
+    // Cada línea llega entera y en orden dentro de su productor
+    const std::string &out = hal::serialOutput();
+    int last[PRODUCERS] = {-1, -1, -1};
+    int lines = 0;
+    for (size_t pos = 0; pos < out.size();)
+    {
+        size_t end = out.find('\n', pos);
+        std::string line = out.substr(pos, end - pos);
+        pos = end + 1;
+        int p, i;
+        if (sscanf(line.c_str(), "p%d %d", &p, &i) != 2)
+            continue;
+        TEST_ASSERT_TRUE(p >= 0 && p < PRODUCERS);
+        TEST_ASSERT_GREATER_THAN(last[p], i);
+        last[p] = i;
+        lines++;
+    }
+    uint32_t dropped = logger.getStats().dropped - droppedBefore;
+    TEST_ASSERT_EQUAL(PRODUCERS * MESSAGES, lines + (int)dropped);
+}
+
+void test_end_stops_task_before_draining()
+{
+    // UART saturado desde el arranque: la tarea saca un mensaje y no puede escribirlo
+    hal::setSerialTxRoom(0);
+    hal::setTaskThreads(true);
+    TEST_ASSERT_TRUE(logger.begin(true));
+    for (int i = 0; i < 20; i++)
+        LOG_PRINT(MAIN, "pendiente %d", i);
+    hal::advanceMs(50);
+
+    // end() espera a que la tarea salga y recién entonces vacía: cada línea una vez y en orden
+    unsigned long before = millis();
+    TEST_ASSERT_TRUE(logger.end());
+    hal::joinTasks();
+    hal::setTaskThreads(false);
+    TEST_ASSERT_FALSE(logger.isDedicated());
+    TEST_ASSERT_FALSE(logger.isAsync());
+    TEST_ASSERT_LESS_THAN(Logger::STOP_TIMEOUT_MS, millis() - before);
+
+    const std::string &out = hal::serialOutput();
+    TEST_ASSERT_EQUAL(1, countLines(out, "Log: cola de"));
+    size_t last = out.find("Log: cola de");
+    char line[32];
+    for (int i = 0; i < 20; i++)
+    {
+        snprintf(line, sizeof(line), "pendiente %d\n", i);
+        TEST_ASSERT_EQUAL(1, countLines(out, line));
+        size_t pos = out.find(line);
+        TEST_ASSERT_TRUE(pos > last);
+        last = pos;
+    }
+
+    // Ya sin tarea, lo que llega sale directo
+    hal::clearSerialOutput();
+    LOG_PRINT(MAIN, "directo");
+    TEST_ASSERT_EQUAL_STRING("directo\n", hal::serialOutput().c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_direct_before_begin_queued_after);
+    RUN_TEST(test_levels_removed_at_compile_time);
+    RUN_TEST(test_repeats_from_same_site_are_grouped);
+    RUN_TEST(test_full_uart_and_full_queue_never_block);
+    RUN_TEST(test_concurrent_producers);
+    RUN_TEST(test_end_stops_task_before_draining);
+    return UNITY_END();
+}
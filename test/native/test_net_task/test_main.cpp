@@ -0,0 +1,271 @@
+/**
+ * @file test_main.cpp
+ * @brief Canales SPSC, NetTask en línea y medición de jitter del control
+ *
+ * Las colas se prueban con dos hilos reales del host; NetTask corre en línea
+ * (la HAL no crea tareas) sobre el reloj virtual.
+ *
+ *   pio test -e native -f native/test_net_task
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <thread>
+#include "NetTask.h"
+#include "LoopJitter.h"
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+// ============================================================================
+// CANALES
+// ============================================================================
+
+void test_queue_fifo_and_full()
+{
+    SpscQueue<int, 4> q;
+    int v;
+    TEST_ASSERT_FALSE(q.pop(v));
+    for (int i = 0; i < 4; i++)
+        TEST_ASSERT_TRUE(q.push(i));
+    TEST_ASSERT_FALSE(q.push(99)); // Llena: se descarta, no se sobrescribe
+    TEST_ASSERT_EQUAL(4, q.size());
+
+    for (int round = 0; round < 10; round++) // Varias vueltas del índice
+    {
+        TEST_ASSERT_TRUE(q.pop(v));
+        TEST_ASSERT_EQUAL(round, v);
+        TEST_ASSERT_TRUE(q.push(round + 4));
+    }
+}
+
+void test_queue_two_threads()
+{
+    static SpscQueue<uint32_t, 64> q;
+    const uint32_t N = 200000;
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < N; i++)
+        {
+            while (!q.push(i))
+                std::this_thread::yield();
+        }
+    });
+
+    uint32_t expected = 0;
+    uint32_t v;
+    while (expected < N)
+    {
+        if (q.pop(v))
+        {
+            if (v != expected)
+                break;
+            expected++;
+        }
+    }
+    producer.join();
+    TEST_ASSERT_EQUAL_UINT32(N, expected);
+    TEST_ASSERT_TRUE(q.empty());
+}
+
+void test_triple_buffer_latest_value()
+{
+    TripleBuffer<int> tb;
+    int v = -1;
+    TEST_ASSERT_FALSE(tb.read(v));
+    tb.write(1);
+    tb.write(2);
+    tb.write(3);
+    TEST_ASSERT_TRUE(tb.read(v));
+    TEST_ASSERT_EQUAL(3, v); // Solo el más reciente
+    TEST_ASSERT_FALSE(tb.read(v));
+    tb.write(4);
+    TEST_ASSERT_TRUE(tb.read(v));
+    TEST_ASSERT_EQUAL(4, v);
+}
+
+void test_triple_buffer_no_torn_reads()
+{
+    struct Wide
+    {
+        uint32_t a, b, c, d;
+    };
+    static TripleBuffer<Wide> tb;
+    const uint32_t N = 200000;
+    std::thread writer([&] {
+        for (uint32_t i = 1; i <= N; i++)
+            tb.write({i, i, i, i});
+    });
+
+    Wide w;
+    uint32_t last = 0, torn = 0, backwards = 0;
+    while (last < N)
+    {
+        if (!tb.read(w))
+            continue;
+        if (w.a != w.b || w.a != w.c || w.a != w.d)
+            torn++;
+        if (w.a < last)
+            backwards++;
+        last = w.a;
+    }
+    writer.join();
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, backwards);
+}
+
+// ============================================================================
+// NETTASK EN LÍNEA
+// ============================================================================
+
+static int publishCount;
+static float lastPublishedPH;
+static unsigned long publishBlockMs;
+static bool emergencyRequested;
+
+static void fakePublish(const TelemetrySnapshot &s)
+{
+    publishCount++;
+    lastPublishedPH = s.ph;
+    delay(publishBlockMs); // Simula un PATCH lento
+}
+
+static void fakePoll(NetTask &net, const TelemetrySnapshot &s)
+{
+    if (emergencyRequested && !s.emergency)
+        net.sendCommand(NetCommand::EMERGENCY_STOP);
+}
+
+static void resetFakes()
+{
+    publishCount = 0;
+    lastPublishedPH = 0.0f;
+    publishBlockMs = 0;
+    emergencyRequested = false;
+}
+
+void test_inline_fallback_publishes_latest_snapshot()
+{
+    resetFakes();
+    NetTask net(10000, 2000);
+    // Sin planificador en el host: pedir la tarea cae a modo en línea
+    TEST_ASSERT_FALSE(net.begin(&fakePublish, &fakePoll, true));
+    TEST_ASSERT_FALSE(net.isDedicated());
+
+    // Sin snapshot todavía no se publica nada
+    net.service(millis());
+    TEST_ASSERT_EQUAL(0, publishCount);
+
+    TelemetrySnapshot s = {};
+    s.ph = 6.1f;
+    net.publishSnapshot(s);
+    net.service(millis());
+    TEST_ASSERT_EQUAL(1, publishCount); // Primer envío inmediato
+    TEST_ASSERT_EQUAL_FLOAT(6.1f, lastPublishedPH);
+
+    for (int i = 0; i < 40; i++) // 20 s en ciclos de 500 ms
+    {
+        delay(500);
+        s.ph = 6.1f + 0.01f * i;
+        net.publishSnapshot(s);
+        net.service(millis());
+    }
+    TEST_ASSERT_EQUAL(3, publishCount);
+    TEST_ASSERT_EQUAL_FLOAT(6.1f + 0.01f * 39, lastPublishedPH);
+    TEST_ASSERT_EQUAL(10, net.getStats().polls);
+}
+
+void test_command_round_trip()
+{
+    resetFakes();
+    NetTask net(10000, 2000);
+    net.begin(&fakePublish, &fakePoll, false);
+
+    TelemetrySnapshot s = {};
+    net.publishSnapshot(s);
+    emergencyRequested = true;
+    delay(2000);
+    net.service(millis());
+
+    NetCommand cmd;
+    TEST_ASSERT_TRUE(net.receiveCommand(cmd));
+    TEST_ASSERT_EQUAL(NetCommand::EMERGENCY_STOP, cmd.type);
+    TEST_ASSERT_FALSE(net.receiveCommand(cmd));
+
+    // Una vez aplicada, el snapshot lo refleja y no se repite la orden
+    s.emergency = true;
+    net.publishSnapshot(s);
+    delay(2000);
+    net.service(millis());
+    TEST_ASSERT_FALSE(net.receiveCommand(cmd));
+}
+
+// ============================================================================
+// JITTER
+// ============================================================================
+
+void test_jitter_statistics()
+{
+    LoopJitter jitter(500000UL);
+    uint32_t t = 1000;
+    jitter.tick(t); // Referencia, no mide
+    for (int i = 0; i < 9; i++)
+    {
+        t += 500000UL + 300; // 0.3 ms tarde
+        jitter.tick(t);
+    }
+    t += 3500000UL; // Un ciclo bloqueado 3 s
+    jitter.tick(t);
+
+    const LoopJitter::Stats &st = jitter.getStats();
+    TEST_ASSERT_EQUAL_UINT32(10, st.ticks);
+    TEST_ASSERT_EQUAL_UINT32(3000000UL, st.lateMaxUs);
+    TEST_ASSERT_EQUAL_UINT32(9, st.histogram[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, st.histogram[LoopJitter::BUCKETS - 1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 300.27f, st.meanLateMs());
+
+    jitter.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, jitter.getStats().ticks);
+}
+
+void test_inline_network_delays_control_loop()
+{
+    // El caso "antes": un PATCH de 3 s en línea atrasa el ciclo de control
+    resetFakes();
+    publishBlockMs = 3000;
+    NetTask net(10000, 2000);
+    net.begin(&fakePublish, nullptr, false);
+    LoopJitter jitter(500000UL);
+
+    unsigned long lastControl = 0;
+    unsigned long end = millis() + 60000;
+    while (millis() < end)
+    {
+        unsigned long now = millis();
+        if (now - lastControl >= 500)
+        {
+            lastControl = now;
+            jitter.tick(micros());
+            net.publishSnapshot(TelemetrySnapshot());
+        }
+        net.service(now);
+        delay(1);
+    }
+
+    TEST_ASSERT_GREATER_OR_EQUAL(2900000UL, jitter.getStats().lateMaxUs);
+    TEST_ASSERT_GREATER_THAN(0, jitter.getStats().histogram[LoopJitter::BUCKETS - 1]);
+    TEST_ASSERT_EQUAL(3000UL, net.getStats().maxPublishMs);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_queue_fifo_and_full);
+    RUN_TEST(test_queue_two_threads);
+    RUN_TEST(test_triple_buffer_latest_value);
+    RUN_TEST(test_triple_buffer_no_torn_reads);
+    RUN_TEST(test_inline_fallback_publishes_latest_snapshot);
+    RUN_TEST(test_command_round_trip);
+    RUN_TEST(test_jitter_statistics);
+    RUN_TEST(test_inline_network_delays_control_loop);
+    return UNITY_END();
+}
@@ -0,0 +1,178 @@
+/**
+ * @file test_main.cpp
+ * @brief PerfStage: cubetas logarítmicas, percentiles, resumen para la telemetría y comando PERF
+ *
+ * También debe compilar y pasar con -DPERF_ENABLED=0 (macros vacías).
+ *
+ *   pio test -e native -f native/test_perf_stage
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <cstring>
+#include "PerfStage.h"
+#include "SerialCommands.h"
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+void test_buckets_cover_every_tick_count()
+{
+    TEST_ASSERT_EQUAL(0, PerfStage::bucketOf(0));
+    TEST_ASSERT_EQUAL(1, PerfStage::bucketOf(1));
+    TEST_ASSERT_EQUAL(PerfStage::BUCKETS - 1, PerfStage::bucketOf(0xFFFFFFFFu));
+
+    // Contiguas, sin huecos, y cada valor cae dentro de su cubeta
+    for (uint8_t b = 0; b + 1 < PerfStage::BUCKETS; b++)
+        TEST_ASSERT_EQUAL(PerfStage::bucketUpper(b) + 1, PerfStage::bucketLower(b + 1));
+    const uint32_t samples[] = {2, 3, 5, 100, 1000, 65535, 65536, 98303, 98304, 240000000u, 0x80000000u};
+    for (uint32_t t : samples)
+    {
+        uint8_t b = PerfStage::bucketOf(t);
+        TEST_ASSERT_TRUE(PerfStage::bucketLower(b) <= t && t <= PerfStage::bucketUpper(b));
+        // Ancho relativo de la cubeta: hasta 50%
+        TEST_ASSERT_TRUE(PerfStage::bucketUpper(b) - PerfStage::bucketLower(b) <= PerfStage::bucketLower(b) / 2);
+    }
+}
+
+void test_percentiles_are_bucket_upper_bounds()
+{
+    PerfStage stage("prueba", "diagnostico/perf/prueba");
+    TEST_ASSERT_EQUAL(0, stage.percentileTicks(500));
+
+    for (int i = 0; i < 98; i++)
+        stage.record(100);
+    stage.record(10000);
+    stage.record(12000);
+    TEST_ASSERT_EQUAL(100, stage.getCount());
+    TEST_ASSERT_EQUAL(12000, stage.getMaxTicks());
+
+    uint32_t p50 = stage.percentileTicks(500);
+    TEST_ASSERT_TRUE(p50 >= 100 && p50 <= 150);
+    TEST_ASSERT_EQUAL(p50, stage.percentileTicks(980));
+    uint32_t p99 = stage.percentileTicks(990);
+    TEST_ASSERT_TRUE(p99 >= 10000 && p99 <= 12000);
+    TEST_ASSERT_EQUAL(12000, stage.percentileTicks(1000)); // Nunca más que el máximo
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (98 * 100 + 22000) / 100.0f / PerfStage::ticksPerUs(), stage.meanUs());
+
+    stage.reset();
+    TEST_ASSERT_EQUAL(0, stage.getCount());
+    TEST_ASSERT_EQUAL(0, stage.percentileTicks(990));
+}
+
+void test_scope_records_one_sample()
+{
+    PerfStage stage("bloque", "diagnostico/perf/bloque");
+    for (int i = 0; i < 3; i++)
+    {
+        PERF_SCOPE(stage);
+        volatile uint32_t x = 0;
+        for (int k = 0; k < 1000; k++)
+            x += k;
+    }
+#if PERF_ENABLED
+    TEST_ASSERT_EQUAL(3, stage.getCount());
+    TEST_ASSERT_TRUE(stage.getMaxTicks() > 0);
+#else
+    TEST_ASSERT_EQUAL(0, stage.getCount());
+#endif
+}
+
+// PERF_STAGE declara la etapa con su ruta; desactivado no declara nada
+PERF_STAGE(perfGlobal, "global");
+#if !PERF_ENABLED
+// Un PERF_SCOPE desactivado compila aunque la etapa no exista
+static void scopeWithoutStage()
+{
+    PERF_SCOPE(etapaInexistente);
+}
+#endif
+
+void test_macros_follow_perf_enabled()
+{
+#if PERF_ENABLED
+    TEST_ASSERT_EQUAL_STRING("diagnostico/perf/global", perfGlobal.getPath());
+    TEST_ASSERT_TRUE(PerfStage::first() == &perfGlobal);
+#else
+    scopeWithoutStage();
+    TEST_ASSERT_NULL(PerfStage::first());
+#endif
+}
+
+void test_registry_and_summary()
+{
+    const PerfStage *before = PerfStage::first(); // perfGlobal, si está activo
+    {
+        PerfStage primera("uno", "diagnostico/perf/uno");
+        PerfStage segunda("dos", "diagnostico/perf/dos");
+        TEST_ASSERT_EQUAL_STRING("diagnostico/perf/uno", primera.getPath());
+
+        primera.record(uint32_t(250 * PerfStage::ticksPerUs()));
+        segunda.record(0xFFFFFFFFu); // Más que SUMMARY_MAX_US
+
+        PerfStage::Summary out[PerfStage::MAX_SUMMARY];
+        uint8_t skip = before ? 1 : 0;
+        TEST_ASSERT_EQUAL(1 + skip, PerfStage::summarize(out, 1 + skip));
+        TEST_ASSERT_EQUAL(2 + skip, PerfStage::summarize(out, PerfStage::MAX_SUMMARY));
+        for (uint8_t i = 0; i < 2; i++)
+            out[i] = out[i + skip];
+        TEST_ASSERT_EQUAL_STRING("diagnostico/perf/uno", out[0].path);
+        TEST_ASSERT_EQUAL(1, out[0].count);
+        TEST_ASSERT_EQUAL(250, out[0].maxUs);
+        TEST_ASSERT_TRUE(out[0].p50Us <= 250 && out[0].p99Us <= 250);
+        TEST_ASSERT_EQUAL_STRING("diagnostico/perf/dos", out[1].path);
+        TEST_ASSERT_EQUAL(PerfStage::SUMMARY_MAX_US, out[1].maxUs);
+
+        // Lo más largo que puede salir entra en un texto de la telemetría
+        char text[24];
+        int n = snprintf(text, sizeof(text), "%lu/%lu/%lu", (unsigned long)out[1].p50Us,
+                         (unsigned long)out[1].p99Us, (unsigned long)out[1].maxUs);
+        TEST_ASSERT_TRUE(n < (int)sizeof(text));
+
+        // Al destruirse salen de la lista (solo pasa en las pruebas)
+        PerfStage::resetAll();
+        TEST_ASSERT_EQUAL(0, primera.getCount());
+    }
+    TEST_ASSERT_TRUE(PerfStage::first() == before);
+}
+
+void test_perf_command()
+{
+    SerialCommands commands;
+    PerfStage control("control", "diagnostico/perf/control");
+    control.record(1000);
+
+    hal::serialInput("perf\n");
+    commands.processCommands();
+#if PERF_ENABLED
+    TEST_ASSERT_TRUE(hal::serialContains("LATENCIA POR ETAPA"));
+    TEST_ASSERT_TRUE(hal::serialContains("control"));
+    TEST_ASSERT_TRUE(hal::serialContains("p99"));
+
+    hal::clearSerialOutput();
+    hal::serialInput("PERF,RESET\n");
+    commands.processCommands();
+    TEST_ASSERT_TRUE(hal::serialContains("Latencias reiniciadas"));
+    TEST_ASSERT_EQUAL(0, control.getCount());
+
+    hal::clearSerialOutput();
+    hal::serialInput("PERF,TODO\n");
+    commands.processCommands();
+    TEST_ASSERT_TRUE(hal::serialContains("Uso: PERF | PERF,RESET"));
+#else
+    TEST_ASSERT_TRUE(hal::serialContains("desactivada"));
+    TEST_ASSERT_EQUAL(1, control.getCount());
+#endif
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_buckets_cover_every_tick_count);
+    RUN_TEST(test_percentiles_are_bucket_upper_bounds);
+    RUN_TEST(test_scope_records_one_sample);
+    RUN_TEST(test_macros_follow_perf_enabled);
+    RUN_TEST(test_registry_and_summary);
+    RUN_TEST(test_perf_command);
+    return UNITY_END();
+}
@@ -0,0 +1,167 @@
+/**
+ * @file test_main.cpp
+ * @brief Lazo cerrado: firmware sin modificar contra el tanque simulado
+ *
+ * Reproduce el setup() y el loop() de main.cpp (sin WiFi ni Firebase) sobre
+ * PlantSim y corre días de operación en tiempo virtual. Imprime el reporte de
+ * cada escenario: tiempo en banda, volumen dosificado y duración de sesiones.
+ *
+ *   pio test -e native -f native/test_plant_sim -v
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <EEPROM.h>
+#include <chrono>
+#include "pin_config.h"
+#include "PlantSim.h"
+#include "SensorHub.h"
+#include "PHSensor.h"
+#include "TDSSensor.h"
+#include "LDRSensor.h"
+#include "LevelSensor.h"
+#include "PumpController.h"
+
+static const PlantSim::Pins SIM_PINS = {PH_PIN, TDS_PIN, LDR_PIN, LVL_PH_MINUS, LVL_PH_PLUS,
+                                        RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS};
+
+static constexpr float MIN_SPEEDUP = 1000.0f;
+
+/**
+ * @brief Los mismos módulos y el mismo orden que main.cpp
+ */
+struct Firmware
+{
+    static constexpr unsigned long SENSOR_INTERVAL = 500;
+    static constexpr uint32_t SENSOR_FRAME_RATE = 100;
+
+    SensorHub hub{PH_PIN, TDS_PIN, LDR_PIN};
+    PHSensor ph{PH_PIN, 0};
+    TDSSensor tds{TDS_PIN};
+    LDRSensor ldr{LDR_PIN};
+    MultiLevelSensor levels;
+    PumpController pump{RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS};
+
+    void setup()
+    {
+        EEPROM.begin(512);
+        ph.begin();
+        tds.begin();
+        ldr.begin();
+        if (hub.begin(SENSOR_FRAME_RATE, SENSOR_MAINS_HZ))
+        {
+            ph.attachHub(&hub);
+            tds.attachHub(&hub);
+            ldr.attachHub(&hub);
+        }
+        levels.addSensor(LVL_PH_MINUS, true, "pH-");
+        levels.addSensor(LVL_PH_PLUS, true, "pH+");
+        levels.begin();
+        pump.begin();
+    }
+
+    void loopOnce()
+    {
+        ph.update();
+        if (tds.shouldUpdate())
+            tds.update();
+        if (ldr.shouldUpdate())
+            ldr.update();
+        if (!pump.isEmergencyMode())
+        {
+            pump.update(ph.getFilteredPH(), ph.getPHRate(), ph.isSettled(),
+                        levels.isLevelOK("pH-"), levels.isLevelOK("pH+"));
+        }
+    }
+
+    // Corre `hours` horas de loop() y devuelve la aceleración frente a tiempo real
+    float run(float hours)
+    {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t steps = uint64_t(hours * 3600000.0f / SENSOR_INTERVAL);
+        for (uint64_t i = 0; i < steps; i++)
+        {
+            delay(SENSOR_INTERVAL);
+            loopOnce();
+            // La salida por Serial no interesa aquí y crecería sin límite
+            if ((i & 1023) == 0)
+                hal::clearSerialOutput();
+        }
+        float wallS = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+        return hours * 3600.0f / (wallS > 1e-6f ? wallS : 1e-6f);
+    }
+};
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+void test_week_of_operation()
+{
+    PlantSim sim(SIM_PINS);
+    sim.begin();
+    Firmware fw;
+    fw.setup();
+
+    float speedup = fw.run(7 * 24.0f);
+    sim.end();
+    sim.printReport();
+    printf("Aceleración: %.0fx tiempo real\n", speedup);
+
+    const PlantSim::Report &r = sim.getReport();
+    TEST_ASSERT_GREATER_OR_EQUAL(MIN_SPEEDUP, speedup);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 7 * 86400.0f, r.simulatedS);
+    TEST_ASSERT_GREATER_OR_EQUAL(99.0f, r.inBandPct());
+    TEST_ASSERT_GREATER_THAN(0, r.minus.sessions); // La deriva alcalina obliga a dosificar pH-
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.0f, r.minus.dryS);
+    TEST_ASSERT_LESS_THAN(r.tdsStart, r.tdsEnd); // Absorción > evaporación con sol
+}
+
+void test_acid_spike_recovers()
+{
+    PlantSim sim(SIM_PINS);
+    sim.begin();
+    Firmware fw;
+    fw.setup();
+    fw.run(1.0f);
+
+    // Vertido de ácido: el tanque cae por debajo de phMin y debe volver con pH+
+    sim.addAcidMmol(60.0f);
+    TEST_ASSERT_LESS_THAN(5.5f, sim.getPH());
+    fw.run(12.0f);
+    sim.end();
+    sim.printReport();
+
+    const PlantSim::Report &r = sim.getReport();
+    TEST_ASSERT_GREATER_THAN(0, r.plus.sessions);
+    TEST_ASSERT_GREATER_OR_EQUAL(5.5f, sim.getPH());
+    TEST_ASSERT_LESS_OR_EQUAL(7.5f, r.phMax); // Sin sobrecorrección hacia el otro límite
+}
+
+void test_empty_reservoir_blocks_dosing()
+{
+    PlantSim::Config config;
+    config.reservoirMl = 120.0f; // Casi en el umbral del sensor de nivel
+    config.alkalinityRiseMmolLDay = 1.5f;
+    PlantSim sim(SIM_PINS, config);
+    sim.begin();
+    Firmware fw;
+    fw.setup();
+    fw.run(2 * 24.0f);
+    sim.end();
+    sim.printReport();
+
+    // El sensor de nivel corta la bomba antes de vaciar el depósito
+    const PlantSim::Report &r = sim.getReport();
+    TEST_ASSERT_GREATER_THAN(0.0f, r.minus.lowLevelS);
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.0f, r.minus.dryS);
+    TEST_ASSERT_GREATER_THAN(0.0f, sim.getReservoirMl(true));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_week_of_operation);
+    RUN_TEST(test_acid_spike_recovers);
+    RUN_TEST(test_empty_reservoir_blocks_dosing);
+    return UNITY_END();
+}
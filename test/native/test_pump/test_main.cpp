@@ -0,0 +1,121 @@
+/**
+ * @file test_main.cpp
+ * @brief Lógica de dosificación de PumpController sobre relés simulados
+ *
+ *   pio test -e native -f native/test_pump
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include "pin_config.h"
+#include "PumpController.h"
+
+// Relés activos en LOW (configuración por defecto)
+static bool relayOn(uint8_t pin) { return hal::outputLevel(pin) == LOW; }
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+void test_begin_starts_circulation_only()
+{
+    PumpController pump(RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS);
+    pump.begin();
+    TEST_ASSERT_EQUAL(OUTPUT, hal::pinModeOf(RELAY_CIRC));
+    TEST_ASSERT_TRUE(relayOn(RELAY_CIRC));
+    TEST_ASSERT_FALSE(relayOn(RELAY_PH_MINUS));
+    TEST_ASSERT_FALSE(relayOn(RELAY_PH_PLUS));
+}
+
+void test_high_ph_doses_minus_until_hysteresis()
+{
+    PumpController pump(RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS);
+    pump.begin();
+    PumpController::Config config = pump.getConfig();
+
+    delay(1000);
+    pump.update(8.0f, true, true);
+    TEST_ASSERT_EQUAL(PumpController::DOSE_MINUS, pump.getCurrentDoseType());
+    TEST_ASSERT_TRUE(relayOn(RELAY_PH_MINUS));
+
+    // Fin del pulso sin llegar al objetivo: sigue dosificando
+    delay(config.doseOnMs);
+    pump.update(7.0f, true, true);
+    TEST_ASSERT_TRUE(pump.isDosingActive());
+
+    // Siguiente pulso por debajo de la histéresis alta: se apaga
+    delay(config.doseOnMs);
+    pump.update(config.phHighHyst - 0.1f, true, true);
+    TEST_ASSERT_FALSE(pump.isDosingActive());
+    TEST_ASSERT_FALSE(relayOn(RELAY_PH_MINUS));
+}
+
+void test_low_tank_level_blocks_dosing()
+{
+    PumpController pump(RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS);
+    pump.begin();
+    delay(1000);
+    pump.update(4.5f, true, false);
+    TEST_ASSERT_FALSE(pump.isDosingActive());
+    TEST_ASSERT_FALSE(relayOn(RELAY_PH_PLUS));
+    TEST_ASSERT_TRUE(hal::serialContains("pH+ bloqueado"));
+}
+
+void test_trend_cuts_pulse_early()
+{
+    PumpController pump(RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS);
+    pump.begin();
+    delay(1000);
+    pump.update(5.0f, 0.0f, true, true, true);
+    TEST_ASSERT_EQUAL(PumpController::DOSE_PLUS, pump.getCurrentDoseType());
+
+    // Subiendo 0.05 pH/s: en 30 s se pasa de la histéresis baja
+    delay(1000);
+    pump.update(5.3f, 0.05f, false, true, true);
+    TEST_ASSERT_FALSE(pump.isDosingActive());
+    TEST_ASSERT_FALSE(relayOn(RELAY_PH_PLUS));
+}
+
+void test_session_timeout()
+{
+    PumpController pump(RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS);
+    pump.begin();
+    PumpController::Config config = pump.getConfig();
+    delay(1000);
+    pump.update(8.5f, true, true);
+    unsigned long start = millis();
+    while (pump.isDosingActive() && millis() - start <= config.maxSessionMs)
+    {
+        delay(config.doseOnMs);
+        pump.update(8.5f, true, true);
+    }
+    TEST_ASSERT_FALSE(pump.isDosingActive());
+    TEST_ASSERT_EQUAL_UINT32(config.maxSessionMs, millis() - start);
+    TEST_ASSERT_TRUE(hal::serialContains("Tiempo máximo"));
+}
+
+void test_emergency_stops_everything()
+{
+    PumpController pump(RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS);
+    pump.begin();
+    pump.forcePumpPlus(true);
+    TEST_ASSERT_TRUE(relayOn(RELAY_PH_PLUS));
+    pump.emergencyStop();
+    TEST_ASSERT_FALSE(relayOn(RELAY_CIRC));
+    TEST_ASSERT_FALSE(relayOn(RELAY_PH_PLUS));
+
+    delay(1000);
+    pump.update(4.0f, true, true); // Sin control automático en emergencia
+    TEST_ASSERT_FALSE(pump.isDosingActive());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_begin_starts_circulation_only);
+    RUN_TEST(test_high_ph_doses_minus_until_hysteresis);
+    RUN_TEST(test_low_tank_level_blocks_dosing);
+    RUN_TEST(test_trend_cuts_pulse_early);
+    RUN_TEST(test_session_timeout);
+    RUN_TEST(test_emergency_stops_everything);
+    return UNITY_END();
+}
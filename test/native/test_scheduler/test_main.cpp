@@ -0,0 +1,223 @@
+/**
+ * @file test_main.cpp
+ * @brief Scheduler: prioridades, tareas de una vez, desbordes, rueda de tiempo y espera
+ *
+ *   pio test -e native -f native/test_scheduler
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <string>
+#include "Scheduler.h"
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+static std::string order;
+static Scheduler *current = nullptr;
+static Scheduler::TaskId other = Scheduler::INVALID_TASK;
+
+static void mark(void *context)
+{
+    order += *(const char *)context;
+}
+
+// Tarea que tarda lo indicado en el contexto (en µs del reloj virtual)
+static void busy(void *context)
+{
+    uint32_t *us = (uint32_t *)context;
+    hal::advanceUs(*us);
+    *us = 0;
+}
+
+static void cancelOther(void *context)
+{
+    mark(context);
+    current->cancel(other);
+}
+
+static void slowDown(void *context)
+{
+    mark(context);
+    current->setPeriod(other, 20000);
+}
+
+void test_priority_then_deadline_order()
+{
+    order.clear();
+    Scheduler s;
+    static const char a = 'a', b = 'b', c = 'c', d = 'd';
+    s.every("baja", 10000, 1, &mark, (void *)&a);
+    s.every("alta", 10000, 5, &mark, (void *)&b);
+    s.every("media", 10000, 3, &mark, (void *)&c);
+
+    TEST_ASSERT_EQUAL(3, s.run(micros()));
+    TEST_ASSERT_EQUAL_STRING("bca", order.c_str());
+
+    // A igual prioridad, primero la que venció antes
+    s.after("media2", 2000, 3, &mark, (void *)&d);
+    order.clear();
+    hal::advanceUs(9999);
+    TEST_ASSERT_EQUAL(1, s.run(micros()));
+    hal::advanceUs(1);
+    TEST_ASSERT_EQUAL(3, s.run(micros()));
+    TEST_ASSERT_EQUAL_STRING("dbca", order.c_str());
+}
+
+void test_one_shot_runs_once()
+{
+    order.clear();
+    Scheduler s;
+    static const char a = 'a';
+    s.run(micros());
+    Scheduler::TaskId id = s.after("una", 5000, 1, &mark, (void *)&a);
+    TEST_ASSERT_TRUE(s.isActive(id));
+
+    hal::advanceUs(4999);
+    TEST_ASSERT_EQUAL(0, s.run(micros()));
+    hal::advanceUs(1);
+    TEST_ASSERT_EQUAL(1, s.run(micros()));
+    TEST_ASSERT_FALSE(s.isActive(id));
+    hal::advanceUs(100000);
+    TEST_ASSERT_EQUAL(0, s.run(micros()));
+    TEST_ASSERT_EQUAL_STRING("a", order.c_str());
+
+    // El lugar se reutiliza
+    TEST_ASSERT_EQUAL(id, s.after("otra", 0, 1, &mark, (void *)&a));
+}
+
+void test_overrun_skips_missed_periods()
+{
+    Scheduler s;
+    static uint32_t workUs = 25000;
+    Scheduler::TaskId id = s.every("lenta", 10000, 1, &busy, &workUs);
+
+    // Termina en 25 ms: pierde los vencimientos de 10 y 20 ms, sin ráfaga
+    TEST_ASSERT_EQUAL(1, s.run(micros()));
+    TEST_ASSERT_EQUAL(0, s.run(micros()));
+    TEST_ASSERT_EQUAL(5000, s.untilNextUs(micros()));
+    hal::advanceUs(5000);
+    TEST_ASSERT_EQUAL(1, s.run(micros()));
+
+    const Scheduler::TaskStats &st = s.getTaskStats(id);
+    TEST_ASSERT_EQUAL(2, st.runs);
+    TEST_ASSERT_EQUAL(1, st.overruns);
+    TEST_ASSERT_EQUAL(2, st.skipped);
+    TEST_ASSERT_EQUAL(25000, st.runMaxUs);
+
+    // Mantiene la fase: el siguiente a los 40 ms
+    TEST_ASSERT_EQUAL(10000, s.untilNextUs(micros()));
+}
+
+void test_cancel_and_set_period_from_callback()
+{
+    order.clear();
+    Scheduler s;
+    current = &s;
+    static const char a = 'a', b = 'b';
+    s.every("cancela", 10000, 5, &cancelOther, (void *)&a);
+    other = s.every("victima", 10000, 1, &mark, (void *)&b);
+    TEST_ASSERT_EQUAL(2, s.run(micros()));
+    TEST_ASSERT_EQUAL_STRING("a", order.c_str());
+    TEST_ASSERT_FALSE(s.isActive(other));
+
+    order.clear();
+    Scheduler t;
+    current = &t;
+    Scheduler::TaskId self = t.every("propia", 10000, 1, &mark, (void *)&b);
+    other = self;
+    t.every("frena", 10000, 5, &slowDown, (void *)&a);
+    t.run(micros());
+    TEST_ASSERT_EQUAL(20000, t.getPeriod(self));
+    hal::advanceUs(10000);
+    t.run(micros()); // "propia" ya tomó el período nuevo
+    hal::advanceUs(10000);
+    t.run(micros());
+    TEST_ASSERT_EQUAL_STRING("abaab", order.c_str());
+    current = nullptr;
+}
+
+void test_deadlines_beyond_one_wheel_turn()
+{
+    order.clear();
+    Scheduler s;
+    static const char a = 'a', b = 'b';
+    s.every("lenta", 200000, 1, &mark, (void *)&a);
+    Scheduler::TaskId fast = s.every("rapida", 1000, 1, &mark, (void *)&b);
+
+    int slow = 0;
+    for (int ms = 0; ms <= 1000; ms++)
+    {
+        order.clear();
+        s.run(micros());
+        if (order.find('a') != std::string::npos)
+            slow++;
+        hal::advanceUs(1000);
+    }
+    TEST_ASSERT_EQUAL(6, slow); // 0, 200, ..., 1000 ms
+    TEST_ASSERT_EQUAL(1001, s.getTaskStats(fast).runs);
+
+    // Un salto de varias vueltas: una sola ejecución y los períodos perdidos contados
+    s.cancel(fast);
+    hal::advanceUs(650000);
+    order.clear();
+    TEST_ASSERT_EQUAL(1, s.run(micros()));
+    TEST_ASSERT_EQUAL(2, s.getTaskStats(0).skipped); // 1200 y 1400 ms
+    TEST_ASSERT_EQUAL(149000, s.untilNextUs(micros()));
+}
+
+void test_micros_wrap()
+{
+    order.clear();
+    Scheduler s;
+    static const char a = 'a';
+    const uint32_t base = 0xFFFFF000u;
+    Scheduler::TaskId id = s.every("vuelta", 10000, 1, &mark, (void *)&a);
+    TEST_ASSERT_EQUAL(1, s.run(base));
+    TEST_ASSERT_EQUAL(0, s.run(base + 9999u)); // Ya desbordó a 32 bits
+    TEST_ASSERT_EQUAL(1, s.run(base + 10000u));
+    TEST_ASSERT_EQUAL(10000, s.untilNextUs(base + 10000u));
+    TEST_ASSERT_EQUAL(2, s.getTaskStats(id).runs);
+    TEST_ASSERT_EQUAL(0, s.getTaskStats(id).overruns);
+}
+
+void test_idle_waits_until_next_deadline()
+{
+    Scheduler s;
+    static const char a = 'a';
+    s.every("periodica", 50000, 1, &mark, (void *)&a);
+    s.run(micros());
+
+    uint64_t t0 = micros();
+    s.idle(micros());
+    TEST_ASSERT_EQUAL(50000, (uint32_t)(micros() - t0));
+    TEST_ASSERT_EQUAL(1, s.getStats().sleeps);
+    TEST_ASSERT_EQUAL(50000, (uint32_t)s.getStats().idleUs);
+    TEST_ASSERT_EQUAL(0, s.untilNextUs(micros()));
+
+    // Con algo vencido o a menos de MIN_IDLE_US no espera
+    s.idle(micros());
+    s.run(micros());
+    hal::advanceUs(49500);
+    t0 = micros();
+    s.idle(micros());
+    TEST_ASSERT_EQUAL(0, (uint32_t)(micros() - t0));
+    TEST_ASSERT_EQUAL(1, s.getStats().sleeps);
+
+    // Sin tareas, la espera tiene tope
+    Scheduler empty;
+    TEST_ASSERT_EQUAL(Scheduler::MAX_IDLE_US, empty.untilNextUs(micros()));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_priority_then_deadline_order);
+    RUN_TEST(test_one_shot_runs_once);
+    RUN_TEST(test_overrun_skips_missed_periods);
+    RUN_TEST(test_cancel_and_set_period_from_callback);
+    RUN_TEST(test_deadlines_beyond_one_wheel_turn);
+    RUN_TEST(test_micros_wrap);
+    RUN_TEST(test_idle_waits_until_next_deadline);
+    return UNITY_END();
+}
@@ -0,0 +1,278 @@
+/**
+ * @file test_main.cpp
+ * @brief Sensores completos sobre el ADC simulado: pH, TDS, nivel y SensorHub
+ *
+ * Las señales llevan el zumbido de red que ve el ESP32 real para comprobar que
+ * las lecturas sincronizadas (bloqueantes o por hub) lo cancelan.
+ *
+ *   pio test -e native -f native/test_sensors
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <EEPROM.h>
+#include "pin_config.h"
+#include "SensorHub.h"
+#include "PHSensor.h"
+#include "TDSSensor.h"
+#include "LevelSensor.h"
+
+static constexpr float PI_F = 3.14159265f;
+static constexpr float DIVIDER_K = 1.5f; // Divisor 5 V -> 3.3 V del módulo de pH
+
+// Nivel DC más zumbido de red de amplitud `hum` cuentas
+static hal::AnalogSource withHum(float dc, float hum)
+{
+    return [dc, hum](uint64_t us)
+    {
+        float t = us * 1e-6f;
+        return uint16_t(lroundf(dc + hum * sinf(2.0f * PI_F * SENSOR_MAINS_HZ * t)));
+    };
+}
+
+// Cuentas ADC que produce un módulo de pH a `moduleVolts` tras el divisor
+static float phCounts(float moduleVolts)
+{
+    return moduleVolts / DIVIDER_K * 4095.0f / 3.3f;
+}
+
+void setUp()
+{
+    hal::reset();
+    EEPROM.begin(512);
+    delay(1); // millis() = 0 es el "sin update previo" de PHSensor
+}
+
+void tearDown() {}
+
+void test_ph_two_point_calibration_persists()
+{
+    PHSensor ph(PH_PIN, 0);
+    ph.setDividerK(DIVIDER_K);
+    ph.begin();
+
+    hal::setAnalog(PH_PIN, lroundf(phCounts(2.50f)));
+    ph.calibratePoint(7.0f);
+    hal::setAnalog(PH_PIN, lroundf(phCounts(2.50f + 3 * 0.17f)));
+    ph.calibratePoint(4.0f);
+    TEST_ASSERT_TRUE(ph.isCalibrationValid());
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, 0.17f, ph.getCalibration().v_per_ph_25);
+
+    ph.saveCalibration();
+    TEST_ASSERT_EQUAL_UINT32(1, hal::eepromCommits());
+
+    PHSensor reloaded(PH_PIN, 0);
+    reloaded.begin();
+    TEST_ASSERT_TRUE(reloaded.isCalibrationValid());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, ph.getCalibration().v_at_ph7, reloaded.getCalibration().v_at_ph7);
+}
+
+void test_ph_blocking_read_rejects_mains_hum()
+{
+    PHSensor ph(PH_PIN, 0);
+    ph.setDividerK(DIVIDER_K);
+    ph.begin();
+
+    // pH 6.0 con la calibración por defecto (V@7 = 2.50 V, 0.18 V/pH)
+    hal::setAnalogSource(PH_PIN, withHum(phCounts(2.50f + 0.18f), 40.0f));
+    for (int i = 0; i < 60; i++)
+    {
+        ph.update();
+        delay(1000);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 6.0f, ph.getFilteredPH());
+    TEST_ASSERT_TRUE(ph.isSettled());
+}
+
+// pH con la calibración por defecto (V@7 = 2.50 V, 0.18 V/pH) como función del tiempo
+static hal::AnalogSource phProfile(float (*phAt)(float seconds))
+{
+    return [phAt](uint64_t us)
+    {
+        float volts = 2.50f + (7.0f - phAt(us * 1e-6f)) * 0.18f;
+        return uint16_t(lroundf(phCounts(volts)));
+    };
+}
+
+// Updates de 1 s hasta `untilMs`
+static void runUntil(PHSensor &ph, unsigned long untilMs)
+{
+    while (millis() < untilMs)
+    {
+        delay(1000);
+        ph.update();
+    }
+}
+
+// Segundos de update (1 por segundo) hasta que isSettled() toma el valor pedido; -1 si no llega
+static int secondsUntilSettled(PHSensor &ph, bool settled, int limit)
+{
+    for (int s = 1; s <= limit; s++)
+    {
+        delay(1000);
+        ph.update();
+        if (ph.isSettled() == settled)
+            return s;
+    }
+    return -1;
+}
+
+void test_ph_rate_and_settling_on_ramp()
+{
+    // Estable en 7, rampa de -0.01 pH/s (dosificación de pH-) durante 300 s y estable en 4
+    hal::setAnalogSource(PH_PIN, phProfile([](float t) {
+        return t < 120.0f ? 7.0f : t < 420.0f ? 7.0f - 0.01f * (t - 120.0f) : 4.0f;
+    }));
+    PHSensor ph(PH_PIN, 0);
+    ph.setDividerK(DIVIDER_K);
+    ph.begin();
+
+    int settle = secondsUntilSettled(ph, true, 60);
+    TEST_ASSERT_TRUE(settle > 0 && settle <= 30);
+    runUntil(ph, 119000UL);
+    TEST_ASSERT_TRUE(ph.isSettled());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, ph.getPHRate());
+
+    // La rampa se detecta en pocos segundos y la pendiente converge a -0.01 pH/s
+    runUntil(ph, 120000UL);
+    int unsettle = secondsUntilSettled(ph, false, 30);
+    TEST_ASSERT_TRUE(unsettle > 0 && unsettle <= 5);
+    runUntil(ph, 400000UL);
+    TEST_ASSERT_FALSE(ph.isSettled());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -0.01f, ph.getPHRate());
+    TEST_ASSERT_FLOAT_WITHIN(0.03f, 4.2f, ph.getFilteredPH()); // Sin retraso de fase en la rampa
+
+    // Al terminar la rampa vuelve a estable en el nuevo valor
+    runUntil(ph, 421000UL);
+    int resettle = secondsUntilSettled(ph, true, 120);
+    TEST_ASSERT_TRUE(resettle > 0 && resettle <= 30);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 4.0f, ph.getFilteredPH());
+    TEST_ASSERT_TRUE(fabsf(ph.getPHRate()) < PhKalman::SETTLED_RATE);
+}
+
+void test_ph_step_unsettles_then_settles()
+{
+    // Escalón de 7 a 6 a los 150 s (p. ej. una dosis que se mezcla de golpe)
+    hal::setAnalogSource(PH_PIN, phProfile([](float t) { return t < 150.0f ? 7.0f : 6.0f; }));
+    PHSensor ph(PH_PIN, 0);
+    ph.setDividerK(DIVIDER_K);
+    ph.begin();
+    runUntil(ph, 148000UL);
+    TEST_ASSERT_TRUE(ph.isSettled());
+
+    runUntil(ph, 150000UL);
+    int unsettle = secondsUntilSettled(ph, false, 10);
+    TEST_ASSERT_TRUE(unsettle > 0 && unsettle <= 2);
+    TEST_ASSERT_TRUE(ph.getPHRate() < -PhKalman::SETTLED_RATE); // La pendiente sigue al escalón
+
+    int resettle = secondsUntilSettled(ph, true, 300);
+    TEST_ASSERT_TRUE(resettle > 0 && resettle <= 60);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 6.0f, ph.getFilteredPH());
+}
+
+void test_ph_hub_tracks_same_value()
+{
+    SensorHub hub(PH_PIN, TDS_PIN, LDR_PIN);
+    PHSensor ph(PH_PIN, 0);
+    ph.setDividerK(DIVIDER_K);
+    ph.begin();
+
+    hal::setAnalogSource(PH_PIN, withHum(phCounts(2.50f - 0.18f), 40.0f));
+    TEST_ASSERT_TRUE(hub.begin(100, SENSOR_MAINS_HZ));
+    TEST_ASSERT_EQUAL(SensorHub::MODE_TIMER, hub.getMode()); // Sin DMA en el host
+    ph.attachHub(&hub);
+
+    for (int i = 0; i < 60; i++)
+    {
+        delay(1000); // El timer del hub muestrea durante la espera
+        ph.update();
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 8.0f, ph.getFilteredPH());
+    TEST_ASSERT_GREATER_THAN(100 * 60, hub.getFrameCount());
+    hub.end();
+    TEST_ASSERT_EQUAL(0, hal::activeTimers());
+}
+
+void test_tds_hub_matches_gravity_formula()
+{
+    const uint16_t adc = 1200;
+    hal::setAnalog(TDS_PIN, adc);
+
+    TDSSensor direct(TDS_PIN);
+    direct.begin();
+    direct.update();
+    TEST_ASSERT_TRUE(direct.isConnected());
+
+    float v = adc * 3.3f / 4096.0f;
+    float expected = (133.42f * v * v * v - 255.86f * v * v + 857.39f * v) * 0.5f;
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, expected, direct.getTDSValue());
+
+    SensorHub hub(PH_PIN, TDS_PIN, LDR_PIN);
+    TEST_ASSERT_TRUE(hub.begin(100, SENSOR_MAINS_HZ));
+    TDSSensor viaHub(TDS_PIN);
+    viaHub.begin();
+    viaHub.attachHub(&hub);
+    delay(1000);
+    viaHub.update();
+    TEST_ASSERT_FLOAT_WITHIN(expected * 0.01f, expected, viaHub.getTDSValue());
+    hub.end();
+}
+
+void test_tds_hub_keeps_sub_count_resolution()
+{
+    // Mitad de los frames en 1200 y mitad en 1201: la media es 1200.5, que
+    // redondeada a cuentas enteras perdería ~0.15 ppm
+    hal::setAnalogSource(TDS_PIN, [](uint64_t us) { return uint16_t((us / 10000) % 2 ? 1201 : 1200); });
+    SensorHub hub(PH_PIN, TDS_PIN, LDR_PIN);
+    TEST_ASSERT_TRUE(hub.begin(100, SENSOR_MAINS_HZ));
+    TDSSensor tds(TDS_PIN);
+    tds.begin();
+    tds.attachHub(&hub);
+    for (int i = 0; i < 5; i++)
+    {
+        delay(1000);
+        tds.update();
+    }
+    hub.end();
+
+    auto tdsAt = [](float counts) {
+        float v = counts * 3.3f / 4096.0f;
+        return (133.42f * v * v * v - 255.86f * v * v + 857.39f * v) * 0.5f;
+    };
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, tdsAt(1200.5f), tds.getTDSValue());
+}
+
+void test_tds_disconnected_reads_zero()
+{
+    hal::setAnalog(TDS_PIN, 0);
+    TDSSensor tds(TDS_PIN);
+    tds.begin();
+    tds.update();
+    TEST_ASSERT_FALSE(tds.isConnected());
+    TEST_ASSERT_FLOAT_WITHIN(0.0f, 0.0f, tds.getTDSValue());
+}
+
+void test_level_sensor_logic()
+{
+    LevelSensor level(LVL_PH_MINUS, false); // LOW = nivel OK
+    level.begin();
+    hal::setDigital(LVL_PH_MINUS, LOW);
+    TEST_ASSERT_TRUE(level.isLevelOK());
+    hal::setDigital(LVL_PH_MINUS, HIGH);
+    TEST_ASSERT_FALSE(level.isLevelOK());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ph_two_point_calibration_persists);
+    RUN_TEST(test_ph_blocking_read_rejects_mains_hum);
+    RUN_TEST(test_ph_rate_and_settling_on_ramp);
+    RUN_TEST(test_ph_step_unsettles_then_settles);
+    RUN_TEST(test_ph_hub_tracks_same_value);
+    RUN_TEST(test_tds_hub_matches_gravity_formula);
+    RUN_TEST(test_tds_hub_keeps_sub_count_resolution);
+    RUN_TEST(test_tds_disconnected_reads_zero);
+    RUN_TEST(test_level_sensor_logic);
+    return UNITY_END();
+}
@@ -0,0 +1,166 @@
+/**
+ * @file test_main.cpp
+ * @brief Comandos por Serial de extremo a extremo (entrada inyectada, salida capturada)
+ *
+ *   pio test -e native -f native/test_serial_commands
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <EEPROM.h>
+#include "pin_config.h"
+#include "PHSensor.h"
+#include "TDSSensor.h"
+#include "PumpController.h"
+#include "SerialCommands.h"
+
+struct Rig
+{
+    PHSensor ph{PH_PIN, 0};
+    TDSSensor tds{TDS_PIN};
+    PumpController pump{RELAY_CIRC, RELAY_PH_MINUS, RELAY_PH_PLUS};
+    SerialCommands commands;
+
+    Rig()
+    {
+        ph.begin();
+        tds.begin();
+        pump.begin();
+        commands.begin(&ph, &pump, &tds);
+        hal::clearSerialOutput();
+    }
+
+    void send(const char *line)
+    {
+        hal::serialInput(line);
+        hal::serialInput("\n");
+        commands.processCommands();
+    }
+};
+
+void setUp()
+{
+    hal::reset();
+    EEPROM.begin(512);
+    hal::setAnalog(PH_PIN, 2000);
+    hal::setAnalog(TDS_PIN, 1200);
+}
+
+void tearDown() {}
+
+void test_commands_are_case_insensitive()
+{
+    Rig rig;
+    rig.send("  pplus,on ");
+    TEST_ASSERT_TRUE(rig.pump.isPumpPlusActive());
+    rig.send("PPLUS,OFF");
+    TEST_ASSERT_FALSE(rig.pump.isPumpPlusActive());
+}
+
+void test_phcal_validates_buffer()
+{
+    Rig rig;
+    rig.send("PHCAL,5");
+    TEST_ASSERT_TRUE(hal::serialContains("Solo pH 4, 7 o 10"));
+    TEST_ASSERT_FALSE(rig.ph.isCalibrationValid());
+
+    rig.send("PHCAL,7");
+    TEST_ASSERT_TRUE(rig.ph.isCalibrationValid());
+    rig.send("PHSAVE");
+    TEST_ASSERT_EQUAL_UINT32(1, hal::eepromCommits());
+}
+
+void test_sett_range_check()
+{
+    Rig rig;
+    rig.send("SETT,23.5");
+    TEST_ASSERT_TRUE(hal::serialContains("23.50"));
+    hal::clearSerialOutput();
+    rig.send("SETT,95");
+    TEST_ASSERT_TRUE(hal::serialContains("fuera de rango"));
+}
+
+void test_emergency_and_resume()
+{
+    Rig rig;
+    rig.send("EMERGENCY");
+    TEST_ASSERT_TRUE(rig.pump.isEmergencyMode());
+    rig.send("RESUME");
+    TEST_ASSERT_FALSE(rig.pump.isEmergencyMode());
+}
+
+static int restartsScheduled = 0;
+static void scheduleRestart() { restartsScheduled++; }
+
+void test_reset_schedules_restart_without_blocking()
+{
+    Rig rig;
+    restartsScheduled = 0;
+    rig.commands.begin(&rig.ph, &rig.pump, &rig.tds, nullptr, &scheduleRestart);
+    unsigned long before = millis();
+    rig.send("RESET");
+    TEST_ASSERT_EQUAL(1, restartsScheduled);
+    TEST_ASSERT_FALSE(hal::restartRequested()); // Lo hace quien lo programó
+    TEST_ASSERT_EQUAL_UINT32(0, millis() - before);
+
+    // Sin callback reinicia en el acto, tampoco espera
+    Rig plain;
+    plain.send("RESET");
+    TEST_ASSERT_TRUE(hal::restartRequested());
+    TEST_ASSERT_EQUAL_UINT32(0, millis() - before);
+}
+
+void test_noise_report_lists_sensors()
+{
+    Rig rig;
+    rig.ph.update();
+    rig.tds.update();
+    rig.send("NOISE");
+    TEST_ASSERT_TRUE(hal::serialContains("pH"));
+    TEST_ASSERT_TRUE(hal::serialContains("TDS"));
+}
+
+void test_partial_line_does_not_block()
+{
+    Rig rig;
+    unsigned long before = millis();
+    hal::serialInput("PPLUS,");
+    rig.commands.processCommands();
+    TEST_ASSERT_EQUAL_UINT32(0, millis() - before);
+    TEST_ASSERT_FALSE(rig.pump.isPumpPlusActive());
+
+    // El resto llega en otro loop()
+    hal::serialInput("ON\n");
+    rig.commands.processCommands();
+    TEST_ASSERT_TRUE(rig.pump.isPumpPlusActive());
+}
+
+void test_bad_arguments_print_usage()
+{
+    Rig rig;
+    rig.send("PPLUS,MAYBE");
+    TEST_ASSERT_TRUE(hal::serialContains("Uso: PPLUS,ON | PPLUS,OFF"));
+    TEST_ASSERT_FALSE(rig.pump.isPumpPlusActive());
+    hal::clearSerialOutput();
+    rig.send("SETT,abc");
+    TEST_ASSERT_TRUE(hal::serialContains("Uso: SETT,25.5"));
+    hal::clearSerialOutput();
+    rig.send("FOO");
+    TEST_ASSERT_TRUE(hal::serialContains("no reconocido"));
+    TEST_ASSERT_EQUAL(1, rig.commands.getStats().unknown);
+    TEST_ASSERT_EQUAL(2, rig.commands.getStats().badArgs);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_commands_are_case_insensitive);
+    RUN_TEST(test_phcal_validates_buffer);
+    RUN_TEST(test_sett_range_check);
+    RUN_TEST(test_emergency_and_resume);
+    RUN_TEST(test_reset_schedules_restart_without_blocking);
+    RUN_TEST(test_noise_report_lists_sensors);
+    RUN_TEST(test_partial_line_does_not_block);
+    RUN_TEST(test_bad_arguments_print_usage);
+    return UNITY_END();
+}
@@ -0,0 +1,213 @@
+/**
+ * @file test_main.cpp
+ * @brief Modo STREAM: tramas COBS con CRC, texto intercalado, UART lleno y comando STREAM
+ *
+ *   pio test -e native -f native/test_serial_stream
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <vector>
+#include "SerialStream.h"
+#include "SerialCommands.h"
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+static StreamFrame::Record sample(uint32_t i)
+{
+    StreamFrame::Record r;
+    r.seq = i;
+    r.timeUs = 1000000UL + i * 5000UL;
+    r.rawPh = uint16_t(2000 + i);
+    r.rawTds = 0; // Ceros en medio del registro: COBS los quita
+    r.rawLdr = 4095;
+    r.ph = 6.25f + i * 0.001f;
+    r.tds = 812.5f;
+    r.ldr = 0;
+    r.levels = StreamFrame::LEVEL_PH_PLUS_OK;
+    r.relays = StreamFrame::PUMP_CIRCULATION_ON | StreamFrame::EMERGENCY_STOP;
+    r.loopMaxUs = 0;
+    r.controlLateUs = 0xFFFFFFFFu;
+    return r;
+}
+
+// Tramos entre 0x00 de la salida del Serial, como los corta el decodificador
+static std::vector<std::string> chunks(const std::string &out)
+{
+    std::vector<std::string> result;
+    std::string chunk;
+    for (char c : out)
+    {
+        if (c)
+            chunk += c;
+        else if (!chunk.empty())
+        {
+            result.push_back(chunk);
+            chunk.clear();
+        }
+    }
+    return result;
+}
+
+void test_frame_round_trip()
+{
+    StreamFrame::Record in = sample(7);
+    uint8_t frame[StreamFrame::MAX_FRAME];
+    size_t len = StreamFrame::encode(in, frame, sizeof(frame));
+    TEST_ASSERT_TRUE(len > 2 && len <= StreamFrame::MAX_FRAME);
+    TEST_ASSERT_EQUAL(0, frame[0]);
+    TEST_ASSERT_EQUAL(0, frame[len - 1]);
+    for (size_t i = 1; i < len - 1; i++)
+        TEST_ASSERT_NOT_EQUAL(0, frame[i]);
+
+    StreamFrame::Record out;
+    TEST_ASSERT_TRUE(StreamFrame::decode(frame + 1, len - 2, out));
+    TEST_ASSERT_EQUAL(in.seq, out.seq);
+    TEST_ASSERT_EQUAL(in.timeUs, out.timeUs);
+    TEST_ASSERT_EQUAL(in.rawPh, out.rawPh);
+    TEST_ASSERT_EQUAL(in.rawTds, out.rawTds);
+    TEST_ASSERT_EQUAL(in.rawLdr, out.rawLdr);
+    TEST_ASSERT_EQUAL(0, memcmp(&in.ph, &out.ph, sizeof(float)));
+    TEST_ASSERT_EQUAL(0, memcmp(&in.tds, &out.tds, sizeof(float)));
+    TEST_ASSERT_EQUAL(in.levels, out.levels);
+    TEST_ASSERT_EQUAL(in.relays, out.relays);
+    TEST_ASSERT_EQUAL(in.controlLateUs, out.controlLateUs);
+
+    // Sin lugar para la trama completa: no escribe nada
+    TEST_ASSERT_EQUAL(0, StreamFrame::encode(in, frame, len - 1));
+}
+
+void test_corrupt_frames_are_rejected()
+{
+    uint8_t frame[StreamFrame::MAX_FRAME];
+    size_t len = StreamFrame::encode(sample(1), frame, sizeof(frame));
+    StreamFrame::Record out;
+
+    // Cualquier bit cambiado (que no sea 0x00, que cortaría la trama) lo detecta COBS o el CRC
+    for (size_t i = 1; i < len - 1; i++)
+    {
+        for (uint8_t b = 0; b < 8; b++)
+        {
+            uint8_t copy[StreamFrame::MAX_FRAME];
+            memcpy(copy, frame, len);
+            copy[i] ^= uint8_t(1 << b);
+            if (copy[i] == 0)
+                continue;
+            TEST_ASSERT_FALSE(StreamFrame::decode(copy + 1, len - 2, out));
+        }
+    }
+    // Truncada o con bytes de más
+    TEST_ASSERT_FALSE(StreamFrame::decode(frame + 1, len - 3, out));
+    TEST_ASSERT_FALSE(StreamFrame::decode((const uint8_t *)"PH: 6.50", 8, out));
+}
+
+void test_cobs_edge_cases()
+{
+    // Largos alrededor de los bloques de 254 bytes, con y sin ceros
+    for (size_t len : {0u, 1u, 253u, 254u, 255u, 508u, 600u})
+    {
+        for (int pattern = 0; pattern < 3; pattern++)
+        {
+            std::vector<uint8_t> in(len);
+            for (size_t i = 0; i < len; i++)
+                in[i] = pattern == 0 ? 0 : pattern == 1 ? uint8_t(1 + i % 255) : uint8_t(i % 7 ? i : 0);
+            std::vector<uint8_t> enc(len + len / 254 + 1);
+            size_t n = StreamFrame::cobsEncode(in.data(), len, enc.data(), enc.size());
+            TEST_ASSERT_TRUE(n > 0);
+            for (size_t i = 0; i < n; i++)
+                TEST_ASSERT_NOT_EQUAL(0, enc[i]);
+            std::vector<uint8_t> dec(len + 1);
+            TEST_ASSERT_EQUAL(len, StreamFrame::cobsDecode(enc.data(), n, dec.data(), dec.size()));
+            TEST_ASSERT_EQUAL(0, len ? memcmp(in.data(), dec.data(), len) : 0);
+        }
+    }
+}
+
+void test_frames_survive_text_and_full_uart()
+{
+    SerialStream stream;
+    stream.start(200);
+    TEST_ASSERT_EQUAL(200, stream.getRate());
+    TEST_ASSERT_EQUAL(5000, stream.getPeriodUs());
+
+    // 1 s a 200 Hz; en medio, texto del log
+    for (int i = 0; i < 200; i++)
+    {
+        StreamFrame::Record r = sample(0);
+        TEST_ASSERT_TRUE(stream.send(r));
+        if (i == 100)
+            Serial.println("PumpController: Circulación ON");
+        hal::advanceUs(stream.getPeriodUs());
+    }
+
+    int frames = 0, text = 0;
+    uint32_t expected = 0;
+    for (const std::string &chunk : chunks(hal::serialOutput()))
+    {
+        StreamFrame::Record r;
+        if (StreamFrame::decode((const uint8_t *)chunk.data(), chunk.size(), r))
+        {
+            TEST_ASSERT_EQUAL(expected++, r.seq);
+            frames++;
+        }
+        else
+            text++;
+    }
+    TEST_ASSERT_EQUAL(200, frames);
+    TEST_ASSERT_EQUAL(1, text);
+
+    // UART lleno: se omite sin esperar y el seq salta
+    hal::setSerialTxRoom(10);
+    StreamFrame::Record r = sample(0);
+    TEST_ASSERT_FALSE(stream.send(r));
+    TEST_ASSERT_EQUAL(1, stream.getStats().skipped);
+    TEST_ASSERT_EQUAL(200, stream.getStats().frames);
+    hal::setSerialTxRoom(-1);
+    TEST_ASSERT_TRUE(stream.send(r));
+    TEST_ASSERT_EQUAL(201, r.seq);
+}
+
+void test_stream_command()
+{
+    SerialStream stream;
+    SerialCommands commands;
+    commands.begin(nullptr, nullptr, nullptr);
+
+    hal::serialInput("STREAM,ON,200\n");
+    commands.processCommands();
+    TEST_ASSERT_TRUE(hal::serialContains("Error: Stream binario no disponible"));
+    TEST_ASSERT_FALSE(stream.isActive());
+
+    commands.attachStream(&stream);
+    hal::serialInput("stream,on,5000\nSTREAM,ON,abc\n");
+    commands.processCommands();
+    TEST_ASSERT_TRUE(hal::serialContains("Frecuencia fuera de rango (1 a 500 Hz)"));
+    TEST_ASSERT_TRUE(hal::serialContains("Uso: STREAM,ON,200 | STREAM,OFF"));
+    TEST_ASSERT_FALSE(stream.isActive());
+
+    hal::serialInput("STREAM,ON\n");
+    commands.processCommands();
+    TEST_ASSERT_TRUE(stream.isActive());
+    TEST_ASSERT_EQUAL(SerialStream::DEFAULT_HZ, stream.getRate());
+    hal::serialInput("STREAM,ON,250\n");
+    commands.processCommands();
+    TEST_ASSERT_EQUAL(250, stream.getRate());
+    TEST_ASSERT_TRUE(hal::serialContains("Stream binario: 250 Hz"));
+
+    hal::serialInput("STREAM,OFF\n");
+    commands.processCommands();
+    TEST_ASSERT_FALSE(stream.isActive());
+    TEST_ASSERT_TRUE(hal::serialContains("Stream binario detenido: 0 tramas"));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_round_trip);
+    RUN_TEST(test_corrupt_frames_are_rejected);
+    RUN_TEST(test_cobs_edge_cases);
+    RUN_TEST(test_frames_survive_text_and_full_uart);
+    RUN_TEST(test_stream_command);
+    return UNITY_END();
+}
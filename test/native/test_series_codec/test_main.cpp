@@ -0,0 +1,140 @@
+/**
+ * @file test_main.cpp
+ * @brief SeriesCodec: ida y vuelta sin pérdida, tamaño, versión 1 y base64
+ *
+ *   pio test -e native -f native/test_series_codec
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <limits.h>
+#include "SeriesCodec.h"
+
+static bool sameBits(float a, float b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+void test_round_trip_is_lossless()
+{
+    // Intervalos irregulares, huecos largos, retrocesos, NaN y extremos
+    const uint64_t times[] = {1792231200000ULL, 1792231210003ULL, 1792231220001ULL, 1792231221000ULL,
+                              1792231300000ULL, 1792234000000ULL, 1792230000000ULL, 0ULL,
+                              0xFFFFFFFFFFFFFFFFULL, 5ULL};
+    const uint32_t seqs[] = {7, 27, 47, 48, 1000, 999, 0xFFFFFFFFu, 0, 1, 5};
+    const uint8_t n = sizeof(times) / sizeof(times[0]);
+    SeriesCodec::Sample in[n];
+    for (uint8_t i = 0; i < n; i++)
+    {
+        in[i].time = times[i];
+        in[i].seq = seqs[i];
+        in[i].ph = 6.0f + i * 0.37f;
+        in[i].tds = 800.0f - i * 13.1f;
+        in[i].ldr = int32_t(i * 977) - 3000;
+    }
+    in[3].ph = NAN;
+    in[4].tds = -0.0f;
+    in[5].ph = 1e30f;
+    in[6].ldr = INT32_MIN;
+    in[7].ldr = INT32_MAX;
+
+    uint8_t bin[SeriesCodec::maxBytes(n)];
+    size_t len = SeriesCodec::encode(in, n, 0xB0070042u, bin, sizeof(bin));
+    TEST_ASSERT_TRUE(len > 0);
+
+    SeriesCodec::Sample out[n];
+    uint32_t boot = 0;
+    TEST_ASSERT_EQUAL(n, SeriesCodec::decode(bin, len, out, n, &boot));
+    TEST_ASSERT_EQUAL_UINT32(0xB0070042u, boot);
+    for (uint8_t i = 0; i < n; i++)
+    {
+        TEST_ASSERT_TRUE(in[i].time == out[i].time);
+        TEST_ASSERT_EQUAL_UINT32(in[i].seq, out[i].seq);
+        TEST_ASSERT_TRUE(sameBits(in[i].ph, out[i].ph));
+        TEST_ASSERT_TRUE(sameBits(in[i].tds, out[i].tds));
+        TEST_ASSERT_EQUAL_INT32(in[i].ldr, out[i].ldr);
+    }
+}
+
+void test_steady_series_is_small()
+{
+    // 30 muestras cada 10 s (cada 20 sellos) con valores fijos: 1 bit por
+    // tiempo, por seq y por float
+    SeriesCodec::Sample in[30];
+    for (uint8_t i = 0; i < 30; i++)
+        in[i] = {1792231200000ULL + i * 10000u, 100u + i * 20u, 6.12f, 803.0f, 1021};
+    uint8_t bin[SeriesCodec::maxBytes(30)];
+    size_t len = SeriesCodec::encode(in, 30, 1, bin, sizeof(bin));
+
+    // 48 cabecera + (64 + 68 + 28) tiempos + (32 + 9 + 28) seq + 2 × (32 + 29) floats + (16 + 29 × 8) LDR
+    TEST_ASSERT_EQUAL((48 + 160 + 69 + 2 * 61 + 248 + 7) / 8, len);
+}
+
+void test_truncated_or_foreign_blocks_fail()
+{
+    SeriesCodec::Sample in[8];
+    for (uint8_t i = 0; i < 8; i++)
+        in[i] = {1000000u + i * 10000u, i, 6.0f + i * 0.01f, 800.0f + i, 1000 + i * 3};
+    uint8_t bin[SeriesCodec::maxBytes(8)];
+    size_t len = SeriesCodec::encode(in, 8, 3, bin, sizeof(bin));
+
+    SeriesCodec::Sample out[8];
+    TEST_ASSERT_EQUAL(0, SeriesCodec::decode(bin, len - 1, out, 8)); // Cortado
+    TEST_ASSERT_EQUAL(0, SeriesCodec::decode(bin, len, out, 7));     // No cabe
+    bin[0] = SeriesCodec::VERSION + 1;
+    TEST_ASSERT_EQUAL(0, SeriesCodec::decode(bin, len, out, 8)); // Otra versión
+
+    // Buffer de salida chico: no escribe un bloque a medias
+    uint8_t small[10];
+    TEST_ASSERT_EQUAL(0, SeriesCodec::encode(in, 8, 3, small, sizeof(small)));
+}
+
+void test_reads_version_1_blocks()
+{
+    // Bloque del firmware anterior (segundos, sin boot_id ni seq)
+    uint8_t bin[64];
+    size_t len = SeriesCodec::base64Decode("AQNq00cgpJAw9cK2w///tl63pREjAAOAPAP9B4GFAA==", bin, sizeof(bin));
+    SeriesCodec::Sample out[3];
+    uint32_t boot = 99;
+    TEST_ASSERT_EQUAL(3, SeriesCodec::decode(bin, len, out, 3, &boot));
+    TEST_ASSERT_EQUAL_UINT32(0, boot);
+    TEST_ASSERT_TRUE(out[0].time == 1792231200000ULL);
+    TEST_ASSERT_TRUE(out[2].time == 1792231220000ULL);
+    TEST_ASSERT_EQUAL_UINT32(0, out[2].seq);
+}
+
+void test_base64()
+{
+    // Vectores de RFC 4648
+    const char *plain[] = {"", "f", "fo", "foo", "foob", "fooba", "foobar"};
+    const char *coded[] = {"", "Zg==", "Zm8=", "Zm9v", "Zm9vYg==", "Zm9vYmE=", "Zm9vYmFy"};
+    for (uint8_t i = 0; i < 7; i++)
+    {
+        char text[16];
+        SeriesCodec::base64Encode(reinterpret_cast<const uint8_t *>(plain[i]), strlen(plain[i]), text,
+                                  sizeof(text));
+        TEST_ASSERT_EQUAL_STRING(coded[i], text);
+
+        uint8_t bytes[8];
+        size_t n = SeriesCodec::base64Decode(coded[i], bytes, sizeof(bytes));
+        TEST_ASSERT_EQUAL(strlen(plain[i]), n);
+        TEST_ASSERT_TRUE(memcmp(bytes, plain[i], n) == 0);
+    }
+
+    uint8_t bytes[8];
+    TEST_ASSERT_EQUAL(0, SeriesCodec::base64Decode("Zm9v!", bytes, sizeof(bytes)));
+    TEST_ASSERT_EQUAL(0, SeriesCodec::base64Decode("Zm9vYmFy", bytes, 5)); // No cabe
+    char text[4];
+    TEST_ASSERT_EQUAL(0, SeriesCodec::base64Encode(reinterpret_cast<const uint8_t *>("foo"), 3, text, 4));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_is_lossless);
+    RUN_TEST(test_steady_series_is_small);
+    RUN_TEST(test_truncated_or_foreign_blocks_fail);
+    RUN_TEST(test_reads_version_1_blocks);
+    RUN_TEST(test_base64);
+    return UNITY_END();
+}
@@ -0,0 +1,337 @@
+/**
+ * @file test_main.cpp
+ * @brief Registro circular del historial en LittleFS: cortes de red y de energía
+ *
+ * LittleFS es el de la HAL (en memoria); destruir el TelemetryLog y crear
+ * otro sobre los mismos archivos equivale a reiniciar la placa.
+ *
+ *   pio test -e native -f native/test_telemetry_log -v
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <LittleFS.h>
+#include <map>
+#include <memory>
+#include "TelemetryLog.h"
+#include "HistoryChunker.h"
+
+static constexpr unsigned long SAMPLE_MS = 10000; // FIREBASE_INTERVAL
+static constexpr uint32_t BOOT = 7;
+
+// RTDB simulado: (boot_id, seq) de la muestra -> pH
+struct FakeHistory
+{
+    std::map<uint64_t, float> ph;
+    uint32_t writes = 0;
+    uint32_t duplicates = 0;
+    bool online = true;
+
+    bool send(const TelemetryLog::Record *records, uint16_t count)
+    {
+        if (!online)
+            return false;
+        writes++;
+        for (uint16_t i = 0; i < count; i++)
+        {
+            uint64_t key = (uint64_t(records[i].bootId) << 32) | records[i].sampleSeq;
+            if (ph.count(key))
+                duplicates++;
+            ph[key] = records[i].ph;
+        }
+        return true;
+    }
+};
+
+static TelemetryLog::Config smallConfig()
+{
+    TelemetryLog::Config c;
+    c.recordsPerSegment = 10;
+    c.segments = 4;
+    c.flushRecords = 1;
+    c.replayBatch = 8;
+    return c;
+}
+
+// Reenvía todo sin esperar el intervalo; devuelve los lotes usados
+static uint32_t drain(TelemetryLog &log, FakeHistory &rtdb, unsigned long &nowMs)
+{
+    uint32_t batches = 0;
+    while (log.pending() && batches < 10000)
+    {
+        nowMs += log.getConfig().replayIntervalMs;
+        if (log.replay(nowMs, [&rtdb](const TelemetryLog::Record *r, uint16_t n) { return rtdb.send(r, n); }))
+            batches++;
+    }
+    return batches;
+}
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+void test_append_and_replay_in_order()
+{
+    TelemetryLog log(smallConfig());
+    TEST_ASSERT_TRUE(log.begin());
+    for (uint32_t i = 0; i < 25; i++)
+        log.append(i * SAMPLE_MS, BOOT, i, 6.0f + i * 0.01f, 800.0f, 1000);
+    TEST_ASSERT_EQUAL_UINT32(25, log.pending());
+
+    TelemetryLog::Record batch[8];
+    uint32_t next;
+    TEST_ASSERT_EQUAL(8, log.readBatch(batch, 8, next));
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        TEST_ASSERT_TRUE(batch[i].epochMs == i * SAMPLE_MS);
+        TEST_ASSERT_EQUAL_UINT32(BOOT, batch[i].bootId);
+        TEST_ASSERT_EQUAL_UINT32(i, batch[i].sampleSeq);
+    }
+
+    // Sin ack el lote se repite
+    TEST_ASSERT_EQUAL(8, log.readBatch(batch, 8, next));
+    TEST_ASSERT_EQUAL_UINT32(0, batch[0].seq);
+    TEST_ASSERT_TRUE(log.ack(next));
+    TEST_ASSERT_EQUAL_UINT32(17, log.pending());
+
+    FakeHistory rtdb;
+    unsigned long now = 0;
+    TEST_ASSERT_EQUAL_UINT32(3, drain(log, rtdb, now));
+    TEST_ASSERT_EQUAL(17, rtdb.ph.size());
+    TEST_ASSERT_EQUAL_UINT32(25, log.getStats().replayed);
+}
+
+void test_reboot_recovers_log_and_ack()
+{
+    TelemetryLog::Config config = smallConfig();
+    config.flushRecords = 4;
+    {
+        TelemetryLog log(config);
+        log.begin();
+        for (uint32_t i = 0; i < 23; i++)
+            log.append(i * SAMPLE_MS, BOOT, i, 6.2f, 800.0f, 1000);
+        TelemetryLog::Record batch[8];
+        uint32_t next;
+        log.readBatch(batch, 5, next);
+        log.ack(next);
+        // 20 en flash; los 3 últimos siguen en RAM y se pierden con el corte
+    }
+
+    TelemetryLog log(config);
+    log.begin();
+    TEST_ASSERT_EQUAL_UINT32(15, log.pending()); // 20 escritos - 5 confirmados
+
+    TelemetryLog::Record batch[8];
+    uint32_t next;
+    log.readBatch(batch, 1, next);
+    TEST_ASSERT_EQUAL_UINT32(5, batch[0].seq);
+
+    // La secuencia sigue donde quedó en flash
+    log.append(99 * SAMPLE_MS, BOOT, 99, 6.2f, 800.0f, 1000);
+    log.flush();
+    FakeHistory rtdb;
+    unsigned long now = 0;
+    drain(log, rtdb, now);
+    TEST_ASSERT_EQUAL(16, rtdb.ph.size());
+    TEST_ASSERT_EQUAL(1, rtdb.ph.count((uint64_t(BOOT) << 32) | 99));
+}
+
+void test_torn_tail_is_skipped()
+{
+    {
+        TelemetryLog log(smallConfig());
+        log.begin();
+        for (uint32_t i = 0; i < 15; i++)
+            log.append(i * SAMPLE_MS, BOOT, i, 6.2f, 800.0f, 1000);
+    }
+    // Corte de energía a mitad del registro 14 (segundo segmento)
+    hal::fsTruncate("/tlog/seg01.bin", 4 * sizeof(TelemetryLog::Record) + 7);
+
+    TelemetryLog log(smallConfig());
+    log.begin();
+    TEST_ASSERT_EQUAL_UINT32(1, log.getStats().corrupt);
+
+    // Lo nuevo va al segmento siguiente; nada se repite ni se desordena
+    for (uint32_t i = 100; i < 105; i++)
+        log.append(i * SAMPLE_MS, BOOT, i, 6.2f, 800.0f, 1000);
+
+    TelemetryLog::Record batch[32];
+    uint32_t next;
+    uint16_t n = log.readBatch(batch, 32, next);
+    TEST_ASSERT_EQUAL(19, n); // 14 válidos + 5 nuevos
+    for (uint16_t i = 1; i < n; i++)
+        TEST_ASSERT_TRUE(batch[i].seq > batch[i - 1].seq);
+    TEST_ASSERT_EQUAL_UINT32(20, batch[14].seq);
+    log.ack(next);
+    TEST_ASSERT_EQUAL_UINT32(0, log.pending());
+}
+
+void test_retention_drops_oldest()
+{
+    TelemetryLog log(smallConfig()); // 4 × 10 = 40 registros
+    log.begin();
+    TEST_ASSERT_EQUAL_UINT32(40, log.capacity());
+    for (uint32_t i = 0; i < 100; i++)
+        log.append(i * SAMPLE_MS, BOOT, i, 6.2f, 800.0f, 1000);
+
+    // Queda la vuelta más reciente: 3 segmentos llenos + el que se escribe
+    TEST_ASSERT_EQUAL_UINT32(40, log.pending());
+    TEST_ASSERT_EQUAL_UINT32(60, log.getStats().dropped);
+    TelemetryLog::Record batch[8];
+    uint32_t next;
+    log.readBatch(batch, 1, next);
+    TEST_ASSERT_EQUAL_UINT32(60, batch[0].seq);
+
+    // La partición nunca pasa de la retención configurada
+    size_t used = LittleFS.usedBytes();
+    TEST_ASSERT_LESS_OR_EQUAL(log.retentionBytes() + 64, used);
+}
+
+void test_multi_hour_outage_with_reboot()
+{
+    // 10 h sin red a 10 s por punto, con un corte de energía a las 4 h;
+    // configuración por defecto (retención ~22 h)
+    FakeHistory rtdb;
+    rtdb.online = false;
+    const uint32_t total = 10 * 360;
+    const uint32_t rebootAt = 4 * 360;
+    unsigned long now = 0;
+
+    std::unique_ptr<TelemetryLog> log(new TelemetryLog());
+    log->begin();
+    uint32_t lostInRam = 0;
+    for (uint32_t i = 0; i < total; i++)
+    {
+        if (i == rebootAt)
+        {
+            lostInRam = (rebootAt % log->getConfig().flushRecords);
+            log.reset(new TelemetryLog());
+            log->begin();
+        }
+        now += SAMPLE_MS;
+        log->append(now, i < rebootAt ? BOOT : BOOT + 1, i, 6.0f + (i % 100) * 0.001f, 800.0f, 1000);
+        // El reenvío no hace nada mientras el envío falla
+        log->replay(now, [&rtdb](const TelemetryLog::Record *r, uint16_t n) { return rtdb.send(r, n); });
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, rtdb.writes);
+
+    // Vuelve la red: lotes de 60 cada segundo
+    rtdb.online = true;
+    uint32_t pending = log->pending();
+    TEST_ASSERT_EQUAL_UINT32(total - lostInRam, pending);
+    uint32_t batches = drain(*log, rtdb, now);
+    TEST_ASSERT_EQUAL_UINT32((pending + 59) / 60, batches);
+    TEST_ASSERT_EQUAL(total - lostInRam, rtdb.ph.size());
+    TEST_ASSERT_EQUAL_UINT32(0, rtdb.duplicates);
+
+    // Desgaste: cada registro se escribe una vez, de a flushRecords
+    const TelemetryLog::Stats &st = log->getStats();
+    printf("Escrito en flash: %llu B para %lu registros, %lu escrituras de segmento, %lu acks\n",
+           (unsigned long long)hal::fsBytesWritten(), (unsigned long)total, (unsigned long)st.segmentWrites,
+           (unsigned long)st.ackWrites);
+    TEST_ASSERT_LESS_OR_EQUAL(uint64_t(total) * sizeof(TelemetryLog::Record) + batches * 8 + 64,
+                              hal::fsBytesWritten());
+    TEST_ASSERT_LESS_OR_EQUAL((total - rebootAt) / 6 + 2 * log->getConfig().segments, st.segmentWrites);
+}
+
+void test_outage_before_first_sntp_is_dated_on_replay()
+{
+    // Arranca sin red ni hora y SNTP llega recién a las 6 h: los bloques
+    // completos van a flash con tiempo monotónico, como guardarBloqueEnFlash()
+    const uint32_t total = 6 * 360 + 7;
+    const uint64_t epochAtSync = 1792231200000ULL; // 2026-10-17 10:00:00 UTC
+    HistoryChunker chunker(30);
+    TelemetryLog log;
+    log.begin();
+    HistoryChunker::Point points[HistoryChunker::MAX_CHUNK];
+    uint64_t monoMs = 0;
+    for (uint32_t i = 0; i < total; i++)
+    {
+        monoMs = 5000 + uint64_t(i) * SAMPLE_MS;
+        chunker.add({0, monoMs, BOOT, i}, 6.0f + (i % 100) * 0.001f, 800.0f, 1000);
+        while (chunker.ready())
+        {
+            uint8_t n = chunker.peek(points, HistoryChunker::MAX_CHUNK);
+            for (uint8_t k = 0; k < n; k++)
+                log.append(points[k].epochMs, points[k].bootId, points[k].seq, points[k].ph, points[k].tds,
+                           points[k].ldr, points[k].monotonic);
+            chunker.commit(n);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(total - 7, log.pending());
+    TEST_ASSERT_EQUAL(7, chunker.count());
+    TEST_ASSERT_EQUAL_UINT32(0, chunker.getStats().dropped);
+
+    // Llega la hora: el reenvío fecha cada registro de este arranque con el offset
+    const int64_t offsetMs = int64_t(epochAtSync) - int64_t(monoMs);
+    chunker.setClock(offsetMs);
+    std::map<uint32_t, uint64_t> epochBySeq;
+    uint32_t undated = 0;
+    auto send = [&](const TelemetryLog::Record *r, uint16_t count) {
+        for (uint16_t k = 0; k < count; k++)
+        {
+            TelemetryLog::Record record = r[k];
+            if (TelemetryLog::toEpoch(record, BOOT, offsetMs) && !(record.flags & TelemetryLog::MONOTONIC))
+                epochBySeq[record.sampleSeq] = record.epochMs;
+            else
+                undated++;
+        }
+        return true;
+    };
+    unsigned long now = 0;
+    while (log.pending())
+    {
+        now += log.getConfig().replayIntervalMs;
+        log.replay(now, send);
+    }
+    // Las 7 que quedaron en RAM salen fechadas en el bloque en vivo
+    TEST_ASSERT_EQUAL(7, chunker.peek(points, HistoryChunker::MAX_CHUNK));
+    for (uint8_t k = 0; k < 7; k++)
+    {
+        TEST_ASSERT_FALSE(points[k].monotonic);
+        epochBySeq[points[k].seq] = points[k].epochMs;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, undated);
+    TEST_ASSERT_EQUAL(total, epochBySeq.size());
+    for (uint32_t i = 0; i < total; i++)
+        TEST_ASSERT_TRUE(epochBySeq[i] == epochAtSync - uint64_t(total - 1 - i) * SAMPLE_MS);
+
+    // Un registro monotónico de otro arranque no se puede fechar
+    TelemetryLog::Record other = {};
+    other.bootId = BOOT - 1;
+    other.epochMs = 5000;
+    other.flags = TelemetryLog::MONOTONIC;
+    TEST_ASSERT_FALSE(TelemetryLog::toEpoch(other, BOOT, offsetMs));
+}
+
+void test_replay_is_rate_limited()
+{
+    TelemetryLog log;
+    log.begin();
+    for (uint32_t i = 0; i < 600; i++)
+        log.append(i * SAMPLE_MS, BOOT, i, 6.2f, 800.0f, 1000);
+
+    FakeHistory rtdb;
+    auto send = [&rtdb](const TelemetryLog::Record *r, uint16_t n) { return rtdb.send(r, n); };
+    TEST_ASSERT_EQUAL(60, log.replay(1000, send));
+    TEST_ASSERT_EQUAL(0, log.replay(1500, send)); // Antes de replayIntervalMs
+    TEST_ASSERT_EQUAL(60, log.replay(2000, send));
+
+    // Un envío fallido no confirma nada
+    rtdb.online = false;
+    TEST_ASSERT_EQUAL(0, log.replay(3000, send));
+    TEST_ASSERT_EQUAL_UINT32(480, log.pending());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_append_and_replay_in_order);
+    RUN_TEST(test_reboot_recovers_log_and_ack);
+    RUN_TEST(test_torn_tail_is_skipped);
+    RUN_TEST(test_retention_drops_oldest);
+    RUN_TEST(test_multi_hour_outage_with_reboot);
+    RUN_TEST(test_outage_before_first_sntp_is_dated_on_replay);
+    RUN_TEST(test_replay_is_rate_limited);
+    return UNITY_END();
+}
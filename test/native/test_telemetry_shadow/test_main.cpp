@@ -0,0 +1,238 @@
+/**
+ * @file test_main.cpp
+ * @brief Publicación por banda muerta y keyframes de TelemetryShadow
+ *
+ *   pio test -e native -f native/test_telemetry_shadow
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <string>
+#include <vector>
+#include "TelemetryShadow.h"
+#include "TelemetrySink.h"
+
+static const char *PH = "sensores/ph4502c/ph";
+static const char *TDS = "sensores/sen0244/tds";
+static const char *EMERGENCIA = "sistema/emergencia";
+static const char *CHIP = "diagnostico/chip";
+
+// Rutas marcadas para enviar en el ciclo en curso
+static std::vector<std::string> due(const TelemetryShadow &shadow)
+{
+    std::vector<std::string> paths;
+    shadow.forEachDue([&paths](const TelemetryShadow::Field &f) { paths.push_back(f.path); });
+    return paths;
+}
+
+static void load(TelemetryShadow &shadow, float ph, float tds, bool emergencia, const char *chip)
+{
+    shadow.setFloat(PH, ph, 0.02f);
+    shadow.setFloat(TDS, tds, 5.0f);
+    shadow.setBool(EMERGENCIA, emergencia);
+    shadow.setText(CHIP, chip);
+}
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+void test_first_cycle_is_keyframe()
+{
+    TelemetryShadow shadow(60000);
+    load(shadow, 6.20f, 800.0f, false, "ESP32");
+
+    TEST_ASSERT_EQUAL(4, shadow.collect(1000));
+    TEST_ASSERT_TRUE(shadow.isKeyframe());
+    TEST_ASSERT_EQUAL(4, due(shadow).size());
+    shadow.commit();
+    TEST_ASSERT_EQUAL(1, shadow.getStats().keyframes);
+}
+
+void test_within_deadband_is_suppressed()
+{
+    TelemetryShadow shadow(60000);
+    load(shadow, 6.20f, 800.0f, false, "ESP32");
+    shadow.collect(1000);
+    shadow.commit();
+
+    // Ruido por debajo de la banda: nada que enviar
+    load(shadow, 6.215f, 804.0f, false, "ESP32");
+    TEST_ASSERT_EQUAL(0, shadow.collect(2000));
+    TEST_ASSERT_FALSE(shadow.isKeyframe());
+    shadow.commit();
+    TEST_ASSERT_EQUAL(4, shadow.getStats().fieldsSuppressed);
+}
+
+void test_crossing_deadband_sends_only_that_field()
+{
+    TelemetryShadow shadow(60000);
+    load(shadow, 6.20f, 800.0f, false, "ESP32");
+    shadow.collect(1000);
+    shadow.commit();
+
+    load(shadow, 6.25f, 803.0f, false, "ESP32");
+    TEST_ASSERT_EQUAL(1, shadow.collect(2000));
+    std::vector<std::string> paths = due(shadow);
+    TEST_ASSERT_EQUAL_STRING(PH, paths[0].c_str());
+    shadow.commit();
+
+    // La banda se mide contra lo publicado, no contra la lectura anterior:
+    // 4 ppm + 4 ppm acumulan 8 ppm desde 800 y cruzan los 5 ppm
+    load(shadow, 6.25f, 804.0f, false, "ESP32");
+    TEST_ASSERT_EQUAL(0, shadow.collect(3000));
+    shadow.commit();
+    load(shadow, 6.25f, 808.0f, false, "ESP32");
+    TEST_ASSERT_EQUAL(1, shadow.collect(4000));
+    TEST_ASSERT_EQUAL_STRING(TDS, due(shadow)[0].c_str());
+}
+
+void test_bool_and_text_changes_are_sent()
+{
+    TelemetryShadow shadow(60000);
+    load(shadow, 6.20f, 800.0f, false, "ESP32");
+    shadow.collect(1000);
+    shadow.commit();
+
+    load(shadow, 6.20f, 800.0f, true, "ESP32-S3");
+    TEST_ASSERT_EQUAL(2, shadow.collect(2000));
+    std::vector<std::string> paths = due(shadow);
+    TEST_ASSERT_EQUAL_STRING(EMERGENCIA, paths[0].c_str());
+    TEST_ASSERT_EQUAL_STRING(CHIP, paths[1].c_str());
+}
+
+void test_failed_send_is_retried()
+{
+    TelemetryShadow shadow(60000);
+    load(shadow, 6.20f, 800.0f, false, "ESP32");
+    shadow.collect(1000);
+    shadow.commit();
+
+    // Sin commit() (PATCH fallido) el cambio sigue pendiente
+    load(shadow, 6.40f, 800.0f, false, "ESP32");
+    TEST_ASSERT_EQUAL(1, shadow.collect(2000));
+    TEST_ASSERT_EQUAL(1, shadow.collect(3000));
+    shadow.commit();
+    TEST_ASSERT_EQUAL(0, shadow.collect(4000));
+
+    // Lo mismo con el primer keyframe: se repite hasta confirmarse
+    TelemetryShadow fresh(60000);
+    load(fresh, 6.20f, 800.0f, false, "ESP32");
+    fresh.collect(1000);
+    TEST_ASSERT_EQUAL(4, fresh.collect(2000));
+    TEST_ASSERT_TRUE(fresh.isKeyframe());
+}
+
+// Como agregarCampo() de main.cpp: lo que no entra en el PATCH queda pendiente
+static uint8_t publish(TelemetryShadow &shadow, PatchBuilder &patch)
+{
+    uint8_t sent = 0;
+    shadow.forEachDue([&](const TelemetryShadow::Field &f)
+    {
+        bool ok = false;
+        switch (f.type)
+        {
+        case TelemetryShadow::FLOAT:
+            ok = patch.addFloat(f.path, f.value.f);
+            break;
+        case TelemetryShadow::INT:
+            ok = patch.addInt(f.path, f.value.i);
+            break;
+        case TelemetryShadow::BOOL:
+            ok = patch.addBool(f.path, f.value.b);
+            break;
+        case TelemetryShadow::TEXT:
+            ok = patch.addText(f.path, f.text);
+            break;
+        }
+        if (ok)
+            sent++;
+        else
+            shadow.markUnsent(f);
+    });
+    return sent;
+}
+
+void test_fields_that_do_not_fit_stay_due()
+{
+    TelemetryShadow shadow(60000);
+    load(shadow, 6.20f, 800.0f, false, "ESP32");
+
+    // Solo entran los dos primeros campos
+    char small[56];
+    PatchBuilder patch(small, sizeof(small));
+    TEST_ASSERT_EQUAL(4, shadow.collect(1000));
+    TEST_ASSERT_EQUAL(2, publish(shadow, patch));
+    TEST_ASSERT_TRUE(patch.overflow());
+    TEST_ASSERT_EQUAL(2, due(shadow).size());
+    shadow.commit(); // El PATCH parcial se publicó bien
+    TEST_ASSERT_EQUAL(2, shadow.getStats().fieldsSent);
+    TEST_ASSERT_EQUAL(2, shadow.getStats().fieldsDeferred);
+    TEST_ASSERT_EQUAL(0, shadow.getStats().fieldsSuppressed);
+
+    // Sin cambios ni keyframe, los que no cupieron salen en el próximo envío
+    TEST_ASSERT_EQUAL(2, shadow.collect(2000));
+    TEST_ASSERT_FALSE(shadow.isKeyframe());
+    std::vector<std::string> pending = due(shadow);
+    TEST_ASSERT_EQUAL_STRING(EMERGENCIA, pending[0].c_str());
+    TEST_ASSERT_EQUAL_STRING(CHIP, pending[1].c_str());
+    char big[256];
+    PatchBuilder next(big, sizeof(big));
+    TEST_ASSERT_EQUAL(2, publish(shadow, next));
+    shadow.commit();
+
+    // Todo publicado: nada pendiente
+    TEST_ASSERT_EQUAL(0, shadow.collect(3000));
+}
+
+void test_keyframe_interval_and_force()
+{
+    TelemetryShadow shadow(60000);
+    load(shadow, 6.20f, 800.0f, false, "ESP32");
+    shadow.collect(1000);
+    shadow.commit();
+
+    TEST_ASSERT_EQUAL(0, shadow.collect(60999));
+    shadow.commit();
+    TEST_ASSERT_EQUAL(4, shadow.collect(61000));
+    TEST_ASSERT_TRUE(shadow.isKeyframe());
+    shadow.commit();
+
+    // El intervalo cuenta desde el último keyframe confirmado
+    TEST_ASSERT_EQUAL(0, shadow.collect(62000));
+    shadow.forceKeyframe();
+    TEST_ASSERT_EQUAL(4, shadow.collect(63000));
+    shadow.commit();
+    TEST_ASSERT_EQUAL(0, shadow.collect(64000));
+    TEST_ASSERT_EQUAL(3, shadow.getStats().keyframes);
+}
+
+void test_nan_and_type_mismatch()
+{
+    TelemetryShadow shadow(60000);
+    shadow.setFloat(PH, NAN, 0.02f);
+    shadow.collect(1000);
+    shadow.commit();
+
+    shadow.setFloat(PH, NAN, 0.02f);
+    TEST_ASSERT_EQUAL(0, shadow.collect(2000));
+    shadow.setFloat(PH, 6.2f, 0.02f);
+    TEST_ASSERT_EQUAL(1, shadow.collect(3000));
+
+    // Una ruta no cambia de tipo
+    TEST_ASSERT_FALSE(shadow.setInt(PH, 6));
+    TEST_ASSERT_EQUAL(1, shadow.size());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_cycle_is_keyframe);
+    RUN_TEST(test_within_deadband_is_suppressed);
+    RUN_TEST(test_crossing_deadband_sends_only_that_field);
+    RUN_TEST(test_bool_and_text_changes_are_sent);
+    RUN_TEST(test_failed_send_is_retried);
+    RUN_TEST(test_fields_that_do_not_fit_stay_due);
+    RUN_TEST(test_keyframe_interval_and_force);
+    RUN_TEST(test_nan_and_type_mismatch);
+    return UNITY_END();
+}
@@ -0,0 +1,155 @@
+/**
+ * @file test_main.cpp
+ * @brief TimeService: reloj monotónico sin hora, anclaje SNTP, deriva y sellos
+ *
+ * La hora del sistema es una fuente falsa que el test mueve a mano; millis()
+ * es el argumento nowMs.
+ *
+ *   pio test -e native -f native/test_time_service
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include <LittleFS.h>
+#include "TimeService.h"
+
+static const uint64_t EPOCH_MS = 1792231200000ULL; // 2026-10-17 10:00:00 UTC
+
+// Hora del sistema simulada
+static bool fakeValid = false;
+static uint64_t fakeEpochMs = 0;
+static uint32_t fakeReads = 0;
+
+static bool fakeSource(uint64_t &epochMs)
+{
+    fakeReads++;
+    epochMs = fakeEpochMs;
+    return fakeValid;
+}
+
+void setUp()
+{
+    hal::reset();
+    fakeValid = false;
+    fakeEpochMs = 0;
+    fakeReads = 0;
+}
+void tearDown() {}
+
+void test_monotonic_fallback_without_ntp()
+{
+    TimeService clock(&fakeSource);
+    clock.begin(5, nullptr);
+    clock.update(1000);
+    TEST_ASSERT_FALSE(clock.isSynced());
+
+    TimeService::Stamp a = clock.stamp(1500);
+    TimeService::Stamp b = clock.stamp(2000);
+    TEST_ASSERT_TRUE(a.epochMs == 0); // Sin hora: solo monotónico
+    TEST_ASSERT_TRUE(a.monoMs == 1500);
+    TEST_ASSERT_EQUAL_UINT32(5, b.bootId);
+    TEST_ASSERT_EQUAL_UINT32(a.seq + 1, b.seq);
+
+    // Un reloj del sistema en 1970 no cuenta como hora
+    fakeValid = true;
+    fakeEpochMs = 12345;
+    clock.update(3000);
+    TEST_ASSERT_FALSE(clock.isSynced());
+}
+
+void test_first_sync_anchors_epoch()
+{
+    TimeService clock(&fakeSource, 1000);
+    clock.begin(1, nullptr);
+    clock.update(0);
+    TEST_ASSERT_EQUAL_UINT32(1, fakeReads);
+    clock.update(500); // Antes de checkIntervalMs no se consulta
+    TEST_ASSERT_EQUAL_UINT32(1, fakeReads);
+
+    fakeValid = true;
+    fakeEpochMs = EPOCH_MS;
+    clock.update(5000);
+    TEST_ASSERT_TRUE(clock.isSynced());
+    TEST_ASSERT_TRUE(clock.offsetMs() == int64_t(EPOCH_MS) - 5000);
+    TEST_ASSERT_EQUAL(5000, clock.getStats().firstSyncMs);
+
+    TimeService::Stamp s = clock.stamp(6250);
+    TEST_ASSERT_TRUE(s.epochMs == EPOCH_MS + 1250);
+    TEST_ASSERT_TRUE(clock.epochMs(7000) == EPOCH_MS + 2000);
+}
+
+void test_drift_and_steps_never_reorder_stamps()
+{
+    TimeService clock(&fakeSource, 1000, 1000);
+    clock.begin(1, nullptr);
+    fakeValid = true;
+    fakeEpochMs = EPOCH_MS;
+    clock.update(0);
+
+    // 100 s después SNTP adelantó el reloj 10 ms: el local atrasa 100 ppm
+    fakeEpochMs = EPOCH_MS + 100010;
+    clock.update(100000);
+    const TimeService::Stats &st = clock.getStats();
+    TEST_ASSERT_EQUAL_INT32(10, st.lastErrorMs);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 100.0f, st.driftPpm);
+    TEST_ASSERT_EQUAL_UINT32(0, st.steps);
+
+    // Un redondeo de 1 ms no es una corrección
+    fakeEpochMs = EPOCH_MS + 101011;
+    clock.update(101000);
+    TEST_ASSERT_EQUAL_INT32(10, st.lastErrorMs);
+
+    // Corrección de 5 s hacia atrás: el epoch de los sellos no retrocede
+    uint64_t before = clock.stamp(102000).epochMs;
+    fakeEpochMs = EPOCH_MS + 98010;
+    clock.update(103000);
+    TEST_ASSERT_EQUAL_UINT32(1, st.steps);
+    TimeService::Stamp held = clock.stamp(104000);
+    TEST_ASSERT_TRUE(held.epochMs == before);
+    TimeService::Stamp later = clock.stamp(110000);
+    TEST_ASSERT_TRUE(later.epochMs == EPOCH_MS + 105010);
+    TEST_ASSERT_EQUAL_UINT32(held.seq + 1, later.seq);
+}
+
+void test_millis_wrap_extends_to_64_bits()
+{
+    TimeService clock(&fakeSource);
+    TEST_ASSERT_TRUE(clock.monotonicMs(0xFFFFFF00UL) == 0xFFFFFF00ULL);
+    TEST_ASSERT_TRUE(clock.monotonicMs(0xFFFFFEF0UL) == 0xFFFFFEF0ULL); // Lectura un poco vieja: no es vuelta
+    TEST_ASSERT_TRUE(clock.monotonicMs(0x10) == 0x100000010ULL);
+    TEST_ASSERT_TRUE(clock.monotonicMs(0xFFFFFFF0UL) == 0xFFFFFFF0ULL); // Anterior a la vuelta
+    TEST_ASSERT_TRUE(clock.monotonicMs(0x20) == 0x100000020ULL);
+}
+
+void test_boot_id_persists_and_recovers()
+{
+    TEST_ASSERT_EQUAL_UINT32(1, TimeService::nextBootId());
+    TEST_ASSERT_EQUAL_UINT32(2, TimeService::nextBootId());
+    TEST_ASSERT_EQUAL_UINT32(3, TimeService::nextBootId());
+
+    // Archivo dañado (corte a mitad de escritura): vuelve a empezar
+    hal::fsTruncate("/boot_id.bin", 3);
+    TEST_ASSERT_EQUAL_UINT32(1, TimeService::nextBootId());
+}
+
+void test_day_index_in_local_zone()
+{
+    const int32_t colombia = -5 * 3600;
+    const uint64_t midnightUtc = 1792195200000ULL; // 2026-10-17 00:00:00 UTC
+    TEST_ASSERT_EQUAL_INT32(20743, TimeService::dayIndex(midnightUtc, 0));
+    TEST_ASSERT_EQUAL_INT32(20742, TimeService::dayIndex(midnightUtc, colombia)); // 16 oct, 19:00 local
+    TEST_ASSERT_EQUAL_INT32(20742, TimeService::dayIndex(midnightUtc + 5 * 3600000ULL - 1, colombia));
+    TEST_ASSERT_EQUAL_INT32(20743, TimeService::dayIndex(midnightUtc + 5 * 3600000ULL, colombia));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_monotonic_fallback_without_ntp);
+    RUN_TEST(test_first_sync_anchors_epoch);
+    RUN_TEST(test_drift_and_steps_never_reorder_stamps);
+    RUN_TEST(test_millis_wrap_extends_to_64_bits);
+    RUN_TEST(test_boot_id_persists_and_recovers);
+    RUN_TEST(test_day_index_in_local_zone);
+    return UNITY_END();
+}
@@ -0,0 +1,165 @@
+/**
+ * @file test_main.cpp
+ * @brief PATCH multi-ruta (PatchBuilder) y lectura del stream SSE de RTDB
+ *
+ *   pio test -e native -f native/test_transport
+ */
+
+#include <unity.h>
+#include <ArduinoHAL.h>
+#include "CommandStream.h"
+#include "RestTransport.h"
+#include "TelemetrySink.h"
+
+void setUp() { hal::reset(); }
+void tearDown() {}
+
+// Un evento completo por feed(); devuelve cuántos eventos salieron
+static int feedAll(SseParser &p, const char *text)
+{
+    int events = 0;
+    for (const char *c = text; *c; c++)
+        if (p.feed(*c))
+            events++;
+    return events;
+}
+
+void test_patch_builder_formats_each_type()
+{
+    char buf[256];
+    PatchBuilder patch(buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_STRING("{}", patch.c_str());
+
+    patch.addInt("a/i", -42);
+    patch.addU64("a/t", 1792195200123ULL);
+    patch.addFloat("a/f", 6.25f);
+    patch.addFloat("a/nan", NAN);
+    patch.addBool("a/b", true);
+    patch.addText("a/s", "luz \"alta\"\n");
+    patch.addRaw("h/1", "{\"n\":2}");
+    TEST_ASSERT_EQUAL_STRING("{\"a/i\":-42,\"a/t\":1792195200123,\"a/f\":6.25,\"a/nan\":null,\"a/b\":true,"
+                             "\"a/s\":\"luz \\\"alta\\\"\\u000a\",\"h/1\":{\"n\":2}}",
+                             patch.c_str());
+    TEST_ASSERT_EQUAL(7, patch.count());
+    TEST_ASSERT_FALSE(patch.overflow());
+
+    patch.clear();
+    TEST_ASSERT_EQUAL_STRING("{}", patch.c_str());
+    TEST_ASSERT_EQUAL(0, patch.count());
+}
+
+void test_patch_builder_overflow_keeps_valid_json()
+{
+    char buf[24];
+    PatchBuilder patch(buf, sizeof(buf));
+    TEST_ASSERT_TRUE(patch.addInt("ph", 6));
+    TEST_ASSERT_FALSE(patch.addText("nivel_luz", "muy alta"));
+    TEST_ASSERT_TRUE(patch.overflow());
+    TEST_ASSERT_EQUAL_STRING("{\"ph\":6}", patch.c_str());
+
+    // Una entrada más corta todavía cabe
+    TEST_ASSERT_TRUE(patch.addBool("e", false));
+    TEST_ASSERT_EQUAL_STRING("{\"ph\":6,\"e\":false}", patch.c_str());
+    TEST_ASSERT_EQUAL(2, patch.count());
+}
+
+void test_sse_parser_events_split_across_reads()
+{
+    SseParser p;
+    const char *stream = "event: put\r\ndata: {\"path\":\"/\",\"data\":null}\r\n\r\n"
+                         ": comentario\n"
+                         "event: keep-alive\ndata: null\n\n";
+    // Byte a byte, como llegan del socket
+    TEST_ASSERT_FALSE(p.feed('e'));
+    for (const char *c = stream + 1;; c++)
+    {
+        if (p.feed(*c))
+            break;
+    }
+    TEST_ASSERT_EQUAL_STRING("put", p.event());
+    TEST_ASSERT_EQUAL_STRING("{\"path\":\"/\",\"data\":null}", p.data());
+
+    TEST_ASSERT_EQUAL(1, feedAll(p, strstr(stream, ": comentario")));
+    TEST_ASSERT_EQUAL_STRING("keep-alive", p.event());
+    TEST_ASSERT_EQUAL_STRING("null", p.data());
+}
+
+void test_sse_parser_multiline_data_and_oversize()
+{
+    SseParser p;
+    TEST_ASSERT_EQUAL(1, feedAll(p, "data: a\ndata: b\n\n"));
+    TEST_ASSERT_EQUAL_STRING("message", p.event());
+    TEST_ASSERT_EQUAL_STRING("a\nb", p.data());
+
+    // Un evento que no cabe se descarta sin romper el siguiente
+    std::string big = "event: put\ndata: " + std::string(SseParser::BUFFER_SIZE + 10, 'x') + "\n\n";
+    TEST_ASSERT_EQUAL(0, feedAll(p, big.c_str()));
+    TEST_ASSERT_EQUAL(1, p.dropped());
+    TEST_ASSERT_EQUAL(1, feedAll(p, "event: patch\ndata: {}\n\n"));
+    TEST_ASSERT_EQUAL_STRING("patch", p.event());
+}
+
+void test_split_event_infers_rtdb_types()
+{
+    CommandSource::Message m;
+    char a[] = "{\"path\":\"/emergency\",\"data\":true}";
+    TEST_ASSERT_TRUE(RestCommandSource::splitEvent(a, m));
+    TEST_ASSERT_EQUAL_STRING("/emergency", m.path);
+    TEST_ASSERT_EQUAL_STRING("boolean", m.type);
+    TEST_ASSERT_EQUAL_STRING("true", m.payload);
+
+    char b[] = "{\"path\":\"/\",\"data\":{\"emergency\":false,\"reset\":true}}";
+    TEST_ASSERT_TRUE(RestCommandSource::splitEvent(b, m));
+    TEST_ASSERT_EQUAL_STRING("json", m.type);
+    TEST_ASSERT_EQUAL_STRING("{\"emergency\":false,\"reset\":true}", m.payload);
+
+    char c[] = "{\"path\":\"/modo\",\"data\":\"manual\"}";
+    TEST_ASSERT_TRUE(RestCommandSource::splitEvent(c, m));
+    TEST_ASSERT_EQUAL_STRING("string", m.type);
+    TEST_ASSERT_EQUAL_STRING("manual", m.payload);
+
+    char d[] = "{\"path\":\"/x\",\"data\":6.5}";
+    char e[] = "{\"path\":\"/x\",\"data\":12}";
+    char f[] = "{\"path\":\"/\",\"data\":null}";
+    TEST_ASSERT_TRUE(RestCommandSource::splitEvent(d, m));
+    TEST_ASSERT_EQUAL_STRING("float", m.type);
+    TEST_ASSERT_TRUE(RestCommandSource::splitEvent(e, m));
+    TEST_ASSERT_EQUAL_STRING("int", m.type);
+    TEST_ASSERT_TRUE(RestCommandSource::splitEvent(f, m));
+    TEST_ASSERT_EQUAL_STRING("null", m.type);
+
+    char bad[] = "{\"data\":true}";
+    TEST_ASSERT_FALSE(RestCommandSource::splitEvent(bad, m));
+}
+
+void test_stream_events_reach_command_stream()
+{
+    // Lo que manda tools/rtdb_server al abrir el stream y tras un PATCH
+    SseParser p;
+    CommandStream cs;
+    CommandStream::Event ev;
+    CommandSource::Message m;
+
+    TEST_ASSERT_EQUAL(1, feedAll(p, "event: put\ndata: {\"path\":\"/\",\"data\":{\"emergency\":true}}\n\n"));
+    TEST_ASSERT_TRUE(RestCommandSource::splitEvent(p.data(), m));
+    TEST_ASSERT_TRUE(cs.parse(m.path, m.type, m.payload, ev));
+    TEST_ASSERT_TRUE(ev.hasEmergency && ev.emergency);
+
+    TEST_ASSERT_EQUAL(1, feedAll(p, "event: patch\ndata: {\"path\":\"/\",\"data\":{\"reset\":true}}\n\n"));
+    TEST_ASSERT_TRUE(RestCommandSource::splitEvent(p.data(), m));
+    TEST_ASSERT_TRUE(cs.parse(m.path, m.type, m.payload, ev));
+    TEST_ASSERT_TRUE(ev.reset);
+    TEST_ASSERT_FALSE(ev.hasEmergency);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_patch_builder_formats_each_type);
+    RUN_TEST(test_patch_builder_overflow_keeps_valid_json);
+    RUN_TEST(test_sse_parser_events_split_across_reads);
+    RUN_TEST(test_sse_parser_multiline_data_and_oversize);
+    RUN_TEST(test_split_event_infers_rtdb_types);
+    RUN_TEST(test_stream_events_reach_command_stream);
+    return UNITY_END();
+}
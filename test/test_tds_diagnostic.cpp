@@ -4,9 +4,14 @@
  * 
  * Este programa prueba específicamente el sensor TDS para determinar
  * por qué está mostrando "Desconectado"
+ *
+ * La cantidad de muestras por ciclo se ajusta al ruido medido
+ * (OversampleBudget de SensorFilters.h): con agua quieta bastan pocas,
+ * con ruido se toman hasta 64 repartidas en el mismo segundo.
  */
 
 #include <Arduino.h>
+#include "SensorFilters.h"
 
 // Pin del sensor TDS según pin_config.h
 #define TDS_PIN 33
@@ -17,6 +22,14 @@
 #define VREF 3.3
 #define ADC_RES 4096.0
 
+// Error estándar objetivo del promedio (cuentas ADC) y límites de muestras
+#define TARGET_ERROR_COUNTS 1.0
+#define MIN_SAMPLES 4
+#define MAX_SAMPLES 64
+#define SAMPLE_WINDOW_MS 1000
+
+OversampleBudget budget(TARGET_ERROR_COUNTS, MIN_SAMPLES, MAX_SAMPLES);
+
 void setup() {
     Serial.begin(115200);
     delay(2000);
@@ -48,8 +61,10 @@ void setup() {
 }
 
 void loop() {
-    // Tomar 20 muestras
-    int readings[20];
+    // Muestras según el ruido medido en los ciclos anteriores
+    int nSamples = budget.samples();
+    int spacingMs = SAMPLE_WINDOW_MS / nSamples;
+    int readings[MAX_SAMPLES];
     int minVal = 4095;
     int maxVal = 0;
     long sumVal = 0;
@@ -58,15 +73,16 @@ void loop() {
     Serial.printf("Tiempo: %lu segundos\n\n", millis() / 1000);
     
     // Tomar muestras
-    for (int i = 0; i < 20; i++) {
+    for (int i = 0; i < nSamples; i++) {
         readings[i] = analogRead(TDS_PIN);
+        budget.push(readings[i]);
         sumVal += readings[i];
         if (readings[i] < minVal) minVal = readings[i];
         if (readings[i] > maxVal) maxVal = readings[i];
-        delay(50);
+        delay(spacingMs);
     }
     
-    int avgADC = sumVal / 20;
+    int avgADC = sumVal / nSamples;
     float avgVoltage = (avgADC * VREF) / ADC_RES;
     
     // Mostrar estadísticas
@@ -75,6 +91,8 @@ void loop() {
     Serial.printf("  Mínimo:       %d\n", minVal);
     Serial.printf("  Máximo:       %d\n", maxVal);
     Serial.printf("  Variación:    %d\n", maxVal - minVal);
+    Serial.printf("  Muestras:     %d cada %d ms (σ=%.2f, error=%.2f cuentas)\n",
+                  nSamples, spacingMs, budget.statistics().stddev(), budget.standardError(nSamples));
     Serial.printf("  Voltaje:      %.3f V\n", avgVoltage);
     Serial.println();
     
@@ -139,13 +157,14 @@ void loop() {
     
     // Mostrar muestras individuales (solo primeras 10)
     Serial.println();
-    Serial.println("📋 MUESTRAS INDIVIDUALES (primeras 10):");
+    int shown = nSamples < 10 ? nSamples : 10;
+    Serial.printf("📋 MUESTRAS INDIVIDUALES (primeras %d):\n", shown);
     Serial.print("  ");
-    for (int i = 0; i < 10; i++) {
+    for (int i = 0; i < shown; i++) {
         Serial.printf("%4d ", readings[i]);
         if ((i + 1) % 5 == 0) {
             Serial.println();
-            if (i < 9) Serial.print("  ");
+            if (i < shown - 1) Serial.print("  ");
         }
     }
     
@@ -0,0 +1,94 @@
+/**
+ * @file decode_history.cpp
+ * @brief Herramienta de host: bloques empaquetados del historial a CSV
+ *
+ * Lee de la entrada estándar, una por línea, cadenas base64 de SeriesCodec
+ * o bloques JSON completos como los guarda RTDB ({"t0":...,"n":...,"z":"..."}),
+ * y escribe una fila CSV por muestra: epoch en ms, boot_id y seq (0 en los
+ * bloques de la versión 1), pH, TDS y LDR. Sirve para revisar lo que el ESP32
+ * publica o un export de la base de datos sin pasar por el dashboard.
+ *
+ * Compilar desde la raíz del proyecto:
+ *   g++ -O2 -std=gnu++17 -Ilib/SeriesCodec tools/decode_history.cpp lib/SeriesCodec/SeriesCodec.cpp -o decode_history
+ *
+ * Uso:
+ *   echo 'AgMAAAAMAAABoUlN1QDwAAAAAAACcSngAAAKpUyBh64Vth///bL1vSiJGAAcAeAf6DwMKA==' | ./decode_history
+ *   jq -c '.[]' historial_2026-10-17.json | ./decode_history > dia.csv
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "SeriesCodec.h"
+
+namespace
+{
+    // Valor de "z" si la línea es JSON; si no, la línea entera (sin espacios)
+    std::string extractBase64(const std::string &line)
+    {
+        size_t key = line.find("\"z\"");
+        if (key == std::string::npos)
+        {
+            std::string out;
+            for (char c : line)
+                if (c != ' ' && c != '\t' && c != '\r' && c != '"')
+                    out += c;
+            return out;
+        }
+        size_t open = line.find('"', line.find(':', key) + 1);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos)
+            return "";
+        return line.substr(open + 1, close - open - 1);
+    }
+
+    void printValue(float v, const char *fmt)
+    {
+        if (std::isfinite(v))
+            printf(fmt, v);
+    }
+}
+
+int main()
+{
+    printf("epoch_ms,boot_id,seq,ph,tds,ldr\n");
+    std::string line;
+    char buf[4096];
+    int bad = 0;
+    unsigned long lineNo = 0;
+    while (fgets(buf, sizeof(buf), stdin))
+    {
+        line = buf;
+        lineNo++;
+        while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+            line.pop_back();
+        std::string text = extractBase64(line);
+        if (text.empty())
+            continue;
+
+        std::vector<uint8_t> bin(text.size());
+        size_t len = SeriesCodec::base64Decode(text.c_str(), bin.data(), bin.size());
+        SeriesCodec::Sample samples[SeriesCodec::MAX_SAMPLES];
+        uint32_t boot = 0;
+        uint8_t n = len ? SeriesCodec::decode(bin.data(), len, samples, SeriesCodec::MAX_SAMPLES, &boot) : 0;
+        if (!n)
+        {
+            fprintf(stderr, "Linea %lu: bloque ilegible\n", lineNo);
+            bad++;
+            continue;
+        }
+        for (uint8_t i = 0; i < n; i++)
+        {
+            printf("%llu,%lu,%lu,", (unsigned long long)samples[i].time, (unsigned long)boot,
+                   (unsigned long)samples[i].seq);
+            printValue(samples[i].ph, "%.2f");
+            printf(",");
+            printValue(samples[i].tds, "%.0f");
+            printf(",%ld\n", (long)samples[i].ldr);
+        }
+    }
+    return bad ? 1 : 0;
+}
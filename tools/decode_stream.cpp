@@ -0,0 +1,205 @@
+/**
+ * @file decode_stream.cpp
+ * @brief Herramienta de host: captura del modo STREAM a CSV o a columnas
+ *
+ * Lee los bytes crudos del puerto serie (archivo o entrada estándar), corta
+ * en cada 0x00, decodifica las tramas de StreamFrame y descarta las que no
+ * pasan el CRC. El texto que se coló entre tramas (mensajes del log, la
+ * respuesta a STREAM,ON) sale por stderr. Al final informa tramas válidas,
+ * descartadas y perdidas (saltos de seq).
+ *
+ * Salida:
+ *   - CSV por stdout, una fila por registro
+ *   - --columnas DIR: un archivo binario por columna (little-endian, tipo
+ *     fijo) y DIR/esquema.csv con nombre, tipo y filas; se cargan sin parsear
+ *     (numpy.fromfile, pandas, DuckDB) y solo se lee lo que se usa
+ *
+ * Compilar desde la raíz del proyecto:
+ *   g++ -O2 -std=gnu++17 -Ilib/SerialStream tools/decode_stream.cpp lib/SerialStream/StreamFrame.cpp -o decode_stream
+ *
+ * Captura (Linux/macOS; el monitor de PlatformIO no sirve para binario):
+ *   stty -F /dev/ttyUSB0 115200 raw -echo
+ *   cat /dev/ttyUSB0 > captura.bin &
+ *   printf 'STREAM,ON,200\n' > /dev/ttyUSB0     # ... y luego STREAM,OFF
+ *   ./decode_stream captura.bin > captura.csv
+ *   ./decode_stream --columnas captura/ captura.bin
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "StreamFrame.h"
+
+namespace
+{
+    struct Column
+    {
+        const char *name;
+        const char *type; // u8, u16, u32, f32
+        std::vector<uint8_t> data;
+
+        template <typename T>
+        void add(T v)
+        {
+            const uint8_t *p = reinterpret_cast<const uint8_t *>(&v);
+            data.insert(data.end(), p, p + sizeof(T)); // Host little-endian (x86, ARM)
+        }
+    };
+
+    const char *const HEADER = "seq,t_us,adc_ph,adc_tds,adc_ldr,ph,tds,ldr,nivel_ph_menos,nivel_ph_mas,circulacion,"
+                               "bomba_ph_menos,bomba_ph_mas,emergencia,loop_max_us,retraso_control_us";
+
+    std::vector<Column> makeColumns()
+    {
+        return {{"seq", "u32", {}},         {"t_us", "u32", {}},           {"adc_ph", "u16", {}},
+                {"adc_tds", "u16", {}},     {"adc_ldr", "u16", {}},        {"ph", "f32", {}},
+                {"tds", "f32", {}},         {"ldr", "u16", {}},            {"nivel_ph_menos", "u8", {}},
+                {"nivel_ph_mas", "u8", {}}, {"circulacion", "u8", {}},     {"bomba_ph_menos", "u8", {}},
+                {"bomba_ph_mas", "u8", {}}, {"emergencia", "u8", {}},      {"loop_max_us", "u32", {}},
+                {"retraso_control_us", "u32", {}}};
+    }
+
+    uint8_t bit(uint8_t bits, uint8_t mask) { return (bits & mask) ? 1 : 0; }
+
+    void addRow(std::vector<Column> &c, const StreamFrame::Record &r)
+    {
+        c[0].add(r.seq);
+        c[1].add(r.timeUs);
+        c[2].add(r.rawPh);
+        c[3].add(r.rawTds);
+        c[4].add(r.rawLdr);
+        c[5].add(r.ph);
+        c[6].add(r.tds);
+        c[7].add(r.ldr);
+        c[8].add(bit(r.levels, StreamFrame::LEVEL_PH_MINUS_OK));
+        c[9].add(bit(r.levels, StreamFrame::LEVEL_PH_PLUS_OK));
+        c[10].add(bit(r.relays, StreamFrame::PUMP_CIRCULATION_ON));
+        c[11].add(bit(r.relays, StreamFrame::PUMP_PH_MINUS_ON));
+        c[12].add(bit(r.relays, StreamFrame::PUMP_PH_PLUS_ON));
+        c[13].add(bit(r.relays, StreamFrame::EMERGENCY_STOP));
+        c[14].add(r.loopMaxUs);
+        c[15].add(r.controlLateUs);
+    }
+
+    void printRow(const StreamFrame::Record &r)
+    {
+        printf("%lu,%lu,%u,%u,%u,", (unsigned long)r.seq, (unsigned long)r.timeUs, r.rawPh, r.rawTds, r.rawLdr);
+        if (std::isfinite(r.ph))
+            printf("%.3f", r.ph);
+        printf(",");
+        if (std::isfinite(r.tds))
+            printf("%.1f", r.tds);
+        printf(",%u,%u,%u,%u,%u,%u,%u,%lu,%lu\n", r.ldr, bit(r.levels, StreamFrame::LEVEL_PH_MINUS_OK),
+               bit(r.levels, StreamFrame::LEVEL_PH_PLUS_OK), bit(r.relays, StreamFrame::PUMP_CIRCULATION_ON),
+               bit(r.relays, StreamFrame::PUMP_PH_MINUS_ON), bit(r.relays, StreamFrame::PUMP_PH_PLUS_ON),
+               bit(r.relays, StreamFrame::EMERGENCY_STOP), (unsigned long)r.loopMaxUs,
+               (unsigned long)r.controlLateUs);
+    }
+
+    bool isText(const std::vector<uint8_t> &chunk)
+    {
+        for (uint8_t c : chunk)
+            if (c < 0x20 && c != '\n' && c != '\r' && c != '\t')
+                return false;
+        return true;
+    }
+
+    bool writeColumns(const std::string &dir, const std::vector<Column> &columns, unsigned long rows)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        FILE *schema = fopen((dir + "/esquema.csv").c_str(), "w");
+        if (!schema)
+            return false;
+        fprintf(schema, "columna,tipo,filas\n");
+        for (const Column &c : columns)
+        {
+            FILE *f = fopen((dir + "/" + c.name + ".bin").c_str(), "wb");
+            if (!f)
+            {
+                fclose(schema);
+                return false;
+            }
+            fwrite(c.data.data(), 1, c.data.size(), f);
+            fclose(f);
+            fprintf(schema, "%s,%s,%lu\n", c.name, c.type, rows);
+        }
+        fclose(schema);
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *columnsDir = nullptr;
+    const char *inputPath = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--columnas") == 0 && i + 1 < argc)
+            columnsDir = argv[++i];
+        else
+            inputPath = argv[i];
+    }
+
+    FILE *in = inputPath ? fopen(inputPath, "rb") : stdin;
+    if (!in)
+    {
+        fprintf(stderr, "No se pudo abrir %s\n", inputPath);
+        return 1;
+    }
+
+    std::vector<Column> columns = makeColumns();
+    if (!columnsDir)
+        printf("%s\n", HEADER);
+
+    unsigned long frames = 0, bad = 0, lost = 0;
+    bool haveSeq = false;
+    uint32_t lastSeq = 0;
+    std::vector<uint8_t> chunk;
+    int c;
+    while ((c = fgetc(in)) != EOF)
+    {
+        if (c != 0)
+        {
+            chunk.push_back(uint8_t(c));
+            continue;
+        }
+        if (chunk.empty())
+            continue;
+
+        StreamFrame::Record r;
+        if (StreamFrame::decode(chunk.data(), chunk.size(), r))
+        {
+            // seq vuelve a 0 con cada STREAM,ON: solo cuenta los saltos hacia adelante
+            if (haveSeq && r.seq > lastSeq + 1)
+                lost += r.seq - lastSeq - 1;
+            haveSeq = true;
+            lastSeq = r.seq;
+            frames++;
+            if (columnsDir)
+                addRow(columns, r);
+            else
+                printRow(r);
+        }
+        else if (isText(chunk))
+            fprintf(stderr, "texto: %.*s", (int)chunk.size(), (const char *)chunk.data());
+        else
+            bad++;
+        chunk.clear();
+    }
+    if (in != stdin)
+        fclose(in);
+
+    if (columnsDir && !writeColumns(columnsDir, columns, frames))
+    {
+        fprintf(stderr, "No se pudo escribir en %s\n", columnsDir);
+        return 1;
+    }
+    fprintf(stderr, "%lu registros, %lu tramas descartadas (CRC/COBS), %lu perdidas (saltos de seq)\n", frames,
+            bad, lost);
+    return frames ? 0 : 1;
+}
@@ -0,0 +1,926 @@
+/**
+ * @file rtdb_server.cpp
+ * @brief Herramienta de host: servidor local con el subconjunto REST de RTDB
+ *
+ * Imita lo que usa el ESP32 de Firebase Realtime Database, sin TLS ni
+ * autenticación: GET, PUT, PATCH (multi-ruta: {"a/b":1} actualiza solo esa
+ * hoja) y DELETE sobre /ruta.json, y el stream SSE de una ruta (GET con
+ * Accept: text/event-stream): un "put" inicial con el nodo completo, luego
+ * "put"/"patch" por cada escritura debajo de la ruta y "keep-alive" cada
+ * --keepalive-s. Con RestTransport permite medir el camino de publicación
+ * (bench_transport) o correr el firmware contra la red local.
+ *
+ * Fallas inyectadas, reproducibles con --seed, solo en rutas de datos:
+ *   --delay-ms N --jitter-ms N   demora fija + uniforme [0, N] por petición
+ *   --fail-rate P --fail-status N responde N (503 por defecto) con prob. P
+ *   --drop-rate P                cierra la conexión sin responder
+ *   --stall-rate P --stall-ms N  no responde en N ms y luego cierra
+ * Se cambian en caliente con PUT /.settings.json (mismos nombres con "_");
+ * GET /.stats.json da los contadores.
+ *
+ * Compilar desde la raíz del proyecto:
+ *   g++ -O2 -std=gnu++17 -pthread tools/rtdb_server.cpp -o rtdb_server
+ *
+ * Uso:
+ *   ./rtdb_server --port 8787 --delay-ms 40 --jitter-ms 20
+ *   curl -X PATCH -d '{"comandos/emergency":true}' http://127.0.0.1:8787/hydroponic_data.json
+ *   curl -X PUT -d '{"fail_rate":0.2}' http://127.0.0.1:8787/.settings.json
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // ========================================================================
+    // ÁRBOL JSON
+    // ========================================================================
+
+    // Hoja (texto JSON tal cual) u objeto; un objeto sin hijos es null
+    struct Node
+    {
+        bool leaf = false;
+        std::string raw;
+        std::map<std::string, Node> kids;
+
+        bool empty() const { return !leaf && kids.empty(); }
+    };
+
+    typedef std::vector<std::string> Path;
+
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(const std::string &text) : p(text.c_str()), end(text.c_str() + text.size()) {}
+
+        bool parse(Node &out)
+        {
+            if (!value(out))
+                return false;
+            skip();
+            return p == end;
+        }
+
+    private:
+        const char *p;
+        const char *end;
+
+        void skip()
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+                p++;
+        }
+
+        bool literal(const char *word, Node &out)
+        {
+            size_t n = strlen(word);
+            if (size_t(end - p) < n || strncmp(p, word, n) != 0)
+                return false;
+            p += n;
+            out.leaf = word[0] != 'n'; // null queda como objeto vacío
+            out.raw = out.leaf ? word : "";
+            return true;
+        }
+
+        // Cadena sin decodificar (con comillas) y su texto para usarla de clave
+        bool string(std::string &raw, std::string &text)
+        {
+            const char *start = p++;
+            while (p < end && *p != '"')
+            {
+                if (*p == '\\')
+                {
+                    if (++p >= end)
+                        return false;
+                    text += *p == 'n' ? '\n' : *p == 't' ? '\t' : *p;
+                }
+                else if ((unsigned char)*p < 0x20)
+                    return false;
+                else
+                    text += *p;
+                p++;
+            }
+            if (p >= end)
+                return false;
+            p++;
+            raw.assign(start, p);
+            return true;
+        }
+
+        bool number(Node &out)
+        {
+            const char *start = p;
+            if (*p == '-')
+                p++;
+            while (p < end && (isdigit((unsigned char)*p) || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' ||
+                               *p == '-'))
+                p++;
+            if (p == start || (p == start + 1 && *start == '-'))
+                return false;
+            out.leaf = true;
+            out.raw.assign(start, p);
+            return true;
+        }
+
+        bool value(Node &out)
+        {
+            skip();
+            if (p >= end)
+                return false;
+            switch (*p)
+            {
+            case '{':
+            case '[':
+            {
+                char close = *p == '{' ? '}' : ']';
+                bool array = *p == '[';
+                p++;
+                skip();
+                if (p < end && *p == close)
+                {
+                    p++;
+                    return true;
+                }
+                for (size_t i = 0;; i++)
+                {
+                    std::string key = std::to_string(i);
+                    if (!array)
+                    {
+                        skip();
+                        std::string raw;
+                        key.clear();
+                        if (p >= end || *p != '"' || !string(raw, key))
+                            return false;
+                        skip();
+                        if (p >= end || *p++ != ':')
+                            return false;
+                    }
+                    Node child;
+                    if (!value(child))
+                        return false;
+                    if (!child.empty())
+                        out.kids[key] = child;
+                    skip();
+                    if (p < end && *p == ',')
+                    {
+                        p++;
+                        continue;
+                    }
+                    if (p < end && *p == close)
+                    {
+                        p++;
+                        return true;
+                    }
+                    return false;
+                }
+            }
+            case '"':
+            {
+                std::string text;
+                out.leaf = true;
+                return string(out.raw, text);
+            }
+            case 't':
+                return literal("true", out);
+            case 'f':
+                return literal("false", out);
+            case 'n':
+                return literal("null", out);
+            default:
+                return number(out);
+            }
+        }
+    };
+
+    std::string quote(const std::string &key)
+    {
+        std::string out = "\"";
+        for (char c : key)
+        {
+            if (c == '"' || c == '\\')
+                out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    // Como RTDB: un objeto con claves 0..n-1 se devuelve como arreglo
+    void toJson(const Node &n, std::string &out)
+    {
+        if (n.leaf)
+        {
+            out += n.raw;
+            return;
+        }
+        if (n.kids.empty())
+        {
+            out += "null";
+            return;
+        }
+        bool array = true;
+        for (size_t i = 0; array && i < n.kids.size(); i++)
+            array = n.kids.count(std::to_string(i)) > 0;
+        out += array ? '[' : '{';
+        if (array)
+        {
+            for (size_t i = 0; i < n.kids.size(); i++)
+            {
+                if (i)
+                    out += ',';
+                toJson(n.kids.at(std::to_string(i)), out);
+            }
+        }
+        else
+        {
+            bool first = true;
+            for (auto &kv : n.kids)
+            {
+                if (!first)
+                    out += ',';
+                first = false;
+                out += quote(kv.first);
+                out += ':';
+                toJson(kv.second, out);
+            }
+        }
+        out += array ? ']' : '}';
+    }
+
+    std::string toJson(const Node *n)
+    {
+        std::string out;
+        if (n)
+            toJson(*n, out);
+        else
+            out = "null";
+        return out;
+    }
+
+    Path splitPath(const std::string &text)
+    {
+        Path out;
+        size_t i = 0;
+        while (i < text.size())
+        {
+            size_t j = text.find('/', i);
+            if (j == std::string::npos)
+                j = text.size();
+            if (j > i)
+                out.push_back(text.substr(i, j - i));
+            i = j + 1;
+        }
+        return out;
+    }
+
+    std::string joinPath(const Path &path, size_t from = 0)
+    {
+        std::string out;
+        for (size_t i = from; i < path.size(); i++)
+            out += "/" + path[i];
+        return out.empty() ? "/" : out;
+    }
+
+    bool isPrefix(const Path &prefix, const Path &path)
+    {
+        if (prefix.size() > path.size())
+            return false;
+        for (size_t i = 0; i < prefix.size(); i++)
+            if (prefix[i] != path[i])
+                return false;
+        return true;
+    }
+
+    const Node *find(const Node &root, const Path &path)
+    {
+        const Node *n = &root;
+        for (auto &seg : path)
+        {
+            if (n->leaf)
+                return nullptr;
+            auto it = n->kids.find(seg);
+            if (it == n->kids.end())
+                return nullptr;
+            n = &it->second;
+        }
+        return n;
+    }
+
+    // Escribe value en path (null borra) y poda los objetos que quedan vacíos
+    void setAt(Node &node, const Path &path, size_t depth, const Node &value)
+    {
+        if (depth == path.size())
+        {
+            node = value;
+            return;
+        }
+        if (node.leaf)
+            node = Node(); // Una hoja en el camino pasa a ser objeto
+        Node &child = node.kids[path[depth]];
+        setAt(child, path, depth + 1, value);
+        if (child.empty())
+            node.kids.erase(path[depth]);
+    }
+
+    // ========================================================================
+    // ESTADO COMPARTIDO
+    // ========================================================================
+
+    struct Settings
+    {
+        int delayMs = 0;
+        int jitterMs = 0;
+        double failRate = 0.0;
+        int failStatus = 503;
+        double dropRate = 0.0;
+        double stallRate = 0.0;
+        int stallMs = 10000;
+        int keepAliveS = 30;
+        bool verbose = false;
+    };
+
+    struct Stats
+    {
+        std::atomic<unsigned long> requests{0};
+        std::atomic<unsigned long> writes{0};
+        std::atomic<unsigned long> failed{0};
+        std::atomic<unsigned long> dropped{0};
+        std::atomic<unsigned long> stalled{0};
+        std::atomic<unsigned long> events{0};
+        std::atomic<int> streams{0};
+    };
+
+    // Escritura para los streams: un PATCH en "path" trae cada clave como sub-escritura
+    struct Change
+    {
+        unsigned long seq;
+        Path path;
+        bool patch;
+        std::string data;
+        std::vector<std::pair<Path, std::string>> parts;
+    };
+
+    std::mutex treeMutex;
+    Node root;
+    std::mutex settingsMutex;
+    Settings settings;
+    std::mt19937 rng(1);
+    Stats stats;
+
+    std::mutex changeMutex;
+    std::condition_variable changeCv;
+    std::deque<Change> changes;
+    unsigned long changeSeq = 0;
+    const size_t CHANGE_LOG = 1024;
+
+    void publish(Change change)
+    {
+        std::lock_guard<std::mutex> lock(changeMutex);
+        change.seq = ++changeSeq;
+        changes.push_back(std::move(change));
+        if (changes.size() > CHANGE_LOG)
+            changes.pop_front();
+        changeCv.notify_all();
+    }
+
+    Settings currentSettings()
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        return settings;
+    }
+
+    std::string settingsJson()
+    {
+        Settings s = currentSettings();
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "{\"delay_ms\":%d,\"jitter_ms\":%d,\"fail_rate\":%g,\"fail_status\":%d,\"drop_rate\":%g,"
+                 "\"stall_rate\":%g,\"stall_ms\":%d,\"keepalive_s\":%d}",
+                 s.delayMs, s.jitterMs, s.failRate, s.failStatus, s.dropRate, s.stallRate, s.stallMs, s.keepAliveS);
+        return buf;
+    }
+
+    bool applySettings(const Node &body)
+    {
+        if (body.leaf)
+            return false;
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        for (auto &kv : body.kids)
+        {
+            if (!kv.second.leaf)
+                return false;
+            double v = atof(kv.second.raw.c_str());
+            const std::string &k = kv.first;
+            if (k == "delay_ms")
+                settings.delayMs = int(v);
+            else if (k == "jitter_ms")
+                settings.jitterMs = int(v);
+            else if (k == "fail_rate")
+                settings.failRate = v;
+            else if (k == "fail_status")
+                settings.failStatus = int(v);
+            else if (k == "drop_rate")
+                settings.dropRate = v;
+            else if (k == "stall_rate")
+                settings.stallRate = v;
+            else if (k == "stall_ms")
+                settings.stallMs = int(v);
+            else if (k == "keepalive_s")
+                settings.keepAliveS = int(v);
+            else if (k == "seed")
+                rng.seed(unsigned(v));
+            else
+                return false;
+        }
+        return true;
+    }
+
+    std::string statsJson()
+    {
+        char buf[256];
+        snprintf(buf, sizeof(buf),
+                 "{\"requests\":%lu,\"writes\":%lu,\"failed\":%lu,\"dropped\":%lu,\"stalled\":%lu,\"events\":%lu,"
+                 "\"streams\":%d}",
+                 stats.requests.load(), stats.writes.load(), stats.failed.load(), stats.dropped.load(),
+                 stats.stalled.load(), stats.events.load(), stats.streams.load());
+        return buf;
+    }
+
+    // ========================================================================
+    // HTTP
+    // ========================================================================
+
+    struct Request
+    {
+        std::string method;
+        std::string path; // Sin ".json" ni query
+        std::string query;
+        std::map<std::string, std::string> headers; // Nombres en minúsculas
+        std::string body;
+    };
+
+    class Connection
+    {
+    public:
+        explicit Connection(int fd) : fd(fd) {}
+
+        bool readLine(std::string &line)
+        {
+            line.clear();
+            for (;;)
+            {
+                size_t nl = buf.find('\n');
+                if (nl != std::string::npos)
+                {
+                    line = buf.substr(0, nl);
+                    buf.erase(0, nl + 1);
+                    if (!line.empty() && line.back() == '\r')
+                        line.pop_back();
+                    return true;
+                }
+                if (buf.size() > 16384 || !fill())
+                    return false;
+            }
+        }
+
+        bool readBody(size_t n, std::string &out)
+        {
+            while (buf.size() < n)
+                if (!fill())
+                    return false;
+            out = buf.substr(0, n);
+            buf.erase(0, n);
+            return true;
+        }
+
+        bool send(const std::string &text)
+        {
+            size_t sent = 0;
+            while (sent < text.size())
+            {
+                ssize_t n = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0)
+                    return false;
+                sent += size_t(n);
+            }
+            return true;
+        }
+
+        int fd;
+
+    private:
+        std::string buf;
+
+        bool fill()
+        {
+            char tmp[4096];
+            ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+            if (n <= 0)
+                return false;
+            buf.append(tmp, size_t(n));
+            return true;
+        }
+    };
+
+    std::string urlDecode(const std::string &text)
+    {
+        std::string out;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            if (text[i] == '%' && i + 2 < text.size())
+            {
+                out += char(strtol(text.substr(i + 1, 2).c_str(), nullptr, 16));
+                i += 2;
+            }
+            else
+                out += text[i];
+        }
+        return out;
+    }
+
+    bool readRequest(Connection &c, Request &req)
+    {
+        std::string line;
+        if (!c.readLine(line) || line.empty())
+            return false;
+        size_t a = line.find(' ');
+        size_t b = line.find(' ', a + 1);
+        if (a == std::string::npos || b == std::string::npos)
+            return false;
+        req.method = line.substr(0, a);
+        std::string target = line.substr(a + 1, b - a - 1);
+        size_t q = target.find('?');
+        if (q != std::string::npos)
+        {
+            req.query = target.substr(q + 1);
+            target.erase(q);
+        }
+        if (target.size() >= 5 && target.compare(target.size() - 5, 5, ".json") == 0)
+            target.erase(target.size() - 5);
+        req.path = urlDecode(target);
+
+        while (c.readLine(line) && !line.empty())
+        {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos)
+                continue;
+            std::string name = line.substr(0, colon);
+            for (auto &ch : name)
+                ch = char(tolower((unsigned char)ch));
+            size_t v = line.find_first_not_of(' ', colon + 1);
+            req.headers[name] = v == std::string::npos ? "" : line.substr(v);
+        }
+        auto len = req.headers.find("content-length");
+        if (len != req.headers.end())
+            return c.readBody(size_t(atol(len->second.c_str())), req.body);
+        return true;
+    }
+
+    const char *reason(int status)
+    {
+        switch (status)
+        {
+        case 200:
+            return "OK";
+        case 204:
+            return "No Content";
+        case 400:
+            return "Bad Request";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        case 429:
+            return "Too Many Requests";
+        case 500:
+            return "Internal Server Error";
+        case 503:
+            return "Service Unavailable";
+        default:
+            return "Status";
+        }
+    }
+
+    bool respond(Connection &c, int status, const std::string &body)
+    {
+        char head[256];
+        snprintf(head, sizeof(head),
+                 "HTTP/1.1 %d %s\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: %zu\r\n"
+                 "Connection: keep-alive\r\nAccess-Control-Allow-Origin: *\r\n\r\n",
+                 status, reason(status), body.size());
+        return c.send(head + body);
+    }
+
+    std::string errorBody(const char *message)
+    {
+        return std::string("{\"error\":") + quote(message) + "}";
+    }
+
+    bool sendEvent(Connection &c, const char *event, const std::string &path, const std::string &data)
+    {
+        stats.events++;
+        return c.send(std::string("event: ") + event + "\ndata: {\"path\":" + quote(path) + ",\"data\":" + data +
+                      "}\n\n");
+    }
+
+    // Eventos de una escritura para un stream abierto en "stream"
+    bool forward(Connection &c, const Path &stream, const Change &ch)
+    {
+        if (isPrefix(stream, ch.path))
+            return sendEvent(c, ch.patch ? "patch" : "put", joinPath(ch.path, stream.size()), ch.data);
+
+        // Escritura por encima del stream: cada parte que lo toca
+        for (auto &part : ch.parts)
+        {
+            if (isPrefix(stream, part.first))
+            {
+                if (!sendEvent(c, "put", joinPath(part.first, stream.size()), part.second))
+                    return false;
+            }
+            else if (isPrefix(part.first, stream))
+            {
+                std::string data;
+                {
+                    std::lock_guard<std::mutex> lock(treeMutex);
+                    data = toJson(find(root, stream));
+                }
+                if (!sendEvent(c, "put", "/", data))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void serveStream(Connection &c, const Request &req)
+    {
+        Path stream = splitPath(req.path);
+        std::string initial;
+        unsigned long seen;
+        {
+            // Nodo inicial y posición en el log de cambios, sin huecos entre ambos
+            std::lock_guard<std::mutex> changeLock(changeMutex);
+            std::lock_guard<std::mutex> lock(treeMutex);
+            initial = toJson(find(root, stream));
+            seen = changeSeq;
+        }
+        if (!c.send("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+                    "Connection: keep-alive\r\nAccess-Control-Allow-Origin: *\r\n\r\n") ||
+            !sendEvent(c, "put", "/", initial))
+            return;
+
+        stats.streams++;
+        for (;;)
+        {
+            std::vector<Change> pending;
+            int keepAliveS = currentSettings().keepAliveS;
+            {
+                std::unique_lock<std::mutex> lock(changeMutex);
+                changeCv.wait_for(lock, std::chrono::seconds(keepAliveS > 0 ? keepAliveS : 30),
+                                  [&] { return changeSeq != seen; });
+                for (auto &ch : changes)
+                    if (ch.seq > seen)
+                        pending.push_back(ch);
+                seen = changeSeq;
+            }
+            bool ok = true;
+            if (pending.empty())
+                ok = c.send("event: keep-alive\ndata: null\n\n");
+            for (auto &ch : pending)
+                ok = ok && forward(c, stream, ch);
+            if (!ok)
+                break;
+        }
+        stats.streams--;
+    }
+
+    enum Fault
+    {
+        NO_FAULT,
+        FAIL,
+        DROP,
+        STALL
+    };
+
+    Fault pickFault(const Settings &s, int &delayMs)
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex);
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        delayMs = s.delayMs + (s.jitterMs > 0 ? int(u(rng) * s.jitterMs) : 0);
+        double r = u(rng);
+        if (r < s.dropRate)
+            return DROP;
+        r -= s.dropRate;
+        if (r < s.stallRate)
+            return STALL;
+        r -= s.stallRate;
+        return r < s.failRate ? FAIL : NO_FAULT;
+    }
+
+    // Una petición; false cierra la conexión
+    bool handle(Connection &c, const Request &req)
+    {
+        stats.requests++;
+        Settings s = currentSettings();
+        if (s.verbose)
+            printf("%s %s (%zu B)\n", req.method.c_str(), req.path.c_str(), req.body.size());
+
+        if (req.path == "/.settings")
+        {
+            Node body;
+            if (req.method == "PUT" || req.method == "PATCH")
+            {
+                if (!JsonParser(req.body).parse(body) || !applySettings(body))
+                    return respond(c, 400, errorBody("ajuste desconocido"));
+            }
+            return respond(c, 200, settingsJson());
+        }
+        if (req.path == "/.stats")
+            return respond(c, 200, statsJson());
+
+        auto accept = req.headers.find("accept");
+        if (req.method == "GET" && accept != req.headers.end() &&
+            accept->second.find("text/event-stream") != std::string::npos)
+        {
+            serveStream(c, req);
+            return false;
+        }
+
+        int delayMs;
+        Fault fault = pickFault(s, delayMs);
+        if (delayMs > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        if (fault == DROP)
+        {
+            stats.dropped++;
+            return false;
+        }
+        if (fault == STALL)
+        {
+            stats.stalled++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(s.stallMs));
+            return false;
+        }
+        if (fault == FAIL)
+        {
+            stats.failed++;
+            return respond(c, s.failStatus, errorBody("falla inyectada"));
+        }
+
+        Path path = splitPath(req.path);
+        bool silent = req.query.find("print=silent") != std::string::npos;
+        if (req.method == "GET")
+        {
+            std::string data;
+            {
+                std::lock_guard<std::mutex> lock(treeMutex);
+                data = toJson(find(root, path));
+            }
+            return respond(c, 200, data);
+        }
+
+        Node body;
+        if (req.method == "DELETE")
+            body = Node();
+        else if (req.method != "PUT" && req.method != "PATCH")
+            return respond(c, 405, errorBody("metodo no soportado"));
+        else if (!JsonParser(req.body).parse(body))
+            return respond(c, 400, errorBody("Invalid data; couldn't parse JSON object"));
+        if (req.method == "PATCH" && body.leaf)
+            return respond(c, 400, errorBody("PATCH requiere un objeto"));
+
+        Change change;
+        change.path = path;
+        change.patch = req.method == "PATCH";
+        {
+            std::lock_guard<std::mutex> lock(treeMutex);
+            if (change.patch)
+            {
+                for (auto &kv : body.kids)
+                {
+                    Path full = path;
+                    for (auto &seg : splitPath(kv.first))
+                        full.push_back(seg);
+                    setAt(root, full, 0, kv.second);
+                    change.parts.push_back({full, toJson(&kv.second)});
+                }
+            }
+            else
+            {
+                setAt(root, path, 0, body);
+                change.parts.push_back({path, toJson(&body)});
+            }
+        }
+        change.data = toJson(&body);
+        stats.writes++;
+        std::string echo = change.data;
+        publish(std::move(change));
+        return silent ? respond(c, 204, "") : respond(c, 200, echo);
+    }
+
+    void serve(int fd)
+    {
+        // Conexiones ociosas: se cierran a los 2 minutos, como hace RTDB
+        timeval tv = {120, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        Connection c(fd);
+        Request req;
+        while (readRequest(c, req))
+        {
+            auto conn = req.headers.find("connection");
+            bool close = conn != req.headers.end() && conn->second.find("close") != std::string::npos;
+            if (!handle(c, req) || close)
+                break;
+            req = Request();
+        }
+        ::close(fd);
+    }
+
+    bool option(int argc, char **argv, int &i, const char *name, double &value)
+    {
+        if (strcmp(argv[i], name) != 0 || i + 1 >= argc)
+            return false;
+        value = atof(argv[++i]);
+        return true;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    signal(SIGPIPE, SIG_IGN);
+    int port = 8787;
+    for (int i = 1; i < argc; i++)
+    {
+        double v;
+        if (option(argc, argv, i, "--port", v))
+            port = int(v);
+        else if (option(argc, argv, i, "--seed", v))
+            rng.seed(unsigned(v));
+        else if (option(argc, argv, i, "--delay-ms", v))
+            settings.delayMs = int(v);
+        else if (option(argc, argv, i, "--jitter-ms", v))
+            settings.jitterMs = int(v);
+        else if (option(argc, argv, i, "--fail-rate", v))
+            settings.failRate = v;
+        else if (option(argc, argv, i, "--fail-status", v))
+            settings.failStatus = int(v);
+        else if (option(argc, argv, i, "--drop-rate", v))
+            settings.dropRate = v;
+        else if (option(argc, argv, i, "--stall-rate", v))
+            settings.stallRate = v;
+        else if (option(argc, argv, i, "--stall-ms", v))
+            settings.stallMs = int(v);
+        else if (option(argc, argv, i, "--keepalive-s", v))
+            settings.keepAliveS = int(v);
+        else if (strcmp(argv[i], "-v") == 0)
+            settings.verbose = true;
+        else
+        {
+            fprintf(stderr, "Opcion desconocida: %s (ver el encabezado de rtdb_server.cpp)\n", argv[i]);
+            return 2;
+        }
+    }
+
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(uint16_t(port));
+    if (server < 0 || bind(server, (sockaddr *)&addr, sizeof(addr)) != 0 || listen(server, 64) != 0)
+    {
+        perror("rtdb_server");
+        return 1;
+    }
+    printf("rtdb_server escuchando en el puerto %d, ajustes %s\n", port, settingsJson().c_str());
+    fflush(stdout);
+
+    for (;;)
+    {
+        int fd = accept(server, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+        std::thread(serve, fd).detach();
+    }
+}